@@ -0,0 +1,91 @@
+/*
+ * app_tasks.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef INC_APP_TASKS_H_
+#define INC_APP_TASKS_H_
+
+#include "stm32f4xx_hal.h"
+#include "cmsis_os2.h"
+
+/* --- Defines --- */
+#define DTC_PERSIST_WINDOW_MS   500U    // Changes within this window after the first one are saved as one log record
+#define EEPROM_CACHE_POLL_MS    100U    // SPITask checks the EEPROM cache for pages due to be written back this often
+/* Dirty pages that make the whole cache due for write-back, one page per
+   SPITask pass. A save can sit in RAM for up to DTC_PERSIST_WINDOW_MS twice
+   over (the window, then the page age), so power-down syncs the cache; a
+   cut too fast for the PVD loses up to about 1 s of changes. */
+#define EEPROM_CACHE_MAX_DIRTY  4U
+
+/* --- Types --- */
+/**
+ * @brief The peripherals and RTOS objects the tasks use, created by main.
+ */
+typedef struct {
+    CAN_HandleTypeDef* hcan;
+    I2C_HandleTypeDef* hi2c;        // PMIC
+    ADC_HandleTypeDef* hadc;        // Sampled into DTC snapshots
+    UART_HandleTypeDef* huart;      // Debug output
+    osMutexId_t comm_mutex;         // I2C bus and UART
+    osThreadId_t i2c_task;
+    osThreadId_t spi_task;
+    osThreadId_t can_task;
+    osThreadId_t uart_task;
+    osThreadId_t can_rx_task;
+} App_Tasks_t;
+
+/* --- Public Function Prototypes --- */
+/*
+ * The bodies of the CubeMX tasks, kept out of main.c so the host tests can
+ * run them on the simulated kernel. Each App_*_Task never returns.
+ */
+
+/**
+ * @brief Sets up the EEPROM cache, the DTC callbacks and the storage queue.
+ * @note  Call once the threads exist, before the scheduler starts. The
+ *        EEPROM and CAN drivers must have been initialized.
+ * @param p_config Kept by reference; must stay valid.
+ * @retval HAL_StatusTypeDef HAL status.
+ */
+HAL_StatusTypeDef App_Tasks_Init(const App_Tasks_t* p_config);
+
+/**
+ * @brief I2CTask: polls the PMIC for under-voltage and owns the DTC
+ *        debounce and clear.
+ */
+void App_I2C_Task(void);
+
+/**
+ * @brief SPITask: restores the DTC state and owns the operation cycle
+ *        boundaries, then SPI1: saves, queued storage requests and EEPROM
+ *        cache write-back.
+ */
+void App_SPI_Task(void);
+
+/**
+ * @brief CANTask: broadcasts the saved DTC state every second.
+ */
+void App_CAN_Task(void);
+
+/**
+ * @brief UARTTask: the debug printout, after a DTC read or clear.
+ */
+void App_UART_Task(void);
+
+/**
+ * @brief CANRxTask: the CAN receive consumer, running ISO-TP and UDS. It
+ *        never waits on anything but CanQueue, so a request is answered
+ *        within P2 whatever the other tasks hold.
+ */
+void App_CAN_Rx_Task(void);
+
+/**
+ * @brief Ends the operation cycle: the supply is going down. SPITask ends
+ *        it, saves it and writes the EEPROM cache back at once.
+ * @note  Called from HAL_PWR_PVDCallback.
+ */
+void App_Power_Down(void);
+
+#endif /* INC_APP_TASKS_H_ */
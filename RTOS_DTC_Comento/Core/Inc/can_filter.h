@@ -0,0 +1,70 @@
+/*
+ * can_filter.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef INC_CAN_FILTER_H_
+#define INC_CAN_FILTER_H_
+
+#include "stm32f4xx_hal.h"
+
+/* --- Defines --- */
+#define CAN_FILTER_BANK_COUNT      14   // Banks owned by CAN1; CAN2 starts at this bank
+#define CAN_FILTER_MAX_ENTRIES     32   // Acceptance entries the manager can hold
+
+#define CAN_FILTER_STD_EXACT       0x7FFU       // Mask that matches one 11-bit ID
+#define CAN_FILTER_EXT_EXACT       0x1FFFFFFFU  // Mask that matches one 29-bit ID
+
+// J1939 identifiers are matched on the PGN, ignoring priority and source address
+#define CAN_FILTER_J1939_PGN_MASK  0x03FFFF00U
+
+/* --- Types --- */
+// One acceptance entry. Exact entries are packed into list-mode banks,
+// masked ones into mask-mode banks; 11-bit IDs use the 16-bit scale.
+typedef struct {
+    uint32_t id;
+    uint32_t mask;   // ID bits that must match, CAN_FILTER_STD_EXACT/EXT_EXACT for one ID
+    uint32_t ide;    // CAN_ID_STD or CAN_ID_EXT
+} CAN_Filter_Entry_t;
+
+/* --- Public Function Prototypes --- */
+
+/**
+ * @brief Loads the default diagnostic entries and programs the banks.
+ * @param hcan Pointer to a CAN_HandleTypeDef structure.
+ * @retval HAL_StatusTypeDef HAL status.
+ */
+HAL_StatusTypeDef CAN_Filter_Init(CAN_HandleTypeDef* hcan);
+
+/**
+ * @brief Adds an entry to the table. Takes effect on the next CAN_Filter_Apply.
+ * @param entry Entry to add; an identical entry is not added twice.
+ * @retval HAL_StatusTypeDef HAL status. HAL_ERROR if the table is full.
+ */
+HAL_StatusTypeDef CAN_Filter_Add(const CAN_Filter_Entry_t* entry);
+
+/**
+ * @brief Removes every entry with the given ID. Takes effect on the next CAN_Filter_Apply.
+ * @param id Identifier of the entries to remove.
+ * @param ide CAN_ID_STD or CAN_ID_EXT.
+ * @retval HAL_StatusTypeDef HAL status. HAL_ERROR if no entry matched.
+ */
+HAL_StatusTypeDef CAN_Filter_Remove(uint32_t id, uint32_t ide);
+
+/**
+ * @brief Packs the table into the filter banks and programs them.
+ * @note  May be called while the bus is running. Each bank is briefly
+ *        disabled while it is rewritten, so matching frames can be missed
+ *        during the update. Call from one task at a time.
+ * @retval HAL_StatusTypeDef HAL status. HAL_ERROR if the table needs more
+ *         than CAN_FILTER_BANK_COUNT banks; the hardware is left unchanged.
+ */
+HAL_StatusTypeDef CAN_Filter_Apply(void);
+
+/**
+ * @brief Returns the number of banks programmed by the last CAN_Filter_Apply.
+ */
+uint8_t CAN_Filter_GetBanksUsed(void);
+
+#endif /* INC_CAN_FILTER_H_ */
@@ -9,10 +9,32 @@
 #define INC_CAN_MANAGER_H_
 
 #include "stm32f4xx_hal.h"
+#include "cmsis_os2.h"
 
 /* --- Defines --- */
-#define CAN_DTC_TRANSMIT_ID   0x18FF50E5 // Example Extended CAN ID for DTC Transmission
-#define CAN_DIAG_RECEIVE_ID   0x18DB33F1 // Example Extended CAN ID for Diagnostic Request
+#define CAN_DTC_TRANSMIT_ID            0x18FF50E5 // Example Extended CAN ID for DTC Transmission
+#define CAN_DTC_FLOW_CONTROL_ID        0x18FF50F1 // Flow control from the tester for the DTC broadcast
+#define CAN_DIAG_RECEIVE_ID            0x18DB33F1 // Example Extended CAN ID for Diagnostic Request
+#define CAN_DIAG_PHYSICAL_RECEIVE_ID   0x18DAE5F1 // Physical requests from the tester at 0xF1 to us at 0xE5
+#define CAN_DIAG_TRANSMIT_ID           0x18DAF1E5 // Diagnostic responses and flow control, to the tester at 0xF1
+#define CAN_OBD_FUNCTIONAL_RECEIVE_ID  0x7DF      // 11-bit functional request to every ECU
+#define CAN_OBD_PHYSICAL_RECEIVE_ID    0x7E0      // 11-bit physical request, ours of 0x7E0-0x7E7
+#define CAN_OBD_TRANSMIT_ID            0x7E8      // 11-bit response, physical request ID + 8
+
+/* --- ISO-TP (ISO 15765-2) Configuration --- */
+#define CAN_ISOTP_TX_BUFFER_SIZE  4095  // Largest message that can be transmitted, in bytes
+#define CAN_ISOTP_RX_BUFFER_SIZE  4095  // Largest message that can be reassembled, in bytes
+#define CAN_ISOTP_BLOCK_SIZE      0     // BS sent in our flow control frames (0 = no further FC)
+#define CAN_ISOTP_ST_MIN          0     // STmin sent in our flow control frames (ms)
+#define CAN_ISOTP_TIMEOUT_MS      1000  // N_Bs / N_Cr timeout waiting for the peer
+#define CAN_ISOTP_PADDING         0xCC  // Filler byte for unused frame data
+#define CAN_ISOTP_TX_WINDOW       3     // Frames of one message queued ahead of the bus
+
+/* --- Transmit Queue Configuration --- */
+#define CAN_TX_QUEUE_SIZE         16    // Frames per priority level, must be a power of two
+
+/* --- Receive Pipeline Configuration --- */
+#define CAN_RX_POOL_SIZE          16    // Received frames that can wait for the consumer task
 
 /* --- Enums --- */
 // Commands received from the diagnostic tool
@@ -22,6 +44,28 @@ typedef enum {
     CMD_READ_DTC = 2,
 } CAN_Command_t;
 
+// Transmit priority; higher levels are moved into the mailboxes first
+typedef enum {
+    CAN_TX_PRIORITY_HIGH = 0,   // Flow control and diagnostic responses
+    CAN_TX_PRIORITY_NORMAL,     // DTC broadcasts
+    CAN_TX_PRIORITY_LOW,        // Periodic telemetry
+    CAN_TX_PRIORITY_COUNT
+} CAN_TxPriority_t;
+
+/* --- Types --- */
+// Bus traffic and error counters collected by the CAN Manager
+typedef struct {
+    uint32_t tx_frames;      // Frames acknowledged on the bus
+    uint32_t tx_errors;      // Frames rejected by HAL or lost to arbitration/bus errors
+    uint32_t rx_frames;      // Frames read from the RX FIFOs
+    uint32_t rx_fifo_full;   // An RX FIFO reached its depth of three frames
+    uint32_t rx_overruns;    // Frames dropped by the hardware because a FIFO was full
+    uint32_t tx_bits;        // Bus bits used by transmitted frames, including stuff bits
+    uint32_t rx_bits;        // Bus bits used by received frames, including stuff bits
+    uint32_t tx_queue_full;  // Frames refused because their priority level was full
+    uint32_t rx_pool_empty;  // Times reception paused because every pool frame was in use
+} CAN_Manager_Stats_t;
+
 /* --- Public Function Prototypes --- */
 
 /**
@@ -32,24 +76,82 @@ typedef enum {
 HAL_StatusTypeDef CAN_Manager_Init(CAN_HandleTypeDef* hcan);
 
 /**
- * @brief Transmits DTC data over the CAN bus using interrupts.
+ * @brief Transmits DTC data over the CAN bus as an ISO-TP message using interrupts.
+ * @note  The data is copied, so the buffer can be reused as soon as this returns.
+ *        Messages longer than 7 bytes are segmented and paced by the receiver's
+ *        flow control frames, which arrive on CAN_DTC_FLOW_CONTROL_ID. The
+ *        broadcast has its own ISO-TP link, so diagnostic responses never wait
+ *        for it; other traffic keeps flowing between the segments.
+ *        Lock-free, so it may be called from tasks and interrupts.
  * @param hcan Pointer to a CAN_HandleTypeDef structure.
  * @param dtc_data Pointer to the DTC data buffer.
- * @param size The size of the DTC data in bytes.
- * @retval HAL_StatusTypeDef HAL status.
+ * @param size The size of the DTC data in bytes, up to CAN_ISOTP_TX_BUFFER_SIZE.
+ * @retval HAL_StatusTypeDef HAL status. HAL_BUSY while the previous DTC message is still being sent.
  */
 HAL_StatusTypeDef CAN_Manager_Transmit_DTC(CAN_HandleTypeDef* hcan, uint8_t* dtc_data, uint16_t size);
 
 /**
- * @brief Gets the last command received via CAN.
- * @retval The received command of type CAN_Command_t.
+ * @brief Queues a single CAN frame, e.g. telemetry, for transmission.
+ * @note  Lock-free, so it may be called from tasks and interrupts without
+ *        holding CommMutexHandle. Frames of one priority leave in order.
+ * @param id Standard or extended identifier.
+ * @param ide CAN_ID_STD or CAN_ID_EXT.
+ * @param data Pointer to the frame data.
+ * @param dlc Number of data bytes, 0 to 8.
+ * @param priority Queue the frame is placed in.
+ * @retval HAL_StatusTypeDef HAL status. HAL_BUSY if that priority level is full.
+ */
+HAL_StatusTypeDef CAN_Manager_Transmit_Frame(uint32_t id, uint32_t ide, const uint8_t* data, uint8_t dlc, CAN_TxPriority_t priority);
+
+/**
+ * @brief Starts interrupt-driven reception into the given queue.
+ * @note  Call once the RTOS objects exist, before the scheduler starts. The RX
+ *        interrupt takes frames from an internal pool and posts pointers to
+ *        the queue, so it must hold at least CAN_RX_POOL_SIZE pointers.
+ * @param queue Message queue with void * sized items.
+ * @retval HAL_StatusTypeDef HAL status.
+ */
+HAL_StatusTypeDef CAN_Manager_Start_Rx(osMessageQueueId_t queue);
+
+/**
+ * @brief Waits for one received frame and runs it through ISO-TP and UDS.
+ * @note  Called in a loop by the consumer task. Every request yields its own
+ *        command, so none is lost to a later one.
+ * @param timeout Maximum time to wait for a frame, in ticks (osWaitForever allowed).
+ * @retval Command carried by a message this frame completed, or CMD_NONE.
+ */
+CAN_Command_t CAN_Manager_Process_Rx(uint32_t timeout);
+
+/**
+ * @brief Copies the bus traffic and error counters.
+ * @param p_stats Pointer to the structure that receives the counters.
+ */
+void CAN_Manager_Get_Stats(CAN_Manager_Stats_t* p_stats);
+
+/**
+ * @brief Resets the bus traffic and error counters to zero.
+ */
+void CAN_Manager_Reset_Stats(void);
+
+/**
+ * @brief Computes the nominal bitrate from the CAN bit timing configuration.
+ * @param hcan Pointer to a CAN_HandleTypeDef structure.
+ * @retval Bitrate in bit/s.
+ */
+uint32_t CAN_Manager_Get_Bitrate(CAN_HandleTypeDef* hcan);
+
+/**
+ * @brief Runs the ISO-TP timers (STmin pacing, N_Bs/N_Cr timeouts).
+ * @note  Must be called every 1 ms, from the SysTick handler. The timers are
+ *        evaluated in CAN_Manager_TX_IRQHandler, which this triggers.
  */
-CAN_Command_t CAN_Manager_Get_Command(void);
+void CAN_Manager_Tick(void);
 
 /**
- * @brief Clears the last received command.
- *        Should be called after a command has been processed.
+ * @brief Continues the ISO-TP session and moves queued frames into the mailboxes.
+ * @note  Must be called from CAN1_TX_IRQHandler, after HAL_CAN_IRQHandler.
+ *        The interrupt is also pended by software whenever a frame is queued.
  */
-void CAN_Manager_Clear_Command(void);
+void CAN_Manager_TX_IRQHandler(void);
 
 #endif /* INC_CAN_MANAGER_H_ */
@@ -3,43 +3,279 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "dtc_table.h"
 
 /**
  * @brief Diagnostic Trouble Codes for the Brake System PMIC
- * @note These are example codes. Actual codes should follow automotive standards like SAE J2012.
+ * @note Generated from DTC_TABLE in dtc_table.h; add new DTCs there.
  */
 typedef enum {
-    // PMIC Under-Voltage Faults
-    DTC_PMIC_BUCK_A_UNDERVOLTAGE = 0,  // Fault code for Buck A rail
-    DTC_PMIC_BUCK_B_UNDERVOLTAGE = 1,  // Fault code for Buck B rail
-    DTC_PMIC_BUCK_C_UNDERVOLTAGE = 2,  // Fault code for Buck C rail
-    DTC_PMIC_BUCK_D_UNDERVOLTAGE = 3,  // Fault code for Buck D rail
-
-    // Add other DTCs for the system here...
-    // e.g., DTC_PMIC_OVER_TEMPERATURE = 4,
-
+#define DTC_ENUM_ENTRY(name, ...) name,
+    DTC_TABLE(DTC_ENUM_ENTRY)
+#undef DTC_ENUM_ENTRY
     DTC_CODE_COUNT // Total number of DTCs, must be last
 } DTC_Code_t;
 
+/**
+ * @brief Size of the DTC status store, derived from DTC_CODE_COUNT.
+ * @note Status bytes are stored bit-sliced: one bitset per status bit.
+ */
+#define DTC_STATUS_BIT_COUNT    8
+#define DTC_WORD_COUNT          ((DTC_CODE_COUNT + 31) / 32)  // Words per status bit
+#define DTC_SUMMARY_WORD_COUNT  ((DTC_WORD_COUNT + 31) / 32)  // One bit per non-zero word of a status bit
+#define DTC_EXT_DATA_SIZE       10  // Bytes of one DTC_ExtData_t in DTC_Export
+#define DTC_STORAGE_SIZE        (DTC_STATUS_BIT_COUNT * DTC_WORD_COUNT * 4 + DTC_CODE_COUNT + \
+                                 DTC_CODE_COUNT * DTC_EXT_DATA_SIZE) // Bytes used by DTC_Export
+
+/**
+ * @brief Aging and healing, counted in fault-free operation cycles.
+ * @note A cycle counts as fault-free when the test completed and never
+ *       failed during it. A cycle in which the test failed restarts the count.
+ */
+#define DTC_HEALING_CYCLES      3   // Fault-free cycles before warningIndicatorRequested is cleared
+#define DTC_AGING_CYCLES        40  // Fault-free cycles before a confirmed DTC is cleared
+
+/**
+ * @brief Walks the DTCs matching a status mask in ascending order.
+ * @note A walk only touches words holding a match, so its cost follows
+ *       the number of matching DTCs, not DTC_CODE_COUNT.
+ */
+typedef struct {
+    uint16_t word_index;    // Word currently being consumed
+    uint8_t status_mask;    // Status bits a DTC must have one of
+    uint32_t pending;       // Matching bits of that word not yet returned
+} DTC_Iterator_t;
+
+/**
+ * @brief Freeze frame: the conditions recorded when a DTC occurs.
+ * @note Filled in by the caller of DTC_SetWithSnapshot. Add a field here and
+ *       an entry to the snapshot data identifier table in uds_server.c to
+ *       record another data item.
+ */
+typedef struct {
+    uint16_t rail_setpoint_mv[4];   // Buck A..D output setpoints
+    uint16_t adc_raw;               // ADC1 reading
+    uint8_t  status_uv;             // Raw MP5475GU STATUS_UV register
+    uint32_t timestamp_ms;          // Kernel tick at capture
+} DTC_Snapshot_t;
+
+#define DTC_SNAPSHOT_RING_SIZE       8     // Latest-occurrence records kept for all DTCs together, a power of two
+#define DTC_SNAPSHOT_FIRST_POOL_SIZE 2     // First-occurrence records pinned for all DTCs together, at most 32
+#define DTC_SNAPSHOT_RECORD_FIRST    0x01  // DTCSnapshotRecordNumber of the first occurrence
+#define DTC_SNAPSHOT_RECORD_LATEST   0x02  // DTCSnapshotRecordNumber of the most recent occurrence
+
+/**
+ * @brief Occurrence counters and timestamps of one DTC (extended data).
+ * @note Updated in place when testFailed goes from 0 to 1, without
+ *       allocating. Kept since the last clear and saved with DTC_Export.
+ *       A hard fault counts one occurrence and then one pending cycle per
+ *       operation cycle; an intermittent one counts an occurrence every
+ *       time it comes back.
+ */
+typedef struct {
+    uint32_t first_failure_time;    // Time of the first failure, DTC_TIMESTAMP_RESOLUTION_US units
+    uint32_t last_failure_time;     // Time of the most recent failure, same units
+    uint8_t  occurrence_counter;    // Failures (testFailed 0 -> 1), saturates at 255
+    uint8_t  pending_counter;       // Operation cycles in which the DTC failed and became pending, saturates at 255
+} DTC_ExtData_t;
+
+#define DTC_TIMESTAMP_RESOLUTION_US 100U  // 32-bit timestamps wrap after about 119 hours
+
+/**
+ * @brief Returns the current time for occurrence timestamps, in
+ *        DTC_TIMESTAMP_RESOLUTION_US units.
+ * @note Called from DTC_Set, so it must be callable from an ISR.
+ */
+typedef uint32_t (*DTC_TimeSource_t)(void);
+
+/**
+ * @brief Called when the saved DTC state changes and should be written to
+ *        non-volatile memory.
+ * @note May be called from the context that changed the DTC, including an
+ *       ISR, so it must only signal the task that does the write.
+ */
+typedef void (*DTC_ChangeCallback_t)(void);
+
+/**
+ * @brief Monitor result passed to DTC_ReportEvent.
+ */
+typedef enum {
+    DTC_EVENT_PASSED = 0,   // Test passed, qualified immediately
+    DTC_EVENT_FAILED,       // Test failed, qualified immediately
+    DTC_EVENT_PREPASSED,    // Sample looks good, debounced towards passed
+    DTC_EVENT_PREFAILED     // Sample looks bad, debounced towards failed
+} DTC_Event_Status_t;
+
+/**
+ * @brief Debounce algorithms.
+ */
+typedef enum {
+    DTC_DEBOUNCE_COUNTER = 0,   // Qualify after enough prefailed/prepassed reports
+    DTC_DEBOUNCE_TIME           // Qualify after prefailed/prepassed persists long enough
+} DTC_Debounce_Algorithm_t;
+
+/**
+ * @brief Debounce settings of one DTC.
+ * @note A report in the opposite direction restarts the debounce from zero,
+ *       so a signal that toggles every sample never qualifies either way.
+ */
+typedef struct {
+    DTC_Debounce_Algorithm_t algorithm;
+    uint16_t fail_threshold;    // Counter: prefailed reports to fail, time: ms
+    uint16_t pass_threshold;    // Counter: prepassed reports to pass, time: ms
+} DTC_Debounce_Config_t;
+
+/**
+ * @brief Definition of a DTC, generated from DTC_TABLE.
+ * @note Lives in flash; DTC_GetDefinition returns a pointer into it.
+ */
+typedef struct {
+    uint32_t number;                // 3-byte UDS DTC number
+    uint8_t severity;               // DTC_SEVERITY_* bits
+    uint8_t functional_unit;        // DTC_FUNCTIONAL_UNIT_*
+    bool snapshot;                  // Record a snapshot when the DTC occurs
+    DTC_Debounce_Config_t debounce;
+    const char* description;
+} DTC_Definition_t;
+
+/**
+ * @brief ISO 14229-1 DTC severity bits (DTCSeverityMask)
+ */
+#define DTC_SEVERITY_NONE                       0x00
+#define DTC_SEVERITY_MAINTENANCE_ONLY           0x20
+#define DTC_SEVERITY_CHECK_AT_NEXT_HALT         0x40
+#define DTC_SEVERITY_CHECK_IMMEDIATELY          0x80
+
+/**
+ * @brief DTC functional units (manufacturer specific)
+ */
+#define DTC_FUNCTIONAL_UNIT_POWER_SUPPLY        0x01  // PMIC rails of the brake ECU
+
+/**
+ * @brief ISO 14229-1 DTC status bits
+ */
+#define DTC_STATUS_TEST_FAILED                  0x01
+#define DTC_STATUS_TEST_FAILED_THIS_OP_CYCLE    0x02
+#define DTC_STATUS_PENDING                      0x04
+#define DTC_STATUS_CONFIRMED                    0x08
+#define DTC_STATUS_TEST_NOT_COMPLETED_SINCE_CLEAR 0x10
+#define DTC_STATUS_TEST_FAILED_SINCE_CLEAR      0x20
+#define DTC_STATUS_TEST_NOT_COMPLETED_THIS_OP_CYCLE 0x40
+#define DTC_STATUS_WARNING_INDICATOR            0x80
+
+/**
+ * @brief Status bits this ECU supports (DTCStatusAvailabilityMask).
+ */
+#define DTC_STATUS_AVAILABILITY_MASK  0xFF
+
 /**
  * @brief Initializes the DTC manager.
+ * @note Call before any task or ISR reports DTCs.
+ * @param p_saved State saved with DTC_Export to restore, or NULL to start
+ *        with every DTC cleared.
+ * @param size Number of bytes at p_saved. Less than DTC_STORAGE_SIZE starts
+ *        cleared too.
  */
-void DTC_Init(void);
+void DTC_Init(const uint8_t* p_saved, uint16_t size);
+
+/**
+ * @brief Registers the function told about changes that need saving.
+ * @param callback Function to call, or NULL for none.
+ */
+void DTC_RegisterChangeCallback(DTC_ChangeCallback_t callback);
+
+/**
+ * @brief Registers the clock used for occurrence timestamps.
+ * @param source Function to call, or NULL to record zero timestamps.
+ */
+void DTC_RegisterTimeSource(DTC_TimeSource_t source);
+
+/**
+ * @brief Starts an operation cycle.
+ * @note Clears testFailedThisOperationCycle and sets
+ *       testNotCompletedThisOperationCycle for every DTC.
+ */
+void DTC_StartOperationCycle(void);
+
+/**
+ * @brief Ends the operation cycle: updates pending, aging and healing.
+ * @note All DTCs are updated in one pass. A DTC whose test completed
+ *       without failing loses pendingDTC and counts a fault-free cycle;
+ *       warningIndicatorRequested is cleared after DTC_HEALING_CYCLES and
+ *       confirmedDTC after DTC_AGING_CYCLES such cycles.
+ * @return true if any status bit or aging counter changed, so the state
+ *         should be saved.
+ */
+bool DTC_EndOperationCycle(void);
 
 /**
  * @brief Sets a specific DTC to indicate a fault has occurred.
+ * @note Lock-free and safe to call from tasks and ISRs at the same time.
  * @param code The DTC to set.
  */
 void DTC_Set(DTC_Code_t code);
 
+/**
+ * @brief Sets a DTC and records a snapshot if this is a new occurrence.
+ * @note The first occurrence since the last clear and every new occurrence
+ *       (testFailed going from 0 to 1) are recorded. Capture copies the
+ *       snapshot without locking. The latest records share a ring, and once
+ *       it is full the oldest one is overwritten. The first
+ *       DTC_SNAPSHOT_FIRST_POOL_SIZE DTCs to fail after a clear keep their
+ *       first record pinned until the next clear; the first record of any
+ *       other DTC lives in the ring like a latest one.
+ * @param code The DTC to set.
+ * @param snapshot Conditions at the time of the fault.
+ */
+void DTC_SetWithSnapshot(DTC_Code_t code, const DTC_Snapshot_t* snapshot);
+
+/**
+ * @brief Reads a stored snapshot record of a DTC.
+ * @param code The DTC to query.
+ * @param record_number DTC_SNAPSHOT_RECORD_FIRST or DTC_SNAPSHOT_RECORD_LATEST.
+ * @param snapshot Receives the record.
+ * @return true if the record is stored, false if it was never captured or
+ *         has been overwritten.
+ */
+bool DTC_GetSnapshot(DTC_Code_t code, uint8_t record_number, DTC_Snapshot_t* snapshot);
+
+/**
+ * @brief Reads the occurrence counters and timestamps of a DTC.
+ * @param code The DTC to query.
+ * @param p_data Receives the record; all zero if the DTC has not failed
+ *        since the last clear.
+ * @return true if the code is valid, false otherwise.
+ */
+bool DTC_GetExtData(DTC_Code_t code, DTC_ExtData_t* p_data);
+
+/**
+ * @brief Reports a monitor result to the debounce engine.
+ * @note The DTC is only set or cleared once the result is qualified
+ *       according to its entry in the debounce table, so a noisy signal
+ *       does not change the DTC status on every sample. May be called from
+ *       an ISR, but each DTC must be reported from one context only.
+ * @param code The DTC the monitor checks.
+ * @param status Result of the test.
+ * @param now_ms Current time in ms, used by time-based debouncing.
+ * @param snapshot Conditions of this sample, recorded if it sets the DTC.
+ *        May be NULL.
+ */
+void DTC_ReportEvent(DTC_Code_t code, DTC_Event_Status_t status, uint32_t now_ms,
+                     const DTC_Snapshot_t* snapshot);
+
 /**
  * @brief Clears a specific DTC, indicating a fault is resolved.
+ * @note Lock-free and safe to call from tasks and ISRs at the same time.
  * @param code The DTC to clear.
  */
 void DTC_Clear(DTC_Code_t code);
 
 /**
- * @brief Clears all DTCs.
+ * @brief Clears all DTCs, their snapshot records, extended data, debounce
+ *        state and aging counters.
+ * @note The debounce state and aging counters are reset with plain stores,
+ *       so call this from the context that reports events and ends the
+ *       operation cycle.
  */
 void DTC_ClearAll(void);
 
@@ -51,15 +287,88 @@ void DTC_ClearAll(void);
 bool DTC_IsSet(DTC_Code_t code);
 
 /**
- * @brief Gets the entire DTC status bitmask.
- * @return The 32-bit bitmask representing all DTC statuses.
+ * @brief Gets the ISO 14229-1 status byte of a DTC.
+ * @param code The DTC to query.
+ * @return The status byte, 0 for an invalid code.
+ */
+uint8_t DTC_GetStatus(DTC_Code_t code);
+
+/**
+ * @brief Gets the 3-byte UDS DTC number (SAE J2012 code plus failure type byte).
+ * @param code The DTC to query.
+ * @return The DTC number, 0 for an invalid code.
+ */
+uint32_t DTC_GetNumber(DTC_Code_t code);
+
+/**
+ * @brief Gets the definition of a DTC from the table in flash.
+ * @param code The DTC to query.
+ * @return Pointer to the definition, NULL for an invalid code.
+ */
+const DTC_Definition_t* DTC_GetDefinition(DTC_Code_t code);
+
+/**
+ * @brief Finds the DTC with a given 3-byte UDS DTC number.
+ * @note A switch generated from DTC_TABLE, which the compiler turns into a
+ *       binary search or jump table.
+ * @param number The DTC number to look up.
+ * @param p_code Receives the matching DTC.
+ * @return true if the number belongs to a DTC, false otherwise.
+ */
+bool DTC_FindByNumber(uint32_t number, DTC_Code_t* p_code);
+
+/**
+ * @brief Counts the DTCs that are currently set.
+ * @note Constant time: reads a population count kept by every status update.
+ * @return Number of active DTCs.
+ */
+uint16_t DTC_GetActiveCount(void);
+
+/**
+ * @brief Counts the DTCs whose status matches any bit of a mask.
+ * @note Does not visit the DTCs: a single-bit mask reads one population
+ *       count, other masks sum at most 64 entries of a status histogram.
+ * @param status_mask Status bits to match.
+ * @return Number of matching DTCs.
+ */
+uint16_t DTC_CountByStatusMask(uint8_t status_mask);
+
+/**
+ * @brief Starts a walk over the active DTCs.
+ * @param it Iterator to initialize.
+ */
+void DTC_Iterator_Init(DTC_Iterator_t* it);
+
+/**
+ * @brief Starts a walk over the DTCs whose status matches any bit of a mask.
+ * @param it Iterator to initialize.
+ * @param status_mask Status bits to match.
+ */
+void DTC_Iterator_InitByStatusMask(DTC_Iterator_t* it, uint8_t status_mask);
+
+/**
+ * @brief Returns the next DTC of a walk.
+ * @param it Iterator started with DTC_Iterator_Init or DTC_Iterator_InitByStatusMask.
+ * @param p_code Receives the DTC.
+ * @return true if a DTC was returned, false at the end of the walk.
+ */
+bool DTC_Iterator_Next(DTC_Iterator_t* it, DTC_Code_t* p_code);
+
+/**
+ * @brief Serializes the DTC states for non-volatile storage.
+ * @param buffer Destination, each status plane as little-endian words, then
+ *        one aging counter per DTC, then the extended data of each DTC.
+ * @param size Size of the buffer, at least DTC_STORAGE_SIZE.
+ * @return Number of bytes written, 0 if the buffer is too small.
  */
-uint32_t DTC_GetStatusBitmask(void);
+uint16_t DTC_Export(uint8_t* buffer, uint16_t size);
 
 /**
- * @brief Sets the entire DTC status bitmask.
- * @param bitmask The 32-bit bitmask to restore DTC statuses from.
+ * @brief Restores the DTC states saved with DTC_Export.
+ * @note Call before any task or ISR reports DTCs.
+ * @param buffer Source data.
+ * @param size Number of bytes available, at least DTC_STORAGE_SIZE.
  */
-void DTC_SetStatusBitmask(uint32_t bitmask);
+void DTC_Import(const uint8_t* buffer, uint16_t size);
 
 #endif /* __DTC_MANAGER_H */
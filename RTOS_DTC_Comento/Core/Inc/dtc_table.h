@@ -0,0 +1,38 @@
+/*
+ * dtc_table.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef INC_DTC_TABLE_H_
+#define INC_DTC_TABLE_H_
+
+/**
+ * @brief Definition of every DTC, the only place a DTC is declared.
+ * @note Expanded by dtc_manager into the DTC_Code_t enum, the const
+ *       definition table and the lookup by DTC number, so nothing here is
+ *       copied to RAM or saved to EEPROM. A DTC number used twice does not
+ *       compile.
+ *
+ * X(name, number, severity, functional_unit, debounce_algorithm,
+ *   fail_threshold, pass_threshold, snapshot, description)
+ * - number: 3-byte UDS DTC number, SAE J2012 code plus failure type byte
+ * - severity: DTC_SEVERITY_* (DTCSeverityMask bits)
+ * - functional_unit: DTC_FUNCTIONAL_UNIT_*
+ * - debounce: see DTC_Debounce_Config_t. The I2C task samples the PMIC
+ *   every 100 ms.
+ * - snapshot: true to record a snapshot when the DTC occurs
+ */
+#define DTC_TABLE(X) \
+    /* SAE J2012 chassis codes C1001..C1004, failure type 0x16 (circuit voltage below threshold) */ \
+    X(DTC_PMIC_BUCK_A_UNDERVOLTAGE, 0x500116, DTC_SEVERITY_CHECK_IMMEDIATELY, DTC_FUNCTIONAL_UNIT_POWER_SUPPLY, \
+      DTC_DEBOUNCE_COUNTER, 3, 5, true, "PMIC Buck A under-voltage")       /* 3 bad samples to fail, 5 good to pass */ \
+    X(DTC_PMIC_BUCK_B_UNDERVOLTAGE, 0x500216, DTC_SEVERITY_CHECK_IMMEDIATELY, DTC_FUNCTIONAL_UNIT_POWER_SUPPLY, \
+      DTC_DEBOUNCE_COUNTER, 3, 5, true, "PMIC Buck B under-voltage") \
+    X(DTC_PMIC_BUCK_C_UNDERVOLTAGE, 0x500316, DTC_SEVERITY_CHECK_IMMEDIATELY, DTC_FUNCTIONAL_UNIT_POWER_SUPPLY, \
+      DTC_DEBOUNCE_TIME, 300, 500, true, "PMIC Buck C under-voltage")      /* 300 ms UV to fail, 500 ms good to pass */ \
+    X(DTC_PMIC_BUCK_D_UNDERVOLTAGE, 0x500416, DTC_SEVERITY_CHECK_IMMEDIATELY, DTC_FUNCTIONAL_UNIT_POWER_SUPPLY, \
+      DTC_DEBOUNCE_TIME, 300, 500, true, "PMIC Buck D under-voltage") \
+    /* Add other DTCs for the system here, e.g. PMIC over-temperature */
+
+#endif /* INC_DTC_TABLE_H_ */
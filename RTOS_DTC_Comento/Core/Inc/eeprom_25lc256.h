@@ -27,6 +27,41 @@
 #define EEPROM_PAGE_SIZE    64    // 64 bytes per page
 #define EEPROM_TOTAL_SIZE   32768 // 256Kbit = 32768 bytes
 
+// Internal write cycle (tWC is 5 ms at most). The writing task sleeps
+// instead of polling the status register back to back.
+#define EEPROM_WRITE_FIRST_POLL_MS  2   // Sleep before the first status read
+#define EEPROM_WRITE_POLL_MS        1   // Sleep between later status reads
+#define EEPROM_WRITE_TIMEOUT_MS     10  // Give up on a page after this long
+#define EEPROM_WRITE_LATENCY_BUCKETS 8  // 1 ms histogram buckets, the last one open-ended
+
+// Polled command and status transfers, a few bytes each. At least 2 ticks,
+// since the HAL may count a tick that starts right after the transfer did.
+#define EEPROM_CMD_TIMEOUT_MS       2
+
+/**
+ * @brief Transfer statistics accumulated by the driver.
+ * @note Times are in DWT cycles; convert with Timebase_CyclesToUs(). The
+ *       totals are 64-bit, since a 32-bit sum wraps after about 268 s of
+ *       accumulated bus time at 16 MHz.
+ */
+typedef struct {
+    uint32_t read_calls;        // Completed EEPROM_Read_DMA calls
+    uint32_t read_bytes;        // Bytes returned by those calls
+    uint64_t read_cycles;       // Total time spent in EEPROM_Read_DMA
+    uint32_t write_calls;       // Completed EEPROM_Write_DMA calls
+    uint32_t write_bytes;       // Bytes written by those calls
+    uint32_t write_pages;       // Physical page write cycles issued
+    uint64_t write_cycles;      // Total time spent in EEPROM_Write_DMA
+    uint64_t wip_wait_cycles;   // Part of write_cycles waiting for the WIP bit, mostly asleep
+    uint64_t wip_poll_cycles;   // Part of wip_wait_cycles the CPU spent reading the status register
+    uint32_t wip_polls;         // Status register reads
+    uint32_t write_timeouts;    // Pages still busy after EEPROM_WRITE_TIMEOUT_MS
+    uint32_t page_min_cycles;   // Shortest page write cycle, 0 before the first page
+    uint32_t page_max_cycles;   // Longest page write cycle
+    uint32_t page_latency[EEPROM_WRITE_LATENCY_BUCKETS];  // Page write cycles per whole ms
+    uint32_t max_call_cycles;   // Longest single read or write call
+} EEPROM_Stats_t;
+
 /**
  * @brief Initializes the EEPROM driver.
  * @param hspi Pointer to a SPI_HandleTypeDef structure that contains
@@ -50,11 +85,25 @@ HAL_StatusTypeDef EEPROM_Read_DMA(uint16_t address, uint8_t* p_data, uint16_t si
  * @brief Writes a block of data to the EEPROM using DMA.
  * @note This function handles page boundaries automatically.
  *       It is blocking and will wait for the write and DMA transfers to complete.
+ *       The calling task sleeps through the internal write cycle of each
+ *       page, so it must run under the scheduler.
  * @param address The starting address to write to.
  * @param p_data Pointer to the buffer containing the data to be written.
  * @param size The number of bytes to write.
- * @retval HAL_StatusTypeDef HAL status.
+ * @retval HAL_StatusTypeDef HAL status. HAL_TIMEOUT if a page is still
+ *         being written after EEPROM_WRITE_TIMEOUT_MS.
  */
 HAL_StatusTypeDef EEPROM_Write_DMA(uint16_t address, uint8_t* p_data, uint16_t size);
 
+/**
+ * @brief Copies the accumulated transfer statistics.
+ * @param p_stats Pointer to the structure that receives the statistics.
+ */
+void EEPROM_GetStats(EEPROM_Stats_t* p_stats);
+
+/**
+ * @brief Resets the transfer statistics to zero.
+ */
+void EEPROM_ResetStats(void);
+
 #endif /* INC_EEPROM_25LC256_H_ */
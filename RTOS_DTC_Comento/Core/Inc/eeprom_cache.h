@@ -0,0 +1,116 @@
+/*
+ * eeprom_cache.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef INC_EEPROM_CACHE_H_
+#define INC_EEPROM_CACHE_H_
+
+#include "eeprom_25lc256.h"
+#include <stdbool.h>
+
+/* --- Defines --- */
+#define EEPROM_CACHE_LINES  8   // Pages held in RAM, EEPROM_PAGE_SIZE bytes each
+
+/* --- Types --- */
+/**
+ * @brief When dirty pages are due to be written back to the EEPROM.
+ * @note EEPROM_Cache_Sync always writes every dirty page, whatever the policy.
+ */
+typedef struct {
+    uint32_t max_age_ms;        // A page is due this long after its first change, 0 = not by age
+    uint8_t max_dirty_pages;    // Every page is due once this many are dirty, 0 = not by count
+} EEPROM_Cache_Policy_t;
+
+/**
+ * @brief Cache statistics.
+ */
+typedef struct {
+    uint32_t read_hits;         // Pages read from RAM
+    uint32_t read_misses;       // Pages read from the EEPROM
+    uint32_t write_merges;      // Page updates merged into an already dirty page
+    uint32_t write_skips;       // Page updates that changed no byte
+    uint32_t page_flushes;      // Physical page writes issued
+} EEPROM_Cache_Stats_t;
+
+/* --- Public Function Prototypes --- */
+/*
+ * The cache sits in front of eeprom_25lc256 and is called with the SPI bus
+ * held, like the driver itself. Use it instead of EEPROM_Read_DMA and
+ * EEPROM_Write_DMA, so that reads see data not written back yet.
+ */
+
+/**
+ * @brief Empties the cache and sets the write-back policy.
+ * @param policy Write-back policy, copied.
+ */
+void EEPROM_Cache_Init(const EEPROM_Cache_Policy_t* policy);
+
+/**
+ * @brief Reads data, from RAM for cached pages and from the EEPROM otherwise.
+ * @param address The starting address to read from.
+ * @param p_data Pointer to the buffer that will receive the data.
+ * @param size The number of bytes to read.
+ * @retval HAL_StatusTypeDef HAL status.
+ */
+HAL_StatusTypeDef EEPROM_Cache_Read(uint16_t address, uint8_t* p_data, uint16_t size);
+
+/**
+ * @brief Writes data into the cache; the EEPROM is written later.
+ * @note Bytes equal to the cached data are not marked dirty, and every
+ *       update of a page before it is written back costs one page write in
+ *       total. A partial page that is not cached is read in first. Only
+ *       blocks on a page write when a dirty page must be evicted; the
+ *       dirty-count policy only makes the pages due.
+ * @param address The starting address to write to.
+ * @param p_data Pointer to the data to write.
+ * @param size The number of bytes to write.
+ * @retval HAL_StatusTypeDef HAL status.
+ */
+HAL_StatusTypeDef EEPROM_Cache_Write(uint16_t address, const uint8_t* p_data, uint16_t size);
+
+/**
+ * @brief Writes back the oldest page that is due, if any.
+ * @note Call periodically from the task that owns the EEPROM. One page
+ *       write per call, so the task can serve other requests in between;
+ *       call again while EEPROM_Cache_IsDue returns true.
+ * @retval HAL_StatusTypeDef HAL status. A page that failed stays dirty and
+ *         is retried on the next call.
+ */
+HAL_StatusTypeDef EEPROM_Cache_Poll(void);
+
+/**
+ * @brief Returns true if a page is due to be written back.
+ */
+bool EEPROM_Cache_IsDue(void);
+
+/**
+ * @brief Makes every dirty page due now, including pages dirtied before
+ *        the last of them is written back.
+ * @note The pages are written back by EEPROM_Cache_Poll, one per call.
+ *       Use instead of EEPROM_Cache_Sync when requests must still be
+ *       served in between, e.g. at power-down.
+ */
+void EEPROM_Cache_Drain(void);
+
+/**
+ * @brief Writes back every dirty page.
+ * @note Call before the supply is removed, or whenever the data must be in
+ *       the EEPROM now.
+ * @retval HAL_StatusTypeDef HAL status.
+ */
+HAL_StatusTypeDef EEPROM_Cache_Sync(void);
+
+/**
+ * @brief Returns the number of pages waiting to be written back.
+ */
+uint8_t EEPROM_Cache_GetDirtyCount(void);
+
+/**
+ * @brief Copies the cache statistics.
+ * @param p_stats Pointer to the structure that receives the statistics.
+ */
+void EEPROM_Cache_GetStats(EEPROM_Cache_Stats_t* p_stats);
+
+#endif /* INC_EEPROM_CACHE_H_ */
@@ -0,0 +1,78 @@
+/*
+ * eeprom_log.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef INC_EEPROM_LOG_H_
+#define INC_EEPROM_LOG_H_
+
+#include "eeprom_25lc256.h"
+
+/* --- Defines --- */
+#define EEPROM_LOG_PAGE_COUNT       (EEPROM_TOTAL_SIZE / EEPROM_PAGE_SIZE)  // 512 pages, all used by the log
+#define EEPROM_LOG_MAX_RECORD_PAGES 8       // Longest record, header included
+#define EEPROM_LOG_HEADER_SIZE      12
+#define EEPROM_LOG_MAX_LENGTH       (EEPROM_LOG_MAX_RECORD_PAGES * EEPROM_PAGE_SIZE - EEPROM_LOG_HEADER_SIZE)
+#define EEPROM_LOG_SCAN_BURST       1024    // Bytes per DMA read of the boot scan
+
+/* --- Types --- */
+/**
+ * @brief Log position and wear figures.
+ */
+typedef struct {
+    uint32_t sequence;          // Sequence number of the newest record, 0 if the log is empty
+    uint16_t latest_page;       // First page of the newest record
+    uint16_t head_page;         // Page the next record starts at
+    uint32_t appends;           // Records written since EEPROM_Log_Init
+    uint32_t wraps;             // Times the head went back to page 0 since EEPROM_Log_Init
+    uint32_t scan_cycles;       // Duration of the boot scan, in DWT cycles
+} EEPROM_Log_Stats_t;
+
+/* --- Public Function Prototypes --- */
+/*
+ * Records are appended round-robin over the whole device, each starting
+ * on a page boundary and tagged with an increasing sequence number and a
+ * CRC-32, so every page takes an equal share of the writes. The newest
+ * record is the valid one with the highest sequence number; a record torn
+ * by a reset fails its CRC and the one before it is used. Appends go
+ * through eeprom_cache; call with the SPI bus held.
+ */
+
+/**
+ * @brief Scans the EEPROM for the newest valid record.
+ * @note Reads the whole device in EEPROM_LOG_SCAN_BURST DMA bursts and checks
+ *       every record on the fly, in one pass. Must run in a task, after
+ *       EEPROM_Init and EEPROM_Cache_Init, before any other log call.
+ * @retval HAL_StatusTypeDef HAL status. HAL_OK with an empty log too.
+ */
+HAL_StatusTypeDef EEPROM_Log_Init(void);
+
+/**
+ * @brief Appends a record after the newest one.
+ * @note The newest record is never overwritten, so a reset during the
+ *       write leaves it readable. Stale records are reused as the head
+ *       wraps around; an EEPROM needs no erase, so no compaction is done.
+ * @param p_data Record contents.
+ * @param length Record length, at most EEPROM_LOG_MAX_LENGTH.
+ * @retval HAL_StatusTypeDef HAL status.
+ */
+HAL_StatusTypeDef EEPROM_Log_Append(const uint8_t* p_data, uint16_t length);
+
+/**
+ * @brief Reads the newest record.
+ * @param p_data Buffer that receives the record.
+ * @param size Size of the buffer.
+ * @param p_length Receives the record length. May be NULL.
+ * @retval HAL_StatusTypeDef HAL status. HAL_ERROR if the log is empty or
+ *         the buffer is too small.
+ */
+HAL_StatusTypeDef EEPROM_Log_ReadLatest(uint8_t* p_data, uint16_t size, uint16_t* p_length);
+
+/**
+ * @brief Copies the log position and wear figures.
+ * @param p_stats Pointer to the structure that receives them.
+ */
+void EEPROM_Log_GetStats(EEPROM_Log_Stats_t* p_stats);
+
+#endif /* INC_EEPROM_LOG_H_ */
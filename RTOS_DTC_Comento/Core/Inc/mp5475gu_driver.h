@@ -40,10 +40,17 @@ typedef union {
     } bits;
 } MP5475GU_StatusUV_t;
 
+// STATUS_UV bit masks, matching MP5475GU_StatusUV_t
+#define MP5475GU_UV_BUCK_D  0x01
+#define MP5475GU_UV_BUCK_C  0x02
+#define MP5475GU_UV_BUCK_B  0x04
+#define MP5475GU_UV_BUCK_A  0x08
+#define MP5475GU_UV_ALL     (MP5475GU_UV_BUCK_A | MP5475GU_UV_BUCK_B | MP5475GU_UV_BUCK_C | MP5475GU_UV_BUCK_D)
 
 // Function Prototypes
 void mp5475gu_init(void);
 HAL_StatusTypeDef mp5475gu_set_vout(I2C_HandleTypeDef *hi2c, MP5475GU_BuckChannel_t channel, float voltage);
+uint16_t mp5475gu_get_vout_mv(MP5475GU_BuckChannel_t channel);
 HAL_StatusTypeDef mp5475gu_read_uv_status(I2C_HandleTypeDef *hi2c, MP5475GU_StatusUV_t *status);
 
 #endif /* __MP5475GU_DRIVER_H */
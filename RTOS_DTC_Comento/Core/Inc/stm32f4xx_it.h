@@ -61,6 +61,7 @@ void DMA1_Stream4_IRQHandler(void);
 void DMA1_Stream6_IRQHandler(void);
 void CAN1_TX_IRQHandler(void);
 void CAN1_RX0_IRQHandler(void);
+void CAN1_RX1_IRQHandler(void);
 void I2C1_EV_IRQHandler(void);
 void I2C1_ER_IRQHandler(void);
 void I2C2_EV_IRQHandler(void);
@@ -71,6 +72,7 @@ void UART4_IRQHandler(void);
 void DMA2_Stream0_IRQHandler(void);
 void DMA2_Stream3_IRQHandler(void);
 /* USER CODE BEGIN EFP */
+void PVD_IRQHandler(void);
 
 /* USER CODE END EFP */
 
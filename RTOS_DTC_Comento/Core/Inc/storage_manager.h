@@ -0,0 +1,98 @@
+/*
+ * storage_manager.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef INC_STORAGE_MANAGER_H_
+#define INC_STORAGE_MANAGER_H_
+
+#include "stm32f4xx_hal.h"
+#include "cmsis_os2.h"
+
+/* --- Defines --- */
+#define STORAGE_QUEUE_DEPTH   8         // Requests that can wait for the storage task
+#define STORAGE_REQUEST_FLAG  0x8000U   // Storage task thread flag raised by Storage_Submit
+
+/* --- Enums --- */
+typedef enum {
+    STORAGE_REQUEST_READ_RECORD = 0,    // Read the newest eeprom_log record
+    STORAGE_REQUEST_APPEND_RECORD,      // Append a record to eeprom_log
+} Storage_RequestType_t;
+
+/* --- Types --- */
+typedef struct Storage_Request Storage_Request_t;
+
+/**
+ * @brief Called by the storage task when a request completes.
+ * @note Runs in the storage task; keep it short, e.g. set a thread flag.
+ *       The request may be submitted again from here.
+ */
+typedef void (*Storage_Callback_t)(Storage_Request_t* request);
+
+/**
+ * @brief An EEPROM request, owned by the caller until its callback runs.
+ */
+struct Storage_Request {
+    Storage_RequestType_t type;
+    uint8_t* p_data;                // Read: destination. Append: record contents.
+    uint16_t size;                  // Read: size of p_data. Append: record length.
+    uint16_t length;                // Read: record length, set on completion
+    HAL_StatusTypeDef status;       // Set on completion
+    Storage_Callback_t callback;    // May be NULL
+    void* context;                  // For the callback
+};
+
+/**
+ * @brief Storage task statistics.
+ */
+typedef struct {
+    uint32_t reads;             // Read requests completed
+    uint32_t read_merges;       // Reads served from the data of the read before them
+    uint32_t appends;           // Append requests completed
+    uint32_t append_merges;     // Appends replaced by the append queued right after them
+    uint32_t queue_full;        // Requests refused because the queue was full
+} Storage_Stats_t;
+
+/* --- Public Function Prototypes --- */
+/*
+ * One storage task owns SPI1 and is the only caller of eeprom_log,
+ * eeprom_cache and eeprom_25lc256. Other tasks queue requests and carry
+ * on; the storage task serves them between its own write-backs.
+ */
+
+/**
+ * @brief Creates the request queue.
+ * @param storage_thread The task that calls Storage_Process. It must not
+ *        use STORAGE_REQUEST_FLAG for anything else.
+ * @retval HAL_StatusTypeDef HAL status.
+ */
+HAL_StatusTypeDef Storage_Init(osThreadId_t storage_thread);
+
+/**
+ * @brief Queues a request for the storage task.
+ * @note Returns without waiting, from a task or an ISR. The request and its
+ *       buffer must stay valid, and unchanged, until the callback runs.
+ * @param request The request.
+ * @retval HAL_StatusTypeDef HAL_OK if queued, HAL_BUSY if the queue is full.
+ */
+HAL_StatusTypeDef Storage_Submit(Storage_Request_t* request);
+
+/**
+ * @brief Serves every queued request. Call from the storage task when
+ *        STORAGE_REQUEST_FLAG is raised.
+ * @note Requests are served in the order they were queued, so a read sees
+ *       every append queued before it. One EEPROM read serves a run of
+ *       consecutive reads, and only the last of a run of consecutive
+ *       appends is written, since reads only ever return the newest
+ *       record; the appends it replaces complete with its status.
+ */
+void Storage_Process(void);
+
+/**
+ * @brief Copies the storage task statistics.
+ * @param p_stats Pointer to the structure that receives the statistics.
+ */
+void Storage_GetStats(Storage_Stats_t* p_stats);
+
+#endif /* INC_STORAGE_MANAGER_H_ */
@@ -0,0 +1,68 @@
+/*
+ * timebase.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef INC_TIMEBASE_H_
+#define INC_TIMEBASE_H_
+
+#include "stm32f4xx_hal.h"
+
+/**
+ * @brief Enables the DWT cycle counter used as the high-resolution timebase.
+ * @note Safe to call more than once.
+ */
+void Timebase_Init(void);
+
+/**
+ * @brief Returns the free-running CPU cycle counter.
+ * @note Wraps every 2^32 cycles (about 268 s at the 16 MHz HSI clock),
+ *       so only differences between two samples are meaningful.
+ * @retval Current cycle count.
+ */
+static inline uint32_t Timebase_GetCycles(void)
+{
+    return DWT->CYCCNT;
+}
+
+/**
+ * @brief Converts a cycle count difference into microseconds.
+ * @param cycles Number of CPU cycles.
+ * @retval Elapsed time in microseconds.
+ */
+uint32_t Timebase_CyclesToUs(uint32_t cycles);
+
+/**
+ * @brief Keeps the extension of the cycle counter across wraps.
+ * @note The only writer of the extension; the SysTick handler calls it
+ *       every tick. It must run at least once per 2^31 cycles.
+ */
+void Timebase_Tick(void);
+
+/**
+ * @brief Returns the cycle counter extended to 64 bits, so it never wraps.
+ * @note Lock-free: one load of the extension and one of the counter, no
+ *       critical section. Safe to call from tasks and ISRs.
+ * @retval Cycles since the counter was started.
+ */
+uint64_t Timebase_GetCycles64(void);
+
+/**
+ * @brief Returns the time since the counter was started in microseconds.
+ * @note Built on Timebase_GetCycles64, so it does not wrap either.
+ * @retval Elapsed time in microseconds.
+ */
+uint64_t Timebase_GetUs(void);
+
+/**
+ * @brief Returns the time since the counter was started in units of unit_us,
+ *        truncated to 32 bits.
+ * @note Divides with 32-bit instructions only, so it is cheap enough for an
+ *       ISR. One unit must be less than 65536 CPU cycles.
+ * @param unit_us Length of one unit in microseconds.
+ * @retval Elapsed time in units, wrapping after 2^32 of them.
+ */
+uint32_t Timebase_GetTime(uint32_t unit_us);
+
+#endif /* INC_TIMEBASE_H_ */
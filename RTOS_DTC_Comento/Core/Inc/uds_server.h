@@ -0,0 +1,78 @@
+/*
+ * uds_server.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef INC_UDS_SERVER_H_
+#define INC_UDS_SERVER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/* --- UDS Service IDs --- */
+#define UDS_SID_READ_DTC_INFORMATION    0x19
+#define UDS_SID_NEGATIVE_RESPONSE       0x7F
+#define UDS_POSITIVE_RESPONSE_OFFSET    0x40
+
+/* --- ReadDTCInformation (0x19) Sub-functions --- */
+#define UDS_RDTCI_REPORT_NUMBER_OF_DTC_BY_STATUS_MASK   0x01
+#define UDS_RDTCI_REPORT_DTC_BY_STATUS_MASK             0x02
+#define UDS_RDTCI_REPORT_DTC_SNAPSHOT_RECORD_BY_DTC     0x04
+#define UDS_RDTCI_REPORT_DTC_EXT_DATA_RECORD_BY_DTC     0x06
+#define UDS_RDTCI_REPORT_SUPPORTED_DTC                  0x0A
+
+// suppressPosRspMsgIndicationBit of a sub-function byte
+#define UDS_SPRMIB                                      0x80
+
+/* --- Negative Response Codes --- */
+#define UDS_NRC_SERVICE_NOT_SUPPORTED           0x11
+#define UDS_NRC_SUBFUNCTION_NOT_SUPPORTED       0x12
+#define UDS_NRC_INCORRECT_LENGTH                0x13
+#define UDS_NRC_RESPONSE_TOO_LONG               0x14
+#define UDS_NRC_BUSY_REPEAT_REQUEST             0x21
+#define UDS_NRC_REQUEST_OUT_OF_RANGE            0x31
+
+/* --- Snapshot Data Identifiers (manufacturer specific) --- */
+#define UDS_DID_RAIL_A_SETPOINT                 0xD100  // mV
+#define UDS_DID_RAIL_B_SETPOINT                 0xD101  // mV
+#define UDS_DID_RAIL_C_SETPOINT                 0xD102  // mV
+#define UDS_DID_RAIL_D_SETPOINT                 0xD103  // mV
+#define UDS_DID_PMIC_STATUS_UV                  0xD104  // Raw STATUS_UV register
+#define UDS_DID_ADC_RAW                         0xD105  // ADC1 counts
+#define UDS_DID_TIMESTAMP                       0xD106  // Kernel tick, ms
+
+// DTCSnapshotRecordNumber that requests every stored record
+#define UDS_SNAPSHOT_RECORD_ALL                 0xFF
+
+/* --- Extended Data Record Numbers (manufacturer specific) --- */
+#define UDS_EXT_DATA_OCCURRENCE_COUNTER         0x01  // 1 byte, saturates at 255
+#define UDS_EXT_DATA_PENDING_COUNTER            0x02  // 1 byte, saturates at 255
+#define UDS_EXT_DATA_FIRST_FAILURE_TIME         0x03  // 4 bytes, units of DTC_TIMESTAMP_RESOLUTION_US
+#define UDS_EXT_DATA_LAST_FAILURE_TIME          0x04  // 4 bytes, units of DTC_TIMESTAMP_RESOLUTION_US
+
+// DTCExtDataRecordNumber that requests every record
+#define UDS_EXT_DATA_RECORD_ALL                 0xFF
+
+// DTCFormatIdentifier for ISO 14229-1 DTC numbers
+#define UDS_DTC_FORMAT_ISO14229_1               0x01
+
+/**
+ * @brief Handles one UDS request and builds its response.
+ * @note  Responses are built directly from dtc_manager state without blocking.
+ *        Called from UARTTask through CAN_Manager_Process_Rx, as soon as the
+ *        request is reassembled. A positive response is not sent when the
+ *        request sets UDS_SPRMIB, and a functional request that no ECU
+ *        needs to reject gets no serviceNotSupported,
+ *        subFunctionNotSupported or requestOutOfRange (ISO 14229-1).
+ * @param request Pointer to the complete request message.
+ * @param request_length Length of the request in bytes.
+ * @param functional true if the request was sent to every ECU.
+ * @param response Buffer that receives the positive or negative response.
+ * @param response_size Size of the response buffer in bytes.
+ * @retval Length of the response, 0 if the request is not answered.
+ */
+uint16_t UDS_Server_Process(const uint8_t* request, uint16_t request_length, bool functional,
+                            uint8_t* response, uint16_t response_size);
+
+#endif /* INC_UDS_SERVER_H_ */
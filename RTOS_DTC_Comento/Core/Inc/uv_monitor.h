@@ -0,0 +1,51 @@
+/*
+ * uv_monitor.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef INC_UV_MONITOR_H_
+#define INC_UV_MONITOR_H_
+
+#include "mp5475gu_driver.h"
+
+/* --- Types --- */
+/**
+ * @brief Latency of the last under-voltage that became a DTC.
+ * @note Measured from the first poll that read the new UV bit, so the time
+ *       between the rail dropping and that poll is not included; it is at
+ *       most one poll period.
+ */
+typedef struct {
+    uint32_t uv_to_dtc_set_ms;  // Until the debounce confirmed the DTC
+    uint32_t uv_to_can_tx_ms;   // Until the next DTC broadcast was queued
+    uint32_t faults;            // UV events that became a DTC since boot
+} UV_Monitor_Latency_t;
+
+/* --- Public Function Prototypes --- */
+
+/**
+ * @brief Reads STATUS_UV once and reports every rail to the DTC debounce.
+ * @note  Called by I2CTask with the I2C bus held. The ADC conversion for the
+ *        freeze frame must have been started beforehand; it is only read if
+ *        a rail is under voltage.
+ * @param hi2c I2C handle of the PMIC.
+ * @param hadc ADC handle sampled into the snapshot.
+ * @retval HAL_StatusTypeDef Status of the STATUS_UV read; nothing is
+ *         reported if it failed.
+ */
+HAL_StatusTypeDef UV_Monitor_Poll(I2C_HandleTypeDef* hi2c, ADC_HandleTypeDef* hadc);
+
+/**
+ * @brief Tells the monitor a DTC broadcast was queued.
+ * @note  Called by CANTask after CAN_Manager_Transmit_DTC succeeds.
+ */
+void UV_Monitor_DTC_Sent(void);
+
+/**
+ * @brief Copies the latency of the last UV fault.
+ * @param p_latency Pointer to the structure that receives it.
+ */
+void UV_Monitor_Get_Latency(UV_Monitor_Latency_t* p_latency);
+
+#endif /* INC_UV_MONITOR_H_ */
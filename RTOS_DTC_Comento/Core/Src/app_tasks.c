@@ -0,0 +1,347 @@
+/*
+ * app_tasks.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "app_tasks.h"
+#include "can_manager.h"
+#include "dtc_manager.h"
+#include "eeprom_cache.h"
+#include "eeprom_log.h"
+#include "mp5475gu_driver.h"
+#include "storage_manager.h"
+#include "timebase.h"
+#include "uv_monitor.h"
+#include <string.h>
+#include <stdio.h>
+
+// --- Private Defines ---
+#define DTC_PERSIST_FLAG        0x0001U // SPITask: the DTC state needs saving
+#define DTC_RESTORED_FLAG       0x0001U // I2CTask: SPITask has restored the DTC state
+#define POWER_DOWN_FLAG         0x0002U // SPITask: the supply is going down
+#define DTC_CLEAR_FLAG          0x0004U // I2CTask: clear every DTC, which it owns the state of
+#define DTC_CLEARED_FLAG        0x0002U // UARTTask: I2CTask has cleared the DTCs
+#define DTC_PRINT_FLAG          0x0004U // UARTTask: the tester read the DTCs
+#define STORAGE_DONE_FLAG       0x0001U // CANTask/UARTTask: their storage request completed
+
+// --- Private Variables ---
+static const App_Tasks_t* app;
+
+// --- Private Function Prototypes ---
+static void DTC_Changed(void);
+static uint32_t DTC_Timestamp(void);
+static void Storage_Done(Storage_Request_t* request);
+static void Storage_Saved(Storage_Request_t* request);
+static HAL_StatusTypeDef Storage_Read_DTC(Storage_Request_t* request, uint8_t* p_data, uint16_t size);
+
+// --- Public API Functions ---
+
+HAL_StatusTypeDef App_Tasks_Init(const App_Tasks_t* p_config)
+{
+    app = p_config;
+    EEPROM_Cache_Init(&(EEPROM_Cache_Policy_t){ DTC_PERSIST_WINDOW_MS, EEPROM_CACHE_MAX_DIRTY });
+    // DTC_Init runs in SPITask, once the saved state has been read
+    DTC_RegisterChangeCallback(DTC_Changed);
+    DTC_RegisterTimeSource(DTC_Timestamp);
+    // SPITask owns SPI1 and serves the EEPROM requests of the other tasks
+    return Storage_Init(app->spi_task);
+}
+
+void App_I2C_Task(void)
+{
+    uint32_t flags;
+
+    // No DTC is reported before SPITask has restored the saved state and
+    // started the operation cycle
+    osThreadFlagsWait(DTC_RESTORED_FLAG, osFlagsWaitAny, osWaitForever);
+
+    for (;;) {
+        // The mutex is held for each bus access only, not across the delay,
+        // so the UART printout is not held up for the whole cycle
+        if (osMutexAcquire(app->comm_mutex, osWaitForever) == osOK) {
+            // TODO: Add I2C communication code here.
+            mp5475gu_set_vout(app->hi2c, BUCK_A, 1.2f);
+            // Sample the ADC now so a reading is ready if a snapshot is needed
+            HAL_ADC_Start(app->hadc);
+            osMutexRelease(app->comm_mutex);
+        }
+        osDelay(100);
+
+        if (osMutexAcquire(app->comm_mutex, osWaitForever) == osOK) {
+            // Read the UV status from the PMIC and report every rail to the
+            // debounce engine, which sets or clears the DTC once qualified
+            UV_Monitor_Poll(app->hi2c, app->hadc);
+            osMutexRelease(app->comm_mutex);
+        }
+
+        // Wait for the next monitoring cycle, check every 100ms
+        flags = osThreadFlagsWait(DTC_CLEAR_FLAG, osFlagsWaitAny, 100);
+        if ((flags & osFlagsError) == 0 && (flags & DTC_CLEAR_FLAG)) {
+            // Cleared here, between polls, so no debounce update of this
+            // task is cut in half. SPITask saves the cleared state.
+            DTC_ClearAll();
+            osThreadFlagsSet(app->uart_task, DTC_CLEARED_FLAG);
+        }
+    }
+}
+
+void App_SPI_Task(void)
+{
+    static uint8_t dtc_data[DTC_STORAGE_SIZE];
+    static Storage_Request_t save_request;
+    uint16_t dtc_length = 0;
+    uint32_t persist_since = 0;
+    uint32_t timeout;
+    uint32_t flags;
+    bool persist_pending = false;
+    bool cache_due = false;
+
+    // The scan needs the SPI DMA semaphore, so it runs here, not before the
+    // scheduler starts. A blank or unreadable log, or a record of another
+    // size (the DTC table changed), starts with every DTC cleared. SPI1 is
+    // SPITask's alone and I2CTask waits for DTC_RESTORED_FLAG, so no mutex.
+    if (EEPROM_Log_Init() != HAL_OK ||
+        EEPROM_Log_ReadLatest(dtc_data, sizeof(dtc_data), &dtc_length) != HAL_OK) {
+        dtc_length = 0;
+    }
+    DTC_Init(dtc_data, dtc_length);
+    // SPITask owns the operation cycle boundaries and the aging counters.
+    // Power-up starts a cycle. The previous one is ended first in case power
+    // went before its end was saved; a cycle that was already ended and
+    // saved has no completed tests, so ending it changes nothing.
+    DTC_EndOperationCycle();
+    DTC_StartOperationCycle();
+    osThreadFlagsSet(app->i2c_task, DTC_RESTORED_FLAG);
+
+    for (;;) {
+        // Sleep until a request is queued, a pending save is due, or the cache
+        // needs a look. Not at all while pages are due for write-back.
+        timeout = EEPROM_CACHE_POLL_MS;
+        if (persist_pending) {
+            uint32_t elapsed = osKernelGetTickCount() - persist_since;
+            timeout = (elapsed < DTC_PERSIST_WINDOW_MS) ? DTC_PERSIST_WINDOW_MS - elapsed : 0;
+        }
+        if (cache_due) {
+            timeout = 0;
+        }
+        flags = osThreadFlagsWait(DTC_PERSIST_FLAG | POWER_DOWN_FLAG | STORAGE_REQUEST_FLAG, osFlagsWaitAny, timeout);
+
+        // Every save is a new log record on fresh pages, so a burst of changes
+        // is let settle into one record. SPITask owns SPI1 and does not wait
+        // in between, so queued reads are still served.
+        if ((flags & osFlagsError) == 0 && (flags & DTC_PERSIST_FLAG) && !persist_pending) {
+            persist_pending = true;
+            persist_since = osKernelGetTickCount();
+        }
+        // Going down: end the operation cycle here, without waiting for
+        // I2CTask's poll, and save it at once. The debounce of I2CTask is not
+        // touched, and a failure it reports meanwhile keeps its bits. If the
+        // supply recovers, monitoring carries on in the new cycle.
+        if ((flags & osFlagsError) == 0 && (flags & POWER_DOWN_FLAG)) {
+            DTC_EndOperationCycle();
+            DTC_StartOperationCycle();
+            // This save covers the change the cycle end just flagged
+            osThreadFlagsClear(DTC_PERSIST_FLAG);
+            persist_pending = true;
+            persist_since = osKernelGetTickCount() - DTC_PERSIST_WINDOW_MS;
+        }
+
+        // Queued like any other request, so a read queued after it sees it.
+        // Only goes to RAM; the pages are written back by the cache poll, or
+        // the sync at power-down. A save that fails raises DTC_PERSIST_FLAG
+        // again and is retried after another window.
+        if (persist_pending && osKernelGetTickCount() - persist_since >= DTC_PERSIST_WINDOW_MS) {
+            DTC_Export(dtc_data, sizeof(dtc_data));
+            save_request = (Storage_Request_t){
+                .type = STORAGE_REQUEST_APPEND_RECORD,
+                .p_data = dtc_data,
+                .size = sizeof(dtc_data),
+                .callback = Storage_Saved,
+                .context = osThreadGetId(),
+            };
+            // Completes in the Storage_Process below. A full queue is served
+            // first, which makes room.
+            if (Storage_Submit(&save_request) != HAL_OK) {
+                Storage_Process();
+                persist_pending = Storage_Submit(&save_request) != HAL_OK;
+            } else {
+                persist_pending = false;
+            }
+        }
+        Storage_Process();
+
+        if ((flags & osFlagsError) == 0 && (flags & POWER_DOWN_FLAG)) {
+            // Every dirty page, now. One that fails stays dirty for the poll.
+            EEPROM_Cache_Sync();
+        }
+        // One page write per pass, so a queued request waits for at most one
+        // page. A page that fails to write stays dirty and is retried after
+        // the usual poll period.
+        cache_due = EEPROM_Cache_Poll() == HAL_OK && EEPROM_Cache_IsDue();
+    }
+}
+
+void App_CAN_Task(void)
+{
+    // Static, so the 128-word stack only holds the call chain
+    static Storage_Request_t request;
+    static uint8_t dtc_data[DTC_STORAGE_SIZE];
+
+    for (;;) {
+        // Neither the read nor the lock-free CAN transmit queue needs the bus
+        // mutex
+        if (Storage_Read_DTC(&request, dtc_data, sizeof(dtc_data)) == HAL_OK) {
+            if (CAN_Manager_Transmit_DTC(app->hcan, dtc_data, sizeof(dtc_data)) == HAL_OK) {
+                UV_Monitor_DTC_Sent();
+            }
+        }
+        osDelay(1000); // Transmit every 1 second
+    }
+}
+
+void App_UART_Task(void)
+{
+    // Static, so the stack is left to snprintf
+    static Storage_Request_t request;
+    static uint8_t dtc_data[DTC_STORAGE_SIZE];
+    static char uart_msg[96];
+    UV_Monitor_Latency_t latency;
+    uint32_t flags;
+
+    for (;;) {
+        // Raised by CANRxTask and I2CTask. Reads that come in while a
+        // printout is under way share the next one.
+        flags = osThreadFlagsWait(DTC_PRINT_FLAG | DTC_CLEARED_FLAG, osFlagsWaitAny, osWaitForever);
+        if (flags & osFlagsError) {
+            continue;
+        }
+
+        // Read before taking the mutex, which the read does not need
+        if ((flags & DTC_PRINT_FLAG) && Storage_Read_DTC(&request, dtc_data, sizeof(dtc_data)) != HAL_OK) {
+            dtc_data[0] = 0; // Nothing saved yet
+        }
+
+        if (osMutexAcquire(app->comm_mutex, osWaitForever) == osOK) {
+            if (flags & DTC_CLEARED_FLAG) {
+                snprintf(uart_msg, sizeof(uart_msg), "DTCs Cleared.\r\n");
+                HAL_UART_Transmit(app->huart, (uint8_t*)uart_msg, strlen(uart_msg), 100);
+            }
+            if (flags & DTC_PRINT_FLAG) {
+                snprintf(uart_msg, sizeof(uart_msg), "DTC Value: 0x%02X, active: %u\r\n",
+                         dtc_data[0], DTC_GetActiveCount());
+                HAL_UART_Transmit(app->huart, (uint8_t*)uart_msg, strlen(uart_msg), 100);
+                // Latency of the last UV fault, from the poll that saw it
+                UV_Monitor_Get_Latency(&latency);
+                snprintf(uart_msg, sizeof(uart_msg), "UV faults: %lu, to DTC: %lu ms, to CAN: %lu ms\r\n",
+                         (unsigned long)latency.faults, (unsigned long)latency.uv_to_dtc_set_ms,
+                         (unsigned long)latency.uv_to_can_tx_ms);
+                HAL_UART_Transmit(app->huart, (uint8_t*)uart_msg, strlen(uart_msg), 100);
+                // Least free stack seen so far, to size the task stacks from
+                snprintf(uart_msg, sizeof(uart_msg), "Stack free: I2C %lu, SPI %lu, CAN %lu, RX %lu, UART %lu B\r\n",
+                         (unsigned long)osThreadGetStackSpace(app->i2c_task),
+                         (unsigned long)osThreadGetStackSpace(app->spi_task),
+                         (unsigned long)osThreadGetStackSpace(app->can_task),
+                         (unsigned long)osThreadGetStackSpace(app->can_rx_task),
+                         (unsigned long)osThreadGetStackSpace(app->uart_task));
+                HAL_UART_Transmit(app->huart, (uint8_t*)uart_msg, strlen(uart_msg), 100);
+            }
+            osMutexRelease(app->comm_mutex);
+        }
+    }
+}
+
+void App_CAN_Rx_Task(void)
+{
+    CAN_Command_t cmd;
+
+    for (;;) {
+        // Blocks on CanQueue, so a request is dispatched as soon as it is
+        // complete. UDS answers inside; the rest is handed off with a flag.
+        cmd = CAN_Manager_Process_Rx(osWaitForever);
+        if (cmd == CMD_READ_DTC) {
+            osThreadFlagsSet(app->uart_task, DTC_PRINT_FLAG);
+        } else if (cmd == CMD_CLEAR_DTC) {
+            // I2CTask owns the debounce and aging state, so it does the
+            // clear, then has UARTTask report it
+            osThreadFlagsSet(app->i2c_task, DTC_CLEAR_FLAG);
+        }
+    }
+}
+
+void App_Power_Down(void)
+{
+    if (app != NULL && app->spi_task != NULL) {
+        osThreadFlagsSet(app->spi_task, POWER_DOWN_FLAG);
+    }
+}
+
+// --- Private Functions ---
+
+/**
+ * @brief Wakes SPITask to save the DTC state. Safe to call from an ISR.
+ */
+static void DTC_Changed(void)
+{
+    if (app->spi_task != NULL) {
+        osThreadFlagsSet(app->spi_task, DTC_PERSIST_FLAG);
+    }
+}
+
+/**
+ * @brief Time for DTC occurrence timestamps, from the DWT cycle counter.
+ *        Safe to call from an ISR.
+ * @retval Time since power-on in DTC_TIMESTAMP_RESOLUTION_US units.
+ */
+static uint32_t DTC_Timestamp(void)
+{
+    return Timebase_GetTime(DTC_TIMESTAMP_RESOLUTION_US);
+}
+
+/**
+ * @brief Wakes the task that submitted a storage request.
+ * @param request The completed request; context is the task.
+ */
+static void Storage_Done(Storage_Request_t* request)
+{
+    osThreadFlagsSet((osThreadId_t)request->context, STORAGE_DONE_FLAG);
+}
+
+/**
+ * @brief Retries a save of the DTC state that failed.
+ * @param request The completed save; context is SPITask.
+ */
+static void Storage_Saved(Storage_Request_t* request)
+{
+    if (request->status != HAL_OK) {
+        osThreadFlagsSet((osThreadId_t)request->context, DTC_PERSIST_FLAG);
+    }
+}
+
+/**
+ * @brief Reads the saved DTC state through SPITask.
+ * @note  Holds no mutex while it waits. Requests are served in order, and
+ *        the saves queued ahead of this one only go to the cache in RAM,
+ *        so it waits for at most the page write-back SPITask is busy with.
+ * @param request Request of the calling task, one per task.
+ * @param p_data Buffer that receives the state.
+ * @param size Size of the buffer.
+ * @retval HAL_StatusTypeDef HAL status. HAL_ERROR until a first state has been saved.
+ */
+static HAL_StatusTypeDef Storage_Read_DTC(Storage_Request_t* request, uint8_t* p_data, uint16_t size)
+{
+    *request = (Storage_Request_t){
+        .type = STORAGE_REQUEST_READ_RECORD,
+        .p_data = p_data,
+        .size = size,
+        .callback = Storage_Done,
+        .context = osThreadGetId(),
+    };
+
+    if (Storage_Submit(request) != HAL_OK) {
+        return HAL_ERROR;
+    }
+    // SPITask owns the request until it completes, so wait whatever happens
+    osThreadFlagsWait(STORAGE_DONE_FLAG, osFlagsWaitAny, osWaitForever);
+    return request->status;
+}
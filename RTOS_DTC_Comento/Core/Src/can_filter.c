@@ -0,0 +1,268 @@
+/*
+ * can_filter.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "can_filter.h"
+#include "can_manager.h" // For the diagnostic IDs
+#include <string.h>
+
+// Bank layouts, in the order they are packed
+typedef enum {
+    FILTER_KIND_STD_LIST = 0,   // Four exact 11-bit IDs per bank
+    FILTER_KIND_STD_MASK,       // Two masked 11-bit IDs per bank
+    FILTER_KIND_EXT_LIST,       // Two exact 29-bit IDs per bank
+    FILTER_KIND_EXT_MASK,       // One masked 29-bit ID per bank
+    FILTER_KIND_COUNT
+} CAN_Filter_Kind_t;
+
+// Filter register bits next to the identifier
+#define FILTER_STD_RTR_IDE_BITS  0x18U  // RTR and IDE in a 16-bit element
+#define FILTER_EXT_IDE_BIT       0x04U
+#define FILTER_EXT_RTR_IDE_BITS  0x06U
+
+// --- Private Variables ---
+static const uint8_t filter_slots_per_bank[FILTER_KIND_COUNT] = { 4, 2, 2, 1 };
+
+// The IDs can_manager handles. Physical requests are matched on our own
+// address only, so traffic between the tester and other ECUs stays out.
+// No J1939 PGN is accepted until there is a handler for it.
+static const CAN_Filter_Entry_t filter_defaults[] = {
+    // OBD-II / UDS on 11-bit IDs
+    { CAN_OBD_FUNCTIONAL_RECEIVE_ID, CAN_FILTER_STD_EXACT, CAN_ID_STD }, // Functional 0x7DF
+    { CAN_OBD_PHYSICAL_RECEIVE_ID, CAN_FILTER_STD_EXACT, CAN_ID_STD },   // Physical 0x7E0
+    // UDS on 29-bit IDs (normal fixed addressing) from the tester at 0xF1
+    { CAN_DIAG_RECEIVE_ID, CAN_FILTER_EXT_EXACT, CAN_ID_EXT },           // Functional 0x18DB33F1
+    { CAN_DIAG_PHYSICAL_RECEIVE_ID, CAN_FILTER_EXT_EXACT, CAN_ID_EXT },  // Physical 0x18DAE5F1
+    { CAN_DTC_FLOW_CONTROL_ID, CAN_FILTER_EXT_EXACT, CAN_ID_EXT },       // Flow control for the DTC broadcast
+};
+
+static CAN_HandleTypeDef* s_hcan;
+static CAN_Filter_Entry_t filter_table[CAN_FILTER_MAX_ENTRIES];
+static uint8_t filter_count = 0;
+static uint8_t banks_used = 0;
+
+// --- Private Function Prototypes ---
+static CAN_Filter_Kind_t CAN_Filter_Get_Kind(const CAN_Filter_Entry_t* entry);
+static uint32_t CAN_Filter_Encode_Id(const CAN_Filter_Entry_t* entry);
+static uint32_t CAN_Filter_Encode_Mask(const CAN_Filter_Entry_t* entry);
+static HAL_StatusTypeDef CAN_Filter_Program_Bank(uint32_t bank, CAN_Filter_Kind_t kind,
+                                                 uint32_t fr1, uint32_t fr2,
+                                                 uint32_t fifo, uint32_t activation);
+
+// --- Public API Functions ---
+
+HAL_StatusTypeDef CAN_Filter_Init(CAN_HandleTypeDef* hcan)
+{
+    s_hcan = hcan;
+    filter_count = 0;
+
+    for (uint32_t i = 0; i < sizeof(filter_defaults) / sizeof(filter_defaults[0]); i++) {
+        if (CAN_Filter_Add(&filter_defaults[i]) != HAL_OK) {
+            return HAL_ERROR;
+        }
+    }
+
+    return CAN_Filter_Apply();
+}
+
+HAL_StatusTypeDef CAN_Filter_Add(const CAN_Filter_Entry_t* entry)
+{
+    if (entry == NULL) {
+        return HAL_ERROR;
+    }
+
+    for (uint8_t i = 0; i < filter_count; i++) {
+        if (memcmp(&filter_table[i], entry, sizeof(*entry)) == 0) {
+            return HAL_OK;
+        }
+    }
+    if (filter_count >= CAN_FILTER_MAX_ENTRIES) {
+        return HAL_ERROR;
+    }
+
+    filter_table[filter_count++] = *entry;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef CAN_Filter_Remove(uint32_t id, uint32_t ide)
+{
+    uint8_t kept = 0;
+
+    for (uint8_t i = 0; i < filter_count; i++) {
+        if (filter_table[i].id != id || filter_table[i].ide != ide) {
+            filter_table[kept++] = filter_table[i];
+        }
+    }
+    if (kept == filter_count) {
+        return HAL_ERROR;
+    }
+
+    filter_count = kept;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef CAN_Filter_Apply(void)
+{
+    uint8_t members[FILTER_KIND_COUNT][CAN_FILTER_MAX_ENTRIES];
+    uint8_t member_count[FILTER_KIND_COUNT] = { 0 };
+    uint32_t fifo_load[2] = { 0, 0 };
+    uint32_t banks_needed = 0;
+    uint32_t bank = 0;
+
+    if (s_hcan == NULL) {
+        return HAL_ERROR;
+    }
+
+    for (uint8_t i = 0; i < filter_count; i++) {
+        CAN_Filter_Kind_t kind = CAN_Filter_Get_Kind(&filter_table[i]);
+        members[kind][member_count[kind]++] = i;
+    }
+    for (uint32_t kind = 0; kind < FILTER_KIND_COUNT; kind++) {
+        banks_needed += (member_count[kind] + filter_slots_per_bank[kind] - 1) / filter_slots_per_bank[kind];
+    }
+    if (banks_needed > CAN_FILTER_BANK_COUNT) {
+        return HAL_ERROR;
+    }
+
+    for (uint32_t kind = 0; kind < FILTER_KIND_COUNT; kind++) {
+        uint8_t slots = filter_slots_per_bank[kind];
+
+        for (uint32_t first = 0; first < member_count[kind]; first += slots) {
+            uint32_t used = member_count[kind] - first;
+            uint32_t ids[4];
+            uint32_t masks[4];
+            uint32_t fr1;
+            uint32_t fr2;
+
+            if (used > slots) {
+                used = slots;
+            }
+
+            // Unused slots repeat the last entry, so they never widen the match
+            for (uint32_t s = 0; s < slots; s++) {
+                const CAN_Filter_Entry_t* entry = &filter_table[members[kind][first + ((s < used) ? s : used - 1)]];
+                ids[s] = CAN_Filter_Encode_Id(entry);
+                masks[s] = CAN_Filter_Encode_Mask(entry);
+            }
+
+            switch (kind) {
+                case FILTER_KIND_STD_LIST: // Four 16-bit IDs
+                    fr1 = ids[0] | (ids[1] << 16);
+                    fr2 = ids[2] | (ids[3] << 16);
+                    break;
+                case FILTER_KIND_STD_MASK: // Two 16-bit ID/mask pairs
+                    fr1 = ids[0] | (masks[0] << 16);
+                    fr2 = ids[1] | (masks[1] << 16);
+                    break;
+                case FILTER_KIND_EXT_LIST: // Two 32-bit IDs
+                    fr1 = ids[0];
+                    fr2 = ids[1];
+                    break;
+                default: // One 32-bit ID and mask
+                    fr1 = ids[0];
+                    fr2 = masks[0];
+                    break;
+            }
+
+            // Spread the entries over both FIFOs so neither overruns alone
+            uint32_t fifo = (fifo_load[0] <= fifo_load[1]) ? CAN_FILTER_FIFO0 : CAN_FILTER_FIFO1;
+            fifo_load[fifo] += used;
+
+            if (CAN_Filter_Program_Bank(bank, (CAN_Filter_Kind_t)kind, fr1, fr2, fifo, ENABLE) != HAL_OK) {
+                return HAL_ERROR;
+            }
+            bank++;
+        }
+    }
+
+    // Switch off banks left over from a larger table
+    for (uint32_t b = bank; b < banks_used; b++) {
+        if (CAN_Filter_Program_Bank(b, FILTER_KIND_EXT_MASK, 0, 0, CAN_FILTER_FIFO0, DISABLE) != HAL_OK) {
+            return HAL_ERROR;
+        }
+    }
+    banks_used = bank;
+
+    return HAL_OK;
+}
+
+uint8_t CAN_Filter_GetBanksUsed(void)
+{
+    return banks_used;
+}
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Picks the bank layout an entry is packed into.
+ */
+static CAN_Filter_Kind_t CAN_Filter_Get_Kind(const CAN_Filter_Entry_t* entry)
+{
+    if (entry->ide == CAN_ID_STD) {
+        return ((entry->mask & CAN_FILTER_STD_EXACT) == CAN_FILTER_STD_EXACT) ? FILTER_KIND_STD_LIST : FILTER_KIND_STD_MASK;
+    }
+    return ((entry->mask & CAN_FILTER_EXT_EXACT) == CAN_FILTER_EXT_EXACT) ? FILTER_KIND_EXT_LIST : FILTER_KIND_EXT_MASK;
+}
+
+/**
+ * @brief Encodes an ID in the filter register layout.
+ * @note  16-bit scale: STID[10:0] RTR IDE EXID[17:15].
+ *        32-bit scale: STID[10:0] EXID[17:0] IDE RTR 0.
+ */
+static uint32_t CAN_Filter_Encode_Id(const CAN_Filter_Entry_t* entry)
+{
+    if (entry->ide == CAN_ID_STD) {
+        return (entry->id & CAN_FILTER_STD_EXACT) << 5;
+    }
+    return ((entry->id & CAN_FILTER_EXT_EXACT) << 3) | FILTER_EXT_IDE_BIT;
+}
+
+/**
+ * @brief Encodes a mask in the filter register layout.
+ * @note  IDE and RTR must match as well, so only data frames of the
+ *        entry's ID type are accepted.
+ */
+static uint32_t CAN_Filter_Encode_Mask(const CAN_Filter_Entry_t* entry)
+{
+    if (entry->ide == CAN_ID_STD) {
+        return ((entry->mask & CAN_FILTER_STD_EXACT) << 5) | FILTER_STD_RTR_IDE_BITS;
+    }
+    return ((entry->mask & CAN_FILTER_EXT_EXACT) << 3) | FILTER_EXT_RTR_IDE_BITS;
+}
+
+/**
+ * @brief Writes one bank given the raw FR1/FR2 register values.
+ */
+static HAL_StatusTypeDef CAN_Filter_Program_Bank(uint32_t bank, CAN_Filter_Kind_t kind,
+                                                 uint32_t fr1, uint32_t fr2,
+                                                 uint32_t fifo, uint32_t activation)
+{
+    CAN_FilterTypeDef config;
+
+    config.FilterBank = bank;
+    config.FilterMode = (kind == FILTER_KIND_STD_LIST || kind == FILTER_KIND_EXT_LIST) ?
+                        CAN_FILTERMODE_IDLIST : CAN_FILTERMODE_IDMASK;
+    config.FilterFIFOAssignment = fifo;
+    config.FilterActivation = activation;
+    config.SlaveStartFilterBank = CAN_FILTER_BANK_COUNT;
+
+    if (kind == FILTER_KIND_STD_LIST || kind == FILTER_KIND_STD_MASK) {
+        // HAL builds FR1 = MaskIdLow:IdLow and FR2 = MaskIdHigh:IdHigh
+        config.FilterScale = CAN_FILTERSCALE_16BIT;
+        config.FilterIdLow = fr1 & 0xFFFF;
+        config.FilterMaskIdLow = fr1 >> 16;
+        config.FilterIdHigh = fr2 & 0xFFFF;
+        config.FilterMaskIdHigh = fr2 >> 16;
+    } else {
+        // HAL builds FR1 = IdHigh:IdLow and FR2 = MaskIdHigh:MaskIdLow
+        config.FilterScale = CAN_FILTERSCALE_32BIT;
+        config.FilterIdHigh = fr1 >> 16;
+        config.FilterIdLow = fr1 & 0xFFFF;
+        config.FilterMaskIdHigh = fr2 >> 16;
+        config.FilterMaskIdLow = fr2 & 0xFFFF;
+    }
+
+    return HAL_CAN_ConfigFilter(s_hcan, &config);
+}
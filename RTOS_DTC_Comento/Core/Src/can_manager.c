@@ -6,61 +6,225 @@
  */
 
 #include "can_manager.h"
+#include "can_filter.h"
 #include "main.h" // For CAN_HandleTypeDef
+#include "uds_server.h"
+#include <stdbool.h>
+#include <string.h>
+
+// Bits after the CRC field: CRC delimiter, ACK slot, ACK delimiter, EOF and intermission
+#define CAN_FRAME_TRAILER_BITS  13
+
+// ISO-TP protocol control information (upper nibble of the first byte)
+#define ISOTP_PCI_SINGLE_FRAME       0x00
+#define ISOTP_PCI_FIRST_FRAME        0x10
+#define ISOTP_PCI_CONSECUTIVE_FRAME  0x20
+#define ISOTP_PCI_FLOW_CONTROL       0x30
+
+// Flow status values in a flow control frame
+#define ISOTP_FS_CONTINUE  0x00
+#define ISOTP_FS_WAIT      0x01
+#define ISOTP_FS_OVERFLOW  0x02
+
+// First frames carry a 12-bit length, or 0 followed by a 32-bit length above 4095 bytes
+#define ISOTP_FF_DL_12BIT_MAX  4095
+
+// Transmit session states
+typedef enum {
+    ISOTP_TX_IDLE = 0,
+    ISOTP_TX_WAIT_FC,       // First frame or block queued, waiting for flow control
+    ISOTP_TX_SENDING_CF,    // Consecutive frames being queued as the window allows
+    ISOTP_TX_FLUSHING,      // Every frame queued, waiting for the last ones to leave
+} IsoTp_TxState_t;
+
+// Ownership of a message slot handed to the transmit session
+typedef enum {
+    ISOTP_MSG_FREE = 0,
+    ISOTP_MSG_FILLING,      // Claimed by a producer that is still copying the data
+    ISOTP_MSG_READY,        // Waiting for the session to pick it up
+    ISOTP_MSG_ACTIVE,       // Being segmented onto the bus
+} IsoTp_MsgState_t;
+
+typedef struct {
+    uint8_t* data;
+    uint16_t size;
+    uint8_t state;          // IsoTp_MsgState_t, changed with atomic operations
+} IsoTp_TxMessage_t;
+
+// Identifiers of one ISO-TP link. The peer sends requests and flow control
+// on the receive IDs, we answer on tx_id.
+typedef struct {
+    uint32_t functional_id;     // Requests to every ECU, or the link's only receive ID
+    uint32_t physical_id;       // Requests and flow control addressed to us
+    uint32_t tx_id;
+    uint32_t ide;               // CAN_ID_STD or CAN_ID_EXT, for all three
+} IsoTp_Address_t;
+
+// ISO-TP links this ECU transmits on, each with its own IDs and session
+typedef enum {
+    ISOTP_CHANNEL_UDS = 0,  // Diagnostic responses
+    ISOTP_CHANNEL_DTC,      // DTC broadcast
+    ISOTP_CHANNEL_COUNT
+} IsoTp_Channel_t;
+
+// Transmit session of one link, owned by the CAN interrupts
+typedef struct {
+    const IsoTp_Address_t* address; // Only changed while the message slot is claimed
+    CAN_TxPriority_t priority;
+    IsoTp_TxMessage_t message;
+    IsoTp_TxState_t state;
+    uint8_t session_id;         // Tags queued frames so an aborted message can be dropped
+    uint8_t frames;             // Session frames queued or in a mailbox
+    uint16_t data_sent_count;
+    uint8_t sequence_number;
+    uint8_t block_size;         // BS granted by the receiver
+    uint8_t block_count;        // Consecutive frames sent in the current block
+    uint8_t st_min_ms;          // STmin granted by the receiver, rounded up to ms
+    uint32_t timer_start;       // Tick of the last FC wait start or CF transmission
+} IsoTp_TxChannel_t;
+
+// One frame waiting in the transmit queue
+typedef struct {
+    uint32_t id;
+    uint8_t ide;
+    uint8_t dlc;
+    uint8_t session;        // Session that produced the frame, 0 for standalone frames
+    uint8_t data[8];
+} CAN_TxFrame_t;
+
+// Slot of a bounded multi-producer ring. The sequence number tells producers
+// and the consumer whose turn it is, so no lock is needed on either side.
+typedef struct {
+    uint32_t sequence;
+    CAN_TxFrame_t frame;
+} CAN_TxSlot_t;
+
+typedef struct {
+    CAN_TxSlot_t slots[CAN_TX_QUEUE_SIZE];
+    uint32_t enqueue_pos;   // Shared by all producers
+    uint32_t dequeue_pos;   // Only touched by the CAN TX interrupt
+} CAN_TxQueue_t;
+
+// One received frame, handed from the RX interrupt to the consumer task
+typedef struct {
+    CAN_RxHeaderTypeDef header;
+    uint8_t data[8];
+} CAN_RxFrame_t;
 
 // --- Private Variables ---
+static CAN_HandleTypeDef* s_hcan;
 static CAN_TxHeaderTypeDef tx_header;
-static CAN_RxHeaderTypeDef rx_header;
-static uint8_t rx_data[8];
 
-// State for interrupt-driven transmission
-static uint8_t* p_tx_data = NULL;
-static volatile uint16_t tx_data_size = 0;
-static volatile uint16_t tx_data_sent_count = 0;
-static volatile uint8_t is_tx_in_progress = 0;
+// Receive pipeline: frames come from the pool, only pointers pass through the queue
+static osMemoryPoolId_t rx_pool = NULL;
+static osMessageQueueId_t rx_queue = NULL;
+static volatile uint32_t rx_paused_its = 0; // FIFO interrupts off until a frame is freed
+
+// Transmit queue, one ring per priority level
+static CAN_TxQueue_t tx_queues[CAN_TX_PRIORITY_COUNT];
+static uint8_t tx_mailbox_session[3];   // Session of the frame held by each mailbox
+
+// Diagnostic requests are accepted on these, and answered on the one they came in on
+static const IsoTp_Address_t diag_addresses[] = {
+    { CAN_DIAG_RECEIVE_ID, CAN_DIAG_PHYSICAL_RECEIVE_ID, CAN_DIAG_TRANSMIT_ID, CAN_ID_EXT },
+    { CAN_OBD_FUNCTIONAL_RECEIVE_ID, CAN_OBD_PHYSICAL_RECEIVE_ID, CAN_OBD_TRANSMIT_ID, CAN_ID_STD },
+};
+static const IsoTp_Address_t dtc_address = {
+    CAN_DTC_FLOW_CONTROL_ID, CAN_DTC_FLOW_CONTROL_ID, CAN_DTC_TRANSMIT_ID, CAN_ID_EXT
+};
 
-// State for received command
-static volatile CAN_Command_t received_command = CMD_NONE;
+// ISO-TP transmit links. Diagnostic responses use the high priority queue,
+// so their frames overtake a broadcast that is in progress.
+static uint8_t tx_buffer[CAN_ISOTP_TX_BUFFER_SIZE];
+static uint8_t uds_response[CAN_ISOTP_TX_BUFFER_SIZE];
+static IsoTp_TxChannel_t tx_channels[ISOTP_CHANNEL_COUNT] = {
+    [ISOTP_CHANNEL_UDS] = { &diag_addresses[0], CAN_TX_PRIORITY_HIGH, { uds_response, 0, ISOTP_MSG_FREE } },
+    [ISOTP_CHANNEL_DTC] = { &dtc_address, CAN_TX_PRIORITY_NORMAL, { tx_buffer, 0, ISOTP_MSG_FREE } },
+};
+static uint8_t tx_next_session_id = 1;  // Shared by the links, so a session ID names its link
+
+// State for ISO-TP reassembly, owned by the consumer task
+static uint8_t rx_buffer[CAN_ISOTP_RX_BUFFER_SIZE];
+static const IsoTp_Address_t* rx_address = NULL;    // Link the message arrives on
+static bool rx_functional = false;                  // Sent to the link's functional ID
+static uint8_t is_rx_in_progress = 0;
+static uint16_t rx_data_size = 0;
+static uint16_t rx_data_received_count = 0;
+static uint8_t rx_sequence_number = 0;
+static uint8_t rx_block_count = 0;
+static uint32_t rx_last_frame_tick = 0;
+
+// Bus statistics
+static CAN_Manager_Stats_t can_stats;
+static uint16_t tx_mailbox_bits[3];
 
 // --- Private Function Prototypes ---
-static void CAN_Send_Next_Frame(CAN_HandleTypeDef* hcan);
-static void Process_CAN_Response(uint8_t* data);
+static bool CAN_Tx_Queue_Push(CAN_TxPriority_t priority, const CAN_TxFrame_t* frame);
+static bool CAN_Tx_Queue_Pop(CAN_TxFrame_t* frame);
+static void CAN_Tx_Kick(void);
+static void CAN_Tx_Drain(void);
+static bool IsoTp_Address_Match(const IsoTp_Address_t* address, const CAN_RxHeaderTypeDef* header);
+static IsoTp_TxChannel_t* IsoTp_Find_Session(uint8_t session_id);
+static void IsoTp_New_Session(IsoTp_TxChannel_t* channel);
+static bool IsoTp_Push_Frame(IsoTp_TxChannel_t* channel, const uint8_t* payload);
+static void IsoTp_Tx_Start(IsoTp_TxChannel_t* channel);
+static void IsoTp_Tx_Feed(IsoTp_TxChannel_t* channel, uint32_t now);
+static void IsoTp_Tx_Finish(IsoTp_TxChannel_t* channel);
+static void IsoTp_Tx_Abort(IsoTp_TxChannel_t* channel);
+static void IsoTp_Tx_Service(void);
+static void CAN_Send_Flow_Control(const IsoTp_Address_t* address, uint8_t flow_status);
+static void CAN_Send_Negative_Response(const IsoTp_Address_t* address, uint8_t sid, uint8_t nrc);
+static void IsoTp_Handle_Flow_Control(IsoTp_TxChannel_t* channel, const uint8_t* data);
+static CAN_Command_t IsoTp_Receive_Frame(const IsoTp_Address_t* address, bool functional,
+                                         const uint8_t* data, uint8_t length);
+static CAN_Command_t Process_CAN_Response(const IsoTp_Address_t* address, bool functional,
+                                          uint8_t* data, uint16_t length);
+static uint16_t CAN_Frame_Bits(uint32_t ide, uint32_t id, uint32_t rtr, uint32_t dlc, const uint8_t* data);
+static void CAN_Tx_Complete(uint32_t mailbox_index);
+static void CAN_Rx_Drain_Fifo(CAN_HandleTypeDef* hcan, uint32_t rx_fifo);
 
 // --- Public API Functions ---
 
 HAL_StatusTypeDef CAN_Manager_Init(CAN_HandleTypeDef* hcan)
 {
-    CAN_FilterTypeDef sFilterConfig;
-
-    // Configure CAN filter for diagnostic requests
-    sFilterConfig.FilterBank = 0;
-    sFilterConfig.FilterMode = CAN_FILTERMODE_IDMASK;
-    sFilterConfig.FilterScale = CAN_FILTERSCALE_32BIT;
-    sFilterConfig.FilterIdHigh = (CAN_DIAG_RECEIVE_ID >> 13) & 0xFFFF;
-    sFilterConfig.FilterIdLow = ((CAN_DIAG_RECEIVE_ID << 3) | CAN_ID_EXT) & 0xFFF8;
-    sFilterConfig.FilterMaskIdHigh = 0xFFFF;
-    sFilterConfig.FilterMaskIdLow = 0xFFF8;
-    sFilterConfig.FilterFIFOAssignment = CAN_RX_FIFO0;
-    sFilterConfig.FilterActivation = ENABLE;
-    sFilterConfig.SlaveStartFilterBank = 14; // Meaningless for single CAN
-
-    if (HAL_CAN_ConfigFilter(hcan, &sFilterConfig) != HAL_OK) {
+    s_hcan = hcan;
+
+    // Spread the diagnostic IDs over the filter banks and both FIFOs
+    if (CAN_Filter_Init(hcan) != HAL_OK) {
         return HAL_ERROR;
     }
 
-    // Configure transmission header
-    tx_header.ExtId = CAN_DTC_TRANSMIT_ID;
-    tx_header.IDE = CAN_ID_EXT;
+    // Configure the fields shared by every transmitted frame
     tx_header.RTR = CAN_RTR_DATA;
-    tx_header.DLC = 8;
     tx_header.TransmitGlobalTime = DISABLE;
 
+    // Each slot starts out owned by the producer whose position matches it
+    for (uint32_t p = 0; p < CAN_TX_PRIORITY_COUNT; p++) {
+        for (uint32_t i = 0; i < CAN_TX_QUEUE_SIZE; i++) {
+            tx_queues[p].slots[i].sequence = i;
+        }
+        tx_queues[p].enqueue_pos = 0;
+        tx_queues[p].dequeue_pos = 0;
+    }
+    memset(tx_mailbox_session, 0, sizeof(tx_mailbox_session));
+    for (uint32_t c = 0; c < ISOTP_CHANNEL_COUNT; c++) {
+        tx_channels[c].message.state = ISOTP_MSG_FREE;
+        tx_channels[c].state = ISOTP_TX_IDLE;
+        tx_channels[c].frames = 0;
+        IsoTp_New_Session(&tx_channels[c]);
+    }
+
+    memset(&can_stats, 0, sizeof(can_stats));
+
     if (HAL_CAN_Start(hcan) != HAL_OK) {
         return HAL_ERROR;
     }
 
-    // Activate both TX and RX notifications
-    if (HAL_CAN_ActivateNotification(hcan, CAN_IT_TX_MAILBOX_EMPTY | CAN_IT_RX_FIFO0_MSG_PENDING) != HAL_OK) {
+    // Activate TX notifications, plus FIFO full/overrun for loss accounting.
+    // Message reception starts with CAN_Manager_Start_Rx once the RTOS objects exist.
+    if (HAL_CAN_ActivateNotification(hcan, CAN_IT_TX_MAILBOX_EMPTY |
+                                           CAN_IT_RX_FIFO0_FULL | CAN_IT_RX_FIFO0_OVERRUN |
+                                           CAN_IT_RX_FIFO1_FULL | CAN_IT_RX_FIFO1_OVERRUN) != HAL_OK) {
         return HAL_ERROR;
     }
 
@@ -69,69 +233,840 @@ HAL_StatusTypeDef CAN_Manager_Init(CAN_HandleTypeDef* hcan)
 
 HAL_StatusTypeDef CAN_Manager_Transmit_DTC(CAN_HandleTypeDef* hcan, uint8_t* dtc_data, uint16_t size)
 {
-    if (is_tx_in_progress) {
+    IsoTp_TxMessage_t* message = &tx_channels[ISOTP_CHANNEL_DTC].message;
+    uint8_t expected = ISOTP_MSG_FREE;
+
+    if (size == 0 || dtc_data == NULL || size > CAN_ISOTP_TX_BUFFER_SIZE) {
+        return HAL_ERROR;
+    }
+
+    // Claim the message slot; only the producer that wins may fill it
+    if (!__atomic_compare_exchange_n(&message->state, &expected, ISOTP_MSG_FILLING,
+                                     false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
         return HAL_BUSY;
     }
-    if (size == 0 || dtc_data == NULL) {
+
+    memcpy(message->data, dtc_data, size);
+    message->size = size;
+    __atomic_store_n(&message->state, ISOTP_MSG_READY, __ATOMIC_RELEASE);
+
+    CAN_Tx_Kick();
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef CAN_Manager_Transmit_Frame(uint32_t id, uint32_t ide, const uint8_t* data, uint8_t dlc, CAN_TxPriority_t priority)
+{
+    CAN_TxFrame_t frame;
+
+    if (dlc > 8 || (data == NULL && dlc != 0) || priority >= CAN_TX_PRIORITY_COUNT) {
         return HAL_ERROR;
     }
 
-    p_tx_data = dtc_data;
-    tx_data_size = size;
-    tx_data_sent_count = 0;
-    is_tx_in_progress = 1;
+    frame.id = id;
+    frame.ide = (uint8_t)ide;
+    frame.dlc = dlc;
+    frame.session = 0;
+    memset(frame.data, 0, sizeof(frame.data));
+    if (dlc != 0) {
+        memcpy(frame.data, data, dlc);
+    }
 
-    CAN_Send_Next_Frame(hcan);
+    if (!CAN_Tx_Queue_Push(priority, &frame)) {
+        __atomic_fetch_add(&can_stats.tx_queue_full, 1, __ATOMIC_RELAXED);
+        return HAL_BUSY;
+    }
 
+    CAN_Tx_Kick();
     return HAL_OK;
 }
 
-CAN_Command_t CAN_Manager_Get_Command(void)
+HAL_StatusTypeDef CAN_Manager_Start_Rx(osMessageQueueId_t queue)
+{
+    if (s_hcan == NULL || queue == NULL) {
+        return HAL_ERROR;
+    }
+
+    rx_pool = osMemoryPoolNew(CAN_RX_POOL_SIZE, sizeof(CAN_RxFrame_t), NULL);
+    if (rx_pool == NULL) {
+        return HAL_ERROR;
+    }
+    rx_queue = queue;
+
+    return HAL_CAN_ActivateNotification(s_hcan, CAN_IT_RX_FIFO0_MSG_PENDING | CAN_IT_RX_FIFO1_MSG_PENDING);
+}
+
+CAN_Command_t CAN_Manager_Process_Rx(uint32_t timeout)
 {
-    return received_command;
+    CAN_RxFrame_t* frame;
+    CAN_Command_t command = CMD_NONE;
+
+    // A partial message must not wait longer than its N_Cr timeout
+    if (is_rx_in_progress && timeout > CAN_ISOTP_TIMEOUT_MS) {
+        timeout = CAN_ISOTP_TIMEOUT_MS;
+    }
+
+    if (osMessageQueueGet(rx_queue, &frame, NULL, timeout) == osOK) {
+        for (uint32_t i = 0; i < sizeof(diag_addresses) / sizeof(diag_addresses[0]); i++) {
+            if (IsoTp_Address_Match(&diag_addresses[i], &frame->header)) {
+                uint32_t id = (frame->header.IDE == CAN_ID_EXT) ? frame->header.ExtId : frame->header.StdId;
+
+                command = IsoTp_Receive_Frame(&diag_addresses[i], id == diag_addresses[i].functional_id,
+                                              frame->data, frame->header.DLC);
+                break;
+            }
+        }
+        osMemoryPoolFree(rx_pool, frame);
+
+        // The interrupt left frames in the hardware FIFOs; fetch them now there is room
+        uint32_t paused_its = __atomic_exchange_n(&rx_paused_its, 0, __ATOMIC_RELAXED);
+        if (paused_its != 0) {
+            HAL_CAN_ActivateNotification(s_hcan, paused_its);
+        }
+    }
+
+    if (is_rx_in_progress && (HAL_GetTick() - rx_last_frame_tick) > CAN_ISOTP_TIMEOUT_MS) {
+        // N_Cr timeout: drop the partial message
+        is_rx_in_progress = 0;
+    }
+
+    return command;
 }
 
-void CAN_Manager_Clear_Command(void)
+void CAN_Manager_Get_Stats(CAN_Manager_Stats_t* p_stats)
 {
-    received_command = CMD_NONE;
+    if (p_stats != NULL) {
+        *p_stats = can_stats;
+    }
 }
 
-// --- Private Helper Functions ---
+void CAN_Manager_Reset_Stats(void)
+{
+    memset(&can_stats, 0, sizeof(can_stats));
+}
 
-static void CAN_Send_Next_Frame(CAN_HandleTypeDef* hcan)
+uint32_t CAN_Manager_Get_Bitrate(CAN_HandleTypeDef* hcan)
 {
-    if (tx_data_sent_count >= tx_data_size) {
-        is_tx_in_progress = 0;
+    // Init fields hold register-encoded values, each one less than the TQ count
+    uint32_t bs1 = (hcan->Init.TimeSeg1 >> CAN_BTR_TS1_Pos) + 1;
+    uint32_t bs2 = (hcan->Init.TimeSeg2 >> CAN_BTR_TS2_Pos) + 1;
+    uint32_t tq_per_bit = 1 + bs1 + bs2; // Sync segment is always one TQ
+
+    return HAL_RCC_GetPCLK1Freq() / (hcan->Init.Prescaler * tq_per_bit);
+}
+
+void CAN_Manager_Tick(void)
+{
+    // Timers are evaluated by the TX interrupt, which owns the session state.
+    // A ready message also waits here if its first frame found the queue full.
+    for (uint32_t c = 0; c < ISOTP_CHANNEL_COUNT; c++) {
+        if (tx_channels[c].state != ISOTP_TX_IDLE ||
+            __atomic_load_n(&tx_channels[c].message.state, __ATOMIC_RELAXED) == ISOTP_MSG_READY) {
+            CAN_Tx_Kick();
+            return;
+        }
+    }
+}
+
+void CAN_Manager_TX_IRQHandler(void)
+{
+    if (s_hcan == NULL) {
         return;
     }
 
+    IsoTp_Tx_Service();
+    CAN_Tx_Drain();
+}
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Adds a frame to the ring of the given priority without locking.
+ * @note  Safe from any task or interrupt. A producer reserves a position with
+ *        a compare-and-swap, copies the frame, then publishes it through the
+ *        slot's sequence number.
+ * @retval false if the ring is full.
+ */
+static bool CAN_Tx_Queue_Push(CAN_TxPriority_t priority, const CAN_TxFrame_t* frame)
+{
+    CAN_TxQueue_t* queue = &tx_queues[priority];
+    uint32_t pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+
+    for (;;) {
+        CAN_TxSlot_t* slot = &queue->slots[pos & (CAN_TX_QUEUE_SIZE - 1)];
+        uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+        int32_t diff = (int32_t)(sequence - pos);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&queue->enqueue_pos, &pos, pos + 1,
+                                            true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                slot->frame = *frame;
+                __atomic_store_n(&slot->sequence, pos + 1, __ATOMIC_RELEASE);
+                return true;
+            }
+            // Lost the race, pos now holds the winner's update
+        } else if (diff < 0) {
+            return false; // The consumer has not freed this slot yet
+        } else {
+            pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * @brief Takes the oldest frame of the highest priority level that has one.
+ * @note  Single consumer: only called from the CAN TX interrupt.
+ * @retval false if no published frame is waiting.
+ */
+static bool CAN_Tx_Queue_Pop(CAN_TxFrame_t* frame)
+{
+    for (uint32_t p = 0; p < CAN_TX_PRIORITY_COUNT; p++) {
+        CAN_TxQueue_t* queue = &tx_queues[p];
+        uint32_t pos = queue->dequeue_pos;
+        CAN_TxSlot_t* slot = &queue->slots[pos & (CAN_TX_QUEUE_SIZE - 1)];
+        uint32_t sequence = __atomic_load_n(&slot->sequence, __ATOMIC_ACQUIRE);
+
+        // A producer preempted between reserving and publishing holds up its
+        // level until it finishes; it kicks the drain again when it does
+        if ((int32_t)(sequence - (pos + 1)) < 0) {
+            continue;
+        }
+
+        *frame = slot->frame;
+        __atomic_store_n(&slot->sequence, pos + CAN_TX_QUEUE_SIZE, __ATOMIC_RELEASE);
+        queue->dequeue_pos = pos + 1;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Makes the CAN TX interrupt run so it drains the transmit queue.
+ * @note  Pending the interrupt instead of draining in place keeps a single
+ *        consumer, whichever context produced the frame.
+ */
+static void CAN_Tx_Kick(void)
+{
+    HAL_NVIC_SetPendingIRQ(CAN1_TX_IRQn);
+}
+
+/**
+ * @brief Moves queued frames into free TX mailboxes.
+ * @note  Relies on TransmitFifoPriority so mailboxes go out in request order.
+ */
+static void CAN_Tx_Drain(void)
+{
+    CAN_TxFrame_t frame;
     uint32_t tx_mailbox;
-    uint8_t tx_payload[8] = {0};
-    uint8_t bytes_to_send = (tx_data_size - tx_data_sent_count >= 8) ? 8 : (tx_data_size - tx_data_sent_count);
+    uint32_t index;
 
-    for (int i = 0; i < bytes_to_send; i++) {
-        tx_payload[i] = p_tx_data[tx_data_sent_count + i];
+    while (HAL_CAN_GetTxMailboxesFreeLevel(s_hcan) > 0 && CAN_Tx_Queue_Pop(&frame)) {
+        IsoTp_TxChannel_t* channel = IsoTp_Find_Session(frame.session);
+
+        if (frame.session != 0 && channel == NULL) {
+            continue; // Left over from an aborted message
+        }
+
+        tx_header.IDE = frame.ide;
+        tx_header.ExtId = frame.id;
+        tx_header.StdId = frame.id;
+        tx_header.DLC = frame.dlc;
+        if (HAL_CAN_AddTxMessage(s_hcan, &tx_header, frame.data, &tx_mailbox) != HAL_OK) {
+            __atomic_fetch_add(&can_stats.tx_errors, 1, __ATOMIC_RELAXED);
+            if (channel != NULL) {
+                IsoTp_Tx_Abort(channel);
+            }
+            continue;
+        }
+
+        // Remember the frame length and owner until the mailbox reports completion
+        index = (tx_mailbox == CAN_TX_MAILBOX0) ? 0 : (tx_mailbox == CAN_TX_MAILBOX1) ? 1 : 2;
+        tx_mailbox_bits[index] = CAN_Frame_Bits(frame.ide, frame.id, CAN_RTR_DATA, frame.dlc, frame.data);
+        tx_mailbox_session[index] = frame.session;
+    }
+}
+
+/**
+ * @brief Tells whether a received frame was sent to one of the link's receive IDs.
+ */
+static bool IsoTp_Address_Match(const IsoTp_Address_t* address, const CAN_RxHeaderTypeDef* header)
+{
+    uint32_t id = (header->IDE == CAN_ID_EXT) ? header->ExtId : header->StdId;
+
+    return header->IDE == address->ide && (id == address->functional_id || id == address->physical_id);
+}
+
+/**
+ * @brief Returns the link whose current session tagged a frame.
+ * @retval NULL for standalone frames and for frames of an aborted session.
+ */
+static IsoTp_TxChannel_t* IsoTp_Find_Session(uint8_t session_id)
+{
+    if (session_id == 0) {
+        return NULL;
     }
-    tx_header.DLC = bytes_to_send;
+    for (uint32_t c = 0; c < ISOTP_CHANNEL_COUNT; c++) {
+        if (tx_channels[c].session_id == session_id) {
+            return &tx_channels[c];
+        }
+    }
+    return NULL;
+}
 
-    if (HAL_CAN_AddTxMessage(hcan, &tx_header, tx_payload, &tx_mailbox) == HAL_OK) {
-        tx_data_sent_count += bytes_to_send;
+/**
+ * @brief Gives a link a session ID no other link holds.
+ */
+static void IsoTp_New_Session(IsoTp_TxChannel_t* channel)
+{
+    do {
+        channel->session_id = tx_next_session_id;
+        tx_next_session_id = (tx_next_session_id == 0xFF) ? 1 : tx_next_session_id + 1;
+    } while (IsoTp_Find_Session(channel->session_id) != channel);
+}
+
+/**
+ * @brief Queues one 8-byte ISO-TP frame of a link's active session.
+ */
+static bool IsoTp_Push_Frame(IsoTp_TxChannel_t* channel, const uint8_t* payload)
+{
+    CAN_TxFrame_t frame;
+
+    frame.id = channel->address->tx_id;
+    frame.ide = (uint8_t)channel->address->ide;
+    frame.dlc = 8;
+    frame.session = channel->session_id;
+    memcpy(frame.data, payload, 8);
+
+    if (!CAN_Tx_Queue_Push(channel->priority, &frame)) {
+        __atomic_fetch_add(&can_stats.tx_queue_full, 1, __ATOMIC_RELAXED);
+        return false;
+    }
+    channel->frames++;
+    return true;
+}
+
+/**
+ * @brief Starts the link's message if one is ready.
+ * @note  If the first frame does not fit in the queue the message stays
+ *        ready and is started again by the next completion or tick.
+ */
+static void IsoTp_Tx_Start(IsoTp_TxChannel_t* channel)
+{
+    IsoTp_TxMessage_t* message = &channel->message;
+    uint8_t frame[8];
+    uint8_t header_length;
+    uint16_t size;
+
+    if (__atomic_load_n(&message->state, __ATOMIC_ACQUIRE) != ISOTP_MSG_READY) {
+        return;
+    }
+    size = message->size;
+
+    if (size <= 7) {
+        // Single frame: the whole message fits after the one-byte PCI
+        frame[0] = ISOTP_PCI_SINGLE_FRAME | size;
+        memcpy(&frame[1], message->data, size);
+        memset(&frame[1 + size], CAN_ISOTP_PADDING, 7 - size);
+    } else {
+        // First frame, then wait for the receiver's flow control
+        if (size <= ISOTP_FF_DL_12BIT_MAX) {
+            frame[0] = ISOTP_PCI_FIRST_FRAME | ((size >> 8) & 0x0F);
+            frame[1] = size & 0xFF;
+            header_length = 2;
+        } else {
+            frame[0] = ISOTP_PCI_FIRST_FRAME;
+            frame[1] = 0;
+            frame[2] = 0;
+            frame[3] = 0;
+            frame[4] = (size >> 8) & 0xFF;
+            frame[5] = size & 0xFF;
+            header_length = 6;
+        }
+        memcpy(&frame[header_length], message->data, 8 - header_length);
+    }
+
+    if (!IsoTp_Push_Frame(channel, frame)) {
+        return;
+    }
+    __atomic_store_n(&message->state, ISOTP_MSG_ACTIVE, __ATOMIC_RELAXED);
+
+    if (size <= 7) {
+        channel->data_sent_count = size;
+        channel->state = ISOTP_TX_FLUSHING;
     } else {
-        is_tx_in_progress = 0;
+        channel->data_sent_count = 8 - header_length;
+        channel->sequence_number = 1;
+        channel->state = ISOTP_TX_WAIT_FC;
+    }
+    channel->timer_start = HAL_GetTick();
+}
+
+/**
+ * @brief Queues consecutive frames while the session window has room.
+ * @note  Up to CAN_ISOTP_TX_WINDOW frames are kept ahead of the bus so the
+ *        mailboxes never run dry. With a non-zero STmin frames must be
+ *        spaced, so the next one is only queued once the previous has left.
+ */
+static void IsoTp_Tx_Feed(IsoTp_TxChannel_t* channel, uint32_t now)
+{
+    IsoTp_TxMessage_t* message = &channel->message;
+    uint8_t frame[8];
+
+    while (channel->state == ISOTP_TX_SENDING_CF && channel->frames < CAN_ISOTP_TX_WINDOW) {
+        if (channel->st_min_ms != 0 &&
+            (channel->frames != 0 || (now - channel->timer_start) <= channel->st_min_ms)) {
+            return;
+        }
+
+        uint16_t remaining = message->size - channel->data_sent_count;
+        uint8_t bytes_to_send = (remaining >= 7) ? 7 : remaining;
+
+        frame[0] = ISOTP_PCI_CONSECUTIVE_FRAME | channel->sequence_number;
+        memcpy(&frame[1], &message->data[channel->data_sent_count], bytes_to_send);
+        memset(&frame[1 + bytes_to_send], CAN_ISOTP_PADDING, 7 - bytes_to_send);
+
+        if (!IsoTp_Push_Frame(channel, frame)) {
+            return; // Queue full, retried on the next completion or tick
+        }
+
+        channel->data_sent_count += bytes_to_send;
+        channel->sequence_number = (channel->sequence_number + 1) & 0x0F;
+        channel->timer_start = now;
+
+        if (channel->data_sent_count >= message->size) {
+            channel->state = ISOTP_TX_FLUSHING;
+        } else if (channel->block_size != 0 && ++channel->block_count >= channel->block_size) {
+            // Block finished, the receiver must grant the next one
+            channel->state = ISOTP_TX_WAIT_FC;
+        }
     }
 }
 
 /**
- * @brief Processes the data received from the diagnostic tool.
+ * @brief Ends the link's session and releases its message slot.
  */
-static void Process_CAN_Response(uint8_t* data)
+static void IsoTp_Tx_Finish(IsoTp_TxChannel_t* channel)
 {
-    // Example diagnostic frame: data[0] is command type
+    if (channel->state != ISOTP_TX_IDLE) {
+        __atomic_store_n(&channel->message.state, ISOTP_MSG_FREE, __ATOMIC_RELEASE);
+    }
+    channel->state = ISOTP_TX_IDLE;
+}
+
+/**
+ * @brief Drops the link's session, including frames still queued or in a mailbox.
+ */
+static void IsoTp_Tx_Abort(IsoTp_TxChannel_t* channel)
+{
+    uint32_t mailboxes = 0;
+
+    for (uint32_t i = 0; i < 3; i++) {
+        if (tx_mailbox_session[i] == channel->session_id) {
+            mailboxes |= (CAN_TX_MAILBOX0 << i);
+            tx_mailbox_session[i] = 0;
+        }
+    }
+    if (mailboxes != 0) {
+        HAL_CAN_AbortTxRequest(s_hcan, mailboxes);
+    }
+
+    // Frames still in the queue carry the old ID and are skipped by the drain
+    IsoTp_New_Session(channel);
+    channel->frames = 0;
+    IsoTp_Tx_Finish(channel);
+}
+
+/**
+ * @brief Advances every transmit session: timeouts, pacing and message hand-over.
+ * @note  The links are independent, so a broadcast waiting for flow control
+ *        never holds up a diagnostic response.
+ */
+static void IsoTp_Tx_Service(void)
+{
+    uint32_t now = HAL_GetTick();
+
+    for (uint32_t c = 0; c < ISOTP_CHANNEL_COUNT; c++) {
+        IsoTp_TxChannel_t* channel = &tx_channels[c];
+
+        if (channel->state == ISOTP_TX_IDLE) {
+            IsoTp_Tx_Start(channel);
+        }
+
+        if (channel->state == ISOTP_TX_WAIT_FC && channel->frames == 0 &&
+            (now - channel->timer_start) > CAN_ISOTP_TIMEOUT_MS) {
+            // N_Bs timeout: the receiver never answered
+            __atomic_fetch_add(&can_stats.tx_errors, 1, __ATOMIC_RELAXED);
+            IsoTp_Tx_Abort(channel);
+        }
+
+        IsoTp_Tx_Feed(channel, now);
+
+        if (channel->state == ISOTP_TX_FLUSHING && channel->frames == 0) {
+            IsoTp_Tx_Finish(channel);
+            IsoTp_Tx_Start(channel);
+        }
+    }
+}
+
+/**
+ * @brief Sends a flow control frame for the message being reassembled.
+ */
+static void CAN_Send_Flow_Control(const IsoTp_Address_t* address, uint8_t flow_status)
+{
+    uint8_t frame[8];
+
+    frame[0] = ISOTP_PCI_FLOW_CONTROL | flow_status;
+    frame[1] = CAN_ISOTP_BLOCK_SIZE;
+    frame[2] = CAN_ISOTP_ST_MIN;
+    memset(&frame[3], CAN_ISOTP_PADDING, 5);
+
+    // Ahead of everything else so the peer is not stalled by our own traffic
+    CAN_Manager_Transmit_Frame(address->tx_id, address->ide, frame, 8, CAN_TX_PRIORITY_HIGH);
+}
+
+/**
+ * @brief Answers a request with a negative response in a single frame,
+ *        without the UDS link's message slot.
+ */
+static void CAN_Send_Negative_Response(const IsoTp_Address_t* address, uint8_t sid, uint8_t nrc)
+{
+    uint8_t frame[8];
+
+    frame[0] = ISOTP_PCI_SINGLE_FRAME | 3;
+    frame[1] = UDS_SID_NEGATIVE_RESPONSE;
+    frame[2] = sid;
+    frame[3] = nrc;
+    memset(&frame[4], CAN_ISOTP_PADDING, 4);
+
+    CAN_Manager_Transmit_Frame(address->tx_id, address->ide, frame, 8, CAN_TX_PRIORITY_HIGH);
+}
+
+/**
+ * @brief Applies a flow control frame received for a link's transmit session.
+ */
+static void IsoTp_Handle_Flow_Control(IsoTp_TxChannel_t* channel, const uint8_t* data)
+{
+    if (channel->state != ISOTP_TX_WAIT_FC) {
+        return;
+    }
+
+    switch (data[0] & 0x0F) {
+        case ISOTP_FS_CONTINUE:
+            channel->block_size = data[1];
+            channel->block_count = 0;
+            if (data[2] <= 0x7F) {
+                channel->st_min_ms = data[2];
+            } else if (data[2] >= 0xF1 && data[2] <= 0xF9) {
+                channel->st_min_ms = 1; // 100-900 us, rounded up to the tick
+            } else {
+                channel->st_min_ms = 0x7F; // Reserved values mean the maximum
+            }
+            channel->state = ISOTP_TX_SENDING_CF;
+            CAN_Tx_Kick();
+            break;
+
+        case ISOTP_FS_WAIT:
+            channel->timer_start = HAL_GetTick(); // Restart N_Bs
+            break;
+
+        default: // Overflow or invalid: the receiver cannot take the message
+            __atomic_fetch_add(&can_stats.tx_errors, 1, __ATOMIC_RELAXED);
+            IsoTp_Tx_Abort(channel);
+            break;
+    }
+}
+
+/**
+ * @brief Feeds one received frame into ISO-TP reassembly.
+ * @note  Runs in the consumer task. Flow control frames never get here, the
+ *        RX interrupt applies them to the transmit session directly. One
+ *        message is reassembled at a time; a new one on any link replaces it.
+ * @param address Link the frame arrived on.
+ * @param functional true if it was sent to the link's functional ID.
+ * @retval Command carried by the message this frame completed, or CMD_NONE.
+ */
+static CAN_Command_t IsoTp_Receive_Frame(const IsoTp_Address_t* address, bool functional,
+                                         const uint8_t* data, uint8_t length)
+{
+    uint16_t copy_length;
+
+    if (length == 0) {
+        return CMD_NONE;
+    }
+
+    switch (data[0] & 0xF0) {
+        case ISOTP_PCI_SINGLE_FRAME:
+            copy_length = data[0] & 0x0F;
+            if (copy_length == 0 || copy_length > length - 1) {
+                return CMD_NONE;
+            }
+            // A single frame aborts any message still being reassembled
+            is_rx_in_progress = 0;
+            memcpy(rx_buffer, &data[1], copy_length);
+            return Process_CAN_Response(address, functional, rx_buffer, copy_length);
+
+        case ISOTP_PCI_FIRST_FRAME: {
+            uint32_t message_length = ((uint32_t)(data[0] & 0x0F) << 8) | data[1];
+            uint8_t header_length = 2;
+
+            if (length < 8) {
+                return CMD_NONE;
+            }
+            if (message_length == 0) {
+                message_length = ((uint32_t)data[2] << 24) | ((uint32_t)data[3] << 16) |
+                                 ((uint32_t)data[4] << 8) | data[5];
+                header_length = 6;
+            }
+            if (message_length > CAN_ISOTP_RX_BUFFER_SIZE) {
+                is_rx_in_progress = 0;
+                CAN_Send_Flow_Control(address, ISOTP_FS_OVERFLOW);
+                return CMD_NONE;
+            }
+            if (message_length <= (uint32_t)(8 - header_length)) {
+                return CMD_NONE; // Would have fitted in a single frame
+            }
+
+            rx_data_size = message_length;
+            rx_data_received_count = 8 - header_length;
+            memcpy(rx_buffer, &data[header_length], rx_data_received_count);
+            rx_sequence_number = 1;
+            rx_block_count = 0;
+            rx_last_frame_tick = HAL_GetTick();
+            rx_address = address;
+            rx_functional = functional;
+            is_rx_in_progress = 1;
+            CAN_Send_Flow_Control(address, ISOTP_FS_CONTINUE);
+            break;
+        }
+
+        case ISOTP_PCI_CONSECUTIVE_FRAME:
+            if (!is_rx_in_progress || address != rx_address) {
+                return CMD_NONE;
+            }
+            if ((data[0] & 0x0F) != rx_sequence_number) {
+                is_rx_in_progress = 0; // Lost a frame, the message is unusable
+                return CMD_NONE;
+            }
+
+            copy_length = rx_data_size - rx_data_received_count;
+            if (copy_length > 7) {
+                copy_length = 7;
+            }
+            if (copy_length > length - 1) {
+                is_rx_in_progress = 0;
+                return CMD_NONE;
+            }
+            memcpy(&rx_buffer[rx_data_received_count], &data[1], copy_length);
+            rx_data_received_count += copy_length;
+            rx_sequence_number = (rx_sequence_number + 1) & 0x0F;
+            rx_last_frame_tick = HAL_GetTick();
+
+            if (rx_data_received_count >= rx_data_size) {
+                is_rx_in_progress = 0;
+                return Process_CAN_Response(address, rx_functional, rx_buffer, rx_data_size);
+            } else if (CAN_ISOTP_BLOCK_SIZE != 0 && ++rx_block_count >= CAN_ISOTP_BLOCK_SIZE) {
+                rx_block_count = 0;
+                CAN_Send_Flow_Control(address, ISOTP_FS_CONTINUE);
+            }
+            break;
+
+        default:
+            break;
+    }
+    return CMD_NONE;
+}
+
+/**
+ * @brief Appends one bit to a frame being measured, tracking CRC and stuffing.
+ */
+static void CAN_Frame_Push_Bit(uint8_t bit, uint16_t* crc, uint8_t* last_bit, uint8_t* run_length, uint16_t* stuff_bits)
+{
+    // CRC-15 (polynomial 0x4599) covers SOF through the data field
+    uint8_t crc_next = bit ^ ((*crc >> 14) & 0x01);
+    *crc = (*crc << 1) & 0x7FFF;
+    if (crc_next) {
+        *crc ^= 0x4599;
+    }
+
+    if (bit == *last_bit) {
+        (*run_length)++;
+    } else {
+        *last_bit = bit;
+        *run_length = 1;
+    }
+
+    // After five equal bits the transmitter inserts one of opposite polarity,
+    // which itself starts a new run
+    if (*run_length == 5) {
+        (*stuff_bits)++;
+        *last_bit = !bit;
+        *run_length = 1;
+    }
+}
+
+/**
+ * @brief Computes the exact number of bus bits a data or remote frame occupies.
+ * @note  Includes stuff bits, CRC, ACK, EOF and the 3-bit intermission.
+ */
+static uint16_t CAN_Frame_Bits(uint32_t ide, uint32_t id, uint32_t rtr, uint32_t dlc, const uint8_t* data)
+{
+    uint16_t crc = 0;
+    uint16_t stuff_bits = 0;
+    uint16_t bit_count = 0;
+    uint8_t last_bit = 2; // No previous bit yet
+    uint8_t run_length = 0;
+    uint32_t fields[6];
+    uint8_t widths[6];
+    uint8_t field_count = 0;
+    uint8_t data_len = (rtr == CAN_RTR_DATA) ? ((dlc > 8) ? 8 : dlc) : 0;
+
+    // Arbitration and control fields, MSB first, starting with a dominant SOF
+    fields[field_count] = 0; widths[field_count++] = 1;
+    if (ide == CAN_ID_EXT) {
+        fields[field_count] = (id >> 18) & 0x7FF; widths[field_count++] = 11;
+        // SRR and IDE are recessive, followed by the 18-bit ID extension
+        fields[field_count] = 0x3; widths[field_count++] = 2;
+        fields[field_count] = id & 0x3FFFF; widths[field_count++] = 18;
+        // RTR, r1, r0
+        fields[field_count] = (rtr == CAN_RTR_REMOTE) ? 0x4 : 0x0; widths[field_count++] = 3;
+    } else {
+        fields[field_count] = id & 0x7FF; widths[field_count++] = 11;
+        // RTR, IDE (dominant), r0
+        fields[field_count] = (rtr == CAN_RTR_REMOTE) ? 0x4 : 0x0; widths[field_count++] = 3;
+    }
+    fields[field_count] = dlc & 0xF; widths[field_count++] = 4;
+
+    for (uint8_t f = 0; f < field_count; f++) {
+        for (int8_t b = widths[f] - 1; b >= 0; b--) {
+            CAN_Frame_Push_Bit((fields[f] >> b) & 0x01, &crc, &last_bit, &run_length, &stuff_bits);
+            bit_count++;
+        }
+    }
+    for (uint8_t i = 0; i < data_len; i++) {
+        for (int8_t b = 7; b >= 0; b--) {
+            CAN_Frame_Push_Bit((data[i] >> b) & 0x01, &crc, &last_bit, &run_length, &stuff_bits);
+            bit_count++;
+        }
+    }
+
+    // The CRC sequence is stuffed as well but does not feed the CRC itself
+    uint16_t crc_value = crc;
+    for (int8_t b = 14; b >= 0; b--) {
+        uint16_t unused_crc = 0;
+        CAN_Frame_Push_Bit((crc_value >> b) & 0x01, &unused_crc, &last_bit, &run_length, &stuff_bits);
+        bit_count++;
+    }
+
+    return bit_count + stuff_bits + CAN_FRAME_TRAILER_BITS;
+}
+
+/**
+ * @brief Accounts a successfully transmitted frame.
+ * @note  Runs inside HAL_CAN_IRQHandler; CAN_Manager_TX_IRQHandler then
+ *        continues the session and refills the mailboxes.
+ */
+static void CAN_Tx_Complete(uint32_t mailbox_index)
+{
+    IsoTp_TxChannel_t* channel = IsoTp_Find_Session(tx_mailbox_session[mailbox_index]);
+
+    __atomic_fetch_add(&can_stats.tx_frames, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&can_stats.tx_bits, tx_mailbox_bits[mailbox_index], __ATOMIC_RELAXED);
+
+    if (channel != NULL && channel->frames > 0) {
+        channel->frames--;
+        channel->timer_start = HAL_GetTick(); // STmin and N_Bs count from the bus
+    }
+    tx_mailbox_session[mailbox_index] = 0;
+}
+
+/**
+ * @brief Processes a complete message received from the diagnostic tool.
+ * @param address Link the request arrived on, which the response goes back on.
+ * @param functional true if the request was sent to every ECU.
+ * @retval Command for the application to carry out.
+ */
+static CAN_Command_t Process_CAN_Response(const IsoTp_Address_t* address, bool functional,
+                                          uint8_t* data, uint16_t length)
+{
+    IsoTp_TxChannel_t* channel = &tx_channels[ISOTP_CHANNEL_UDS];
+    IsoTp_TxMessage_t* message = &channel->message;
+    uint8_t expected = ISOTP_MSG_FREE;
+
+    // Example diagnostic request: data[0] is the service ID
     // 0x31: Clear DTC, 0x19: Read DTC
     if (data[0] == 0x31) { // A simplified UDS-like command
-        received_command = CMD_CLEAR_DTC;
-    } else if (data[0] == 0x19) {
-        received_command = CMD_READ_DTC;
+        return CMD_CLEAR_DTC;
+    }
+    // Everything else goes to the UDS server, which also rejects the
+    // services it does not support. Answer on CAN right away so the tester
+    // sees it within P2. The response slot is only reused once the previous
+    // answer has left; until then the tester is told to repeat the request.
+    if (__atomic_compare_exchange_n(&message->state, &expected, ISOTP_MSG_FILLING,
+                                    false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        uint16_t response_length = UDS_Server_Process(data, length, functional, uds_response, sizeof(uds_response));
+        if (response_length > 0) {
+            channel->address = address;
+            message->size = response_length;
+            __atomic_store_n(&message->state, ISOTP_MSG_READY, __ATOMIC_RELEASE);
+            CAN_Tx_Kick();
+        } else {
+            __atomic_store_n(&message->state, ISOTP_MSG_FREE, __ATOMIC_RELEASE);
+        }
+    } else {
+        CAN_Send_Negative_Response(address, data[0], UDS_NRC_BUSY_REPEAT_REQUEST);
+    }
+    return (data[0] == UDS_SID_READ_DTC_INFORMATION) ? CMD_READ_DTC : CMD_NONE;
+}
+
+/**
+ * @brief Moves every frame waiting in an RX FIFO into the receive pipeline.
+ * @note  Flow control for our transmit session is applied here, since the
+ *        session belongs to the CAN interrupts; everything else is posted
+ *        to the consumer task.
+ */
+static void CAN_Rx_Drain_Fifo(CAN_HandleTypeDef* hcan, uint32_t rx_fifo)
+{
+    while (HAL_CAN_GetRxFifoFillLevel(hcan, rx_fifo) > 0) {
+        CAN_RxFrame_t* frame = osMemoryPoolAlloc(rx_pool, 0);
+
+        if (frame == NULL) {
+            // Pool exhausted: leave the rest in hardware until the task frees a frame
+            uint32_t pending_it = (rx_fifo == CAN_RX_FIFO0) ? CAN_IT_RX_FIFO0_MSG_PENDING : CAN_IT_RX_FIFO1_MSG_PENDING;
+            __atomic_fetch_add(&can_stats.rx_pool_empty, 1, __ATOMIC_RELAXED);
+            HAL_CAN_DeactivateNotification(hcan, pending_it);
+            __atomic_fetch_or(&rx_paused_its, pending_it, __ATOMIC_RELAXED);
+            return;
+        }
+        if (HAL_CAN_GetRxMessage(hcan, rx_fifo, &frame->header, frame->data) != HAL_OK) {
+            osMemoryPoolFree(rx_pool, frame);
+            return;
+        }
+
+        __atomic_fetch_add(&can_stats.rx_frames, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&can_stats.rx_bits,
+                           CAN_Frame_Bits(frame->header.IDE,
+                                          (frame->header.IDE == CAN_ID_EXT) ? frame->header.ExtId : frame->header.StdId,
+                                          frame->header.RTR, frame->header.DLC, frame->data),
+                           __ATOMIC_RELAXED);
+
+        if (frame->header.DLC >= 3 && (frame->data[0] & 0xF0) == ISOTP_PCI_FLOW_CONTROL) {
+            IsoTp_TxChannel_t* channel = NULL;
+
+            for (uint32_t c = 0; c < ISOTP_CHANNEL_COUNT && channel == NULL; c++) {
+                if (IsoTp_Address_Match(tx_channels[c].address, &frame->header)) {
+                    channel = &tx_channels[c];
+                }
+            }
+            if (channel != NULL) {
+                IsoTp_Handle_Flow_Control(channel, frame->data);
+                osMemoryPoolFree(rx_pool, frame);
+                continue;
+            }
+        }
+
+        // The queue is as deep as the pool, so this only fails if it was never set up
+        if (osMessageQueuePut(rx_queue, &frame, 0, 0) != osOK) {
+            osMemoryPoolFree(rx_pool, frame);
+        }
     }
 }
 
@@ -139,30 +1074,92 @@ static void Process_CAN_Response(uint8_t* data)
 
 void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef *hcan)
 {
-    if (is_tx_in_progress) CAN_Send_Next_Frame(hcan);
+    CAN_Tx_Complete(0);
 }
 
 void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef *hcan)
 {
-    if (is_tx_in_progress) CAN_Send_Next_Frame(hcan);
+    CAN_Tx_Complete(1);
 }
 
 void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef *hcan)
 {
-    if (is_tx_in_progress) CAN_Send_Next_Frame(hcan);
+    CAN_Tx_Complete(2);
 }
 
 /**
-  * @brief  FIFO 0 message pending callback.
+  * @brief  FIFO 0 full callback.
   * @param  hcan: pointer to a CAN_HandleTypeDef structure.
   * @retval None
   */
-void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
+void HAL_CAN_RxFifo0FullCallback(CAN_HandleTypeDef *hcan)
+{
+    __atomic_fetch_add(&can_stats.rx_fifo_full, 1, __ATOMIC_RELAXED);
+}
+
+/**
+  * @brief  FIFO 1 full callback.
+  * @param  hcan: pointer to a CAN_HandleTypeDef structure.
+  * @retval None
+  */
+void HAL_CAN_RxFifo1FullCallback(CAN_HandleTypeDef *hcan)
+{
+    __atomic_fetch_add(&can_stats.rx_fifo_full, 1, __ATOMIC_RELAXED);
+}
+
+/**
+  * @brief  Error CAN callback.
+  * @note   MX_CAN1_Init enables automatic retransmission, so the mailbox
+  *         retries a frame that lost arbitration or hit a bus error and
+  *         neither reaches this callback. Should it be disabled the frame is
+  *         gone, so the transfer is aborted.
+  * @param  hcan: pointer to a CAN_HandleTypeDef structure.
+  * @retval None
+  */
+void HAL_CAN_ErrorCallback(CAN_HandleTypeDef *hcan)
 {
-    if (HAL_CAN_GetRxMessage(hcan, CAN_RX_FIFO0, &rx_header, rx_data) == HAL_OK) {
-        // Check if the message is for us (optional, as filter should handle it)
-        if (rx_header.ExtId == CAN_DIAG_RECEIVE_ID) {
-            Process_CAN_Response(rx_data);
+    uint32_t error = HAL_CAN_GetError(hcan);
+
+    if (error & (HAL_CAN_ERROR_RX_FOV0 | HAL_CAN_ERROR_RX_FOV1)) {
+        __atomic_fetch_add(&can_stats.rx_overruns, 1, __ATOMIC_RELAXED);
+    }
+    if (error & (HAL_CAN_ERROR_TX_ALST0 | HAL_CAN_ERROR_TX_TERR0 |
+                 HAL_CAN_ERROR_TX_ALST1 | HAL_CAN_ERROR_TX_TERR1 |
+                 HAL_CAN_ERROR_TX_ALST2 | HAL_CAN_ERROR_TX_TERR2)) {
+        __atomic_fetch_add(&can_stats.tx_errors, 1, __ATOMIC_RELAXED);
+        // The failed mailbox reports no completion, so release it here
+        for (uint32_t i = 0; i < 3; i++) {
+            if (error & ((HAL_CAN_ERROR_TX_ALST0 | HAL_CAN_ERROR_TX_TERR0) << (i * 2))) {
+                IsoTp_TxChannel_t* channel = IsoTp_Find_Session(tx_mailbox_session[i]);
+
+                // The message is broken; drop whatever is still queued behind the lost frame
+                if (channel != NULL) {
+                    IsoTp_Tx_Abort(channel);
+                }
+                tx_mailbox_session[i] = 0;
+            }
         }
     }
+
+    HAL_CAN_ResetError(hcan);
+}
+
+/**
+  * @brief  FIFO 0 message pending callback.
+  * @param  hcan: pointer to a CAN_HandleTypeDef structure.
+  * @retval None
+  */
+void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef *hcan)
+{
+    CAN_Rx_Drain_Fifo(hcan, CAN_RX_FIFO0);
+}
+
+/**
+  * @brief  FIFO 1 message pending callback.
+  * @param  hcan: pointer to a CAN_HandleTypeDef structure.
+  * @retval None
+  */
+void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef *hcan)
+{
+    CAN_Rx_Drain_Fifo(hcan, CAN_RX_FIFO1);
 }
@@ -1,20 +1,532 @@
 #include "dtc_manager.h"
+#include <string.h>
 
-// We can use a bitmask to store the status of all DTCs.
-// A 32-bit integer can hold up to 32 DTC statuses.
-// For more DTCs, an array of uint32_t can be used.
-static uint32_t dtc_status_bitmask = 0;
+// Status byte of each DTC, the reference copy. A status transition is
+// claimed with a compare-and-swap on it, then applied to the query index
+// below, so tasks and ISRs can update DTCs concurrently without locks.
+static uint8_t dtc_status[DTC_CODE_COUNT];
+
+// Query index, kept up to date on every transition:
+// - Status bytes bit-sliced: plane b holds status bit b of every DTC, one
+//   bit per code, so matching a mask is an OR of a few planes per 32 DTCs.
+// - One summary bit per non-zero plane word, so a walk skips words with
+//   no match without reading them.
+// - Population counts per status bit and per status byte value, so counts
+//   are answered without visiting any DTC.
+static uint32_t dtc_planes[DTC_STATUS_BIT_COUNT][DTC_WORD_COUNT];
+static uint32_t dtc_summary[DTC_STATUS_BIT_COUNT][DTC_SUMMARY_WORD_COUNT];
+static uint16_t dtc_bit_count[DTC_STATUS_BIT_COUNT];
+static uint16_t dtc_status_histogram[256];
+
+#define DTC_PLANE_TF        0   // testFailed
+#define DTC_PLANE_TFTOC     1   // testFailedThisOperationCycle
+#define DTC_PLANE_PDTC      2   // pendingDTC
+#define DTC_PLANE_CDTC      3   // confirmedDTC
+#define DTC_PLANE_TNCSLC    4   // testNotCompletedSinceLastClear
+#define DTC_PLANE_TFSLC     5   // testFailedSinceLastClear
+#define DTC_PLANE_TNCTOC    6   // testNotCompletedThisOperationCycle
+#define DTC_PLANE_WIR       7   // warningIndicatorRequested
+
+// Layout of the DTC_Export image after the status planes
+#define DTC_STORAGE_AGING_OFFSET     (DTC_STATUS_BIT_COUNT * DTC_WORD_COUNT * 4)
+#define DTC_STORAGE_EXT_DATA_OFFSET  (DTC_STORAGE_AGING_OFFSET + DTC_CODE_COUNT)
+
+// Status of every DTC after a clear: no test has run yet
+#define DTC_STATUS_AFTER_CLEAR  (DTC_STATUS_TEST_NOT_COMPLETED_SINCE_CLEAR | \
+                                 DTC_STATUS_TEST_NOT_COMPLETED_THIS_OP_CYCLE)
+
+// Snapshot ring. A record's seq is odd while it is being written, so a
+// reader can detect a copy torn by a concurrent capture and retry.
+typedef struct {
+    uint32_t seq;
+    uint32_t serial;        // Capture number, tells a reused slot apart
+    DTC_Snapshot_t data;
+} DTC_Snapshot_Slot_t;
+
+#define DTC_SNAPSHOT_NONE           0xFFFFFFFFUL  // No record in snapshot_index
+#define DTC_SNAPSHOT_IN_RING        0xFF          // First record not pinned, read from the ring
+#define DTC_SNAPSHOT_READ_RETRIES   4
+#define DTC_SNAPSHOT_FIRST_FULL     (0xFFFFFFFFUL >> (32 - DTC_SNAPSHOT_FIRST_POOL_SIZE))
+
+// Latest records share the ring. The first DTCs to fail since the last
+// clear pin their first record in a pool slot, so a burst of other faults
+// never evicts it; later ones find their first record in the ring.
+static DTC_Snapshot_Slot_t snapshot_ring[DTC_SNAPSHOT_RING_SIZE];
+static DTC_Snapshot_Slot_t snapshot_first[DTC_SNAPSHOT_FIRST_POOL_SIZE];
+static uint32_t snapshot_first_used;    // Bit per pool slot
+static uint32_t snapshot_head;
+// Capture serial of each DTC's first and latest record; the latest one's
+// ring slot is the serial modulo DTC_SNAPSHOT_RING_SIZE
+static uint32_t snapshot_index[DTC_CODE_COUNT][2];
+// Pool slot of each DTC's first record, or DTC_SNAPSHOT_IN_RING
+static uint8_t snapshot_first_slot[DTC_CODE_COUNT];
+
+_Static_assert(DTC_SNAPSHOT_FIRST_POOL_SIZE > 0 && DTC_SNAPSHOT_FIRST_POOL_SIZE <= 32, "snapshot_first_used has a bit per slot");
+
+// Definition of each DTC, generated from DTC_TABLE and kept in flash
+static const DTC_Definition_t dtc_definitions[DTC_CODE_COUNT] = {
+#define DTC_DEFINITION_ENTRY(name, number, severity, unit, algorithm, fail, pass, snapshot, description) \
+    [name] = { (number), (severity), (unit), (snapshot), { (algorithm), (fail), (pass) }, (description) },
+    DTC_TABLE(DTC_DEFINITION_ENTRY)
+#undef DTC_DEFINITION_ENTRY
+};
+
+// Checks on every table entry. Duplicate DTC numbers are caught by the
+// case labels in DTC_FindByNumber.
+#define DTC_CHECK_ENTRY(name, number, severity, unit, algorithm, fail, pass, snapshot, description) \
+    _Static_assert((number) > 0 && (number) < 0xFFFFFF, #name ": DTC number must be 3 bytes, not 0 or 0xFFFFFF"); \
+    _Static_assert((fail) > 0 && (pass) > 0, #name ": debounce thresholds must not be 0");
+DTC_TABLE(DTC_CHECK_ENTRY)
+#undef DTC_CHECK_ENTRY
+
+// Debounce progress of each DTC. counter > 0 is heading towards failed,
+// < 0 towards passed. Time-based debouncing only uses its sign and
+// start_ms, the time the current direction began.
+typedef struct {
+    int16_t counter;
+    uint32_t start_ms;
+} DTC_Debounce_State_t;
+
+static DTC_Debounce_State_t dtc_debounce[DTC_CODE_COUNT];
+
+// Consecutive fault-free operation cycles of each DTC, for healing and aging
+static uint8_t dtc_aging[DTC_CODE_COUNT];
+
+// Occurrence counters and timestamps of each DTC, 12 bytes per DTC
+static DTC_ExtData_t dtc_ext_data[DTC_CODE_COUNT];
+
+// Told when the state in DTC_Export changes
+static DTC_ChangeCallback_t dtc_change_callback;
+
+// Clock for the occurrence timestamps
+static DTC_TimeSource_t dtc_time_source;
+
+/**
+ * @brief Finds the first word with a DTC matching a status mask at or after
+ *        a given index.
+ * @return The word index, or -1 if no remaining word matches.
+ */
+static int32_t DTC_Find_Word(uint8_t status_mask, uint32_t start)
+{
+    for (uint32_t s = start / 32; s < DTC_SUMMARY_WORD_COUNT; s++) {
+        uint32_t bits = 0;
+        for (uint8_t m = status_mask; m != 0; m &= m - 1) {
+            bits |= __atomic_load_n(&dtc_summary[__builtin_ctz(m)][s], __ATOMIC_RELAXED);
+        }
+        if (s == start / 32) {
+            bits &= ~0UL << (start % 32);
+        }
+        if (bits != 0) {
+            // Count trailing zeros: RBIT + CLZ on Cortex-M4
+            return (int32_t)(s * 32 + __builtin_ctz(bits));
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Returns the bits of a word that belong to defined DTCs.
+ */
+static uint32_t DTC_Valid_Bits(uint32_t word)
+{
+    if (word == DTC_WORD_COUNT - 1 && (DTC_CODE_COUNT % 32) != 0) {
+        return (1UL << (DTC_CODE_COUNT % 32)) - 1;
+    }
+    return 0xFFFFFFFFUL;
+}
+
+/**
+ * @brief Returns the DTCs of one word whose status matches any bit of a mask.
+ */
+static uint32_t DTC_Match_Word(uint8_t status_mask, uint32_t word)
+{
+    uint32_t bits = 0;
+
+    while (status_mask != 0) {
+        uint32_t plane = __builtin_ctz(status_mask);
+        bits |= __atomic_load_n(&dtc_planes[plane][word], __ATOMIC_RELAXED);
+        status_mask &= status_mask - 1;
+    }
+    return bits;
+}
+
+/**
+ * @brief Tells the registered callback that the saved state is out of date.
+ */
+static void DTC_Notify_Change(void)
+{
+    DTC_ChangeCallback_t callback = dtc_change_callback;
+
+    if (callback != NULL) {
+        callback();
+    }
+}
+
+/**
+ * @brief Copies a DTC's status byte into the planes and summaries.
+ * @note Plane words are updated with atomic OR/AND (LDREX/STREX on
+ *       Cortex-M4). If another writer changes the status byte meanwhile,
+ *       the copy is repeated, so the planes always end up matching it.
+ */
+static void DTC_Sync_Planes(DTC_Code_t code, uint8_t status)
+{
+    uint32_t word = (uint32_t)code / 32;
+    uint32_t bit = 1UL << (code % 32);
+    uint32_t summary_bit = 1UL << (word % 32);
+
+    for (;;) {
+        for (uint32_t plane = 0; plane < DTC_STATUS_BIT_COUNT; plane++) {
+            uint32_t* p_word = &dtc_planes[plane][word];
+            uint32_t* p_summary = &dtc_summary[plane][word / 32];
+
+            if (status & (1U << plane)) {
+                if ((__atomic_fetch_or(p_word, bit, __ATOMIC_SEQ_CST) & bit) == 0) {
+                    __atomic_fetch_or(p_summary, summary_bit, __ATOMIC_SEQ_CST);
+                }
+            } else if ((__atomic_fetch_and(p_word, ~bit, __ATOMIC_SEQ_CST) & bit) != 0 &&
+                       __atomic_load_n(p_word, __ATOMIC_SEQ_CST) == 0) {
+                __atomic_fetch_and(p_summary, ~summary_bit, __ATOMIC_SEQ_CST);
+                // A concurrent writer may have set a bit of this word in the
+                // meantime; it sets its plane bit before the summary bit
+                if (__atomic_load_n(p_word, __ATOMIC_SEQ_CST) != 0) {
+                    __atomic_fetch_or(p_summary, summary_bit, __ATOMIC_SEQ_CST);
+                }
+            }
+        }
+
+        uint8_t latest = __atomic_load_n(&dtc_status[code], __ATOMIC_SEQ_CST);
+        if (latest == status) {
+            return;
+        }
+        status = latest;
+    }
+}
+
+/**
+ * @brief Adds one to a counter unless it is already at 255.
+ * @return The previous value.
+ */
+static uint8_t DTC_Increment_Saturating(uint8_t* counter)
+{
+    uint8_t old_value = __atomic_load_n(counter, __ATOMIC_RELAXED);
+
+    while (old_value < 0xFF &&
+           !__atomic_compare_exchange_n(counter, &old_value, old_value + 1, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    return old_value;
+}
+
+/**
+ * @brief Updates the extended data of a DTC that has just been set.
+ * @param old_status Status byte before the DTC was set.
+ */
+static void DTC_Record_Failure(DTC_Code_t code, uint8_t old_status)
+{
+    DTC_ExtData_t* data = &dtc_ext_data[code];
+
+    if ((old_status & DTC_STATUS_TEST_FAILED) == 0) {
+        DTC_TimeSource_t source = dtc_time_source;
+        uint32_t now = (source != NULL) ? source() : 0;
+
+        if (DTC_Increment_Saturating(&data->occurrence_counter) == 0) {
+            __atomic_store_n(&data->first_failure_time, now, __ATOMIC_RELAXED);
+        }
+        __atomic_store_n(&data->last_failure_time, now, __ATOMIC_RELAXED);
+    }
+    if ((old_status & DTC_STATUS_TEST_FAILED_THIS_OP_CYCLE) == 0) {
+        DTC_Increment_Saturating(&data->pending_counter);
+    }
+}
+
+/**
+ * @brief Writes the status bits selected by a mask for one DTC and updates
+ *        the query index.
+ * @return The previous status byte.
+ */
+static uint8_t DTC_Write_Status(DTC_Code_t code, uint8_t mask, uint8_t status)
+{
+    uint8_t old_status = __atomic_load_n(&dtc_status[code], __ATOMIC_RELAXED);
+    uint8_t new_status;
+    uint8_t flipped;
+
+    do {
+        new_status = (old_status & ~mask) | (status & mask);
+        if (new_status == old_status) {
+            return old_status;
+        }
+    } while (!__atomic_compare_exchange_n(&dtc_status[code], &old_status, new_status, false,
+                                          __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+
+    // This writer owns the transition old_status -> new_status
+    __atomic_fetch_sub(&dtc_status_histogram[old_status], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&dtc_status_histogram[new_status], 1, __ATOMIC_RELAXED);
+    flipped = old_status ^ new_status;
+    while (flipped != 0) {
+        uint32_t plane = __builtin_ctz(flipped);
+        if (new_status & (1U << plane)) {
+            __atomic_fetch_add(&dtc_bit_count[plane], 1, __ATOMIC_RELAXED);
+        } else {
+            __atomic_fetch_sub(&dtc_bit_count[plane], 1, __ATOMIC_RELAXED);
+        }
+        flipped &= flipped - 1;
+    }
+
+    DTC_Sync_Planes(code, new_status);
+    return old_status;
+}
+
+/**
+ * @brief Records a qualified failure of a DTC.
+ * @return The status before the failure.
+ */
+static uint8_t DTC_Write_Failed(DTC_Code_t code)
+{
+    // Failing now, this cycle and since the last clear, confirmed, and the
+    // warning indicator is requested
+    const uint8_t failed_status = DTC_STATUS_TEST_FAILED | DTC_STATUS_TEST_FAILED_THIS_OP_CYCLE |
+                                  DTC_STATUS_PENDING | DTC_STATUS_CONFIRMED |
+                                  DTC_STATUS_TEST_FAILED_SINCE_CLEAR | DTC_STATUS_WARNING_INDICATOR;
+    uint8_t old_status = DTC_Write_Status(code, 0xFF, failed_status);
+
+    DTC_Record_Failure(code, old_status);
+
+    // If the status has changed, save it to non-volatile memory.
+    if (old_status != failed_status) {
+        DTC_Notify_Change();
+    }
+    return old_status;
+}
+
+/**
+ * @brief Drops every snapshot record.
+ */
+static void DTC_Snapshot_Reset(void)
+{
+    for (uint32_t code = 0; code < DTC_CODE_COUNT; code++) {
+        __atomic_store_n(&snapshot_index[code][DTC_SNAPSHOT_RECORD_FIRST - 1], DTC_SNAPSHOT_NONE, __ATOMIC_RELAXED);
+        __atomic_store_n(&snapshot_index[code][DTC_SNAPSHOT_RECORD_LATEST - 1], DTC_SNAPSHOT_NONE, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&snapshot_first_used, 0, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Claims a free slot of the first-occurrence pool.
+ * @return The slot, or DTC_SNAPSHOT_IN_RING if the pool is full.
+ */
+static uint8_t DTC_Snapshot_Claim_First(void)
+{
+    uint32_t used = __atomic_load_n(&snapshot_first_used, __ATOMIC_RELAXED);
+    uint32_t slot;
+
+    do {
+        if (used == DTC_SNAPSHOT_FIRST_FULL) {
+            return DTC_SNAPSHOT_IN_RING;
+        }
+        slot = (uint32_t)__builtin_ctz(~used);
+    } while (!__atomic_compare_exchange_n(&snapshot_first_used, &used, used | (1UL << slot),
+                                          true, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return (uint8_t)slot;
+}
+
+/**
+ * @brief Copies a snapshot into a slot, tagged with its capture serial.
+ */
+static void DTC_Snapshot_Write(DTC_Snapshot_Slot_t* record, uint32_t serial, const DTC_Snapshot_t* snapshot)
+{
+    uint32_t seq = __atomic_load_n(&record->seq, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&record->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    record->serial = serial;
+    record->data = *snapshot;
+    __atomic_store_n(&record->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * @brief Copies a snapshot into the next ring slot.
+ * @return The capture serial of the record.
+ */
+static uint32_t DTC_Snapshot_Capture(const DTC_Snapshot_t* snapshot)
+{
+    uint32_t serial;
+
+    // Skip the serial reserved for "no record"
+    do {
+        serial = __atomic_fetch_add(&snapshot_head, 1, __ATOMIC_RELAXED);
+    } while (serial == DTC_SNAPSHOT_NONE);
+
+    DTC_Snapshot_Write(&snapshot_ring[serial % DTC_SNAPSHOT_RING_SIZE], serial, snapshot);
+    return serial;
+}
+
+/**
+ * @brief Stores a word little-endian.
+ */
+static void DTC_Put_U32(uint8_t* p, uint32_t value)
+{
+    p[0] = value & 0xFF;
+    p[1] = (value >> 8) & 0xFF;
+    p[2] = (value >> 16) & 0xFF;
+    p[3] = (value >> 24) & 0xFF;
+}
+
+/**
+ * @brief Loads a little-endian word.
+ */
+static uint32_t DTC_Get_U32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Rebuilds the whole query index from the status bytes.
+ * @note Not safe against concurrent writers; used by clear and restore.
+ */
+static void DTC_Rebuild_Index(void)
+{
+    memset(dtc_planes, 0, sizeof(dtc_planes));
+    memset(dtc_summary, 0, sizeof(dtc_summary));
+    memset(dtc_bit_count, 0, sizeof(dtc_bit_count));
+    memset(dtc_status_histogram, 0, sizeof(dtc_status_histogram));
+
+    for (uint32_t code = 0; code < DTC_CODE_COUNT; code++) {
+        uint8_t status = dtc_status[code];
+
+        dtc_status_histogram[status]++;
+        for (uint32_t plane = 0; plane < DTC_STATUS_BIT_COUNT; plane++) {
+            if (status & (1U << plane)) {
+                dtc_planes[plane][code / 32] |= 1UL << (code % 32);
+                dtc_bit_count[plane]++;
+            }
+        }
+    }
+    for (uint32_t plane = 0; plane < DTC_STATUS_BIT_COUNT; plane++) {
+        for (uint32_t w = 0; w < DTC_WORD_COUNT; w++) {
+            if (dtc_planes[plane][w] != 0) {
+                dtc_summary[plane][w / 32] |= 1UL << (w % 32);
+            }
+        }
+    }
+}
 
 /**
  * @brief Initializes the DTC manager.
  */
-void DTC_Init(void)
+void DTC_Init(const uint8_t* p_saved, uint16_t size)
+{
+    // Snapshots are not saved, so no record survives a reset either way
+    DTC_Snapshot_Reset();
+    if (p_saved != NULL && size >= DTC_STORAGE_SIZE) {
+        DTC_Import(p_saved, size);
+        return;
+    }
+    DTC_Rebuild_Index(); // Index the all-zero status bytes before the first update
+    DTC_ClearAll();
+}
+
+/**
+ * @brief Registers the function told about changes that need saving.
+ * @param callback Function to call, or NULL for none.
+ */
+void DTC_RegisterChangeCallback(DTC_ChangeCallback_t callback)
+{
+    dtc_change_callback = callback;
+}
+
+/**
+ * @brief Registers the clock used for occurrence timestamps.
+ * @param source Function to call, or NULL to record zero timestamps.
+ */
+void DTC_RegisterTimeSource(DTC_TimeSource_t source)
+{
+    dtc_time_source = source;
+}
+
+/**
+ * @brief Starts an operation cycle.
+ */
+void DTC_StartOperationCycle(void)
 {
-    // In a real application, this function should read the last known DTC status
-    // from non-volatile memory (e.g., EEPROM) and restore it.
-    // For now, we just clear it.
-    // Example: dtc_status_bitmask = EEPROM_Read(DTC_STATUS_ADDRESS);
-    dtc_status_bitmask = 0;
+    for (uint32_t code = 0; code < DTC_CODE_COUNT; code++) {
+        DTC_Write_Status((DTC_Code_t)code,
+                         DTC_STATUS_TEST_FAILED_THIS_OP_CYCLE | DTC_STATUS_TEST_NOT_COMPLETED_THIS_OP_CYCLE,
+                         DTC_STATUS_TEST_NOT_COMPLETED_THIS_OP_CYCLE);
+    }
+}
+
+/**
+ * @brief Ends the operation cycle: updates pending, aging and healing.
+ * @return true if any status bit or aging counter changed.
+ */
+bool DTC_EndOperationCycle(void)
+{
+    bool changed = false;
+
+    for (uint32_t w = 0; w < DTC_WORD_COUNT; w++) {
+        uint32_t failed = __atomic_load_n(&dtc_planes[DTC_PLANE_TFTOC][w], __ATOMIC_RELAXED);
+        uint32_t passed = ~__atomic_load_n(&dtc_planes[DTC_PLANE_TNCTOC][w], __ATOMIC_RELAXED) &
+                          ~failed & DTC_Valid_Bits(w);
+        // Only DTCs that failed, or passed with history still to age, need
+        // their counter touched
+        uint32_t visit = failed | (passed & DTC_Match_Word(DTC_STATUS_CONFIRMED | DTC_STATUS_WARNING_INDICATOR, w));
+        uint32_t healed = 0;
+        uint32_t aged = 0;
+        uint32_t clear;
+
+        while (visit != 0) {
+            uint32_t bit = __builtin_ctz(visit);
+            uint32_t code = w * 32 + bit;
+
+            if (failed & (1UL << bit)) {
+                if (dtc_aging[code] != 0) {
+                    dtc_aging[code] = 0;
+                    changed = true;
+                }
+            } else {
+                if (dtc_aging[code] < 0xFF) {
+                    dtc_aging[code]++;
+                    changed = true;
+                }
+                if (dtc_aging[code] >= DTC_HEALING_CYCLES) {
+                    healed |= 1UL << bit;
+                }
+                if (dtc_aging[code] >= DTC_AGING_CYCLES) {
+                    aged |= 1UL << bit;
+                    dtc_aging[code] = 0;
+                }
+            }
+            visit &= visit - 1;
+        }
+
+        // Clear only the selected bits, so a DTC failing meanwhile keeps
+        // the bits it has just set
+        passed &= __atomic_load_n(&dtc_planes[DTC_PLANE_PDTC][w], __ATOMIC_RELAXED);
+        clear = passed | healed | aged;
+        while (clear != 0) {
+            uint32_t bit = __builtin_ctz(clear);
+            uint8_t mask = 0;
+
+            if (passed & (1UL << bit)) {
+                mask |= DTC_STATUS_PENDING;
+            }
+            if (healed & (1UL << bit)) {
+                mask |= DTC_STATUS_WARNING_INDICATOR;
+            }
+            if (aged & (1UL << bit)) {
+                mask |= DTC_STATUS_CONFIRMED;
+            }
+            if ((DTC_Write_Status((DTC_Code_t)(w * 32 + bit), mask, 0) & mask) != 0) {
+                changed = true;
+            }
+            clear &= clear - 1;
+        }
+    }
+
+    if (changed) {
+        DTC_Notify_Change();
+    }
+    return changed;
 }
 
 /**
@@ -24,14 +536,192 @@ void DTC_Init(void)
 void DTC_Set(DTC_Code_t code)
 {
     if (code < DTC_CODE_COUNT) {
-        uint32_t old_bitmask = dtc_status_bitmask;
-        dtc_status_bitmask |= (1UL << code);
+        DTC_Write_Failed(code);
+    }
+}
+
+/**
+ * @brief Sets a DTC and records a snapshot if this is a new occurrence.
+ * @param code The DTC to set.
+ * @param snapshot Conditions at the time of the fault.
+ */
+void DTC_SetWithSnapshot(DTC_Code_t code, const DTC_Snapshot_t* snapshot)
+{
+    if (code < DTC_CODE_COUNT) {
+        // The status returned by the atomic update decides whether this is
+        // a new occurrence, so two concurrent callers never both record it
+        uint8_t old_status = DTC_Write_Failed(code);
+
+        if (snapshot != NULL && (old_status & DTC_STATUS_TEST_FAILED) == 0) {
+            uint32_t serial = DTC_Snapshot_Capture(snapshot);
+
+            // The first occurrence is also the latest one. Without a pool
+            // slot it stays readable until the ring wraps.
+            if ((old_status & DTC_STATUS_TEST_FAILED_SINCE_CLEAR) == 0) {
+                uint8_t slot = DTC_Snapshot_Claim_First();
+
+                if (slot != DTC_SNAPSHOT_IN_RING) {
+                    DTC_Snapshot_Write(&snapshot_first[slot], serial, snapshot);
+                }
+                __atomic_store_n(&snapshot_first_slot[code], slot, __ATOMIC_RELAXED);
+                __atomic_store_n(&snapshot_index[code][DTC_SNAPSHOT_RECORD_FIRST - 1], serial, __ATOMIC_RELEASE);
+            }
+            __atomic_store_n(&snapshot_index[code][DTC_SNAPSHOT_RECORD_LATEST - 1], serial, __ATOMIC_RELEASE);
+        }
+    }
+}
 
-        // If the status has changed, save it to non-volatile memory.
-        if (old_bitmask != dtc_status_bitmask) {
-            // Example: EEPROM_Write(DTC_STATUS_ADDRESS, dtc_status_bitmask);
+/**
+ * @brief Reads a stored snapshot record of a DTC.
+ * @param code The DTC to query.
+ * @param record_number DTC_SNAPSHOT_RECORD_FIRST or DTC_SNAPSHOT_RECORD_LATEST.
+ * @param snapshot Receives the record.
+ * @return true if the record is stored, false if it was never captured or
+ *         has been overwritten.
+ */
+bool DTC_GetSnapshot(DTC_Code_t code, uint8_t record_number, DTC_Snapshot_t* snapshot)
+{
+    const DTC_Snapshot_Slot_t* record;
+    uint32_t serial;
+
+    if (code >= DTC_CODE_COUNT || snapshot == NULL ||
+        record_number < DTC_SNAPSHOT_RECORD_FIRST || record_number > DTC_SNAPSHOT_RECORD_LATEST) {
+        return false;
+    }
+    serial = __atomic_load_n(&snapshot_index[code][record_number - 1], __ATOMIC_ACQUIRE);
+    if (serial == DTC_SNAPSHOT_NONE) {
+        return false;
+    }
+    record = &snapshot_ring[serial % DTC_SNAPSHOT_RING_SIZE];
+    if (record_number == DTC_SNAPSHOT_RECORD_FIRST) {
+        uint8_t slot = __atomic_load_n(&snapshot_first_slot[code], __ATOMIC_RELAXED);
+
+        if (slot != DTC_SNAPSHOT_IN_RING) {
+            record = &snapshot_first[slot];
         }
     }
+
+    for (int retry = 0; retry < DTC_SNAPSHOT_READ_RETRIES; retry++) {
+        uint32_t seq = __atomic_load_n(&record->seq, __ATOMIC_ACQUIRE);
+        uint32_t owner;
+
+        if (seq & 1) {
+            continue; // A capture is writing this slot
+        }
+        owner = record->serial;
+        *snapshot = record->data;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&record->seq, __ATOMIC_RELAXED) == seq) {
+            // The slot may have been reused by a later capture since it was indexed
+            return owner == serial;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Reads the occurrence counters and timestamps of a DTC.
+ * @param code The DTC to query.
+ * @param p_data Receives the record.
+ * @return true if the code is valid, false otherwise.
+ */
+bool DTC_GetExtData(DTC_Code_t code, DTC_ExtData_t* p_data)
+{
+    const DTC_ExtData_t* data;
+
+    if (code >= DTC_CODE_COUNT || p_data == NULL) {
+        return false;
+    }
+    data = &dtc_ext_data[code];
+    p_data->first_failure_time = __atomic_load_n(&data->first_failure_time, __ATOMIC_RELAXED);
+    p_data->last_failure_time = __atomic_load_n(&data->last_failure_time, __ATOMIC_RELAXED);
+    p_data->occurrence_counter = __atomic_load_n(&data->occurrence_counter, __ATOMIC_RELAXED);
+    p_data->pending_counter = __atomic_load_n(&data->pending_counter, __ATOMIC_RELAXED);
+    return true;
+}
+
+/**
+ * @brief Reports a monitor result to the debounce engine.
+ * @param code The DTC the monitor checks.
+ * @param status Result of the test.
+ * @param now_ms Current time in ms, used by time-based debouncing.
+ * @param snapshot Conditions of this sample, recorded if it sets the DTC.
+ */
+void DTC_ReportEvent(DTC_Code_t code, DTC_Event_Status_t status, uint32_t now_ms,
+                     const DTC_Snapshot_t* snapshot)
+{
+    const DTC_Debounce_Config_t* config;
+    DTC_Debounce_State_t* state;
+    int32_t result = 0; // 1 qualified failed, -1 qualified passed
+    uint8_t current;
+
+    if (code >= DTC_CODE_COUNT) {
+        return;
+    }
+    config = &dtc_definitions[code].debounce;
+    state = &dtc_debounce[code];
+
+    switch (status) {
+        case DTC_EVENT_FAILED:
+            state->counter = (config->algorithm == DTC_DEBOUNCE_COUNTER) ? (int16_t)config->fail_threshold : 1;
+            result = 1;
+            break;
+
+        case DTC_EVENT_PASSED:
+            state->counter = (config->algorithm == DTC_DEBOUNCE_COUNTER) ? -(int16_t)config->pass_threshold : -1;
+            result = -1;
+            break;
+
+        case DTC_EVENT_PREFAILED:
+            if (state->counter <= 0) {
+                state->counter = 0; // Changed direction, start over
+                state->start_ms = now_ms;
+            }
+            if (config->algorithm == DTC_DEBOUNCE_COUNTER) {
+                if (state->counter < (int32_t)config->fail_threshold) {
+                    state->counter++;
+                }
+                result = (state->counter >= (int32_t)config->fail_threshold) ? 1 : 0;
+            } else {
+                state->counter = 1;
+                result = (now_ms - state->start_ms >= config->fail_threshold) ? 1 : 0;
+            }
+            break;
+
+        case DTC_EVENT_PREPASSED:
+            if (state->counter >= 0) {
+                state->counter = 0; // Changed direction, start over
+                state->start_ms = now_ms;
+            }
+            if (config->algorithm == DTC_DEBOUNCE_COUNTER) {
+                if (state->counter > -(int32_t)config->pass_threshold) {
+                    state->counter--;
+                }
+                result = (state->counter <= -(int32_t)config->pass_threshold) ? -1 : 0;
+            } else {
+                state->counter = -1;
+                result = (now_ms - state->start_ms >= config->pass_threshold) ? -1 : 0;
+            }
+            break;
+
+        default:
+            return;
+    }
+
+    // Only a qualified result that changes the status reaches DTC_Set/DTC_Clear,
+    // so repeated reports in the same direction cause no status writes
+    current = DTC_GetStatus(code);
+    if (result > 0 &&
+        (current & (DTC_STATUS_TEST_FAILED | DTC_STATUS_TEST_NOT_COMPLETED_THIS_OP_CYCLE)) != DTC_STATUS_TEST_FAILED) {
+        if (snapshot != NULL && dtc_definitions[code].snapshot) {
+            DTC_SetWithSnapshot(code, snapshot);
+        } else {
+            DTC_Set(code);
+        }
+    } else if (result < 0 &&
+               (current & (DTC_STATUS_TEST_FAILED | DTC_STATUS_TEST_NOT_COMPLETED_THIS_OP_CYCLE)) != 0) {
+        DTC_Clear(code);
+    }
 }
 
 /**
@@ -41,23 +731,33 @@ void DTC_Set(DTC_Code_t code)
 void DTC_Clear(DTC_Code_t code)
 {
     if (code < DTC_CODE_COUNT) {
-        uint32_t old_bitmask = dtc_status_bitmask;
-        dtc_status_bitmask &= ~(1UL << code);
+        // A passed test result: the history bits (pending, confirmed,
+        // warning indicator) are kept until the end of the operation cycle
+        uint8_t mask = DTC_STATUS_TEST_FAILED | DTC_STATUS_TEST_NOT_COMPLETED_SINCE_CLEAR |
+                       DTC_STATUS_TEST_NOT_COMPLETED_THIS_OP_CYCLE;
+        uint8_t old_status = DTC_Write_Status(code, mask, 0);
 
-        // If the status has changed, save it to non-volatile memory.
-        if (old_bitmask != dtc_status_bitmask) {
-            // Example: EEPROM_Write(DTC_STATUS_ADDRESS, dtc_status_bitmask);
+        // If the status has changed, save it to non-volatile memory. The
+        // history bits alone do not count, they are left as they were.
+        if ((old_status & mask) != 0) {
+            DTC_Notify_Change();
         }
     }
 }
 
 /**
- * @brief Clears all DTCs.
+ * @brief Clears all DTCs, their snapshot records, debounce state and aging counters.
  */
 void DTC_ClearAll(void)
 {
-    dtc_status_bitmask = 0;
-    // Example: EEPROM_Write(DTC_STATUS_ADDRESS, dtc_status_bitmask);
+    DTC_Snapshot_Reset();
+    memset(dtc_debounce, 0, sizeof(dtc_debounce));
+    memset(dtc_aging, 0, sizeof(dtc_aging));
+    memset(dtc_ext_data, 0, sizeof(dtc_ext_data));
+    for (uint32_t code = 0; code < DTC_CODE_COUNT; code++) {
+        DTC_Write_Status((DTC_Code_t)code, 0xFF, DTC_STATUS_AFTER_CLEAR);
+    }
+    DTC_Notify_Change();
 }
 
 /**
@@ -68,25 +768,220 @@ void DTC_ClearAll(void)
 bool DTC_IsSet(DTC_Code_t code)
 {
     if (code < DTC_CODE_COUNT) {
-        return (dtc_status_bitmask & (1UL << code)) != 0;
+        return (__atomic_load_n(&dtc_status[code], __ATOMIC_RELAXED) & DTC_STATUS_TEST_FAILED) != 0;
     }
     return false;
 }
 
 /**
- * @brief Gets the entire DTC status bitmask.
- * @return The 32-bit bitmask representing all DTC statuses.
+ * @brief Gets the ISO 14229-1 status byte of a DTC.
+ * @param code The DTC to query.
+ * @return The status byte, 0 for an invalid code.
  */
-uint32_t DTC_GetStatusBitmask(void)
+uint8_t DTC_GetStatus(DTC_Code_t code)
 {
-    return dtc_status_bitmask;
+    if (code < DTC_CODE_COUNT) {
+        return __atomic_load_n(&dtc_status[code], __ATOMIC_RELAXED);
+    }
+    return 0;
+}
+
+/**
+ * @brief Gets the 3-byte UDS DTC number (SAE J2012 code plus failure type byte).
+ * @param code The DTC to query.
+ * @return The DTC number, 0 for an invalid code.
+ */
+uint32_t DTC_GetNumber(DTC_Code_t code)
+{
+    if (code < DTC_CODE_COUNT) {
+        return dtc_definitions[code].number;
+    }
+    return 0;
+}
+
+/**
+ * @brief Gets the definition of a DTC from the table in flash.
+ * @param code The DTC to query.
+ * @return Pointer to the definition, NULL for an invalid code.
+ */
+const DTC_Definition_t* DTC_GetDefinition(DTC_Code_t code)
+{
+    if (code < DTC_CODE_COUNT) {
+        return &dtc_definitions[code];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Finds the DTC with a given 3-byte UDS DTC number.
+ * @param number The DTC number to look up.
+ * @param p_code Receives the matching DTC.
+ * @return true if the number belongs to a DTC, false otherwise.
+ */
+bool DTC_FindByNumber(uint32_t number, DTC_Code_t* p_code)
+{
+    // A DTC number listed twice in DTC_TABLE is a duplicate case value
+    switch (number) {
+#define DTC_LOOKUP_ENTRY(name, number, ...) \
+        case (number): \
+            *p_code = name; \
+            return true;
+        DTC_TABLE(DTC_LOOKUP_ENTRY)
+#undef DTC_LOOKUP_ENTRY
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Counts the DTCs that are currently set.
+ * @return Number of active DTCs.
+ */
+uint16_t DTC_GetActiveCount(void)
+{
+    return __atomic_load_n(&dtc_bit_count[DTC_PLANE_TF], __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Counts the DTCs whose status matches any bit of a mask.
+ * @param status_mask Status bits to match.
+ * @return Number of matching DTCs.
+ */
+uint16_t DTC_CountByStatusMask(uint8_t status_mask)
+{
+    uint8_t unmatched = (uint8_t)~status_mask;
+    uint16_t count = DTC_CODE_COUNT;
+    uint8_t v = unmatched;
+
+    if (status_mask == 0) {
+        return 0;
+    }
+    if ((status_mask & (status_mask - 1)) == 0) {
+        return __atomic_load_n(&dtc_bit_count[__builtin_ctz(status_mask)], __ATOMIC_RELAXED);
+    }
+    // Subtract the DTCs with no bit of the mask: every status value made of
+    // unmatched bits only, at most 64 histogram entries for a 2-bit mask
+    for (;;) {
+        count -= __atomic_load_n(&dtc_status_histogram[v], __ATOMIC_RELAXED);
+        if (v == 0) {
+            break;
+        }
+        v = (v - 1) & unmatched;
+    }
+    return count;
 }
 
 /**
- * @brief Sets the entire DTC status bitmask.
- * @param bitmask The 32-bit bitmask to restore DTC statuses from.
+ * @brief Starts a walk over the active DTCs.
+ * @param it Iterator to initialize.
  */
-void DTC_SetStatusBitmask(uint32_t bitmask)
+void DTC_Iterator_Init(DTC_Iterator_t* it)
 {
-    dtc_status_bitmask = bitmask;
+    DTC_Iterator_InitByStatusMask(it, DTC_STATUS_TEST_FAILED);
+}
+
+/**
+ * @brief Starts a walk over the DTCs whose status matches any bit of a mask.
+ * @param it Iterator to initialize.
+ * @param status_mask Status bits to match.
+ */
+void DTC_Iterator_InitByStatusMask(DTC_Iterator_t* it, uint8_t status_mask)
+{
+    it->status_mask = status_mask;
+    it->word_index = 0;
+    it->pending = DTC_Match_Word(status_mask, 0);
+}
+
+/**
+ * @brief Returns the next DTC of a walk.
+ * @param it Iterator started with DTC_Iterator_Init or DTC_Iterator_InitByStatusMask.
+ * @param p_code Receives the DTC.
+ * @return true if a DTC was returned, false at the end of the walk.
+ */
+bool DTC_Iterator_Next(DTC_Iterator_t* it, DTC_Code_t* p_code)
+{
+    while (it->pending == 0) {
+        int32_t next;
+
+        next = DTC_Find_Word(it->status_mask, it->word_index + 1U);
+        if (next < 0) {
+            it->word_index = DTC_WORD_COUNT;
+            return false;
+        }
+        it->word_index = (uint16_t)next;
+        it->pending = DTC_Match_Word(it->status_mask, next);
+    }
+
+    uint32_t bit = __builtin_ctz(it->pending);
+    it->pending &= it->pending - 1; // Drop the lowest set bit
+    *p_code = (DTC_Code_t)(it->word_index * 32 + bit);
+    return true;
+}
+
+/**
+ * @brief Serializes the DTC states for non-volatile storage.
+ * @param buffer Destination, each status plane as little-endian words, then
+ *        one aging counter per DTC.
+ * @param size Size of the buffer, at least DTC_STORAGE_SIZE.
+ * @return Number of bytes written, 0 if the buffer is too small.
+ */
+uint16_t DTC_Export(uint8_t* buffer, uint16_t size)
+{
+    if (buffer == NULL || size < DTC_STORAGE_SIZE) {
+        return 0;
+    }
+    for (uint32_t plane = 0; plane < DTC_STATUS_BIT_COUNT; plane++) {
+        for (uint32_t w = 0; w < DTC_WORD_COUNT; w++) {
+            DTC_Put_U32(&buffer[(plane * DTC_WORD_COUNT + w) * 4],
+                        __atomic_load_n(&dtc_planes[plane][w], __ATOMIC_RELAXED));
+        }
+    }
+    memcpy(&buffer[DTC_STORAGE_AGING_OFFSET], dtc_aging, DTC_CODE_COUNT);
+    for (uint32_t code = 0; code < DTC_CODE_COUNT; code++) {
+        DTC_ExtData_t data;
+        uint8_t* p = &buffer[DTC_STORAGE_EXT_DATA_OFFSET + code * DTC_EXT_DATA_SIZE];
+
+        DTC_GetExtData((DTC_Code_t)code, &data);
+        DTC_Put_U32(&p[0], data.first_failure_time);
+        DTC_Put_U32(&p[4], data.last_failure_time);
+        p[8] = data.occurrence_counter;
+        p[9] = data.pending_counter;
+    }
+    return DTC_STORAGE_SIZE;
+}
+
+/**
+ * @brief Restores the DTC states saved with DTC_Export.
+ * @param buffer Source data.
+ * @param size Number of bytes available, at least DTC_STORAGE_SIZE.
+ */
+void DTC_Import(const uint8_t* buffer, uint16_t size)
+{
+    if (buffer == NULL || size < DTC_STORAGE_SIZE) {
+        return;
+    }
+
+    for (uint32_t plane = 0; plane < DTC_STATUS_BIT_COUNT; plane++) {
+        for (uint32_t w = 0; w < DTC_WORD_COUNT; w++) {
+            // Ignore bits beyond the last defined code
+            dtc_planes[plane][w] = DTC_Get_U32(&buffer[(plane * DTC_WORD_COUNT + w) * 4]) & DTC_Valid_Bits(w);
+        }
+    }
+    for (uint32_t code = 0; code < DTC_CODE_COUNT; code++) {
+        uint8_t status = 0;
+        for (uint32_t plane = 0; plane < DTC_STATUS_BIT_COUNT; plane++) {
+            status |= ((dtc_planes[plane][code / 32] >> (code % 32)) & 0x01) << plane;
+        }
+        dtc_status[code] = status;
+    }
+    memcpy(dtc_aging, &buffer[DTC_STORAGE_AGING_OFFSET], DTC_CODE_COUNT);
+    for (uint32_t code = 0; code < DTC_CODE_COUNT; code++) {
+        const uint8_t* p = &buffer[DTC_STORAGE_EXT_DATA_OFFSET + code * DTC_EXT_DATA_SIZE];
+
+        dtc_ext_data[code].first_failure_time = DTC_Get_U32(&p[0]);
+        dtc_ext_data[code].last_failure_time = DTC_Get_U32(&p[4]);
+        dtc_ext_data[code].occurrence_counter = p[8];
+        dtc_ext_data[code].pending_counter = p[9];
+    }
+    DTC_Rebuild_Index();
 }
@@ -6,7 +6,8 @@
  */
 
 #include "eeprom_25lc256.h"
-#include "main.h" // For HAL_Delay
+#include "timebase.h"
+#include <string.h>
 
 // Module-level static variables
 static SPI_HandleTypeDef* s_hspi;
@@ -16,6 +17,9 @@ static uint16_t s_cs_pin;
 // RTOS-related static variables
 static osSemaphoreId_t spi_dma_semaphore;
 
+// Transfer statistics
+static EEPROM_Stats_t s_stats;
+
 // --- Private Helper Functions ---
 
 /**
@@ -41,24 +45,83 @@ static void EEPROM_WriteEnable(void)
 {
     uint8_t cmd = EEPROM_CMD_WREN;
     EEPROM_CS_Low();
-    HAL_SPI_Transmit(s_hspi, &cmd, 1, HAL_MAX_DELAY);
+    HAL_SPI_Transmit(s_hspi, &cmd, 1, EEPROM_CMD_TIMEOUT_MS);
     EEPROM_CS_High();
 }
 
 /**
- * @brief Polls the EEPROM's status register until the Write-In-Progress (WIP) bit is cleared.
+ * @brief Reads the EEPROM's status register.
+ * @note Polled, like the command headers: two bytes take a few us, so a
+ *       transfer that runs out EEPROM_CMD_TIMEOUT_MS means the SPI is
+ *       stuck, and the write in progress fails instead of hanging SPITask.
  */
-static void EEPROM_WaitForWriteComplete(void)
+static HAL_StatusTypeDef EEPROM_ReadStatus(uint8_t* p_status)
 {
-    uint8_t cmd = EEPROM_CMD_RDSR;
-    uint8_t status = 0;
+    uint8_t tx[2] = { EEPROM_CMD_RDSR, 0x00 };
+    uint8_t rx[2];
+    uint32_t start = Timebase_GetCycles();
+    HAL_StatusTypeDef status;
 
     EEPROM_CS_Low();
-    HAL_SPI_Transmit(s_hspi, &cmd, 1, HAL_MAX_DELAY);
-    do {
-        HAL_SPI_Receive(s_hspi, &status, 1, HAL_MAX_DELAY);
-    } while (status & EEPROM_WIP_BIT);
+    status = HAL_SPI_TransmitReceive(s_hspi, tx, rx, 2, EEPROM_CMD_TIMEOUT_MS);
     EEPROM_CS_High();
+
+    *p_status = rx[1];
+    s_stats.wip_polls++;
+    s_stats.wip_poll_cycles += Timebase_GetCycles() - start;
+    return status;
+}
+
+/**
+ * @brief Waits for the Write-In-Progress (WIP) bit to clear.
+ * @note Sleeps between status reads, so other tasks run during the
+ *       internal write cycle instead of the CPU polling the bus.
+ */
+static HAL_StatusTypeDef EEPROM_WaitForWriteComplete(void)
+{
+    uint8_t status = EEPROM_WIP_BIT;
+    uint32_t start = Timebase_GetCycles();
+    uint32_t start_tick = osKernelGetTickCount();
+    uint32_t delay = EEPROM_WRITE_FIRST_POLL_MS;
+    uint32_t cycles;
+    uint32_t bucket;
+
+    while (status & EEPROM_WIP_BIT) {
+        if (osKernelGetTickCount() - start_tick > EEPROM_WRITE_TIMEOUT_MS) {
+            s_stats.write_timeouts++;
+            return HAL_TIMEOUT;
+        }
+        osDelay(delay);
+        delay = EEPROM_WRITE_POLL_MS;
+        if (EEPROM_ReadStatus(&status) != HAL_OK) {
+            return HAL_ERROR;
+        }
+    }
+
+    cycles = Timebase_GetCycles() - start;
+    s_stats.wip_wait_cycles += cycles;
+    if (s_stats.page_min_cycles == 0 || cycles < s_stats.page_min_cycles) {
+        s_stats.page_min_cycles = cycles;
+    }
+    if (cycles > s_stats.page_max_cycles) {
+        s_stats.page_max_cycles = cycles;
+    }
+    bucket = Timebase_CyclesToUs(cycles) / 1000;
+    if (bucket >= EEPROM_WRITE_LATENCY_BUCKETS) {
+        bucket = EEPROM_WRITE_LATENCY_BUCKETS - 1;
+    }
+    s_stats.page_latency[bucket]++;
+    return HAL_OK;
+}
+
+/**
+ * @brief Records the duration of a completed read or write call.
+ */
+static void EEPROM_UpdateMaxCall(uint32_t cycles)
+{
+    if (cycles > s_stats.max_call_cycles) {
+        s_stats.max_call_cycles = cycles;
+    }
 }
 
 // --- Public API Functions ---
@@ -69,6 +132,9 @@ void EEPROM_Init(SPI_HandleTypeDef* hspi, GPIO_TypeDef* cs_port, uint16_t cs_pin
     s_cs_port = cs_port;
     s_cs_pin = cs_pin;
 
+    Timebase_Init();
+    memset(&s_stats, 0, sizeof(s_stats));
+
     // Create a binary semaphore for DMA synchronization
     // Initial count is 0, so the first acquire will block.
     spi_dma_semaphore = osSemaphoreNew(1, 0, NULL);
@@ -80,13 +146,14 @@ void EEPROM_Init(SPI_HandleTypeDef* hspi, GPIO_TypeDef* cs_port, uint16_t cs_pin
 HAL_StatusTypeDef EEPROM_Read_DMA(uint16_t address, uint8_t* p_data, uint16_t size)
 {
     uint8_t header[3];
+    uint32_t start = Timebase_GetCycles();
     header[0] = EEPROM_CMD_READ;
     header[1] = (address >> 8) & 0xFF; // MSB
     header[2] = address & 0xFF;        // LSB
 
     EEPROM_CS_Low();
     // Send Read command and address
-    if (HAL_SPI_Transmit(s_hspi, header, 3, HAL_MAX_DELAY) != HAL_OK) {
+    if (HAL_SPI_Transmit(s_hspi, header, 3, EEPROM_CMD_TIMEOUT_MS) != HAL_OK) {
         EEPROM_CS_High();
         return HAL_ERROR;
     }
@@ -107,6 +174,12 @@ HAL_StatusTypeDef EEPROM_Read_DMA(uint16_t address, uint8_t* p_data, uint16_t si
         return HAL_ERROR; // Semaphore error
     }
 
+    uint32_t elapsed = Timebase_GetCycles() - start;
+    s_stats.read_calls++;
+    s_stats.read_bytes += size;
+    s_stats.read_cycles += elapsed;
+    EEPROM_UpdateMaxCall(elapsed);
+
     return HAL_OK;
 }
 
@@ -114,6 +187,8 @@ HAL_StatusTypeDef EEPROM_Write_DMA(uint16_t address, uint8_t* p_data, uint16_t s
 {
     uint8_t header[3];
     uint16_t bytes_to_write;
+    uint16_t total_size = size;
+    uint32_t start = Timebase_GetCycles();
 
     while (size > 0) {
         EEPROM_WriteEnable();
@@ -129,7 +204,7 @@ HAL_StatusTypeDef EEPROM_Write_DMA(uint16_t address, uint8_t* p_data, uint16_t s
         EEPROM_CS_Low();
 
         // Send Write command and address
-        if (HAL_SPI_Transmit(s_hspi, header, 3, HAL_MAX_DELAY) != HAL_OK) {
+        if (HAL_SPI_Transmit(s_hspi, header, 3, EEPROM_CMD_TIMEOUT_MS) != HAL_OK) {
             EEPROM_CS_High();
             return HAL_ERROR;
         }
@@ -150,16 +225,38 @@ HAL_StatusTypeDef EEPROM_Write_DMA(uint16_t address, uint8_t* p_data, uint16_t s
         }
 
         // Wait for the internal write cycle of the EEPROM to finish
-        EEPROM_WaitForWriteComplete();
+        HAL_StatusTypeDef wip_status = EEPROM_WaitForWriteComplete();
+        s_stats.write_pages++;
+        if (wip_status != HAL_OK) {
+            return wip_status;
+        }
 
         address += bytes_to_write;
         p_data += bytes_to_write;
         size -= bytes_to_write;
     }
 
+    uint32_t elapsed = Timebase_GetCycles() - start;
+    s_stats.write_calls++;
+    s_stats.write_bytes += total_size;
+    s_stats.write_cycles += elapsed;
+    EEPROM_UpdateMaxCall(elapsed);
+
     return HAL_OK;
 }
 
+void EEPROM_GetStats(EEPROM_Stats_t* p_stats)
+{
+    if (p_stats != NULL) {
+        *p_stats = s_stats;
+    }
+}
+
+void EEPROM_ResetStats(void)
+{
+    memset(&s_stats, 0, sizeof(s_stats));
+}
+
 // --- HAL SPI DMA Callback Functions ---
 
 /**
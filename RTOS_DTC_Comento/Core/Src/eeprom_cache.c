@@ -0,0 +1,320 @@
+/*
+ * eeprom_cache.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "eeprom_cache.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define CACHE_NO_PAGE  0xFFFFU
+
+// One cached page. Bytes [dirty_lo, dirty_hi) differ from the EEPROM;
+// dirty_lo == dirty_hi means the page is clean.
+typedef struct {
+    uint16_t page;          // Page number, CACHE_NO_PAGE if the line is free
+    uint8_t dirty_lo;
+    uint8_t dirty_hi;
+    uint32_t dirty_since;   // Kernel tick of the first change since the last write-back
+    uint32_t last_use;      // For least-recently-used eviction
+    uint8_t data[EEPROM_PAGE_SIZE];
+} EEPROM_Cache_Line_t;
+
+// --- Private Variables ---
+static EEPROM_Cache_Line_t cache_lines[EEPROM_CACHE_LINES];
+static EEPROM_Cache_Policy_t cache_policy;
+static EEPROM_Cache_Stats_t cache_stats;
+static uint32_t cache_use_counter;
+static bool cache_draining;         // Every dirty page is due until none is left
+
+// --- Private Function Prototypes ---
+static EEPROM_Cache_Line_t* EEPROM_Cache_Find(uint16_t page);
+static EEPROM_Cache_Line_t* EEPROM_Cache_Allocate(bool evict_dirty);
+static EEPROM_Cache_Line_t* EEPROM_Cache_Next_Due(void);
+static HAL_StatusTypeDef EEPROM_Cache_Flush_Line(EEPROM_Cache_Line_t* line);
+
+// --- Public API Functions ---
+
+void EEPROM_Cache_Init(const EEPROM_Cache_Policy_t* policy)
+{
+    for (uint32_t i = 0; i < EEPROM_CACHE_LINES; i++) {
+        cache_lines[i].page = CACHE_NO_PAGE;
+        cache_lines[i].dirty_lo = 0;
+        cache_lines[i].dirty_hi = 0;
+    }
+    memset(&cache_policy, 0, sizeof(cache_policy));
+    if (policy != NULL) {
+        cache_policy = *policy;
+    }
+    memset(&cache_stats, 0, sizeof(cache_stats));
+    cache_draining = false;
+}
+
+HAL_StatusTypeDef EEPROM_Cache_Read(uint16_t address, uint8_t* p_data, uint16_t size)
+{
+    while (size > 0) {
+        uint16_t page = address / EEPROM_PAGE_SIZE;
+        uint16_t offset = address % EEPROM_PAGE_SIZE;
+        uint16_t chunk = EEPROM_PAGE_SIZE - offset;
+        EEPROM_Cache_Line_t* line;
+
+        if (chunk > size) {
+            chunk = size;
+        }
+
+        line = EEPROM_Cache_Find(page);
+        if (line != NULL) {
+            cache_stats.read_hits++;
+        } else {
+            cache_stats.read_misses++;
+            // A read never forces a write-back: with every line dirty the
+            // data is read around the cache
+            line = EEPROM_Cache_Allocate(false);
+            if (line == NULL) {
+                if (EEPROM_Read_DMA(address, p_data, chunk) != HAL_OK) {
+                    return HAL_ERROR;
+                }
+                address += chunk;
+                p_data += chunk;
+                size -= chunk;
+                continue;
+            }
+            if (EEPROM_Read_DMA(page * EEPROM_PAGE_SIZE, line->data, EEPROM_PAGE_SIZE) != HAL_OK) {
+                return HAL_ERROR;
+            }
+            line->page = page;
+        }
+
+        memcpy(p_data, &line->data[offset], chunk);
+        line->last_use = ++cache_use_counter;
+
+        address += chunk;
+        p_data += chunk;
+        size -= chunk;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef EEPROM_Cache_Write(uint16_t address, const uint8_t* p_data, uint16_t size)
+{
+    while (size > 0) {
+        uint16_t page = address / EEPROM_PAGE_SIZE;
+        uint16_t offset = address % EEPROM_PAGE_SIZE;
+        uint16_t chunk = EEPROM_PAGE_SIZE - offset;
+        uint16_t first = 0;
+        uint16_t last;
+        bool loaded = true;     // line->data holds the page as in the EEPROM
+        EEPROM_Cache_Line_t* line;
+
+        if (chunk > size) {
+            chunk = size;
+        }
+
+        line = EEPROM_Cache_Find(page);
+        if (line == NULL) {
+            line = EEPROM_Cache_Allocate(true);
+            if (line == NULL) {
+                return HAL_ERROR;
+            }
+            // The page is written back as one range, so the bytes around a
+            // partial update must be known
+            if (chunk < EEPROM_PAGE_SIZE) {
+                if (EEPROM_Read_DMA(page * EEPROM_PAGE_SIZE, line->data, EEPROM_PAGE_SIZE) != HAL_OK) {
+                    return HAL_ERROR;
+                }
+            } else {
+                loaded = false;
+            }
+            line->page = page;
+        }
+        line->last_use = ++cache_use_counter;
+
+        // Only the span between the first and last changed byte gets dirty.
+        // A whole page that was not read in is all dirty, since the line
+        // still holds the bytes of the page it was evicted from.
+        last = chunk;
+        while (loaded && first < chunk && line->data[offset + first] == p_data[first]) {
+            first++;
+        }
+        while (loaded && last > first && line->data[offset + last - 1] == p_data[last - 1]) {
+            last--;
+        }
+        if (first == last) {
+            cache_stats.write_skips++;
+        } else {
+            if (line->dirty_lo == line->dirty_hi) {
+                line->dirty_lo = offset + first;
+                line->dirty_hi = offset + last;
+                line->dirty_since = osKernelGetTickCount();
+            } else {
+                cache_stats.write_merges++;
+                if (offset + first < line->dirty_lo) {
+                    line->dirty_lo = offset + first;
+                }
+                if (offset + last > line->dirty_hi) {
+                    line->dirty_hi = offset + last;
+                }
+            }
+            memcpy(&line->data[offset + first], &p_data[first], last - first);
+        }
+
+        address += chunk;
+        p_data += chunk;
+        size -= chunk;
+    }
+
+    // Written back by the polls, so the caller does not wait for the pages
+    if (cache_policy.max_dirty_pages != 0 && EEPROM_Cache_GetDirtyCount() >= cache_policy.max_dirty_pages) {
+        cache_draining = true;
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef EEPROM_Cache_Poll(void)
+{
+    EEPROM_Cache_Line_t* line = EEPROM_Cache_Next_Due();
+
+    if (line == NULL) {
+        return HAL_OK;
+    }
+    return EEPROM_Cache_Flush_Line(line);
+}
+
+bool EEPROM_Cache_IsDue(void)
+{
+    return EEPROM_Cache_Next_Due() != NULL;
+}
+
+void EEPROM_Cache_Drain(void)
+{
+    cache_draining = true;
+}
+
+HAL_StatusTypeDef EEPROM_Cache_Sync(void)
+{
+    HAL_StatusTypeDef status = HAL_OK;
+
+    for (uint32_t i = 0; i < EEPROM_CACHE_LINES; i++) {
+        if (EEPROM_Cache_Flush_Line(&cache_lines[i]) != HAL_OK) {
+            status = HAL_ERROR;
+        }
+    }
+    return status;
+}
+
+uint8_t EEPROM_Cache_GetDirtyCount(void)
+{
+    uint8_t count = 0;
+
+    for (uint32_t i = 0; i < EEPROM_CACHE_LINES; i++) {
+        if (cache_lines[i].dirty_lo != cache_lines[i].dirty_hi) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void EEPROM_Cache_GetStats(EEPROM_Cache_Stats_t* p_stats)
+{
+    if (p_stats != NULL) {
+        *p_stats = cache_stats;
+    }
+}
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Returns the line holding a page, NULL if it is not cached.
+ */
+static EEPROM_Cache_Line_t* EEPROM_Cache_Find(uint16_t page)
+{
+    for (uint32_t i = 0; i < EEPROM_CACHE_LINES; i++) {
+        if (cache_lines[i].page == page) {
+            return &cache_lines[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Frees a line for a new page: a free line, else the least recently
+ *        used clean one, else (if allowed) the least recently used dirty
+ *        one after writing it back.
+ * @return The line, marked free, or NULL if none could be freed.
+ */
+static EEPROM_Cache_Line_t* EEPROM_Cache_Allocate(bool evict_dirty)
+{
+    EEPROM_Cache_Line_t* clean = NULL;
+    EEPROM_Cache_Line_t* dirty = NULL;
+
+    for (uint32_t i = 0; i < EEPROM_CACHE_LINES; i++) {
+        EEPROM_Cache_Line_t* line = &cache_lines[i];
+
+        if (line->page == CACHE_NO_PAGE) {
+            return line;
+        }
+        if (line->dirty_lo == line->dirty_hi) {
+            if (clean == NULL || (int32_t)(line->last_use - clean->last_use) < 0) {
+                clean = line;
+            }
+        } else if (dirty == NULL || (int32_t)(line->last_use - dirty->last_use) < 0) {
+            dirty = line;
+        }
+    }
+
+    if (clean == NULL) {
+        if (!evict_dirty || dirty == NULL || EEPROM_Cache_Flush_Line(dirty) != HAL_OK) {
+            return NULL;
+        }
+        clean = dirty;
+    }
+    clean->page = CACHE_NO_PAGE;
+    return clean;
+}
+
+/**
+ * @brief Returns the dirty line changed first if it is due, NULL otherwise.
+ * @note No other line is due by age if the oldest is not.
+ */
+static EEPROM_Cache_Line_t* EEPROM_Cache_Next_Due(void)
+{
+    EEPROM_Cache_Line_t* oldest = NULL;
+
+    for (uint32_t i = 0; i < EEPROM_CACHE_LINES; i++) {
+        EEPROM_Cache_Line_t* line = &cache_lines[i];
+
+        if (line->dirty_lo != line->dirty_hi &&
+            (oldest == NULL || (int32_t)(line->dirty_since - oldest->dirty_since) < 0)) {
+            oldest = line;
+        }
+    }
+
+    if (oldest == NULL) {
+        cache_draining = false;
+        return NULL;
+    }
+    if (cache_draining ||
+        (cache_policy.max_age_ms != 0 && osKernelGetTickCount() - oldest->dirty_since >= cache_policy.max_age_ms)) {
+        return oldest;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Writes the dirty range of a line back with one page write.
+ */
+static HAL_StatusTypeDef EEPROM_Cache_Flush_Line(EEPROM_Cache_Line_t* line)
+{
+    if (line->dirty_lo == line->dirty_hi) {
+        return HAL_OK;
+    }
+    if (EEPROM_Write_DMA(line->page * EEPROM_PAGE_SIZE + line->dirty_lo, &line->data[line->dirty_lo],
+                         line->dirty_hi - line->dirty_lo) != HAL_OK) {
+        return HAL_ERROR;
+    }
+    line->dirty_lo = 0;
+    line->dirty_hi = 0;
+    cache_stats.page_flushes++;
+    return HAL_OK;
+}
@@ -0,0 +1,282 @@
+/*
+ * eeprom_log.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "eeprom_log.h"
+#include "eeprom_cache.h"
+#include "timebase.h"
+#include <stdbool.h>
+#include <string.h>
+
+#define LOG_MAGIC           0x4C47U // "GL"
+#define LOG_CRC_OFFSET      8       // The CRC field is left out of its own CRC
+#define LOG_SCAN_SLOTS      4       // Records verified at the same time during the scan
+
+// Record header, at the start of the record's first page. The CRC
+// covers the header fields before it and the payload.
+typedef struct {
+    uint16_t magic;
+    uint16_t length;        // Payload bytes
+    uint32_t sequence;
+    uint32_t crc;
+} EEPROM_Log_Header_t;
+
+// A record being verified by the boot scan
+typedef struct {
+    bool active;
+    uint16_t page;
+    uint16_t offset;        // Record bytes consumed so far
+    uint16_t total;         // Header plus payload bytes
+    EEPROM_Log_Header_t header;
+    uint32_t crc;           // Running CRC, see EEPROM_Log_Crc
+} EEPROM_Log_Candidate_t;
+
+// CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320), one byte per
+// lookup. The STM32 CRC unit only takes whole words with another bit order.
+static const uint32_t log_crc_table[256] = {
+    0x00000000UL, 0x77073096UL, 0xEE0E612CUL, 0x990951BAUL, 0x076DC419UL, 0x706AF48FUL,
+    0xE963A535UL, 0x9E6495A3UL, 0x0EDB8832UL, 0x79DCB8A4UL, 0xE0D5E91EUL, 0x97D2D988UL,
+    0x09B64C2BUL, 0x7EB17CBDUL, 0xE7B82D07UL, 0x90BF1D91UL, 0x1DB71064UL, 0x6AB020F2UL,
+    0xF3B97148UL, 0x84BE41DEUL, 0x1ADAD47DUL, 0x6DDDE4EBUL, 0xF4D4B551UL, 0x83D385C7UL,
+    0x136C9856UL, 0x646BA8C0UL, 0xFD62F97AUL, 0x8A65C9ECUL, 0x14015C4FUL, 0x63066CD9UL,
+    0xFA0F3D63UL, 0x8D080DF5UL, 0x3B6E20C8UL, 0x4C69105EUL, 0xD56041E4UL, 0xA2677172UL,
+    0x3C03E4D1UL, 0x4B04D447UL, 0xD20D85FDUL, 0xA50AB56BUL, 0x35B5A8FAUL, 0x42B2986CUL,
+    0xDBBBC9D6UL, 0xACBCF940UL, 0x32D86CE3UL, 0x45DF5C75UL, 0xDCD60DCFUL, 0xABD13D59UL,
+    0x26D930ACUL, 0x51DE003AUL, 0xC8D75180UL, 0xBFD06116UL, 0x21B4F4B5UL, 0x56B3C423UL,
+    0xCFBA9599UL, 0xB8BDA50FUL, 0x2802B89EUL, 0x5F058808UL, 0xC60CD9B2UL, 0xB10BE924UL,
+    0x2F6F7C87UL, 0x58684C11UL, 0xC1611DABUL, 0xB6662D3DUL, 0x76DC4190UL, 0x01DB7106UL,
+    0x98D220BCUL, 0xEFD5102AUL, 0x71B18589UL, 0x06B6B51FUL, 0x9FBFE4A5UL, 0xE8B8D433UL,
+    0x7807C9A2UL, 0x0F00F934UL, 0x9609A88EUL, 0xE10E9818UL, 0x7F6A0DBBUL, 0x086D3D2DUL,
+    0x91646C97UL, 0xE6635C01UL, 0x6B6B51F4UL, 0x1C6C6162UL, 0x856530D8UL, 0xF262004EUL,
+    0x6C0695EDUL, 0x1B01A57BUL, 0x8208F4C1UL, 0xF50FC457UL, 0x65B0D9C6UL, 0x12B7E950UL,
+    0x8BBEB8EAUL, 0xFCB9887CUL, 0x62DD1DDFUL, 0x15DA2D49UL, 0x8CD37CF3UL, 0xFBD44C65UL,
+    0x4DB26158UL, 0x3AB551CEUL, 0xA3BC0074UL, 0xD4BB30E2UL, 0x4ADFA541UL, 0x3DD895D7UL,
+    0xA4D1C46DUL, 0xD3D6F4FBUL, 0x4369E96AUL, 0x346ED9FCUL, 0xAD678846UL, 0xDA60B8D0UL,
+    0x44042D73UL, 0x33031DE5UL, 0xAA0A4C5FUL, 0xDD0D7CC9UL, 0x5005713CUL, 0x270241AAUL,
+    0xBE0B1010UL, 0xC90C2086UL, 0x5768B525UL, 0x206F85B3UL, 0xB966D409UL, 0xCE61E49FUL,
+    0x5EDEF90EUL, 0x29D9C998UL, 0xB0D09822UL, 0xC7D7A8B4UL, 0x59B33D17UL, 0x2EB40D81UL,
+    0xB7BD5C3BUL, 0xC0BA6CADUL, 0xEDB88320UL, 0x9ABFB3B6UL, 0x03B6E20CUL, 0x74B1D29AUL,
+    0xEAD54739UL, 0x9DD277AFUL, 0x04DB2615UL, 0x73DC1683UL, 0xE3630B12UL, 0x94643B84UL,
+    0x0D6D6A3EUL, 0x7A6A5AA8UL, 0xE40ECF0BUL, 0x9309FF9DUL, 0x0A00AE27UL, 0x7D079EB1UL,
+    0xF00F9344UL, 0x8708A3D2UL, 0x1E01F268UL, 0x6906C2FEUL, 0xF762575DUL, 0x806567CBUL,
+    0x196C3671UL, 0x6E6B06E7UL, 0xFED41B76UL, 0x89D32BE0UL, 0x10DA7A5AUL, 0x67DD4ACCUL,
+    0xF9B9DF6FUL, 0x8EBEEFF9UL, 0x17B7BE43UL, 0x60B08ED5UL, 0xD6D6A3E8UL, 0xA1D1937EUL,
+    0x38D8C2C4UL, 0x4FDFF252UL, 0xD1BB67F1UL, 0xA6BC5767UL, 0x3FB506DDUL, 0x48B2364BUL,
+    0xD80D2BDAUL, 0xAF0A1B4CUL, 0x36034AF6UL, 0x41047A60UL, 0xDF60EFC3UL, 0xA867DF55UL,
+    0x316E8EEFUL, 0x4669BE79UL, 0xCB61B38CUL, 0xBC66831AUL, 0x256FD2A0UL, 0x5268E236UL,
+    0xCC0C7795UL, 0xBB0B4703UL, 0x220216B9UL, 0x5505262FUL, 0xC5BA3BBEUL, 0xB2BD0B28UL,
+    0x2BB45A92UL, 0x5CB36A04UL, 0xC2D7FFA7UL, 0xB5D0CF31UL, 0x2CD99E8BUL, 0x5BDEAE1DUL,
+    0x9B64C2B0UL, 0xEC63F226UL, 0x756AA39CUL, 0x026D930AUL, 0x9C0906A9UL, 0xEB0E363FUL,
+    0x72076785UL, 0x05005713UL, 0x95BF4A82UL, 0xE2B87A14UL, 0x7BB12BAEUL, 0x0CB61B38UL,
+    0x92D28E9BUL, 0xE5D5BE0DUL, 0x7CDCEFB7UL, 0x0BDBDF21UL, 0x86D3D2D4UL, 0xF1D4E242UL,
+    0x68DDB3F8UL, 0x1FDA836EUL, 0x81BE16CDUL, 0xF6B9265BUL, 0x6FB077E1UL, 0x18B74777UL,
+    0x88085AE6UL, 0xFF0F6A70UL, 0x66063BCAUL, 0x11010B5CUL, 0x8F659EFFUL, 0xF862AE69UL,
+    0x616BFFD3UL, 0x166CCF45UL, 0xA00AE278UL, 0xD70DD2EEUL, 0x4E048354UL, 0x3903B3C2UL,
+    0xA7672661UL, 0xD06016F7UL, 0x4969474DUL, 0x3E6E77DBUL, 0xAED16A4AUL, 0xD9D65ADCUL,
+    0x40DF0B66UL, 0x37D83BF0UL, 0xA9BCAE53UL, 0xDEBB9EC5UL, 0x47B2CF7FUL, 0x30B5FFE9UL,
+    0xBDBDF21CUL, 0xCABAC28AUL, 0x53B39330UL, 0x24B4A3A6UL, 0xBAD03605UL, 0xCDD70693UL,
+    0x54DE5729UL, 0x23D967BFUL, 0xB3667A2EUL, 0xC4614AB8UL, 0x5D681B02UL, 0x2A6F2B94UL,
+    0xB40BBE37UL, 0xC30C8EA1UL, 0x5A05DF1BUL, 0x2D02EF8DUL,
+};
+
+// --- Private Variables ---
+static bool log_has_record;
+static uint16_t log_latest_length;
+static EEPROM_Log_Stats_t log_stats;
+// Scan bursts and records being appended are built here
+static uint8_t log_buffer[EEPROM_LOG_SCAN_BURST];
+// Records being verified by the scan, kept off the calling task's stack
+static EEPROM_Log_Candidate_t log_scan_slots[LOG_SCAN_SLOTS];
+
+// --- Private Function Prototypes ---
+static uint32_t EEPROM_Log_Crc(uint32_t crc, const uint8_t* p_data, uint16_t size);
+static uint16_t EEPROM_Log_Pages(uint16_t length);
+static void EEPROM_Log_Scan_Page(EEPROM_Log_Candidate_t* slots, uint16_t page, const uint8_t* p_page);
+
+// --- Public API Functions ---
+
+HAL_StatusTypeDef EEPROM_Log_Init(void)
+{
+    uint32_t start = Timebase_GetCycles();
+
+    memset(log_scan_slots, 0, sizeof(log_scan_slots));
+    memset(&log_stats, 0, sizeof(log_stats));
+    log_has_record = false;
+
+    // The cache is empty at this point, so the scan reads the device directly
+    for (uint32_t address = 0; address < EEPROM_TOTAL_SIZE; address += EEPROM_LOG_SCAN_BURST) {
+        if (EEPROM_Read_DMA(address, log_buffer, EEPROM_LOG_SCAN_BURST) != HAL_OK) {
+            return HAL_ERROR;
+        }
+        for (uint32_t p = 0; p < EEPROM_LOG_SCAN_BURST / EEPROM_PAGE_SIZE; p++) {
+            EEPROM_Log_Scan_Page(log_scan_slots, address / EEPROM_PAGE_SIZE + p, &log_buffer[p * EEPROM_PAGE_SIZE]);
+        }
+    }
+
+    if (log_has_record) {
+        log_stats.head_page = log_stats.latest_page + EEPROM_Log_Pages(log_latest_length);
+        if (log_stats.head_page >= EEPROM_LOG_PAGE_COUNT) {
+            log_stats.head_page = 0;
+        }
+    }
+    log_stats.scan_cycles = Timebase_GetCycles() - start;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef EEPROM_Log_Append(const uint8_t* p_data, uint16_t length)
+{
+    EEPROM_Log_Header_t header;
+    uint16_t pages = EEPROM_Log_Pages(length);
+    uint16_t page = log_stats.head_page;
+    uint16_t size = pages * EEPROM_PAGE_SIZE;
+
+    if (p_data == NULL || length > EEPROM_LOG_MAX_LENGTH) {
+        return HAL_ERROR;
+    }
+    // A record never wraps, so it can be checked in one sequential read
+    if (page + pages > EEPROM_LOG_PAGE_COUNT) {
+        page = 0;
+    }
+
+    header.magic = LOG_MAGIC;
+    header.length = length;
+    header.sequence = log_stats.sequence + 1;
+    header.crc = EEPROM_Log_Crc(0xFFFFFFFFUL, (const uint8_t*)&header, LOG_CRC_OFFSET);
+    header.crc = ~EEPROM_Log_Crc(header.crc, p_data, length);
+
+    // Whole pages are written, so the cache never has to read one in first
+    memcpy(log_buffer, &header, EEPROM_LOG_HEADER_SIZE);
+    memcpy(&log_buffer[EEPROM_LOG_HEADER_SIZE], p_data, length);
+    memset(&log_buffer[EEPROM_LOG_HEADER_SIZE + length], 0xFF, size - EEPROM_LOG_HEADER_SIZE - length);
+    if (EEPROM_Cache_Write(page * EEPROM_PAGE_SIZE, log_buffer, size) != HAL_OK) {
+        return HAL_ERROR;
+    }
+
+    if (page == 0 && log_has_record) {
+        log_stats.wraps++;
+    }
+    log_has_record = true;
+    log_latest_length = length;
+    log_stats.sequence = header.sequence;
+    log_stats.latest_page = page;
+    log_stats.head_page = page + pages;
+    if (log_stats.head_page >= EEPROM_LOG_PAGE_COUNT) {
+        log_stats.head_page = 0;
+    }
+    log_stats.appends++;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef EEPROM_Log_ReadLatest(uint8_t* p_data, uint16_t size, uint16_t* p_length)
+{
+    if (!log_has_record || p_data == NULL || size < log_latest_length) {
+        return HAL_ERROR;
+    }
+    if (EEPROM_Cache_Read(log_stats.latest_page * EEPROM_PAGE_SIZE + EEPROM_LOG_HEADER_SIZE,
+                          p_data, log_latest_length) != HAL_OK) {
+        return HAL_ERROR;
+    }
+    if (p_length != NULL) {
+        *p_length = log_latest_length;
+    }
+    return HAL_OK;
+}
+
+void EEPROM_Log_GetStats(EEPROM_Log_Stats_t* p_stats)
+{
+    if (p_stats != NULL) {
+        *p_stats = log_stats;
+    }
+}
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Adds bytes to a running CRC-32.
+ * @note Start with 0xFFFFFFFF and invert the result after the last bytes.
+ */
+static uint32_t EEPROM_Log_Crc(uint32_t crc, const uint8_t* p_data, uint16_t size)
+{
+    for (uint16_t i = 0; i < size; i++) {
+        crc = log_crc_table[(crc ^ p_data[i]) & 0xFFU] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+/**
+ * @brief Returns the pages a record with this payload length occupies.
+ */
+static uint16_t EEPROM_Log_Pages(uint16_t length)
+{
+    return (EEPROM_LOG_HEADER_SIZE + length + EEPROM_PAGE_SIZE - 1) / EEPROM_PAGE_SIZE;
+}
+
+/**
+ * @brief Feeds one page to the boot scan.
+ * @note Opens a candidate when the page starts with a plausible header and
+ *       adds the page to the CRC of every open candidate. A completed
+ *       candidate with a matching CRC becomes the newest record if its
+ *       sequence number is the highest so far.
+ */
+static void EEPROM_Log_Scan_Page(EEPROM_Log_Candidate_t* slots, uint16_t page, const uint8_t* p_page)
+{
+    EEPROM_Log_Header_t header;
+
+    memcpy(&header, p_page, sizeof(header));
+    if (header.magic == LOG_MAGIC && header.length <= EEPROM_LOG_MAX_LENGTH &&
+        page + EEPROM_Log_Pages(header.length) <= EEPROM_LOG_PAGE_COUNT) {
+        EEPROM_Log_Candidate_t* slot = &slots[0];
+
+        // Reuse a free slot, else drop the candidate least likely to matter
+        for (uint32_t i = 0; i < LOG_SCAN_SLOTS; i++) {
+            if (!slots[i].active) {
+                slot = &slots[i];
+                break;
+            }
+            if (slots[i].header.sequence < slot->header.sequence) {
+                slot = &slots[i];
+            }
+        }
+        slot->active = true;
+        slot->page = page;
+        slot->offset = 0;
+        slot->total = EEPROM_LOG_HEADER_SIZE + header.length;
+        slot->header = header;
+        slot->crc = 0xFFFFFFFFUL;
+    }
+
+    for (uint32_t i = 0; i < LOG_SCAN_SLOTS; i++) {
+        EEPROM_Log_Candidate_t* slot = &slots[i];
+        uint16_t from = 0;
+        uint16_t to;
+
+        if (!slot->active) {
+            continue;
+        }
+        to = slot->total - slot->offset;
+        if (to > EEPROM_PAGE_SIZE) {
+            to = EEPROM_PAGE_SIZE;
+        }
+        if (slot->offset == 0) {
+            // The header page: cover the fields before the CRC, skip the
+            // CRC itself
+            slot->crc = EEPROM_Log_Crc(slot->crc, p_page, LOG_CRC_OFFSET);
+            from = EEPROM_LOG_HEADER_SIZE;
+        }
+        slot->crc = EEPROM_Log_Crc(slot->crc, &p_page[from], to - from);
+        slot->offset += to;
+
+        if (slot->offset == slot->total) {
+            slot->active = false;
+            if (~slot->crc == slot->header.crc &&
+                (!log_has_record || slot->header.sequence > log_stats.sequence)) {
+                log_has_record = true;
+                log_latest_length = slot->header.length;
+                log_stats.sequence = slot->header.sequence;
+                log_stats.latest_page = slot->page;
+            }
+        }
+    }
+}
@@ -26,9 +26,8 @@
 
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "app_tasks.h"
 #include "can_manager.h"
-#include <string.h>
-#include <stdio.h>
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -38,6 +37,10 @@
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+/* The board has no ignition input, so a DTC operation cycle runs from
+   power-up to power-down. The PVD flags the supply going down at 2.9 V. */
+#define POWER_DOWN_PVD_LEVEL    PWR_PVDLEVEL_7
+
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
@@ -98,8 +101,15 @@ const osThreadAttr_t CANTask_attributes = {
 osThreadId_t UARTTaskHandle;
 const osThreadAttr_t UARTTask_attributes = {
   .name = "UARTTask",
-  .stack_size = 128 * 4,
-  .priority = (osPriority_t) osPriorityNormal,
+  .stack_size = 256 * 4,
+  .priority = (osPriority_t) osPriorityBelowNormal,
+};
+/* Definitions for CANRxTask */
+osThreadId_t CANRxTaskHandle;
+const osThreadAttr_t CANRxTask_attributes = {
+  .name = "CANRxTask",
+  .stack_size = 256 * 4,
+  .priority = (osPriority_t) osPriorityAboveNormal,
 };
 /* Definitions for CanQueue */
 osMessageQueueId_t CanQueueHandle;
@@ -112,7 +122,7 @@ const osMutexAttr_t CommMutexHandle_attributes = {
   .name = "CommMutexHandle"
 };
 /* USER CODE BEGIN PV */
-
+static App_Tasks_t app_tasks;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -131,6 +141,7 @@ void StartI2CTask(void *argument);
 void StartSPITask(void *argument);
 void StartCANTask(void *argument);
 void StartUARTTask(void *argument);
+void StartCANRxTask(void *argument);
 
 /* USER CODE BEGIN PFP */
 
@@ -181,6 +192,11 @@ int main(void)
   mp5475gu_init();
   EEPROM_Init(&hspi1, GPIOC, GPIO_PIN_4);
   CAN_Manager_Init(&hcan1);
+  // Supply monitor: the PVD interrupt ends the operation cycle
+  HAL_PWR_ConfigPVD(&(PWR_PVDTypeDef){ POWER_DOWN_PVD_LEVEL, PWR_PVD_MODE_IT_RISING });
+  HAL_PWR_EnablePVD();
+  HAL_NVIC_SetPriority(PVD_IRQn, 5, 0);
+  HAL_NVIC_EnableIRQ(PVD_IRQn);
   /* USER CODE END 2 */
 
   /* Init scheduler */
@@ -203,10 +219,14 @@ int main(void)
 
   /* Create the queue(s) */
   /* creation of CanQueue */
-  CanQueueHandle = osMessageQueueNew (8, 8, &CanQueue_attributes);
+  CanQueueHandle = osMessageQueueNew (16, sizeof(void *), &CanQueue_attributes);
 
   /* USER CODE BEGIN RTOS_QUEUES */
   /* add queues, ... */
+  // Received CAN frames reach CANRxTask through CanQueue
+  if (CAN_Manager_Start_Rx(CanQueueHandle) != HAL_OK) {
+    Error_Handler();
+  }
   /* USER CODE END RTOS_QUEUES */
 
   /* Create the thread(s) */
@@ -225,8 +245,27 @@ int main(void)
   /* creation of UARTTask */
   UARTTaskHandle = osThreadNew(StartUARTTask, NULL, &UARTTask_attributes);
 
+  /* creation of CANRxTask */
+  CANRxTaskHandle = osThreadNew(StartCANRxTask, NULL, &CANRxTask_attributes);
+
   /* USER CODE BEGIN RTOS_THREADS */
   /* add threads, ... */
+  // The task bodies live in app_tasks.c
+  app_tasks = (App_Tasks_t){
+    .hcan = &hcan1,
+    .hi2c = &hi2c1,
+    .hadc = &hadc1,
+    .huart = &huart4,
+    .comm_mutex = CommMutexHandleHandle,
+    .i2c_task = I2CTaskHandle,
+    .spi_task = SPITaskHandle,
+    .can_task = CANTaskHandle,
+    .uart_task = UARTTaskHandle,
+    .can_rx_task = CANRxTaskHandle,
+  };
+  if (App_Tasks_Init(&app_tasks) != HAL_OK) {
+    Error_Handler();
+  }
   /* USER CODE END RTOS_THREADS */
 
   /* USER CODE BEGIN RTOS_EVENTS */
@@ -361,9 +400,9 @@ static void MX_CAN1_Init(void)
   hcan1.Init.TimeTriggeredMode = DISABLE;
   hcan1.Init.AutoBusOff = DISABLE;
   hcan1.Init.AutoWakeUp = DISABLE;
-  hcan1.Init.AutoRetransmission = DISABLE;
+  hcan1.Init.AutoRetransmission = ENABLE;
   hcan1.Init.ReceiveFifoLocked = DISABLE;
-  hcan1.Init.TransmitFifoPriority = DISABLE;
+  hcan1.Init.TransmitFifoPriority = ENABLE;
   if (HAL_CAN_Init(&hcan1) != HAL_OK)
   {
     Error_Handler();
@@ -625,7 +664,15 @@ static void MX_GPIO_Init(void)
 }
 
 /* USER CODE BEGIN 4 */
-
+/**
+  * @brief  PVD callback: the supply has dropped below POWER_DOWN_PVD_LEVEL.
+  *         Ends the operation cycle.
+  * @retval None
+  */
+void HAL_PWR_PVDCallback(void)
+{
+  App_Power_Down();
+}
 /* USER CODE END 4 */
 
 /* USER CODE BEGIN Header_StartDefaultTask */
@@ -656,57 +703,7 @@ void StartDefaultTask(void *argument)
 void StartI2CTask(void *argument)
 {
   /* USER CODE BEGIN StartI2CTask */
-  MP5475GU_StatusUV_t uv_status;
-  HAL_StatusTypeDef ret;
-  /* Infinite loop */
-  for(;;)
-  {
-    if (osMutexAcquire(CommMutexHandleHandle, osWaitForever) == osOK){
-
-      // TODO: Add I2C communication code here.
-      mp5475gu_set_vout(&hi2c1, BUCK_A, 1.2f);
-      osDelay(100);
-      
-      // 1. Read the UV status from the PMIC
-      ret = mp5475gu_read_uv_status(&hi2c1, &uv_status);
-      if (ret == HAL_OK) {
-        // 2. Update DTCs based on the read status
-
-        // Check Buck A
-        if (uv_status.bits.BUCKA_UV) {
-          DTC_Set(DTC_PMIC_BUCK_A_UNDERVOLTAGE);
-        } else {
-          DTC_Clear(DTC_PMIC_BUCK_A_UNDERVOLTAGE);
-        }
-  
-        // Check Buck B
-        if (uv_status.bits.BUCKB_UV) {
-          DTC_Set(DTC_PMIC_BUCK_B_UNDERVOLTAGE);
-        } else {
-          DTC_Clear(DTC_PMIC_BUCK_B_UNDERVOLTAGE);
-        }
-  
-        // Check Buck C
-        if (uv_status.bits.BUCKC_UV) {
-          DTC_Set(DTC_PMIC_BUCK_C_UNDERVOLTAGE);
-        } else {
-          DTC_Clear(DTC_PMIC_BUCK_C_UNDERVOLTAGE);
-        }
-  
-        // Check Buck D
-        if (uv_status.bits.BUCKD_UV) {
-          DTC_Set(DTC_PMIC_BUCK_D_UNDERVOLTAGE);
-        } else {
-          DTC_Clear(DTC_PMIC_BUCK_D_UNDERVOLTAGE);
-        }
-      }
-
-      osMutexRelease(CommMutexHandleHandle);
-
-      // Wait for the next monitoring cycle
-      osDelay(100); // Check every 100ms
-    }
-  }
+  App_I2C_Task();
   /* USER CODE END StartI2CTask */
 }
 
@@ -720,26 +717,7 @@ void StartI2CTask(void *argument)
 void StartSPITask(void *argument)
 {
   /* USER CODE BEGIN StartSPITask */
-  uint8_t dtc_data;
-  uint16_t dtc_address;
-  /* Infinite loop */
-  for(;;)
-  {
-    if (osMutexAcquire(CommMutexHandleHandle, osWaitForever) == osOK){
-
-      // TODO: Add SPI communication code here.
-      dtc_data = DTC_GetStatusBitmask();
-      dtc_address = 0x0000;
-      if (EEPROM_Write_DMA(dtc_address, &dtc_data, 1) == HAL_OK) {
-        // 쓰기 성공
-      } else {
-        // 쓰기 실패
-      }
-
-      osMutexRelease(CommMutexHandleHandle);
-    }
-    osDelay(100);
-  }
+  App_SPI_Task();
   /* USER CODE END StartSPITask */
 }
 
@@ -753,21 +731,7 @@ void StartSPITask(void *argument)
 void StartCANTask(void *argument)
 {
   /* USER CODE BEGIN StartCANTask */
-  uint8_t dtc_data;
-  uint16_t dtc_address = 0x0000;
-  /* Infinite loop */
-  for(;;)
-  {
-    if (osMutexAcquire(CommMutexHandleHandle, osWaitForever) == osOK){
-
-      if (EEPROM_Read_DMA(dtc_address, &dtc_data, 1) == HAL_OK) {
-        CAN_Manager_Transmit_DTC(&hcan1, &dtc_data, 1);
-      }
-      
-      osMutexRelease(CommMutexHandleHandle);
-    }
-    osDelay(1000); // Transmit every 1 second
-  }
+  App_CAN_Task();
   /* USER CODE END StartCANTA_Task */
 }
 
@@ -781,46 +745,24 @@ void StartCANTask(void *argument)
 void StartUARTTask(void *argument)
 {
   /* USER CODE BEGIN StartUARTTask */
-  CAN_Command_t cmd;
-  uint8_t dtc_value;
-  uint16_t dtc_address = 0x0000;
-  char uart_msg[50];
-
-  /* Infinite loop */
-  for(;;)
-  {
-    cmd = CAN_Manager_Get_Command();
-
-    if (cmd != CMD_NONE) {
-      if (osMutexAcquire(CommMutexHandleHandle, osWaitForever) == osOK) {
-        switch (cmd) {
-          case CMD_CLEAR_DTC:
-            dtc_value = 0x00; // Clear DTCs
-            EEPROM_Write_DMA(dtc_address, &dtc_value, 1);
-            DTC_ClearAll(); // Also clear in-memory representation
-            snprintf(uart_msg, sizeof(uart_msg), "DTCs Cleared.\r\n");
-            HAL_UART_Transmit(&huart4, (uint8_t*)uart_msg, strlen(uart_msg), 100);
-            break;
-
-          case CMD_READ_DTC:
-            EEPROM_Read_DMA(dtc_address, &dtc_value, 1);
-            snprintf(uart_msg, sizeof(uart_msg), "DTC Value: 0x%02X\r\n", dtc_value);
-            HAL_UART_Transmit(&huart4, (uint8_t*)uart_msg, strlen(uart_msg), 100);
-            break;
-
-          default:
-            break;
-        }
-        CAN_Manager_Clear_Command(); // Reset command after processing
-        osMutexRelease(CommMutexHandleHandle);
-      }
-    }
-
-    osDelay(200); // Poll for commands every 200ms
-  }
+  App_UART_Task();
   /* USER CODE END StartUARTTask */
 }
 
+/* USER CODE BEGIN Header_StartCANRxTask */
+/**
+* @brief Function implementing the CANRxTask thread.
+* @param argument: Not used
+* @retval None
+*/
+/* USER CODE END Header_StartCANRxTask */
+void StartCANRxTask(void *argument)
+{
+  /* USER CODE BEGIN StartCANRxTask */
+  App_CAN_Rx_Task();
+  /* USER CODE END StartCANRxTask */
+}
+
 /**
   * @brief  This function is executed in case of error occurrence.
   * @retval None
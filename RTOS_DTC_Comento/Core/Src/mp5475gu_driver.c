@@ -3,6 +3,9 @@
 // Semaphore for I2C DMA synchronization
 static osSemaphoreId_t i2cTxRxSemHandle;
 
+// Last output voltage written to each buck, in mV (0 = never set)
+static uint16_t vout_setpoint_mv[4];
+
 /**
  * @brief  Initializes the MP5475GU driver, creating the semaphore.
  */
@@ -53,9 +56,23 @@ HAL_StatusTypeDef mp5475gu_set_vout(I2C_HandleTypeDef *hi2c, MP5475GU_BuckChanne
         return HAL_TIMEOUT;
     }
 
+    vout_setpoint_mv[channel] = (uint16_t)(voltage * 1000.0f + 0.5f);
     return HAL_OK;
 }
 
+/**
+ * @brief  Returns the last output voltage written to a buck converter.
+ * @param  channel: The buck channel (BUCK_A, BUCK_B, BUCK_C, or BUCK_D).
+ * @retval Setpoint in mV, 0 if it has not been set since reset.
+ */
+uint16_t mp5475gu_get_vout_mv(MP5475GU_BuckChannel_t channel)
+{
+    if (channel > BUCK_D) {
+        return 0;
+    }
+    return vout_setpoint_mv[channel];
+}
+
 /**
  * @brief  Read the Under-Voltage (UV) status register using DMA.
  * @param  hi2c: Pointer to the I2C handle.
@@ -0,0 +1,123 @@
+/*
+ * storage_manager.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "storage_manager.h"
+#include "eeprom_log.h"
+#include <string.h>
+
+// --- Private Variables ---
+static osMessageQueueId_t storage_queue = NULL;    // Holds Storage_Request_t pointers
+static osThreadId_t storage_thread = NULL;
+static Storage_Stats_t storage_stats;
+
+// --- Private Function Prototypes ---
+static void Storage_Complete(Storage_Request_t** requests, uint32_t count);
+
+// --- Public API Functions ---
+
+HAL_StatusTypeDef Storage_Init(osThreadId_t thread)
+{
+    storage_queue = osMessageQueueNew(STORAGE_QUEUE_DEPTH, sizeof(Storage_Request_t*), NULL);
+    if (storage_queue == NULL || thread == NULL) {
+        return HAL_ERROR;
+    }
+    storage_thread = thread;
+    memset(&storage_stats, 0, sizeof(storage_stats));
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef Storage_Submit(Storage_Request_t* request)
+{
+    if (request == NULL || request->p_data == NULL || storage_queue == NULL) {
+        return HAL_ERROR;
+    }
+    if (osMessageQueuePut(storage_queue, &request, 0, 0) != osOK) {
+        // Also counted from ISRs
+        __atomic_fetch_add(&storage_stats.queue_full, 1, __ATOMIC_RELAXED);
+        return HAL_BUSY;
+    }
+    osThreadFlagsSet(storage_thread, STORAGE_REQUEST_FLAG);
+    return HAL_OK;
+}
+
+void Storage_Process(void)
+{
+    Storage_Request_t* requests[STORAGE_QUEUE_DEPTH];
+    Storage_Request_t* request;
+    Storage_Request_t* read;            // A read that succeeded in this run
+    uint32_t count = 0;
+    uint32_t run_end;
+    HAL_StatusTypeDef status;
+
+    // The queue holds STORAGE_QUEUE_DEPTH requests, so this takes all of
+    // them; later ones raise the flag again
+    while (count < STORAGE_QUEUE_DEPTH &&
+           osMessageQueueGet(storage_queue, &requests[count], NULL, 0) == osOK) {
+        count++;
+    }
+
+    // In queue order, so a read sees every append queued before it, one run
+    // of requests of the same type at a time
+    for (uint32_t i = 0; i < count; i = run_end) {
+        run_end = i + 1;
+        while (run_end < count && requests[run_end]->type == requests[i]->type) {
+            run_end++;
+        }
+
+        if (requests[i]->type == STORAGE_REQUEST_READ_RECORD) {
+            read = NULL;
+            for (uint32_t j = i; j < run_end; j++) {
+                request = requests[j];
+                if (read != NULL && request->size >= read->length) {
+                    memcpy(request->p_data, read->p_data, read->length);
+                    request->length = read->length;
+                    request->status = HAL_OK;
+                    storage_stats.read_merges++;
+                } else {
+                    request->status = EEPROM_Log_ReadLatest(request->p_data, request->size, &request->length);
+                    if (request->status == HAL_OK) {
+                        read = request;
+                    }
+                }
+                storage_stats.reads++;
+            }
+        } else {
+            // Reads only ever return the newest record, so only the last
+            // append of the run is written
+            status = EEPROM_Log_Append(requests[run_end - 1]->p_data, requests[run_end - 1]->size);
+            for (uint32_t j = i; j < run_end; j++) {
+                requests[j]->status = status;
+            }
+            storage_stats.appends += run_end - i;
+            storage_stats.append_merges += run_end - i - 1;
+        }
+        // Only now, since a merged read copies from the buffer of another
+        Storage_Complete(&requests[i], run_end - i);
+    }
+}
+
+void Storage_GetStats(Storage_Stats_t* p_stats)
+{
+    if (p_stats != NULL) {
+        *p_stats = storage_stats;
+    }
+}
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Tells the owners of requests that they completed.
+ * @note A request belongs to its owner again once its callback starts, so
+ *       it is not touched afterwards.
+ */
+static void Storage_Complete(Storage_Request_t** requests, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++) {
+        if (requests[i]->callback != NULL) {
+            requests[i]->callback(requests[i]);
+        }
+    }
+}
@@ -0,0 +1,109 @@
+/*
+ * timebase.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "timebase.h"
+
+// Half periods of the 32-bit cycle counter elapsed at the last
+// Timebase_Tick. Bit 0 matches the counter's top bit as that tick saw it.
+static volatile uint32_t s_half_periods;
+
+/**
+ * @brief Returns the cycle count in two halves, lock-free.
+ */
+static void Timebase_Read(uint32_t* p_high, uint32_t* p_low)
+{
+    uint32_t half_periods = s_half_periods;
+    uint32_t now = DWT->CYCCNT;
+
+    // The counter may have crossed one half since the last tick; the load
+    // of s_half_periods is a single word, so no update is ever seen torn
+    if ((now >> 31) != (half_periods & 1U)) {
+        half_periods++;
+    }
+    *p_high = half_periods >> 1;
+    *p_low = now;
+}
+
+/**
+ * @brief Divides a cycle count given in two halves by less than 2^16.
+ * @note Long division in 16-bit digits, so every step is a 32-bit UDIV
+ *       instead of a call to the 64-bit division routine.
+ */
+static uint64_t Timebase_Divide(uint32_t high, uint32_t low, uint32_t divisor)
+{
+    uint32_t q_high = high / divisor;
+    uint32_t mid = ((high % divisor) << 16) | (low >> 16);
+    uint32_t q_mid = mid / divisor;
+    uint32_t rest = ((mid % divisor) << 16) | (low & 0xFFFFU);
+
+    return ((uint64_t)q_high << 32) + ((uint64_t)q_mid << 16) + rest / divisor;
+}
+
+void Timebase_Init(void)
+{
+    // Trace must be enabled before the DWT registers can be accessed
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+
+    if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0) {
+        DWT->CYCCNT = 0;
+        s_half_periods = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+}
+
+uint32_t Timebase_CyclesToUs(uint32_t cycles)
+{
+    uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+
+    if (cycles_per_us == 0) {
+        cycles_per_us = 1;
+    }
+    return cycles / cycles_per_us;
+}
+
+void Timebase_Tick(void)
+{
+    uint32_t half_periods = s_half_periods;
+
+    if ((DWT->CYCCNT >> 31) != (half_periods & 1U)) {
+        s_half_periods = half_periods + 1;
+    }
+}
+
+uint64_t Timebase_GetCycles64(void)
+{
+    uint32_t high;
+    uint32_t low;
+
+    Timebase_Read(&high, &low);
+    return ((uint64_t)high << 32) | low;
+}
+
+uint64_t Timebase_GetUs(void)
+{
+    uint32_t cycles_per_us = SystemCoreClock / 1000000U;
+    uint32_t high;
+    uint32_t low;
+
+    if (cycles_per_us == 0) {
+        cycles_per_us = 1;
+    }
+    Timebase_Read(&high, &low);
+    return Timebase_Divide(high, low, cycles_per_us);
+}
+
+uint32_t Timebase_GetTime(uint32_t unit_us)
+{
+    uint32_t cycles_per_unit = (SystemCoreClock / 1000000U) * unit_us;
+    uint32_t high;
+    uint32_t low;
+
+    if (cycles_per_unit == 0) {
+        cycles_per_unit = 1;
+    }
+    Timebase_Read(&high, &low);
+    return (uint32_t)Timebase_Divide(high, low, cycles_per_unit);
+}
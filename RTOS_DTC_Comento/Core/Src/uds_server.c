@@ -0,0 +1,315 @@
+/*
+ * uds_server.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "uds_server.h"
+#include "dtc_manager.h"
+#include <stddef.h>
+#include <string.h>
+
+// One data item of a snapshot record: where it lives in DTC_Snapshot_t
+typedef struct {
+    uint16_t did;
+    uint8_t offset;
+    uint8_t size;       // 1, 2 or 4 bytes, sent big-endian
+} UDS_Snapshot_Item_t;
+
+#define UDS_SNAPSHOT_ITEM(did, field) \
+    { (did), offsetof(DTC_Snapshot_t, field), sizeof(((DTC_Snapshot_t*)0)->field) }
+
+// Data items reported in each snapshot record, in order
+static const UDS_Snapshot_Item_t uds_snapshot_items[] = {
+    UDS_SNAPSHOT_ITEM(UDS_DID_RAIL_A_SETPOINT, rail_setpoint_mv[0]),
+    UDS_SNAPSHOT_ITEM(UDS_DID_RAIL_B_SETPOINT, rail_setpoint_mv[1]),
+    UDS_SNAPSHOT_ITEM(UDS_DID_RAIL_C_SETPOINT, rail_setpoint_mv[2]),
+    UDS_SNAPSHOT_ITEM(UDS_DID_RAIL_D_SETPOINT, rail_setpoint_mv[3]),
+    UDS_SNAPSHOT_ITEM(UDS_DID_PMIC_STATUS_UV, status_uv),
+    UDS_SNAPSHOT_ITEM(UDS_DID_ADC_RAW, adc_raw),
+    UDS_SNAPSHOT_ITEM(UDS_DID_TIMESTAMP, timestamp_ms),
+};
+
+#define UDS_SNAPSHOT_ITEM_COUNT  (sizeof(uds_snapshot_items) / sizeof(uds_snapshot_items[0]))
+
+// One extended data record: where its value lives in DTC_ExtData_t
+typedef struct {
+    uint8_t record_number;
+    uint8_t offset;
+    uint8_t size;       // 1, 2 or 4 bytes, sent big-endian
+} UDS_Ext_Data_Item_t;
+
+#define UDS_EXT_DATA_ITEM(number, field) \
+    { (number), offsetof(DTC_ExtData_t, field), sizeof(((DTC_ExtData_t*)0)->field) }
+
+// Extended data records, in ascending record number order
+static const UDS_Ext_Data_Item_t uds_ext_data_items[] = {
+    UDS_EXT_DATA_ITEM(UDS_EXT_DATA_OCCURRENCE_COUNTER, occurrence_counter),
+    UDS_EXT_DATA_ITEM(UDS_EXT_DATA_PENDING_COUNTER, pending_counter),
+    UDS_EXT_DATA_ITEM(UDS_EXT_DATA_FIRST_FAILURE_TIME, first_failure_time),
+    UDS_EXT_DATA_ITEM(UDS_EXT_DATA_LAST_FAILURE_TIME, last_failure_time),
+};
+
+#define UDS_EXT_DATA_ITEM_COUNT  (sizeof(uds_ext_data_items) / sizeof(uds_ext_data_items[0]))
+
+// --- Private Function Prototypes ---
+static uint16_t UDS_Negative_Response(uint8_t sid, uint8_t nrc, uint8_t* response);
+static uint16_t UDS_Read_DTC_Information(const uint8_t* request, uint16_t request_length,
+                                         uint8_t* response, uint16_t response_size);
+static uint16_t UDS_Put_DTC(uint8_t* response, uint16_t offset, DTC_Code_t code);
+static uint16_t UDS_Put_Snapshot(uint8_t* response, uint16_t offset, uint16_t response_size,
+                                 uint8_t record_number, const DTC_Snapshot_t* snapshot);
+static uint16_t UDS_Put_Field(uint8_t* response, uint16_t offset, const void* base,
+                              uint8_t field_offset, uint8_t size);
+
+// --- Public API Functions ---
+
+uint16_t UDS_Server_Process(const uint8_t* request, uint16_t request_length, bool functional,
+                            uint8_t* response, uint16_t response_size)
+{
+    uint16_t length;
+    bool suppress_positive = false;
+
+    if (request_length == 0 || response_size < 3) {
+        return 0;
+    }
+
+    switch (request[0]) {
+        case UDS_SID_READ_DTC_INFORMATION:
+            suppress_positive = request_length >= 2 && (request[1] & UDS_SPRMIB);
+            length = UDS_Read_DTC_Information(request, request_length, response, response_size);
+            break;
+
+        default:
+            length = UDS_Negative_Response(request[0], UDS_NRC_SERVICE_NOT_SUPPORTED, response);
+            break;
+    }
+
+    if (length == 0 || response[0] != UDS_SID_NEGATIVE_RESPONSE) {
+        return suppress_positive ? 0 : length;
+    }
+    // Only the ECUs that support a functional request answer it
+    if (functional && (response[2] == UDS_NRC_SERVICE_NOT_SUPPORTED ||
+                       response[2] == UDS_NRC_SUBFUNCTION_NOT_SUPPORTED ||
+                       response[2] == UDS_NRC_REQUEST_OUT_OF_RANGE)) {
+        return 0;
+    }
+    return length;
+}
+
+// --- Private Helper Functions ---
+
+/**
+ * @brief Builds a negative response: 0x7F, request SID, NRC.
+ */
+static uint16_t UDS_Negative_Response(uint8_t sid, uint8_t nrc, uint8_t* response)
+{
+    response[0] = UDS_SID_NEGATIVE_RESPONSE;
+    response[1] = sid;
+    response[2] = nrc;
+    return 3;
+}
+
+/**
+ * @brief Writes DTCAndStatusRecord (3-byte DTC number, status byte) at offset.
+ */
+static uint16_t UDS_Put_DTC(uint8_t* response, uint16_t offset, DTC_Code_t code)
+{
+    uint32_t number = DTC_GetNumber(code);
+
+    response[offset++] = (number >> 16) & 0xFF;
+    response[offset++] = (number >> 8) & 0xFF;
+    response[offset++] = number & 0xFF;
+    response[offset++] = DTC_GetStatus(code) & DTC_STATUS_AVAILABILITY_MASK;
+    return offset;
+}
+
+/**
+ * @brief Writes one DTCSnapshotRecord (record number, identifier count,
+ *        DID/value pairs) at offset.
+ * @return New offset, 0 if the record does not fit.
+ */
+static uint16_t UDS_Put_Snapshot(uint8_t* response, uint16_t offset, uint16_t response_size,
+                                 uint8_t record_number, const DTC_Snapshot_t* snapshot)
+{
+    if (offset + 2 > response_size) {
+        return 0;
+    }
+    response[offset++] = record_number;
+    response[offset++] = UDS_SNAPSHOT_ITEM_COUNT;
+
+    for (uint32_t i = 0; i < UDS_SNAPSHOT_ITEM_COUNT; i++) {
+        const UDS_Snapshot_Item_t* item = &uds_snapshot_items[i];
+
+        if (offset + 2 + item->size > response_size) {
+            return 0;
+        }
+        response[offset++] = (item->did >> 8) & 0xFF;
+        response[offset++] = item->did & 0xFF;
+        offset = UDS_Put_Field(response, offset, snapshot, item->offset, item->size);
+    }
+    return offset;
+}
+
+/**
+ * @brief Writes a 1, 2 or 4-byte field of a structure big-endian at offset.
+ */
+static uint16_t UDS_Put_Field(uint8_t* response, uint16_t offset, const void* base,
+                              uint8_t field_offset, uint8_t size)
+{
+    const uint8_t* field = (const uint8_t*)base + field_offset;
+    uint32_t value = 0;
+
+    if (size == 1) {
+        value = field[0];
+    } else if (size == 2) {
+        uint16_t v16;
+        memcpy(&v16, field, sizeof(v16));
+        value = v16;
+    } else {
+        memcpy(&value, field, sizeof(value));
+    }
+
+    for (int shift = (size - 1) * 8; shift >= 0; shift -= 8) {
+        response[offset++] = (value >> shift) & 0xFF;
+    }
+    return offset;
+}
+
+/**
+ * @brief Handles ReadDTCInformation (0x19).
+ */
+static uint16_t UDS_Read_DTC_Information(const uint8_t* request, uint16_t request_length,
+                                         uint8_t* response, uint16_t response_size)
+{
+    uint8_t sub_function;
+    uint8_t status_mask;
+    bool report_all;
+    uint16_t length;
+    uint16_t count;
+    DTC_Code_t code;
+    DTC_Iterator_t it;
+    DTC_ExtData_t ext_data;
+
+    if (request_length < 2) {
+        return UDS_Negative_Response(request[0], UDS_NRC_INCORRECT_LENGTH, response);
+    }
+
+    sub_function = request[1] & ~UDS_SPRMIB;
+    response[0] = request[0] + UDS_POSITIVE_RESPONSE_OFFSET;
+    response[1] = sub_function;
+
+    switch (sub_function) {
+        case UDS_RDTCI_REPORT_NUMBER_OF_DTC_BY_STATUS_MASK:
+            if (request_length != 3) {
+                return UDS_Negative_Response(request[0], UDS_NRC_INCORRECT_LENGTH, response);
+            }
+            if (response_size < 6) {
+                return UDS_Negative_Response(request[0], UDS_NRC_RESPONSE_TOO_LONG, response);
+            }
+            status_mask = request[2] & DTC_STATUS_AVAILABILITY_MASK;
+            count = DTC_CountByStatusMask(status_mask);
+            response[2] = DTC_STATUS_AVAILABILITY_MASK;
+            response[3] = UDS_DTC_FORMAT_ISO14229_1;
+            response[4] = (count >> 8) & 0xFF;
+            response[5] = count & 0xFF;
+            return 6;
+
+        case UDS_RDTCI_REPORT_DTC_BY_STATUS_MASK:
+        case UDS_RDTCI_REPORT_SUPPORTED_DTC:
+            if (sub_function == UDS_RDTCI_REPORT_DTC_BY_STATUS_MASK) {
+                if (request_length != 3) {
+                    return UDS_Negative_Response(request[0], UDS_NRC_INCORRECT_LENGTH, response);
+                }
+                status_mask = request[2] & DTC_STATUS_AVAILABILITY_MASK;
+                report_all = false;
+            } else {
+                if (request_length != 2) {
+                    return UDS_Negative_Response(request[0], UDS_NRC_INCORRECT_LENGTH, response);
+                }
+                status_mask = 0;
+                report_all = true; // Every supported DTC, whatever its status
+            }
+            response[2] = DTC_STATUS_AVAILABILITY_MASK;
+            length = 3;
+            if (report_all) {
+                for (int i = 0; i < DTC_CODE_COUNT; i++) {
+                    if (length + 4 > response_size) {
+                        return UDS_Negative_Response(request[0], UDS_NRC_RESPONSE_TOO_LONG, response);
+                    }
+                    length = UDS_Put_DTC(response, length, (DTC_Code_t)i);
+                }
+                return length;
+            }
+            DTC_Iterator_InitByStatusMask(&it, status_mask);
+            while (DTC_Iterator_Next(&it, &code)) {
+                if (length + 4 > response_size) {
+                    return UDS_Negative_Response(request[0], UDS_NRC_RESPONSE_TOO_LONG, response);
+                }
+                length = UDS_Put_DTC(response, length, code);
+            }
+            return length;
+
+        case UDS_RDTCI_REPORT_DTC_SNAPSHOT_RECORD_BY_DTC:
+            if (request_length != 6) {
+                return UDS_Negative_Response(request[0], UDS_NRC_INCORRECT_LENGTH, response);
+            }
+            if (!DTC_FindByNumber(((uint32_t)request[2] << 16) | ((uint32_t)request[3] << 8) | request[4], &code) ||
+                (request[5] != UDS_SNAPSHOT_RECORD_ALL &&
+                 (request[5] < DTC_SNAPSHOT_RECORD_FIRST || request[5] > DTC_SNAPSHOT_RECORD_LATEST))) {
+                return UDS_Negative_Response(request[0], UDS_NRC_REQUEST_OUT_OF_RANGE, response);
+            }
+            if (response_size < 6) {
+                return UDS_Negative_Response(request[0], UDS_NRC_RESPONSE_TOO_LONG, response);
+            }
+            length = UDS_Put_DTC(response, 2, code);
+            // Records that were never captured are left out of the response
+            for (uint8_t record = DTC_SNAPSHOT_RECORD_FIRST; record <= DTC_SNAPSHOT_RECORD_LATEST; record++) {
+                DTC_Snapshot_t snapshot;
+
+                if ((request[5] != UDS_SNAPSHOT_RECORD_ALL && request[5] != record) ||
+                    !DTC_GetSnapshot(code, record, &snapshot)) {
+                    continue;
+                }
+                length = UDS_Put_Snapshot(response, length, response_size, record, &snapshot);
+                if (length == 0) {
+                    return UDS_Negative_Response(request[0], UDS_NRC_RESPONSE_TOO_LONG, response);
+                }
+            }
+            return length;
+
+        case UDS_RDTCI_REPORT_DTC_EXT_DATA_RECORD_BY_DTC:
+            if (request_length != 6) {
+                return UDS_Negative_Response(request[0], UDS_NRC_INCORRECT_LENGTH, response);
+            }
+            if (!DTC_FindByNumber(((uint32_t)request[2] << 16) | ((uint32_t)request[3] << 8) | request[4], &code)) {
+                return UDS_Negative_Response(request[0], UDS_NRC_REQUEST_OUT_OF_RANGE, response);
+            }
+            if (response_size < 6) {
+                return UDS_Negative_Response(request[0], UDS_NRC_RESPONSE_TOO_LONG, response);
+            }
+            length = UDS_Put_DTC(response, 2, code);
+            DTC_GetExtData(code, &ext_data);
+            count = 0;
+            for (uint32_t i = 0; i < UDS_EXT_DATA_ITEM_COUNT; i++) {
+                const UDS_Ext_Data_Item_t* item = &uds_ext_data_items[i];
+
+                if (request[5] != UDS_EXT_DATA_RECORD_ALL && request[5] != item->record_number) {
+                    continue;
+                }
+                if (length + 1 + item->size > response_size) {
+                    return UDS_Negative_Response(request[0], UDS_NRC_RESPONSE_TOO_LONG, response);
+                }
+                response[length++] = item->record_number;
+                length = UDS_Put_Field(response, length, &ext_data, item->offset, item->size);
+                count++;
+            }
+            if (count == 0) {
+                return UDS_Negative_Response(request[0], UDS_NRC_REQUEST_OUT_OF_RANGE, response);
+            }
+            return length;
+
+        default:
+            return UDS_Negative_Response(request[0], UDS_NRC_SUBFUNCTION_NOT_SUPPORTED, response);
+    }
+}
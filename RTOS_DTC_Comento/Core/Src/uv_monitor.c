@@ -0,0 +1,92 @@
+/*
+ * uv_monitor.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "uv_monitor.h"
+#include "dtc_manager.h"
+
+// --- Private Variables ---
+static DTC_Snapshot_t snapshot;
+static uint8_t uv_last = 0;             // STATUS_UV bits of the previous poll
+static uint32_t uv_edge_tick = 0;       // Poll that first read the newest UV bit
+static uint16_t active_count = 0;       // DTC_GetActiveCount() after the previous poll
+static uint8_t dtc_pending = 0;         // UV seen, DTC not confirmed yet
+static volatile uint8_t tx_pending = 0; // DTC confirmed, broadcast not queued yet
+static volatile UV_Monitor_Latency_t latency;
+
+// --- Public API Functions ---
+
+HAL_StatusTypeDef UV_Monitor_Poll(I2C_HandleTypeDef* hi2c, ADC_HandleTypeDef* hadc)
+{
+    MP5475GU_StatusUV_t uv_status;
+    HAL_StatusTypeDef ret;
+    uint32_t now_ms;
+
+    ret = mp5475gu_read_uv_status(hi2c, &uv_status);
+    if (ret != HAL_OK) {
+        return ret;
+    }
+    now_ms = osKernelGetTickCount();
+
+    // Freeze frame for any DTC set below. Only gathered when a rail is
+    // under voltage, so a healthy cycle does no extra work.
+    if (uv_status.data & MP5475GU_UV_ALL) {
+        for (int ch = BUCK_A; ch <= BUCK_D; ch++) {
+            snapshot.rail_setpoint_mv[ch] = mp5475gu_get_vout_mv((MP5475GU_BuckChannel_t)ch);
+        }
+        snapshot.status_uv = uv_status.data;
+        snapshot.adc_raw = (HAL_ADC_PollForConversion(hadc, 0) == HAL_OK) ?
+                           (uint16_t)HAL_ADC_GetValue(hadc) : 0;
+        snapshot.timestamp_ms = now_ms;
+    }
+
+    // Report each rail to the debounce engine, which sets or clears the DTC
+    // once the result is qualified
+    DTC_ReportEvent(DTC_PMIC_BUCK_A_UNDERVOLTAGE,
+                    uv_status.bits.BUCKA_UV ? DTC_EVENT_PREFAILED : DTC_EVENT_PREPASSED,
+                    now_ms, &snapshot);
+    DTC_ReportEvent(DTC_PMIC_BUCK_B_UNDERVOLTAGE,
+                    uv_status.bits.BUCKB_UV ? DTC_EVENT_PREFAILED : DTC_EVENT_PREPASSED,
+                    now_ms, &snapshot);
+    DTC_ReportEvent(DTC_PMIC_BUCK_C_UNDERVOLTAGE,
+                    uv_status.bits.BUCKC_UV ? DTC_EVENT_PREFAILED : DTC_EVENT_PREPASSED,
+                    now_ms, &snapshot);
+    DTC_ReportEvent(DTC_PMIC_BUCK_D_UNDERVOLTAGE,
+                    uv_status.bits.BUCKD_UV ? DTC_EVENT_PREFAILED : DTC_EVENT_PREPASSED,
+                    now_ms, &snapshot);
+
+    // A rail newly under voltage: time it until the debounce confirms a DTC
+    if (uv_status.data & ~uv_last & MP5475GU_UV_ALL) {
+        uv_edge_tick = now_ms;
+        dtc_pending = 1;
+    }
+    uv_last = uv_status.data;
+    if (dtc_pending && DTC_GetActiveCount() > active_count) {
+        latency.uv_to_dtc_set_ms = now_ms - uv_edge_tick;
+        latency.faults++;
+        dtc_pending = 0;
+        tx_pending = 1;
+    }
+    active_count = DTC_GetActiveCount();
+
+    return HAL_OK;
+}
+
+void UV_Monitor_DTC_Sent(void)
+{
+    if (tx_pending) {
+        latency.uv_to_can_tx_ms = osKernelGetTickCount() - uv_edge_tick;
+        tx_pending = 0;
+    }
+}
+
+void UV_Monitor_Get_Latency(UV_Monitor_Latency_t* p_latency)
+{
+    if (p_latency != NULL) {
+        p_latency->uv_to_dtc_set_ms = latency.uv_to_dtc_set_ms;
+        p_latency->uv_to_can_tx_ms = latency.uv_to_can_tx_ms;
+        p_latency->faults = latency.faults;
+    }
+}
@@ -0,0 +1,746 @@
+/*
+ * can_bus.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "can_bus.h"
+#include "can_filter_model.h"
+#include "sim_os.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* --- Types --- */
+typedef enum {
+    MAILBOX_FREE = 0,
+    MAILBOX_PENDING,        // Requested, waiting for the bus
+    MAILBOX_ON_BUS,         // Being sent
+} Bus_Mailbox_State_t;
+
+typedef struct {
+    Bus_Mailbox_State_t state;
+    uint32_t sequence;      // Request order, for TransmitFifoPriority
+    uint64_t queued_cycles;
+    CAN_Bus_Frame_t frame;
+    // Status bits of CAN_TSR for this mailbox
+    bool rqcp;
+    bool txok;
+    bool alst;
+} Bus_Mailbox_t;
+
+typedef struct {
+    CAN_Bus_Frame_t frames[CAN_BUS_FIFO_DEPTH];
+    uint32_t head;
+    uint32_t fill;
+    bool full;              // FULLx
+    bool overrun;           // FOVRx
+} Bus_Fifo_t;
+
+typedef struct {
+    CAN_Bus_Frame_t frame;
+    uint64_t queued_cycles;
+} Bus_Queued_t;
+
+typedef struct {
+    bool active;
+    int node;
+    CAN_Bus_Frame_t frame;
+    uint64_t next_cycles;
+    uint64_t period_cycles;
+} Bus_Periodic_t;
+
+typedef struct {
+    bool used;
+    const char* name;
+    CAN_Bus_Rx_Callback_t rx_callback;
+    void* context;
+    Bus_Queued_t* queue;
+    uint32_t queue_length;
+    uint32_t queue_capacity;
+    CAN_Bus_Node_Stats_t stats;
+} Bus_Node_t;
+
+#define CAN_BUS_MAX_PERIODIC    32
+
+/* --- Private Variables --- */
+static uint32_t bus_bitrate;
+static Bus_Node_t bus_nodes[CAN_BUS_MAX_NODES];
+static Bus_Periodic_t bus_periodic[CAN_BUS_MAX_PERIODIC];
+static CAN_Bus_Stats_t bus_stats;
+static uint64_t bus_stats_start;
+
+// Frame on the bus
+static bool bus_active;
+static bool bus_delivered;          // EOF reached, receivers served
+static int bus_sender;
+static int bus_sender_mailbox;      // Controller mailbox, -1 for a node queue entry
+static CAN_Bus_Frame_t bus_frame;
+static uint64_t bus_frame_queued;
+static uint64_t bus_eof_cycles;
+static uint64_t bus_idle_cycles;
+static uint16_t bus_frame_bits;
+
+// The bxCAN controller
+static CAN_HandleTypeDef* ctrl_hcan;
+static int ctrl_node = -1;
+static bool ctrl_started;
+static uint32_t ctrl_its;
+static Bus_Mailbox_t ctrl_mailboxes[CAN_BUS_MAILBOXES];
+static uint32_t ctrl_sequence;
+static Bus_Fifo_t ctrl_fifos[2];
+
+/* --- Private Function Prototypes --- */
+static uint64_t CAN_Bus_Next_Event(void);
+static void CAN_Bus_Run(void);
+static void CAN_Bus_Deliver(void);
+static void CAN_Bus_Arbitrate(void);
+static uint32_t CAN_Bus_Arbitration_Key(const CAN_Bus_Frame_t* frame);
+static int CAN_Bus_Controller_Candidate(void);
+static int CAN_Bus_Node_Candidate(const Bus_Node_t* node);
+static void CAN_Bus_Controller_Receive(const CAN_Bus_Frame_t* frame);
+static void CAN_Bus_Update_Irqs(void);
+static void CAN_Bus_Enqueue(int node, const CAN_Bus_Frame_t* frame, uint64_t queued_cycles);
+
+/* --- Public Functions --- */
+
+void CAN_Bus_Reset(uint32_t bitrate)
+{
+    for (uint32_t i = 0; i < CAN_BUS_MAX_NODES; i++) {
+        free(bus_nodes[i].queue);
+    }
+    memset(bus_nodes, 0, sizeof(bus_nodes));
+    memset(bus_periodic, 0, sizeof(bus_periodic));
+    memset(ctrl_mailboxes, 0, sizeof(ctrl_mailboxes));
+    memset(ctrl_fifos, 0, sizeof(ctrl_fifos));
+    bus_bitrate = bitrate;
+    bus_active = false;
+    ctrl_hcan = NULL;
+    ctrl_node = -1;
+    ctrl_started = false;
+    ctrl_its = 0;
+    ctrl_sequence = 0;
+    CAN_Bus_Reset_Stats();
+    Sim_AddDevice(CAN_Bus_Next_Event, CAN_Bus_Run);
+}
+
+int CAN_Bus_Attach_Controller(CAN_HandleTypeDef* hcan)
+{
+    ctrl_hcan = hcan;
+    ctrl_node = CAN_Bus_Add_Node("bxCAN", NULL, NULL);
+    return ctrl_node;
+}
+
+int CAN_Bus_Add_Node(const char* name, CAN_Bus_Rx_Callback_t rx_callback, void* context)
+{
+    for (int i = 0; i < CAN_BUS_MAX_NODES; i++) {
+        if (!bus_nodes[i].used) {
+            bus_nodes[i].used = true;
+            bus_nodes[i].name = name;
+            bus_nodes[i].rx_callback = rx_callback;
+            bus_nodes[i].context = context;
+            return i;
+        }
+    }
+    Sim_Fatal("too many CAN nodes");
+    return -1;
+}
+
+void CAN_Bus_Send(int node, const CAN_Bus_Frame_t* frame)
+{
+    CAN_Bus_Enqueue(node, frame, Sim_GetCycles());
+}
+
+void CAN_Bus_Add_Periodic(int node, const CAN_Bus_Frame_t* frame, uint32_t first_us, uint32_t period_us)
+{
+    for (uint32_t i = 0; i < CAN_BUS_MAX_PERIODIC; i++) {
+        if (!bus_periodic[i].active) {
+            bus_periodic[i].active = true;
+            bus_periodic[i].node = node;
+            bus_periodic[i].frame = *frame;
+            bus_periodic[i].next_cycles = Sim_GetCycles() + (uint64_t)first_us * (SIM_CPU_HZ / 1000000U);
+            bus_periodic[i].period_cycles = (uint64_t)period_us * (SIM_CPU_HZ / 1000000U);
+            return;
+        }
+    }
+    Sim_Fatal("too many periodic CAN frames");
+}
+
+void CAN_Bus_Stop_Periodic(void)
+{
+    memset(bus_periodic, 0, sizeof(bus_periodic));
+}
+
+uint16_t CAN_Bus_Frame_Bits(const CAN_Bus_Frame_t* frame)
+{
+    uint8_t bits[160];
+    uint16_t count = 0;
+    uint16_t crc = 0;
+    uint16_t stuffed = 0;
+    uint8_t run = 0;
+    uint8_t last = 2;
+    uint8_t length = (frame->dlc > 8) ? 8 : frame->dlc;
+
+    // SOF, arbitration and control fields, data, MSB first
+#define PUSH(value, width) \
+    for (int b_ = (width) - 1; b_ >= 0; b_--) { bits[count++] = ((value) >> b_) & 1U; }
+    PUSH(0U, 1);
+    if (frame->ide == CAN_ID_EXT) {
+        PUSH(frame->id >> 18, 11);
+        PUSH(3U, 2);                    // SRR, IDE
+        PUSH(frame->id & 0x3FFFFU, 18);
+        PUSH(0U, 3);                    // RTR, r1, r0
+    } else {
+        PUSH(frame->id, 11);
+        PUSH(0U, 3);                    // RTR, IDE, r0
+    }
+    PUSH(frame->dlc & 0x0FU, 4);
+    for (uint8_t i = 0; i < length; i++) {
+        PUSH(frame->data[i], 8);
+    }
+
+    // CRC-15 over everything so far, then appended
+    for (uint16_t i = 0; i < count; i++) {
+        bool feedback = bits[i] ^ ((crc >> 14) & 1U);
+        crc = (uint16_t)((crc << 1) & 0x7FFFU);
+        if (feedback) {
+            crc ^= 0x4599U;
+        }
+    }
+    PUSH(crc, 15);
+#undef PUSH
+
+    // A stuff bit follows every five equal bits, counting stuff bits too
+    for (uint16_t i = 0; i < count; i++) {
+        if (bits[i] == last) {
+            run++;
+        } else {
+            last = bits[i];
+            run = 1;
+        }
+        if (run == 5) {
+            stuffed++;
+            last = !last;
+            run = 1;
+        }
+    }
+
+    return count + stuffed + CAN_BUS_TRAILER_BITS + CAN_BUS_IFS_BITS;
+}
+
+uint64_t CAN_Bus_Bits_To_Cycles(uint64_t bits)
+{
+    return (bits * SIM_CPU_HZ + bus_bitrate - 1) / bus_bitrate;
+}
+
+void CAN_Bus_Get_Node_Stats(int node, CAN_Bus_Node_Stats_t* p_stats)
+{
+    *p_stats = bus_nodes[node].stats;
+}
+
+void CAN_Bus_Get_Stats(CAN_Bus_Stats_t* p_stats)
+{
+    *p_stats = bus_stats;
+    p_stats->elapsed_cycles = Sim_GetCycles() - bus_stats_start;
+}
+
+void CAN_Bus_Reset_Stats(void)
+{
+    memset(&bus_stats, 0, sizeof(bus_stats));
+    for (uint32_t i = 0; i < CAN_BUS_MAX_NODES; i++) {
+        memset(&bus_nodes[i].stats, 0, sizeof(bus_nodes[i].stats));
+    }
+    bus_stats_start = Sim_GetCycles();
+}
+
+bool CAN_Bus_Is_Idle(void)
+{
+    if (bus_active || CAN_Bus_Controller_Candidate() >= 0) {
+        return false;
+    }
+    for (int i = 0; i < CAN_BUS_MAX_NODES; i++) {
+        if (bus_nodes[i].queue_length != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* --- Bus --- */
+
+static uint64_t CAN_Bus_Next_Event(void)
+{
+    uint64_t next = UINT64_MAX;
+
+    for (uint32_t i = 0; i < CAN_BUS_MAX_PERIODIC; i++) {
+        if (bus_periodic[i].active && bus_periodic[i].next_cycles < next) {
+            next = bus_periodic[i].next_cycles;
+        }
+    }
+    if (bus_active) {
+        uint64_t event = bus_delivered ? bus_idle_cycles : bus_eof_cycles;
+        return (event < next) ? event : next;
+    }
+    if (!CAN_Bus_Is_Idle()) {
+        return Sim_GetCycles();     // Start arbitration now
+    }
+    return next;
+}
+
+static void CAN_Bus_Run(void)
+{
+    uint64_t now = Sim_GetCycles();
+
+    for (uint32_t i = 0; i < CAN_BUS_MAX_PERIODIC; i++) {
+        while (bus_periodic[i].active && bus_periodic[i].next_cycles <= now) {
+            CAN_Bus_Enqueue(bus_periodic[i].node, &bus_periodic[i].frame, bus_periodic[i].next_cycles);
+            bus_periodic[i].next_cycles += bus_periodic[i].period_cycles;
+        }
+    }
+
+    if (bus_active && !bus_delivered && now >= bus_eof_cycles) {
+        CAN_Bus_Deliver();
+    }
+    if (bus_active && bus_delivered && now >= bus_idle_cycles) {
+        bus_active = false;
+    }
+    if (!bus_active) {
+        CAN_Bus_Arbitrate();
+    }
+}
+
+/**
+ * @brief Ends the frame on the bus: the sender gets its acknowledgement and
+ *        every other node receives it.
+ */
+static void CAN_Bus_Deliver(void)
+{
+    Bus_Node_t* sender = &bus_nodes[bus_sender];
+    uint64_t wait = bus_eof_cycles - bus_frame_queued;
+
+    bus_delivered = true;
+    bus_stats.frames++;
+    bus_stats.busy_cycles += CAN_Bus_Bits_To_Cycles(bus_frame_bits);
+    sender->stats.tx_frames++;
+    sender->stats.tx_bits += bus_frame_bits;
+    if (wait > sender->stats.max_wait_cycles) {
+        sender->stats.max_wait_cycles = wait;
+    }
+
+    if (bus_sender_mailbox >= 0) {
+        Bus_Mailbox_t* mailbox = &ctrl_mailboxes[bus_sender_mailbox];
+        mailbox->state = MAILBOX_FREE;
+        mailbox->rqcp = true;
+        mailbox->txok = true;
+        mailbox->alst = false;
+    }
+
+    for (int i = 0; i < CAN_BUS_MAX_NODES; i++) {
+        if (!bus_nodes[i].used || i == bus_sender) {
+            continue;
+        }
+        bus_nodes[i].stats.rx_frames++;
+        if (i == ctrl_node) {
+            CAN_Bus_Controller_Receive(&bus_frame);
+        } else if (bus_nodes[i].rx_callback != NULL) {
+            bus_nodes[i].rx_callback(bus_nodes[i].context, &bus_frame, bus_eof_cycles);
+        }
+    }
+    CAN_Bus_Update_Irqs();
+}
+
+/**
+ * @brief Starts the next frame if any node has one: every ready frame
+ *        contends and the lowest arbitration field wins.
+ */
+static void CAN_Bus_Arbitrate(void)
+{
+    int winner = -1;
+    int winner_entry = -1;
+    uint32_t winner_key = UINT32_MAX;
+    uint64_t now = Sim_GetCycles();
+
+    for (int i = 0; i < CAN_BUS_MAX_NODES; i++) {
+        int entry;
+        uint32_t key;
+
+        if (!bus_nodes[i].used) {
+            continue;
+        }
+        entry = (i == ctrl_node) ? CAN_Bus_Controller_Candidate() : CAN_Bus_Node_Candidate(&bus_nodes[i]);
+        if (entry < 0) {
+            continue;
+        }
+        key = CAN_Bus_Arbitration_Key((i == ctrl_node) ? &ctrl_mailboxes[entry].frame :
+                                                         &bus_nodes[i].queue[entry].frame);
+        if (winner < 0 || key < winner_key) {
+            winner = i;
+            winner_entry = entry;
+            winner_key = key;
+        }
+    }
+    if (winner < 0) {
+        return;
+    }
+
+    // Everyone else backs off; the controller without retransmission drops its frame
+    for (int i = 0; i < CAN_BUS_MAX_NODES; i++) {
+        if (!bus_nodes[i].used || i == winner) {
+            continue;
+        }
+        if (i == ctrl_node) {
+            int entry = CAN_Bus_Controller_Candidate();
+            if (entry >= 0) {
+                bus_nodes[i].stats.lost_arbitration++;
+                if (ctrl_hcan->Init.AutoRetransmission == DISABLE) {
+                    ctrl_mailboxes[entry].state = MAILBOX_FREE;
+                    ctrl_mailboxes[entry].rqcp = true;
+                    ctrl_mailboxes[entry].txok = false;
+                    ctrl_mailboxes[entry].alst = true;
+                }
+            }
+        } else if (bus_nodes[i].queue_length != 0) {
+            bus_nodes[i].stats.lost_arbitration++;
+        }
+    }
+
+    bus_active = true;
+    bus_delivered = false;
+    bus_sender = winner;
+    if (winner == ctrl_node) {
+        Bus_Mailbox_t* mailbox = &ctrl_mailboxes[winner_entry];
+        mailbox->state = MAILBOX_ON_BUS;
+        bus_sender_mailbox = winner_entry;
+        bus_frame = mailbox->frame;
+        bus_frame_queued = mailbox->queued_cycles;
+    } else {
+        Bus_Node_t* node = &bus_nodes[winner];
+        bus_sender_mailbox = -1;
+        bus_frame = node->queue[winner_entry].frame;
+        bus_frame_queued = node->queue[winner_entry].queued_cycles;
+        memmove(&node->queue[winner_entry], &node->queue[winner_entry + 1],
+                (node->queue_length - winner_entry - 1) * sizeof(Bus_Queued_t));
+        node->queue_length--;
+    }
+    bus_frame_bits = CAN_Bus_Frame_Bits(&bus_frame);
+    bus_eof_cycles = now + CAN_Bus_Bits_To_Cycles(bus_frame_bits - CAN_BUS_IFS_BITS);
+    bus_idle_cycles = now + CAN_Bus_Bits_To_Cycles(bus_frame_bits);
+    CAN_Bus_Update_Irqs();
+}
+
+/**
+ * @brief Arbitration field as a number: lower wins. Base ID, then SRR/RTR
+ *        and IDE, then the extension, so an 11-bit data frame beats a
+ *        29-bit one with the same base.
+ */
+static uint32_t CAN_Bus_Arbitration_Key(const CAN_Bus_Frame_t* frame)
+{
+    if (frame->ide == CAN_ID_EXT) {
+        return ((frame->id >> 18) << 21) | (3U << 19) | ((frame->id & 0x3FFFFU) << 1);
+    }
+    return (frame->id & 0x7FFU) << 21;
+}
+
+/**
+ * @brief The mailbox the controller puts forward next, -1 if none.
+ */
+static int CAN_Bus_Controller_Candidate(void)
+{
+    int best = -1;
+
+    if (ctrl_node < 0 || !ctrl_started) {
+        return -1;
+    }
+    for (int i = 0; i < CAN_BUS_MAILBOXES; i++) {
+        const Bus_Mailbox_t* mailbox = &ctrl_mailboxes[i];
+
+        if (mailbox->state != MAILBOX_PENDING) {
+            continue;
+        }
+        if (best < 0) {
+            best = i;
+        } else if (ctrl_hcan->Init.TransmitFifoPriority == ENABLE) {
+            if ((int32_t)(mailbox->sequence - ctrl_mailboxes[best].sequence) < 0) {
+                best = i;
+            }
+        } else if (CAN_Bus_Arbitration_Key(&mailbox->frame) < CAN_Bus_Arbitration_Key(&ctrl_mailboxes[best].frame)) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief The queued frame a node puts forward next: highest priority, oldest first.
+ */
+static int CAN_Bus_Node_Candidate(const Bus_Node_t* node)
+{
+    int best = -1;
+
+    for (uint32_t i = 0; i < node->queue_length; i++) {
+        if (best < 0 || CAN_Bus_Arbitration_Key(&node->queue[i].frame) < CAN_Bus_Arbitration_Key(&node->queue[best].frame)) {
+            best = (int)i;
+        }
+    }
+    return best;
+}
+
+static void CAN_Bus_Enqueue(int node_index, const CAN_Bus_Frame_t* frame, uint64_t queued_cycles)
+{
+    Bus_Node_t* node = &bus_nodes[node_index];
+
+    if (node->queue_length == node->queue_capacity) {
+        node->queue_capacity = (node->queue_capacity == 0) ? 16 : node->queue_capacity * 2;
+        node->queue = realloc(node->queue, node->queue_capacity * sizeof(Bus_Queued_t));
+    }
+    node->queue[node->queue_length].frame = *frame;
+    node->queue[node->queue_length].queued_cycles = queued_cycles;
+    node->queue_length++;
+    if (node->queue_length > node->stats.queue_peak) {
+        node->stats.queue_peak = node->queue_length;
+    }
+}
+
+/* --- bxCAN controller --- */
+
+/**
+ * @brief Puts a frame the controller heard through the filters into a FIFO.
+ * @note  With ReceiveFifoLocked disabled a full FIFO takes the new frame in
+ *        place of its newest one, so one frame is lost either way.
+ */
+static void CAN_Bus_Controller_Receive(const CAN_Bus_Frame_t* frame)
+{
+    Bus_Node_t* node = &bus_nodes[ctrl_node];
+    uint32_t fifo_number;
+    Bus_Fifo_t* fifo;
+
+    if (!ctrl_started || !CAN_Filter_Model_Match(frame->id, frame->ide, &fifo_number)) {
+        return;
+    }
+    node->stats.rx_accepted++;
+    fifo = &ctrl_fifos[fifo_number];
+    if (fifo->fill == CAN_BUS_FIFO_DEPTH) {
+        fifo->overrun = true;
+        node->stats.rx_overruns++;
+        fifo->frames[(fifo->head + CAN_BUS_FIFO_DEPTH - 1) % CAN_BUS_FIFO_DEPTH] = *frame;
+        return;
+    }
+    fifo->frames[(fifo->head + fifo->fill) % CAN_BUS_FIFO_DEPTH] = *frame;
+    fifo->fill++;
+    if (fifo->fill == CAN_BUS_FIFO_DEPTH) {
+        fifo->full = true;
+    }
+}
+
+/**
+ * @brief Pends the interrupt lines whose enabled sources are active, as the
+ *        level-sensitive lines of the chip would.
+ */
+static void CAN_Bus_Update_Irqs(void)
+{
+    bool tx = false;
+
+    if (ctrl_node < 0) {
+        return;
+    }
+    for (int i = 0; i < CAN_BUS_MAILBOXES; i++) {
+        tx |= ctrl_mailboxes[i].rqcp;
+    }
+    if (tx && (ctrl_its & CAN_IT_TX_MAILBOX_EMPTY)) {
+        HAL_NVIC_SetPendingIRQ(CAN1_TX_IRQn);
+    }
+    if ((ctrl_fifos[0].fill != 0 && (ctrl_its & CAN_IT_RX_FIFO0_MSG_PENDING)) ||
+        (ctrl_fifos[0].full && (ctrl_its & CAN_IT_RX_FIFO0_FULL)) ||
+        (ctrl_fifos[0].overrun && (ctrl_its & CAN_IT_RX_FIFO0_OVERRUN))) {
+        HAL_NVIC_SetPendingIRQ(CAN1_RX0_IRQn);
+    }
+    if ((ctrl_fifos[1].fill != 0 && (ctrl_its & CAN_IT_RX_FIFO1_MSG_PENDING)) ||
+        (ctrl_fifos[1].full && (ctrl_its & CAN_IT_RX_FIFO1_FULL)) ||
+        (ctrl_fifos[1].overrun && (ctrl_its & CAN_IT_RX_FIFO1_OVERRUN))) {
+        HAL_NVIC_SetPendingIRQ(CAN1_RX1_IRQn);
+    }
+}
+
+/* --- HAL --- */
+
+HAL_StatusTypeDef HAL_CAN_Start(CAN_HandleTypeDef* hcan)
+{
+    if (hcan != ctrl_hcan) {
+        return HAL_ERROR;
+    }
+    ctrl_started = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_ActivateNotification(CAN_HandleTypeDef* hcan, uint32_t ActiveITs)
+{
+    (void)hcan;
+    ctrl_its |= ActiveITs;
+    CAN_Bus_Update_Irqs();
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_DeactivateNotification(CAN_HandleTypeDef* hcan, uint32_t InactiveITs)
+{
+    (void)hcan;
+    ctrl_its &= ~InactiveITs;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_CAN_AddTxMessage(CAN_HandleTypeDef* hcan, CAN_TxHeaderTypeDef* pHeader,
+                                       uint8_t aData[], uint32_t* pTxMailbox)
+{
+    if (!ctrl_started) {
+        hcan->ErrorCode |= HAL_CAN_ERROR_NOT_STARTED;
+        return HAL_ERROR;
+    }
+    for (int i = 0; i < CAN_BUS_MAILBOXES; i++) {
+        Bus_Mailbox_t* mailbox = &ctrl_mailboxes[i];
+
+        if (mailbox->state != MAILBOX_FREE) {
+            continue;
+        }
+        mailbox->state = MAILBOX_PENDING;
+        mailbox->sequence = ctrl_sequence++;
+        mailbox->queued_cycles = Sim_GetCycles();
+        mailbox->frame.ide = pHeader->IDE;
+        mailbox->frame.id = (pHeader->IDE == CAN_ID_EXT) ? pHeader->ExtId : pHeader->StdId;
+        mailbox->frame.dlc = (uint8_t)pHeader->DLC;
+        memcpy(mailbox->frame.data, aData, (pHeader->DLC > 8) ? 8 : pHeader->DLC);
+        *pTxMailbox = CAN_TX_MAILBOX0 << i;
+        return HAL_OK;
+    }
+    hcan->ErrorCode |= HAL_CAN_ERROR_PARAM;
+    return HAL_ERROR;
+}
+
+HAL_StatusTypeDef HAL_CAN_AbortTxRequest(CAN_HandleTypeDef* hcan, uint32_t TxMailboxes)
+{
+    (void)hcan;
+    for (int i = 0; i < CAN_BUS_MAILBOXES; i++) {
+        // A frame already on the bus is not stopped
+        if ((TxMailboxes & (CAN_TX_MAILBOX0 << i)) && ctrl_mailboxes[i].state == MAILBOX_PENDING) {
+            ctrl_mailboxes[i].state = MAILBOX_FREE;
+            ctrl_mailboxes[i].rqcp = true;
+            ctrl_mailboxes[i].txok = false;
+            ctrl_mailboxes[i].alst = false;
+        }
+    }
+    CAN_Bus_Update_Irqs();
+    return HAL_OK;
+}
+
+uint32_t HAL_CAN_GetTxMailboxesFreeLevel(CAN_HandleTypeDef* hcan)
+{
+    uint32_t free_level = 0;
+
+    (void)hcan;
+    for (int i = 0; i < CAN_BUS_MAILBOXES; i++) {
+        free_level += (ctrl_mailboxes[i].state == MAILBOX_FREE) ? 1U : 0U;
+    }
+    return free_level;
+}
+
+HAL_StatusTypeDef HAL_CAN_GetRxMessage(CAN_HandleTypeDef* hcan, uint32_t RxFifo,
+                                       CAN_RxHeaderTypeDef* pHeader, uint8_t aData[])
+{
+    Bus_Fifo_t* fifo = &ctrl_fifos[RxFifo];
+    const CAN_Bus_Frame_t* frame;
+
+    if (fifo->fill == 0) {
+        hcan->ErrorCode |= HAL_CAN_ERROR_PARAM;
+        return HAL_ERROR;
+    }
+    frame = &fifo->frames[fifo->head];
+    pHeader->IDE = frame->ide;
+    pHeader->StdId = (frame->ide == CAN_ID_STD) ? frame->id : (frame->id >> 18);
+    pHeader->ExtId = (frame->ide == CAN_ID_EXT) ? frame->id : 0;
+    pHeader->RTR = CAN_RTR_DATA;
+    pHeader->DLC = frame->dlc;
+    pHeader->Timestamp = 0;
+    pHeader->FilterMatchIndex = 0;
+    memcpy(aData, frame->data, 8);
+
+    // Releasing the output mailbox
+    fifo->head = (fifo->head + 1) % CAN_BUS_FIFO_DEPTH;
+    fifo->fill--;
+    return HAL_OK;
+}
+
+uint32_t HAL_CAN_GetRxFifoFillLevel(CAN_HandleTypeDef* hcan, uint32_t RxFifo)
+{
+    (void)hcan;
+    return ctrl_fifos[RxFifo].fill;
+}
+
+uint32_t HAL_CAN_GetError(CAN_HandleTypeDef* hcan)
+{
+    return hcan->ErrorCode;
+}
+
+HAL_StatusTypeDef HAL_CAN_ResetError(CAN_HandleTypeDef* hcan)
+{
+    hcan->ErrorCode = HAL_CAN_ERROR_NONE;
+    return HAL_OK;
+}
+
+/**
+ * @brief Same order of checks and callbacks as the HAL's handler.
+ */
+void HAL_CAN_IRQHandler(CAN_HandleTypeDef* hcan)
+{
+    static void (* const complete[CAN_BUS_MAILBOXES])(CAN_HandleTypeDef*) = {
+        HAL_CAN_TxMailbox0CompleteCallback,
+        HAL_CAN_TxMailbox1CompleteCallback,
+        HAL_CAN_TxMailbox2CompleteCallback,
+    };
+    static void (* const full[2])(CAN_HandleTypeDef*) = {
+        HAL_CAN_RxFifo0FullCallback,
+        HAL_CAN_RxFifo1FullCallback,
+    };
+    static void (* const pending[2])(CAN_HandleTypeDef*) = {
+        HAL_CAN_RxFifo0MsgPendingCallback,
+        HAL_CAN_RxFifo1MsgPendingCallback,
+    };
+    uint32_t error = HAL_CAN_ERROR_NONE;
+
+    if (ctrl_its & CAN_IT_TX_MAILBOX_EMPTY) {
+        for (int i = 0; i < CAN_BUS_MAILBOXES; i++) {
+            Bus_Mailbox_t* mailbox = &ctrl_mailboxes[i];
+
+            if (!mailbox->rqcp) {
+                continue;
+            }
+            mailbox->rqcp = false;
+            if (mailbox->txok) {
+                complete[i](hcan);
+            } else if (mailbox->alst) {
+                error |= HAL_CAN_ERROR_TX_ALST0 << (i * 2);
+            }
+            // An aborted request calls the abort callback, which the
+            // application does not use
+        }
+    }
+
+    for (uint32_t f = 0; f < 2; f++) {
+        Bus_Fifo_t* fifo = &ctrl_fifos[f];
+        uint32_t it_shift = f * 3;  // FIFO1 bits follow the three of FIFO0
+
+        if ((ctrl_its & (CAN_IT_RX_FIFO0_OVERRUN << it_shift)) && fifo->overrun) {
+            error |= (f == 0) ? HAL_CAN_ERROR_RX_FOV0 : HAL_CAN_ERROR_RX_FOV1;
+            fifo->overrun = false;
+        }
+        if ((ctrl_its & (CAN_IT_RX_FIFO0_FULL << it_shift)) && fifo->full) {
+            fifo->full = false;
+            full[f](hcan);
+        }
+        if ((ctrl_its & (CAN_IT_RX_FIFO0_MSG_PENDING << it_shift)) && fifo->fill != 0) {
+            pending[f](hcan);
+        }
+    }
+
+    if (error != HAL_CAN_ERROR_NONE) {
+        hcan->ErrorCode |= error;
+        HAL_CAN_ErrorCallback(hcan);
+    }
+    CAN_Bus_Update_Irqs();
+}
@@ -0,0 +1,143 @@
+/*
+ * can_bus.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef TESTS_SIM_CAN_BUS_H_
+#define TESTS_SIM_CAN_BUS_H_
+
+#include "stm32f4xx_hal.h"
+#include <stdbool.h>
+
+/*
+ * In-process CAN bus for host tests, on simulated time.
+ *
+ * One bxCAN controller, the ECU's CAN1, sits behind the HAL_CAN functions
+ * and HAL_CAN_IRQHandler: three TX mailboxes sent in request order or by
+ * identifier as TransmitFifoPriority says, two RX FIFOs three frames deep
+ * fed through the filter banks of can_filter_model, and the TX, RX0 and RX1
+ * interrupt lines. With AutoRetransmission disabled a mailbox that loses
+ * arbitration reports ALST and its frame is gone, as on the chip.
+ *
+ * Any number of simulated nodes (other ECUs, testers) can be added. Each
+ * queues frames without limit, retransmits after a lost arbitration, sends
+ * its highest priority frame first and sees every frame it did not send.
+ * Periodic traffic can be attached to a node to load the bus.
+ *
+ * A frame occupies the bus for its exact length: arbitration, control and
+ * data fields and the CRC with their stuff bits, then the fixed trailer and
+ * the intermission, at the bitrate of the controller's Init timing. Frames
+ * that become ready while the bus is busy contend at the next idle bit;
+ * the lowest identifier wins, an 11-bit one before a 29-bit one with the
+ * same base.
+ */
+
+/* --- Defines --- */
+#define CAN_BUS_MAX_NODES       8
+#define CAN_BUS_MAILBOXES       3
+#define CAN_BUS_FIFO_DEPTH      3
+#define CAN_BUS_TRAILER_BITS    10      // CRC delimiter, ACK slot and delimiter, EOF
+#define CAN_BUS_IFS_BITS        3       // Intermission before the next frame may start
+
+/* --- Types --- */
+typedef struct {
+    uint32_t id;
+    uint32_t ide;           // CAN_ID_STD or CAN_ID_EXT
+    uint8_t dlc;
+    uint8_t data[8];
+} CAN_Bus_Frame_t;
+
+/**
+ * @brief Called at the end of every frame a node did not send itself.
+ * @param end_cycles Time the frame's EOF ended, in simulated cycles.
+ */
+typedef void (*CAN_Bus_Rx_Callback_t)(void* context, const CAN_Bus_Frame_t* frame, uint64_t end_cycles);
+
+/**
+ * @brief What one node did on the bus.
+ */
+typedef struct {
+    uint32_t tx_frames;         // Frames that completed
+    uint64_t tx_bits;           // Bus bits they took, trailer and intermission included
+    uint32_t lost_arbitration;  // Contentions lost; a controller without retransmission drops the frame
+    uint32_t rx_frames;         // Frames seen from other nodes
+    uint32_t rx_accepted;       // Controller: frames that passed the filters
+    uint32_t rx_overruns;       // Controller: accepted frames lost to a full FIFO
+    uint32_t queue_peak;        // Node: most frames waiting at once
+    uint64_t max_wait_cycles;   // Longest time from queued to the end of the frame
+} CAN_Bus_Node_Stats_t;
+
+/**
+ * @brief Whole-bus figures.
+ */
+typedef struct {
+    uint32_t frames;
+    uint64_t busy_cycles;       // Time some frame occupied the bus
+    uint64_t elapsed_cycles;    // Time since the bus was reset
+} CAN_Bus_Stats_t;
+
+/* --- Functions --- */
+/**
+ * @brief Clears every node and statistic and registers the bus with the
+ *        simulated kernel. Call after Sim_Reset.
+ * @param bitrate Nominal bitrate in bit/s.
+ */
+void CAN_Bus_Reset(uint32_t bitrate);
+
+/**
+ * @brief Attaches the bxCAN controller the HAL_CAN functions drive.
+ * @retval Node number of the controller.
+ */
+int CAN_Bus_Attach_Controller(CAN_HandleTypeDef* hcan);
+
+/**
+ * @brief Adds a simulated node.
+ * @param name Name for reports.
+ * @param rx_callback Called for every frame of other nodes. May be NULL.
+ * @retval Node number.
+ */
+int CAN_Bus_Add_Node(const char* name, CAN_Bus_Rx_Callback_t rx_callback, void* context);
+
+/**
+ * @brief Queues a frame on a simulated node.
+ */
+void CAN_Bus_Send(int node, const CAN_Bus_Frame_t* frame);
+
+/**
+ * @brief Makes a simulated node queue a frame every period.
+ * @param first_us Time of the first frame, from now.
+ * @param period_us Time between frames.
+ */
+void CAN_Bus_Add_Periodic(int node, const CAN_Bus_Frame_t* frame, uint32_t first_us, uint32_t period_us);
+
+/**
+ * @brief Stops every periodic frame of every node.
+ */
+void CAN_Bus_Stop_Periodic(void);
+
+/**
+ * @brief Returns the exact bus length of a data frame, stuff bits,
+ *        trailer and intermission included.
+ */
+uint16_t CAN_Bus_Frame_Bits(const CAN_Bus_Frame_t* frame);
+
+/**
+ * @brief Converts a number of bits to simulated cycles at the bus bitrate.
+ */
+uint64_t CAN_Bus_Bits_To_Cycles(uint64_t bits);
+
+void CAN_Bus_Get_Node_Stats(int node, CAN_Bus_Node_Stats_t* p_stats);
+void CAN_Bus_Get_Stats(CAN_Bus_Stats_t* p_stats);
+
+/**
+ * @brief Restarts the statistics of the bus and of every node.
+ */
+void CAN_Bus_Reset_Stats(void);
+
+/**
+ * @brief True while no frame is on the bus or waiting to be sent.
+ */
+bool CAN_Bus_Is_Idle(void);
+
+#endif /* TESTS_SIM_CAN_BUS_H_ */
@@ -0,0 +1,123 @@
+/*
+ * can_filter_model.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "can_filter_model.h"
+#include <string.h>
+
+/* --- Types --- */
+typedef struct {
+    bool active;
+    bool list_mode;
+    bool scale_32bit;
+    uint32_t fifo;
+    uint32_t fr1;
+    uint32_t fr2;
+} CAN_Filter_Model_Bank_t;
+
+/* --- Private Variables --- */
+static CAN_Filter_Model_Bank_t model_banks[CAN_FILTER_MODEL_BANKS];
+static uint32_t model_slave_start = 14;     // CAN2SB reset value
+static uint32_t model_config_calls;
+
+/* --- Private Function Prototypes --- */
+static bool CAN_Filter_Model_Match_16(uint32_t value, uint32_t id16, uint32_t mask16);
+
+/* --- Public Functions --- */
+
+void CAN_Filter_Model_Reset(void)
+{
+    memset(model_banks, 0, sizeof(model_banks));
+    model_slave_start = 14;
+    model_config_calls = 0;
+}
+
+bool CAN_Filter_Model_Match(uint32_t id, uint32_t ide, uint32_t* p_fifo)
+{
+    // The frame identifier as it lines up with each register scale
+    uint32_t r32 = (ide == CAN_ID_EXT) ? ((id << 3) | 0x04U) : (id << 21);
+    uint32_t r16 = (ide == CAN_ID_EXT) ? ((((id >> 18) & 0x7FFU) << 5) | 0x08U | ((id >> 15) & 0x07U)) :
+                                         ((id & 0x7FFU) << 5);
+
+    for (uint32_t b = 0; b < model_slave_start && b < CAN_FILTER_MODEL_BANKS; b++) {
+        const CAN_Filter_Model_Bank_t* bank = &model_banks[b];
+        bool match;
+
+        if (!bank->active) {
+            continue;
+        }
+        if (bank->scale_32bit) {
+            match = bank->list_mode ? (r32 == bank->fr1 || r32 == bank->fr2) :
+                                      (((r32 ^ bank->fr1) & bank->fr2) == 0);
+        } else if (bank->list_mode) {
+            match = r16 == (bank->fr1 & 0xFFFFU) || r16 == (bank->fr1 >> 16) ||
+                    r16 == (bank->fr2 & 0xFFFFU) || r16 == (bank->fr2 >> 16);
+        } else {
+            match = CAN_Filter_Model_Match_16(r16, bank->fr1 & 0xFFFFU, bank->fr1 >> 16) ||
+                    CAN_Filter_Model_Match_16(r16, bank->fr2 & 0xFFFFU, bank->fr2 >> 16);
+        }
+        if (match) {
+            if (p_fifo != NULL) {
+                *p_fifo = bank->fifo;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t CAN_Filter_Model_GetActiveBanks(void)
+{
+    uint32_t count = 0;
+
+    for (uint32_t b = 0; b < model_slave_start && b < CAN_FILTER_MODEL_BANKS; b++) {
+        count += model_banks[b].active ? 1U : 0U;
+    }
+    return count;
+}
+
+uint32_t CAN_Filter_Model_GetConfigCalls(void)
+{
+    return model_config_calls;
+}
+
+/* --- HAL --- */
+
+HAL_StatusTypeDef HAL_CAN_ConfigFilter(CAN_HandleTypeDef* hcan, CAN_FilterTypeDef* sFilterConfig)
+{
+    CAN_Filter_Model_Bank_t* bank;
+
+    (void)hcan;
+    if (sFilterConfig->FilterBank >= CAN_FILTER_MODEL_BANKS) {
+        return HAL_ERROR;
+    }
+    model_config_calls++;
+    model_slave_start = sFilterConfig->SlaveStartFilterBank;
+
+    // Register layout as written by HAL_CAN_ConfigFilter
+    bank = &model_banks[sFilterConfig->FilterBank];
+    bank->list_mode = sFilterConfig->FilterMode == CAN_FILTERMODE_IDLIST;
+    bank->scale_32bit = sFilterConfig->FilterScale == CAN_FILTERSCALE_32BIT;
+    bank->fifo = sFilterConfig->FilterFIFOAssignment;
+    if (bank->scale_32bit) {
+        bank->fr1 = ((sFilterConfig->FilterIdHigh & 0xFFFFU) << 16) | (sFilterConfig->FilterIdLow & 0xFFFFU);
+        bank->fr2 = ((sFilterConfig->FilterMaskIdHigh & 0xFFFFU) << 16) | (sFilterConfig->FilterMaskIdLow & 0xFFFFU);
+    } else {
+        bank->fr1 = ((sFilterConfig->FilterMaskIdLow & 0xFFFFU) << 16) | (sFilterConfig->FilterIdLow & 0xFFFFU);
+        bank->fr2 = ((sFilterConfig->FilterMaskIdHigh & 0xFFFFU) << 16) | (sFilterConfig->FilterIdHigh & 0xFFFFU);
+    }
+    bank->active = sFilterConfig->FilterActivation == ENABLE;
+    return HAL_OK;
+}
+
+/* --- Private Functions --- */
+
+/**
+ * @brief Matches one 16-bit element against an ID/mask pair.
+ */
+static bool CAN_Filter_Model_Match_16(uint32_t value, uint32_t id16, uint32_t mask16)
+{
+    return ((value ^ id16) & mask16) == 0;
+}
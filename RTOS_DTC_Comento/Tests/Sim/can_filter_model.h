@@ -0,0 +1,50 @@
+/*
+ * can_filter_model.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef TESTS_SIM_CAN_FILTER_MODEL_H_
+#define TESTS_SIM_CAN_FILTER_MODEL_H_
+
+#include "stm32f4xx_hal.h"
+#include <stdbool.h>
+
+/*
+ * Model of the bxCAN acceptance filter banks, behind HAL_CAN_ConfigFilter.
+ * HAL_CAN_ConfigFilter packs its fields into FR1/FR2 as the HAL does, and
+ * frames are matched against the raw registers the way the controller
+ * matches them, so both the encoding and the HAL field layout are tested.
+ * The banks are shared by CAN1 and CAN2 as on the STM32F4; banks from
+ * SlaveStartFilterBank on belong to CAN2.
+ */
+
+/* --- Defines --- */
+#define CAN_FILTER_MODEL_BANKS      28
+
+/* --- Functions --- */
+/**
+ * @brief Deactivates every bank.
+ */
+void CAN_Filter_Model_Reset(void);
+
+/**
+ * @brief Matches a data frame against the active CAN1 banks.
+ * @param id 11-bit or 29-bit identifier.
+ * @param ide CAN_ID_STD or CAN_ID_EXT.
+ * @param p_fifo Receives the FIFO of the matching bank. May be NULL.
+ * @retval true if a bank accepts the frame.
+ */
+bool CAN_Filter_Model_Match(uint32_t id, uint32_t ide, uint32_t* p_fifo);
+
+/**
+ * @brief Returns the number of active CAN1 banks.
+ */
+uint32_t CAN_Filter_Model_GetActiveBanks(void);
+
+/**
+ * @brief Returns the HAL_CAN_ConfigFilter calls since the last reset.
+ */
+uint32_t CAN_Filter_Model_GetConfigCalls(void);
+
+#endif /* TESTS_SIM_CAN_FILTER_MODEL_H_ */
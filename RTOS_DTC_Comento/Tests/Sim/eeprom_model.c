@@ -0,0 +1,281 @@
+/*
+ * eeprom_model.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "eeprom_model.h"
+#include "sim_os.h"
+#include <string.h>
+
+/* --- Defines --- */
+#define EEPROM_MODEL_CS_PORT    GPIOC
+#define EEPROM_MODEL_CS_PIN     GPIO_PIN_4
+#define EEPROM_MODEL_BYTE_CYCLES (8U * (SIM_CPU_HZ / EEPROM_MODEL_SCK_HZ))
+
+/* --- Private Variables --- */
+static uint8_t model_array[EEPROM_TOTAL_SIZE];
+static uint32_t model_page_writes[EEPROM_MODEL_PAGE_COUNT];
+static EEPROM_Model_Stats_t model_stats;
+static uint32_t model_write_time_us = EEPROM_MODEL_WRITE_TIME_US;
+static int32_t model_tear_bytes = -1;   // Bytes of the next page to program, -1 for all
+
+static bool model_selected;             // CS low
+static bool model_wel;                  // Write enable latch
+static uint64_t model_busy_until;       // End of the write cycle, in simulated cycles
+
+// Transaction in progress
+static uint32_t model_byte_index;       // Bytes clocked since CS went low
+static uint8_t model_command;
+static bool model_ignored;              // Command arrived during a write cycle
+static uint16_t model_address;
+static uint8_t model_page_buffer[EEPROM_PAGE_SIZE];
+static uint16_t model_page_base;
+static uint8_t model_page_offset;
+static uint32_t model_latched;          // Data bytes latched by a WRITE
+
+// DMA completion
+static SPI_HandleTypeDef* model_dma_hspi;
+
+/* --- Private Function Prototypes --- */
+static uint8_t EEPROM_Model_Clock(uint8_t mosi);
+static void EEPROM_Model_Deselect(void);
+static void EEPROM_Model_TxComplete(void* context);
+static void EEPROM_Model_RxComplete(void* context);
+
+/* --- Public Functions --- */
+
+void EEPROM_Model_Reset(void)
+{
+    memset(model_array, 0xFF, sizeof(model_array));
+    memset(model_page_writes, 0, sizeof(model_page_writes));
+    memset(&model_stats, 0, sizeof(model_stats));
+    model_write_time_us = EEPROM_MODEL_WRITE_TIME_US;
+    model_tear_bytes = -1;
+    model_selected = false;
+    model_wel = false;
+    model_busy_until = 0;
+}
+
+void EEPROM_Model_Restart(void)
+{
+    model_selected = false;
+    model_wel = false;
+    model_busy_until = 0;
+}
+
+uint8_t* EEPROM_Model_GetArray(void)
+{
+    return model_array;
+}
+
+void EEPROM_Model_SetWriteTime(uint32_t write_time_us)
+{
+    model_write_time_us = write_time_us;
+}
+
+void EEPROM_Model_TearNextWrite(uint16_t bytes)
+{
+    model_tear_bytes = bytes;
+}
+
+uint32_t EEPROM_Model_GetPageWrites(uint16_t page)
+{
+    return (page < EEPROM_MODEL_PAGE_COUNT) ? model_page_writes[page] : 0;
+}
+
+void EEPROM_Model_GetStats(EEPROM_Model_Stats_t* p_stats)
+{
+    *p_stats = model_stats;
+}
+
+bool EEPROM_Model_IsBusy(void)
+{
+    return Sim_GetCycles() < model_busy_until;
+}
+
+/* --- Device --- */
+
+/**
+ * @brief Shifts one byte in and one byte out.
+ */
+static uint8_t EEPROM_Model_Clock(uint8_t mosi)
+{
+    uint32_t index = model_byte_index++;
+    uint8_t miso = 0xFF;    // SO is high impedance unless driven
+
+    Sim_AdvanceCycles(EEPROM_MODEL_BYTE_CYCLES);
+    model_stats.bytes_clocked++;
+    if (!model_selected) {
+        return miso;
+    }
+
+    if (index == 0) {
+        model_command = mosi;
+        model_ignored = EEPROM_Model_IsBusy() && mosi != EEPROM_CMD_RDSR;
+        if (model_ignored) {
+            model_stats.busy_commands++;
+        } else if (mosi == EEPROM_CMD_RDSR) {
+            model_stats.status_reads++;
+        }
+        return miso;
+    }
+    if (model_ignored) {
+        return miso;
+    }
+
+    switch (model_command) {
+    case EEPROM_CMD_RDSR:
+        miso = (EEPROM_Model_IsBusy() ? EEPROM_WIP_BIT : 0) | (model_wel ? EEPROM_WEL_BIT : 0);
+        break;
+
+    case EEPROM_CMD_READ:
+        if (index <= 2) {
+            model_address = (uint16_t)((model_address << 8) | mosi);
+        } else {
+            miso = model_array[model_address % EEPROM_TOTAL_SIZE];
+            model_address = (model_address + 1) % EEPROM_TOTAL_SIZE;
+        }
+        break;
+
+    case EEPROM_CMD_WRITE:
+        if (index <= 2) {
+            model_address = (uint16_t)((model_address << 8) | mosi);
+            if (index == 2) {
+                model_address %= EEPROM_TOTAL_SIZE;
+                model_page_base = model_address & ~(EEPROM_PAGE_SIZE - 1);
+                model_page_offset = model_address % EEPROM_PAGE_SIZE;
+                memcpy(model_page_buffer, &model_array[model_page_base], EEPROM_PAGE_SIZE);
+                model_latched = 0;
+            }
+        } else {
+            if (model_latched == EEPROM_PAGE_SIZE - (model_address % EEPROM_PAGE_SIZE)) {
+                model_stats.page_wraps++;
+            }
+            model_page_buffer[model_page_offset] = mosi;
+            model_page_offset = (model_page_offset + 1) % EEPROM_PAGE_SIZE;
+            model_latched++;
+        }
+        break;
+
+    default:
+        break;
+    }
+    return miso;
+}
+
+/**
+ * @brief CS rising edge: ends the command.
+ */
+static void EEPROM_Model_Deselect(void)
+{
+    model_stats.transactions++;
+    if (model_byte_index == 0 || model_ignored) {
+        return;
+    }
+
+    switch (model_command) {
+    case EEPROM_CMD_WREN:
+        model_wel = true;
+        break;
+
+    case EEPROM_CMD_WRDI:
+        model_wel = false;
+        break;
+
+    case EEPROM_CMD_WRITE:
+        if (!model_wel) {
+            model_stats.unlatched_writes++;
+            break;
+        }
+        if (model_latched == 0) {
+            break;
+        }
+        // Bytes not latched keep their old value, read in with the address
+        if (model_tear_bytes >= 0) {
+            memcpy(&model_array[model_page_base], model_page_buffer, (uint32_t)model_tear_bytes);
+            model_tear_bytes = -1;
+        } else {
+            memcpy(&model_array[model_page_base], model_page_buffer, EEPROM_PAGE_SIZE);
+        }
+        model_page_writes[model_page_base / EEPROM_PAGE_SIZE]++;
+        model_stats.page_writes++;
+        model_busy_until = Sim_GetCycles() + (uint64_t)model_write_time_us * (SIM_CPU_HZ / 1000000U);
+        model_wel = false;
+        break;
+
+    default:
+        break;
+    }
+}
+
+/* --- HAL functions used by the driver --- */
+
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState)
+{
+    if (GPIOx != EEPROM_MODEL_CS_PORT || GPIO_Pin != EEPROM_MODEL_CS_PIN) {
+        return;
+    }
+    if (PinState == GPIO_PIN_RESET && !model_selected) {
+        model_selected = true;
+        model_byte_index = 0;
+        model_ignored = false;
+    } else if (PinState == GPIO_PIN_SET && model_selected) {
+        model_selected = false;
+        EEPROM_Model_Deselect();
+    }
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size, uint32_t Timeout)
+{
+    (void)hspi;
+    (void)Timeout;
+    for (uint16_t i = 0; i < Size; i++) {
+        (void)EEPROM_Model_Clock(pData[i]);
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData,
+                                          uint16_t Size, uint32_t Timeout)
+{
+    (void)hspi;
+    (void)Timeout;
+    for (uint16_t i = 0; i < Size; i++) {
+        pRxData[i] = EEPROM_Model_Clock(pTxData[i]);
+    }
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size)
+{
+    for (uint16_t i = 0; i < Size; i++) {
+        (void)EEPROM_Model_Clock(pData[i]);
+    }
+    model_dma_hspi = hspi;
+    Sim_RunIsr(EEPROM_Model_TxComplete, NULL);
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size)
+{
+    // The master clocks out dummy bytes to receive
+    for (uint16_t i = 0; i < Size; i++) {
+        pData[i] = EEPROM_Model_Clock(0xFF);
+    }
+    model_dma_hspi = hspi;
+    Sim_RunIsr(EEPROM_Model_RxComplete, NULL);
+    return HAL_OK;
+}
+
+static void EEPROM_Model_TxComplete(void* context)
+{
+    (void)context;
+    HAL_SPI_TxCpltCallback(model_dma_hspi);
+}
+
+static void EEPROM_Model_RxComplete(void* context)
+{
+    (void)context;
+    HAL_SPI_RxCpltCallback(model_dma_hspi);
+}
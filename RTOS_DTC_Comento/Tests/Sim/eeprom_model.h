@@ -0,0 +1,91 @@
+/*
+ * eeprom_model.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef TESTS_SIM_EEPROM_MODEL_H_
+#define TESTS_SIM_EEPROM_MODEL_H_
+
+#include "eeprom_25lc256.h"
+#include <stdbool.h>
+
+/*
+ * Model of the 25LC256 on SPI1, behind the HAL SPI and GPIO functions the
+ * driver calls. It decodes the command stream byte by byte while CS
+ * (PC4) is low, as the device does:
+ *  - WREN/WRDI set and reset the write enable latch when CS goes high.
+ *  - READ streams from any address and wraps at the end of the array.
+ *  - WRITE latches up to one page; the address wraps inside the page, and
+ *    the page is programmed when CS goes high, if the latch was set. The
+ *    internal write cycle then keeps WIP set for the write time and the
+ *    latch is reset.
+ *  - While WIP is set, every command except RDSR is ignored.
+ * Bytes are clocked at EEPROM_MODEL_SCK_HZ, so SPI transfers take
+ * simulated time like on the board; DMA transfers complete at once and
+ * call the driver's completion callback from an interrupt.
+ */
+
+/* --- Defines --- */
+#define EEPROM_MODEL_SCK_HZ         8000000U    // SPI1 at HSI / 2, as set up in MX_SPI1_Init
+#define EEPROM_MODEL_WRITE_TIME_US  5000U       // tWC, the datasheet maximum
+#define EEPROM_MODEL_PAGE_COUNT     (EEPROM_TOTAL_SIZE / EEPROM_PAGE_SIZE)
+
+/* --- Types --- */
+/**
+ * @brief What the device saw, to check the driver against the datasheet.
+ */
+typedef struct {
+    uint32_t transactions;      // CS low to high cycles
+    uint32_t bytes_clocked;     // Bytes shifted in either direction
+    uint32_t page_writes;       // Internal write cycles started
+    uint32_t status_reads;      // RDSR commands
+    uint32_t busy_commands;     // Commands other than RDSR ignored during a write cycle
+    uint32_t unlatched_writes;  // WRITE commands ignored since WREN was not sent first
+    uint32_t page_wraps;        // WRITE data that wrapped to the start of its page
+} EEPROM_Model_Stats_t;
+
+/* --- Functions --- */
+/**
+ * @brief Erases the array to 0xFF, makes the device idle and clears the stats.
+ */
+void EEPROM_Model_Reset(void);
+
+/**
+ * @brief Power cycle of the device, to go with Sim_Reset: the write cycle
+ *        in progress completes, the latch is reset and the array is kept.
+ */
+void EEPROM_Model_Restart(void);
+
+/**
+ * @brief Direct access to the array, to set up or inspect contents.
+ */
+uint8_t* EEPROM_Model_GetArray(void);
+
+/**
+ * @brief Sets the internal write cycle time, EEPROM_MODEL_WRITE_TIME_US by default.
+ */
+void EEPROM_Model_SetWriteTime(uint32_t write_time_us);
+
+/**
+ * @brief Makes the next programmed page torn, as if the supply failed
+ *        during its write cycle: only its first `bytes` bytes are written.
+ */
+void EEPROM_Model_TearNextWrite(uint16_t bytes);
+
+/**
+ * @brief Returns the internal write cycles a page has been through.
+ */
+uint32_t EEPROM_Model_GetPageWrites(uint16_t page);
+
+/**
+ * @brief Copies the device statistics.
+ */
+void EEPROM_Model_GetStats(EEPROM_Model_Stats_t* p_stats);
+
+/**
+ * @brief True while an internal write cycle is in progress.
+ */
+bool EEPROM_Model_IsBusy(void);
+
+#endif /* TESTS_SIM_EEPROM_MODEL_H_ */
@@ -0,0 +1,197 @@
+/*
+ * isotp_tester.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "isotp_tester.h"
+#include "sim_os.h"
+#include <string.h>
+
+/* --- Defines --- */
+#define ISOTP_PCI_SINGLE_FRAME       0x00
+#define ISOTP_PCI_FIRST_FRAME        0x10
+#define ISOTP_PCI_CONSECUTIVE_FRAME  0x20
+#define ISOTP_PCI_FLOW_CONTROL       0x30
+#define ISOTP_FS_CONTINUE            0x00
+#define ISOTP_PADDING                0xAA
+
+/* --- Private Function Prototypes --- */
+static void IsoTp_Tester_Rx(void* context, const CAN_Bus_Frame_t* frame, uint64_t end_cycles);
+static void IsoTp_Tester_Send(IsoTp_Tester_t* tester, const uint8_t* payload);
+static void IsoTp_Tester_Send_Block(IsoTp_Tester_t* tester, uint8_t block_size);
+static void IsoTp_Tester_Send_Flow_Control(IsoTp_Tester_t* tester);
+static void IsoTp_Tester_Complete(IsoTp_Tester_t* tester, uint64_t end_cycles);
+
+/* --- Public Functions --- */
+
+void IsoTp_Tester_Init(IsoTp_Tester_t* tester, const char* name, const IsoTp_Tester_Config_t* config)
+{
+    memset(tester, 0, sizeof(*tester));
+    tester->config = *config;
+    tester->node = CAN_Bus_Add_Node(name, IsoTp_Tester_Rx, tester);
+}
+
+bool IsoTp_Tester_Request(IsoTp_Tester_t* tester, const uint8_t* data, uint16_t length)
+{
+    uint8_t frame[8];
+
+    if (tester->tx_wait_fc || length == 0 || length > ISOTP_TESTER_MAX_LENGTH) {
+        return false;
+    }
+    memcpy(tester->tx_data, data, length);
+    tester->tx_size = length;
+    memset(frame, ISOTP_PADDING, sizeof(frame));
+
+    if (length <= 7) {
+        frame[0] = ISOTP_PCI_SINGLE_FRAME | length;
+        memcpy(&frame[1], data, length);
+        tester->tx_sent = length;
+    } else {
+        frame[0] = ISOTP_PCI_FIRST_FRAME | (length >> 8);
+        frame[1] = length & 0xFF;
+        memcpy(&frame[2], data, 6);
+        tester->tx_sent = 6;
+        tester->tx_sequence = 1;
+        tester->tx_wait_fc = true;
+    }
+    IsoTp_Tester_Send(tester, frame);
+    return true;
+}
+
+/* --- Private Functions --- */
+
+static void IsoTp_Tester_Rx(void* context, const CAN_Bus_Frame_t* frame, uint64_t end_cycles)
+{
+    IsoTp_Tester_t* tester = context;
+    const uint8_t* data = frame->data;
+    uint16_t length;
+
+    if (frame->ide != (tester->config.standard_ids ? CAN_ID_STD : CAN_ID_EXT) ||
+        frame->id != tester->config.response_id || frame->dlc == 0) {
+        return;
+    }
+
+    switch (data[0] & 0xF0) {
+        case ISOTP_PCI_SINGLE_FRAME:
+            length = data[0] & 0x0F;
+            if (length == 0 || length > frame->dlc - 1) {
+                return;
+            }
+            tester->rx_active = false;
+            memcpy(tester->rx_data, &data[1], length);
+            tester->rx_size = length;
+            tester->rx_start_cycles = end_cycles;
+            IsoTp_Tester_Complete(tester, end_cycles);
+            break;
+
+        case ISOTP_PCI_FIRST_FRAME:
+            length = ((data[0] & 0x0F) << 8) | data[1];
+            if (frame->dlc < 8 || length <= 6) {
+                return;
+            }
+            if (tester->rx_active) {
+                tester->sequence_errors++;  // The previous message never finished
+            }
+            memcpy(tester->rx_data, &data[2], 6);
+            tester->rx_size = length;
+            tester->rx_received = 6;
+            tester->rx_sequence = 1;
+            tester->rx_block_count = 0;
+            tester->rx_active = true;
+            tester->rx_start_cycles = end_cycles;
+            IsoTp_Tester_Send_Flow_Control(tester);
+            break;
+
+        case ISOTP_PCI_CONSECUTIVE_FRAME:
+            if (!tester->rx_active) {
+                return;
+            }
+            if ((data[0] & 0x0F) != tester->rx_sequence) {
+                tester->sequence_errors++;
+                tester->rx_active = false;
+                return;
+            }
+            length = tester->rx_size - tester->rx_received;
+            length = (length > 7) ? 7 : length;
+            memcpy(&tester->rx_data[tester->rx_received], &data[1], length);
+            tester->rx_received += length;
+            tester->rx_sequence = (tester->rx_sequence + 1) & 0x0F;
+            if (tester->rx_received >= tester->rx_size) {
+                tester->rx_active = false;
+                IsoTp_Tester_Complete(tester, end_cycles);
+            } else if (tester->config.block_size != 0 && ++tester->rx_block_count >= tester->config.block_size) {
+                tester->rx_block_count = 0;
+                IsoTp_Tester_Send_Flow_Control(tester);
+            }
+            break;
+
+        case ISOTP_PCI_FLOW_CONTROL:
+            if (!tester->tx_wait_fc || (data[0] & 0x0F) != ISOTP_FS_CONTINUE) {
+                return;
+            }
+            tester->flow_controls++;
+            IsoTp_Tester_Send_Block(tester, data[1]);
+            break;
+
+        default:
+            break;
+    }
+}
+
+static void IsoTp_Tester_Send(IsoTp_Tester_t* tester, const uint8_t* payload)
+{
+    CAN_Bus_Frame_t frame = { tester->config.request_id, tester->config.standard_ids ? CAN_ID_STD : CAN_ID_EXT, 8, { 0 } };
+
+    memcpy(frame.data, payload, 8);
+    CAN_Bus_Send(tester->node, &frame);
+}
+
+/**
+ * @brief Queues the consecutive frames of one granted block, all of them for BS 0.
+ */
+static void IsoTp_Tester_Send_Block(IsoTp_Tester_t* tester, uint8_t block_size)
+{
+    uint8_t frame[8];
+    uint8_t count = 0;
+
+    while (tester->tx_sent < tester->tx_size && (block_size == 0 || count < block_size)) {
+        uint16_t length = tester->tx_size - tester->tx_sent;
+
+        length = (length > 7) ? 7 : length;
+        memset(frame, ISOTP_PADDING, sizeof(frame));
+        frame[0] = ISOTP_PCI_CONSECUTIVE_FRAME | tester->tx_sequence;
+        memcpy(&frame[1], &tester->tx_data[tester->tx_sent], length);
+        IsoTp_Tester_Send(tester, frame);
+        tester->tx_sent += length;
+        tester->tx_sequence = (tester->tx_sequence + 1) & 0x0F;
+        count++;
+    }
+    tester->tx_wait_fc = (tester->tx_sent < tester->tx_size);
+}
+
+static void IsoTp_Tester_Send_Flow_Control(IsoTp_Tester_t* tester)
+{
+    uint8_t frame[8];
+
+    if (!tester->config.flow_control) {
+        return;
+    }
+    memset(frame, ISOTP_PADDING, sizeof(frame));
+    frame[0] = ISOTP_PCI_FLOW_CONTROL | ISOTP_FS_CONTINUE;
+    frame[1] = tester->config.block_size;
+    frame[2] = tester->config.st_min;
+    IsoTp_Tester_Send(tester, frame);
+}
+
+static void IsoTp_Tester_Complete(IsoTp_Tester_t* tester, uint64_t end_cycles)
+{
+    memcpy(tester->message, tester->rx_data, tester->rx_size);
+    tester->message_length = tester->rx_size;
+    tester->message_start_cycles = tester->rx_start_cycles;
+    tester->message_end_cycles = end_cycles;
+    tester->messages++;
+    if (tester->config.on_message != NULL) {
+        tester->config.on_message(tester);
+    }
+}
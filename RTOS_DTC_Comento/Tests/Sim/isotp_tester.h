@@ -0,0 +1,83 @@
+/*
+ * isotp_tester.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef TESTS_SIM_ISOTP_TESTER_H_
+#define TESTS_SIM_ISOTP_TESTER_H_
+
+#include "can_bus.h"
+
+/*
+ * Diagnostic tester on the simulated CAN bus, speaking ISO-TP (ISO 15765-2)
+ * with 8-byte frames and no addressing byte.
+ *
+ * Requests go out as a single frame, or as a first frame followed by
+ * consecutive frames once the ECU grants them with flow control. The ECU
+ * grants STmin 0, so a granted block is queued on the node at once.
+ * Responses are reassembled, answered with the flow control of the config,
+ * and kept until the next one completes.
+ */
+
+/* --- Defines --- */
+#define ISOTP_TESTER_MAX_LENGTH     4095
+
+/* --- Types --- */
+typedef struct IsoTp_Tester IsoTp_Tester_t;
+
+typedef struct {
+    uint32_t request_id;        // ID the tester sends on
+    uint32_t response_id;       // ID the tester listens to
+    bool standard_ids;          // 11-bit IDs instead of 29-bit ones
+    uint8_t block_size;         // BS of our flow control frames
+    uint8_t st_min;             // STmin of our flow control frames
+    bool flow_control;          // false: never answer a first frame
+    void (*on_message)(const IsoTp_Tester_t* tester);  // Each complete response, may be NULL
+} IsoTp_Tester_Config_t;
+
+struct IsoTp_Tester {
+    int node;
+    IsoTp_Tester_Config_t config;
+
+    // Request being sent
+    uint8_t tx_data[ISOTP_TESTER_MAX_LENGTH];
+    uint16_t tx_size;
+    uint16_t tx_sent;
+    uint8_t tx_sequence;
+    bool tx_wait_fc;
+
+    // Response being reassembled
+    uint8_t rx_data[ISOTP_TESTER_MAX_LENGTH];
+    uint16_t rx_size;
+    uint16_t rx_received;
+    uint8_t rx_sequence;
+    uint8_t rx_block_count;
+    bool rx_active;
+    uint64_t rx_start_cycles;   // End of the first frame of the message
+
+    // Last complete response
+    uint8_t message[ISOTP_TESTER_MAX_LENGTH];
+    uint16_t message_length;
+    uint64_t message_start_cycles;
+    uint64_t message_end_cycles;
+
+    uint32_t messages;          // Responses completed
+    uint32_t sequence_errors;   // Messages broken by a missing or reordered frame
+    uint32_t flow_controls;     // Flow control frames received for our requests
+};
+
+/* --- Functions --- */
+/**
+ * @brief Adds the tester to the bus.
+ */
+void IsoTp_Tester_Init(IsoTp_Tester_t* tester, const char* name, const IsoTp_Tester_Config_t* config);
+
+/**
+ * @brief Starts sending a request.
+ * @retval false if the previous request still waits for flow control or the
+ *         request is too long.
+ */
+bool IsoTp_Tester_Request(IsoTp_Tester_t* tester, const uint8_t* data, uint16_t length);
+
+#endif /* TESTS_SIM_ISOTP_TESTER_H_ */
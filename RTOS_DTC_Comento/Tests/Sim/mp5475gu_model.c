@@ -0,0 +1,194 @@
+/*
+ * mp5475gu_model.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "mp5475gu_model.h"
+#include "sim_os.h"
+#include <string.h>
+
+/* --- Private Variables --- */
+static uint8_t model_registers[256];
+static const MP5475GU_Model_Step_t* model_script;
+static uint16_t model_step_count;
+static uint64_t model_script_start;
+static uint16_t model_adc;
+static bool model_adc_started;
+static uint32_t model_transfers;
+
+// Transfer in flight
+static bool model_busy;
+static bool model_read;
+static bool model_nack;
+static uint8_t model_reg;
+static uint8_t* model_data;
+static uint16_t model_size;
+static uint64_t model_end_cycles;
+static I2C_HandleTypeDef* model_hi2c;
+
+/* --- Private Function Prototypes --- */
+static uint64_t MP5475GU_Model_Next_Event(void);
+static void MP5475GU_Model_Run(void);
+static void MP5475GU_Model_Complete(void* context);
+static uint8_t MP5475GU_Model_Status_UV(void);
+static HAL_StatusTypeDef MP5475GU_Model_Start(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                              uint8_t* pData, uint16_t Size, bool read);
+
+/* --- Public Functions --- */
+
+void MP5475GU_Model_Reset(void)
+{
+    memset(model_registers, 0, sizeof(model_registers));
+    model_script = NULL;
+    model_step_count = 0;
+    model_adc = 0;
+    model_adc_started = false;
+    model_transfers = 0;
+    model_busy = false;
+    Sim_AddDevice(MP5475GU_Model_Next_Event, MP5475GU_Model_Run);
+}
+
+void MP5475GU_Model_Set_Script(const MP5475GU_Model_Step_t* script, uint16_t step_count)
+{
+    model_script = script;
+    model_step_count = step_count;
+    model_script_start = Sim_GetCycles();
+}
+
+uint8_t MP5475GU_Model_Get_Register(uint8_t reg)
+{
+    return model_registers[reg];
+}
+
+void MP5475GU_Model_Set_Adc(uint16_t raw)
+{
+    model_adc = raw;
+}
+
+uint32_t MP5475GU_Model_Get_Transfers(void)
+{
+    return model_transfers;
+}
+
+/* --- Device --- */
+
+static uint64_t MP5475GU_Model_Next_Event(void)
+{
+    return model_busy ? model_end_cycles : UINT64_MAX;
+}
+
+static void MP5475GU_Model_Run(void)
+{
+    if (model_busy && Sim_GetCycles() >= model_end_cycles) {
+        model_busy = false;
+        Sim_RunIsr(MP5475GU_Model_Complete, NULL);
+    }
+}
+
+/**
+ * @brief Ends the transfer: the data moves and the DMA callback runs.
+ */
+static void MP5475GU_Model_Complete(void* context)
+{
+    (void)context;
+    if (model_nack) {
+        HAL_I2C_ErrorCallback(model_hi2c);
+        return;
+    }
+    model_registers[MP5475GU_REG_STATUS_UV] = MP5475GU_Model_Status_UV();
+    for (uint16_t i = 0; i < model_size; i++) {
+        uint8_t reg = (uint8_t)(model_reg + i);
+        if (model_read) {
+            model_data[i] = model_registers[reg];
+        } else if (reg != MP5475GU_REG_STATUS_UV) {
+            model_registers[reg] = model_data[i];
+        }
+    }
+    model_transfers++;
+    if (model_read) {
+        HAL_I2C_MemRxCpltCallback(model_hi2c);
+    } else {
+        HAL_I2C_MemTxCpltCallback(model_hi2c);
+    }
+}
+
+static uint8_t MP5475GU_Model_Status_UV(void)
+{
+    uint64_t elapsed_ms = (Sim_GetCycles() - model_script_start) / SIM_CYCLES_PER_TICK;
+    uint8_t mask = 0;
+
+    for (uint16_t i = 0; i < model_step_count && model_script[i].time_ms <= elapsed_ms; i++) {
+        mask = model_script[i].uv_mask;
+    }
+    return mask;
+}
+
+/**
+ * @brief Clocks a register access: START, address, register, and for a
+ *        read a repeated START and the address again, then the data and
+ *        STOP. Nine clocks per byte with the acknowledge.
+ */
+static HAL_StatusTypeDef MP5475GU_Model_Start(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                              uint8_t* pData, uint16_t Size, bool read)
+{
+    uint32_t clocks;
+
+    if (model_busy) {
+        return HAL_BUSY;
+    }
+    model_busy = true;
+    model_read = read;
+    model_nack = (DevAddress != MP5475GU_I2C_ADDR);
+    model_reg = (uint8_t)MemAddress;
+    model_data = pData;
+    model_size = Size;
+    model_hi2c = hi2c;
+
+    if (model_nack) {
+        clocks = 1 + 9;
+    } else if (read) {
+        clocks = 1 + 9 + 9 + 1 + 9 + 9U * Size + 1;
+    } else {
+        clocks = 1 + 9 + 9 + 9U * Size + 1;
+    }
+    model_end_cycles = Sim_GetCycles() + (uint64_t)clocks * SIM_CPU_HZ / MP5475GU_MODEL_SCL_HZ;
+    return HAL_OK;
+}
+
+/* --- HAL --- */
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                        uint16_t MemAddSize, uint8_t* pData, uint16_t Size)
+{
+    (void)MemAddSize;
+    return MP5475GU_Model_Start(hi2c, DevAddress, MemAddress, pData, Size, false);
+}
+
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                       uint16_t MemAddSize, uint8_t* pData, uint16_t Size)
+{
+    (void)MemAddSize;
+    return MP5475GU_Model_Start(hi2c, DevAddress, MemAddress, pData, Size, true);
+}
+
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef* hadc)
+{
+    (void)hadc;
+    model_adc_started = true;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_ADC_PollForConversion(ADC_HandleTypeDef* hadc, uint32_t Timeout)
+{
+    (void)hadc;
+    (void)Timeout;
+    return model_adc_started ? HAL_OK : HAL_TIMEOUT;
+}
+
+uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef* hadc)
+{
+    (void)hadc;
+    model_adc_started = false;
+    return model_adc;
+}
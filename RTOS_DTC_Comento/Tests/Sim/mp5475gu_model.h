@@ -0,0 +1,64 @@
+/*
+ * mp5475gu_model.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef TESTS_SIM_MP5475GU_MODEL_H_
+#define TESTS_SIM_MP5475GU_MODEL_H_
+
+#include "mp5475gu_driver.h"
+#include <stdbool.h>
+
+/*
+ * Model of the MP5475GU on I2C1, behind HAL_I2C_Mem_Read_DMA and
+ * HAL_I2C_Mem_Write_DMA, plus the ADC1 channel sampled into freeze frames.
+ *
+ * The PMIC answers at MP5475GU_I2C_ADDR with a plain register file. Any
+ * other address is not acknowledged and ends in HAL_I2C_ErrorCallback.
+ * A transfer takes its bit time at MP5475GU_MODEL_SCL_HZ and completes
+ * from an interrupt, so the driver waits on its semaphore as on the board.
+ *
+ * Under-voltage faults are scripted: from each step's time on, STATUS_UV
+ * reads the step's bits, so a test knows the exact time each rail dropped.
+ * This replaces fault injection inside the driver.
+ */
+
+/* --- Defines --- */
+#define MP5475GU_MODEL_SCL_HZ   100000U     // I2C1 ClockSpeed in MX_I2C1_Init
+
+/* --- Types --- */
+typedef struct {
+    uint32_t time_ms;           // From MP5475GU_Model_Set_Script
+    uint8_t uv_mask;            // STATUS_UV from then on
+} MP5475GU_Model_Step_t;
+
+/* --- Functions --- */
+/**
+ * @brief Clears the registers and the script and registers the model with
+ *        the simulated kernel. Call after Sim_Reset.
+ */
+void MP5475GU_Model_Reset(void);
+
+/**
+ * @brief Starts a UV scenario now.
+ * @param script Steps sorted by time, kept until the next call.
+ */
+void MP5475GU_Model_Set_Script(const MP5475GU_Model_Step_t* script, uint16_t step_count);
+
+/**
+ * @brief Returns a register as the last write left it.
+ */
+uint8_t MP5475GU_Model_Get_Register(uint8_t reg);
+
+/**
+ * @brief Sets the value ADC1 conversions return.
+ */
+void MP5475GU_Model_Set_Adc(uint16_t raw);
+
+/**
+ * @brief Returns the number of completed I2C transfers.
+ */
+uint32_t MP5475GU_Model_Get_Transfers(void);
+
+#endif /* TESTS_SIM_MP5475GU_MODEL_H_ */
@@ -0,0 +1,949 @@
+/*
+ * sim_os.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "sim_os.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ucontext.h>
+
+/* --- Defines --- */
+#define SIM_MAX_OBJECTS     16      // Of each kernel object type
+#define SIM_MAX_THREADS     8
+#define SIM_MAX_IRQS        32
+#define SIM_MAX_DEVICES     4
+#define SIM_TASK_STACK_SIZE (256U * 1024U)  // Host stack of a task, whatever its target stack
+#define SIM_NEVER           UINT64_MAX
+
+#define osFlagsErrorTimeout 0xFFFFFFFEU
+#define osFlagsErrorResource 0xFFFFFFFDU
+
+/* --- Types --- */
+typedef struct {
+    bool used;
+    uint32_t count;
+    uint32_t max_count;
+} SimSemaphore_t;
+
+typedef struct {
+    bool used;
+    uint8_t* buffer;
+    uint32_t msg_size;
+    uint32_t msg_count;
+    uint32_t head;      // Next message to get
+    uint32_t length;    // Messages queued
+    uint32_t max_length;
+} SimQueue_t;
+
+typedef struct {
+    bool used;
+    uint8_t* blocks;
+    bool* allocated;
+    uint32_t block_size;
+    uint32_t block_count;
+} SimPool_t;
+
+typedef struct {
+    bool used;
+    osThreadId_t owner;
+} SimMutex_t;
+
+typedef struct {
+    osThreadId_t id;
+    uint32_t flags;
+} SimThread_t;
+
+// A task created with osThreadNew. It runs on a host stack of its own and
+// gives the CPU back to Sim_RunThreads whenever it waits.
+typedef struct {
+    bool used;
+    osThreadFunc_t func;
+    void* argument;
+    const char* name;
+    osPriority_t priority;
+    uint32_t stack_size;
+    void* stack;
+    ucontext_t context;
+    bool waiting;
+    bool (*ready)(void* context);   // NULL for a plain delay
+    void* ready_context;
+    uint64_t deadline;              // When the wait times out, SIM_NEVER for forever
+    bool seen_ready;
+    uint64_t ready_cycles;          // When it was first seen ready
+    Sim_ThreadStats_t stats;
+} SimTask_t;
+
+typedef struct {
+    uint64_t (*next_event)(void);
+    void (*run)(void);
+} SimDevice_t;
+
+typedef struct {
+    SimThread_t* thread;
+    uint32_t flags;
+    uint32_t options;
+} SimFlagsWait_t;
+
+/* --- Core registers and globals the Core modules link against --- */
+uint32_t SystemCoreClock = SIM_CPU_HZ;
+static DWT_Type sim_dwt;
+static CoreDebug_Type sim_core_debug;
+DWT_Type* DWT = &sim_dwt;
+CoreDebug_Type* CoreDebug = &sim_core_debug;
+
+static GPIO_TypeDef sim_gpio[3] = { { 0 }, { 1 }, { 2 } };
+GPIO_TypeDef* const GPIOA = &sim_gpio[0];
+GPIO_TypeDef* const GPIOB = &sim_gpio[1];
+GPIO_TypeDef* const GPIOC = &sim_gpio[2];
+
+int sim_check_failures;
+
+/* --- Private Variables --- */
+static uint64_t sim_cycles;
+static void (*sim_tick_hook)(void);
+static uint32_t sim_primask;
+static SimDevice_t sim_devices[SIM_MAX_DEVICES];
+
+static void (*sim_irq_handlers[SIM_MAX_IRQS])(void);
+static uint32_t sim_irq_pending;
+static uint32_t sim_isr_depth;
+
+static osThreadId_t sim_current_thread = (osThreadId_t)&sim_current_thread;
+static SimThread_t sim_threads[SIM_MAX_THREADS];
+static SimTask_t sim_tasks[SIM_MAX_THREADS];
+static SimTask_t* sim_running_task;     // NULL while the test itself runs
+static uint32_t sim_last_task;          // Round robin among equal priorities
+static ucontext_t sim_scheduler_context;
+
+static SimSemaphore_t sim_semaphores[SIM_MAX_OBJECTS];
+static SimMutex_t sim_mutexes[SIM_MAX_OBJECTS];
+static SimQueue_t sim_queues[SIM_MAX_OBJECTS];
+static SimPool_t sim_pools[SIM_MAX_OBJECTS];
+
+/* --- Private Function Prototypes --- */
+static void Sim_RunPendingIrqs(void);
+static void Sim_Step(uint64_t limit);
+static void Sim_RunDevices(void);
+static bool Sim_Wait(bool (*ready)(void* context), void* context, uint32_t timeout, const char* what);
+static SimThread_t* Sim_FindThread(osThreadId_t thread, bool create);
+static bool Sim_TaskRunnable(SimTask_t* task);
+static SimTask_t* Sim_NextTask(int32_t above_priority);
+static void Sim_Resume(SimTask_t* task);
+static void Sim_Yield(void);
+static void Sim_WatchTasks(void);
+static void Sim_Preempt(void);
+static void Sim_TaskEntry(void);
+
+/* --- Checks --- */
+
+int Sim_Result(const char* name)
+{
+    if (sim_check_failures != 0) {
+        printf("FAIL %s (%d failed checks)\n", name, sim_check_failures);
+        return 1;
+    }
+    printf("PASS %s\n", name);
+    return 0;
+}
+
+void Sim_Fatal(const char* message)
+{
+    fprintf(stderr, "fatal: %s\n", message);
+    exit(2);
+}
+
+/* --- Time --- */
+
+void Sim_Reset(void)
+{
+    for (uint32_t i = 0; i < SIM_MAX_OBJECTS; i++) {
+        free(sim_queues[i].buffer);
+        free(sim_pools[i].blocks);
+        free(sim_pools[i].allocated);
+    }
+    // Tasks left waiting are dropped with their stacks
+    for (uint32_t i = 0; i < SIM_MAX_THREADS; i++) {
+        free(sim_tasks[i].stack);
+    }
+    memset(sim_tasks, 0, sizeof(sim_tasks));
+    sim_running_task = NULL;
+    sim_last_task = 0;
+    memset(sim_semaphores, 0, sizeof(sim_semaphores));
+    memset(sim_mutexes, 0, sizeof(sim_mutexes));
+    memset(sim_queues, 0, sizeof(sim_queues));
+    memset(sim_pools, 0, sizeof(sim_pools));
+    memset(sim_threads, 0, sizeof(sim_threads));
+    memset(sim_irq_handlers, 0, sizeof(sim_irq_handlers));
+    sim_irq_pending = 0;
+    sim_isr_depth = 0;
+    sim_primask = 0;
+    sim_cycles = 0;
+    sim_tick_hook = NULL;
+    memset(sim_devices, 0, sizeof(sim_devices));
+    sim_dwt.CYCCNT = 0;
+    sim_dwt.CTRL = 0;
+    sim_current_thread = (osThreadId_t)&sim_current_thread;
+}
+
+void Sim_AdvanceCycles(uint64_t cycles)
+{
+    uint64_t remaining = cycles;
+
+    Sim_RunDevices();
+    while (remaining > 0) {
+        uint64_t start = sim_cycles;
+
+        Sim_Step(sim_cycles + remaining);
+        remaining -= sim_cycles - start;
+
+        // A task busy on the CPU is preempted by a higher priority task
+        // that became ready, and carries on once that one waits again
+        if (sim_running_task != NULL && !Sim_InIsr()) {
+            Sim_WatchTasks();
+            Sim_Preempt();
+        }
+    }
+}
+
+void Sim_AdvanceUs(uint32_t us)
+{
+    Sim_AdvanceCycles((uint64_t)us * (SIM_CPU_HZ / 1000000U));
+}
+
+uint64_t Sim_GetCycles(void)
+{
+    return sim_cycles;
+}
+
+uint64_t Sim_GetUs(void)
+{
+    return sim_cycles / (SIM_CPU_HZ / 1000000U);
+}
+
+void Sim_SetTickHook(void (*hook)(void))
+{
+    sim_tick_hook = hook;
+}
+
+void Sim_AddDevice(uint64_t (*next_event)(void), void (*run)(void))
+{
+    for (uint32_t i = 0; i < SIM_MAX_DEVICES; i++) {
+        if (sim_devices[i].run == NULL) {
+            sim_devices[i].next_event = next_event;
+            sim_devices[i].run = run;
+            return;
+        }
+    }
+    Sim_Fatal("too many devices");
+}
+
+/**
+ * @brief Moves time to the next tick, device event or limit, whichever is
+ *        first, and runs what is due there.
+ */
+static void Sim_Step(uint64_t limit)
+{
+    uint64_t next_tick = (sim_cycles / SIM_CYCLES_PER_TICK + 1) * SIM_CYCLES_PER_TICK;
+    uint64_t next = (next_tick < limit) ? next_tick : limit;
+
+    for (uint32_t i = 0; i < SIM_MAX_DEVICES; i++) {
+        if (sim_devices[i].run != NULL) {
+            uint64_t event = sim_devices[i].next_event();
+            if (event > sim_cycles && event < next) {
+                next = event;
+            }
+        }
+    }
+
+    if (sim_dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) {
+        sim_dwt.CYCCNT += (uint32_t)(next - sim_cycles);
+    }
+    sim_cycles = next;
+
+    if (sim_cycles == next_tick && sim_tick_hook != NULL) {
+        sim_isr_depth++;
+        sim_tick_hook();
+        sim_isr_depth--;
+        Sim_RunPendingIrqs();
+    }
+    Sim_RunDevices();
+}
+
+/**
+ * @brief Runs every device event due by now. Devices act as hardware: the
+ *        interrupts they pend run as soon as the CPU takes them.
+ */
+static void Sim_RunDevices(void)
+{
+    bool ran;
+
+    do {
+        ran = false;
+        for (uint32_t i = 0; i < SIM_MAX_DEVICES; i++) {
+            if (sim_devices[i].run != NULL && sim_devices[i].next_event() <= sim_cycles) {
+                sim_devices[i].run();
+                ran = true;
+            }
+        }
+    } while (ran);
+}
+
+/**
+ * @brief Blocks the running task until a condition holds or the timeout
+ *        expires. Time moves on meanwhile, so interrupts raised by devices
+ *        and ticks can satisfy the condition, and the task wakes as soon as
+ *        they do.
+ */
+static bool Sim_Wait(bool (*ready)(void* context), void* context, uint32_t timeout, const char* what)
+{
+    uint64_t deadline;
+
+    if (ready(context)) {
+        return true;
+    }
+    if (timeout == 0 || Sim_InIsr()) {
+        return false;
+    }
+    if (sim_running_task != NULL) {
+        // Blocked: the other tasks run until the condition holds or the
+        // timeout expires, and a wait forever is no deadlock
+        SimTask_t* task = sim_running_task;
+
+        task->ready = ready;
+        task->ready_context = context;
+        task->deadline = (timeout == osWaitForever) ? SIM_NEVER : sim_cycles + (uint64_t)timeout * SIM_CYCLES_PER_TICK;
+        task->waiting = true;
+        Sim_Yield();
+        return ready(context);
+    }
+    deadline = sim_cycles + (uint64_t)((timeout == osWaitForever) ? SIM_FOREVER_TICKS : timeout) * SIM_CYCLES_PER_TICK;
+    while (sim_cycles < deadline) {
+        Sim_Step(deadline);
+        if (ready(context)) {
+            return true;
+        }
+    }
+    if (timeout == osWaitForever) {
+        char message[64];
+        snprintf(message, sizeof(message), "deadlock: %s forever", what);
+        Sim_Fatal(message);
+    }
+    return false;
+}
+
+/* --- Interrupts --- */
+
+void Sim_SetIrqHandler(IRQn_Type irq, void (*handler)(void))
+{
+    sim_irq_handlers[irq] = handler;
+}
+
+void Sim_RunIsr(void (*handler)(void* context), void* context)
+{
+    sim_isr_depth++;
+    handler(context);
+    sim_isr_depth--;
+    Sim_RunPendingIrqs();
+}
+
+bool Sim_InIsr(void)
+{
+    return sim_isr_depth != 0;
+}
+
+static void Sim_RunPendingIrqs(void)
+{
+    // Only from task level: a handler pended by a handler runs when the
+    // outermost one returns
+    while (sim_isr_depth == 0 && sim_primask == 0 && sim_irq_pending != 0) {
+        uint32_t irq = __builtin_ctz(sim_irq_pending);
+
+        sim_irq_pending &= ~(1U << irq);
+        if (sim_irq_handlers[irq] != NULL) {
+            sim_isr_depth++;
+            sim_irq_handlers[irq]();
+            sim_isr_depth--;
+        }
+    }
+}
+
+uint32_t __get_PRIMASK(void)
+{
+    return sim_primask;
+}
+
+void __set_PRIMASK(uint32_t primask)
+{
+    sim_primask = primask;
+    Sim_RunPendingIrqs();
+}
+
+void __disable_irq(void)
+{
+    sim_primask = 1;
+}
+
+void __enable_irq(void)
+{
+    sim_primask = 0;
+    Sim_RunPendingIrqs();
+}
+
+uint32_t __get_IPSR(void)
+{
+    return Sim_InIsr() ? 16U : 0U;
+}
+
+void HAL_NVIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+    sim_irq_pending |= 1U << IRQn;
+    Sim_RunPendingIrqs();
+}
+
+uint32_t HAL_GetTick(void)
+{
+    return (uint32_t)(sim_cycles / SIM_CYCLES_PER_TICK);
+}
+
+void HAL_Delay(uint32_t Delay)
+{
+    Sim_AdvanceCycles((uint64_t)Delay * SIM_CYCLES_PER_TICK);
+}
+
+uint32_t HAL_RCC_GetPCLK1Freq(void)
+{
+    return SystemCoreClock;     // APB1 is not divided on this board
+}
+
+/* --- Kernel --- */
+
+uint32_t osKernelGetTickCount(void)
+{
+    return HAL_GetTick();
+}
+
+uint32_t osKernelGetTickFreq(void)
+{
+    return 1000U;
+}
+
+osStatus_t osDelay(uint32_t ticks)
+{
+    if (Sim_InIsr()) {
+        return osErrorISR;
+    }
+    if (sim_running_task != NULL) {
+        SimTask_t* task = sim_running_task;
+
+        task->ready = NULL;
+        task->deadline = sim_cycles + (uint64_t)ticks * SIM_CYCLES_PER_TICK;
+        task->waiting = true;
+        Sim_Yield();
+        return osOK;
+    }
+    Sim_AdvanceCycles((uint64_t)ticks * SIM_CYCLES_PER_TICK);
+    return osOK;
+}
+
+/* --- Threads --- */
+
+void Sim_SetCurrentThread(osThreadId_t thread)
+{
+    sim_current_thread = thread;
+}
+
+uint32_t Sim_GetThreadFlags(osThreadId_t thread)
+{
+    SimThread_t* t = Sim_FindThread(thread, false);
+    return (t != NULL) ? t->flags : 0;
+}
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void* argument, const osThreadAttr_t* attr)
+{
+    for (uint32_t i = 0; i < SIM_MAX_THREADS; i++) {
+        SimTask_t* task = &sim_tasks[i];
+
+        if (task->used) {
+            continue;
+        }
+        memset(task, 0, sizeof(*task));
+        task->used = true;
+        task->func = func;
+        task->argument = argument;
+        task->name = (attr != NULL) ? attr->name : NULL;
+        task->priority = (attr != NULL && attr->priority != 0) ? attr->priority : osPriorityNormal;
+        task->stack_size = (attr != NULL) ? attr->stack_size : 0;
+        task->stack = malloc(SIM_TASK_STACK_SIZE);
+        if (task->stack == NULL) {
+            Sim_Fatal("out of memory for a task stack");
+        }
+        getcontext(&task->context);
+        task->context.uc_stack.ss_sp = task->stack;
+        task->context.uc_stack.ss_size = SIM_TASK_STACK_SIZE;
+        task->context.uc_link = NULL;
+        makecontext(&task->context, Sim_TaskEntry, 0);
+        return task;
+    }
+    return NULL;
+}
+
+uint32_t osThreadGetStackSpace(osThreadId_t thread_id)
+{
+    // Host stacks say nothing about the target's, so all of it is free
+    SimTask_t* task = thread_id;
+    return (task != NULL) ? task->stack_size : 0;
+}
+
+void Sim_RunThreads(uint32_t duration_ms)
+{
+    uint64_t end = sim_cycles + (uint64_t)duration_ms * SIM_CYCLES_PER_TICK;
+
+    if (sim_running_task != NULL) {
+        Sim_Fatal("Sim_RunThreads called from a task");
+    }
+    Sim_RunDevices();
+    for (;;) {
+        SimTask_t* task;
+        uint64_t limit = end;
+
+        Sim_WatchTasks();
+        if (sim_cycles >= end) {
+            break;
+        }
+        task = Sim_NextTask(-1);
+        if (task != NULL) {
+            Sim_Resume(task);
+            continue;
+        }
+        // Idle: on to the next timeout, tick or device event
+        for (uint32_t i = 0; i < SIM_MAX_THREADS; i++) {
+            if (sim_tasks[i].used && sim_tasks[i].waiting &&
+                sim_tasks[i].deadline > sim_cycles && sim_tasks[i].deadline < limit) {
+                limit = sim_tasks[i].deadline;
+            }
+        }
+        Sim_Step(limit);
+    }
+}
+
+void Sim_GetThreadStats(osThreadId_t thread, Sim_ThreadStats_t* p_stats)
+{
+    SimTask_t* task = thread;
+
+    if (task != NULL && p_stats != NULL) {
+        *p_stats = task->stats;
+    }
+}
+
+/**
+ * @brief First code a task runs: its function, which must never return.
+ */
+static void Sim_TaskEntry(void)
+{
+    SimTask_t* task = sim_running_task;
+
+    task->func(task->argument);
+    Sim_Fatal("a task returned from its function");
+}
+
+/**
+ * @brief True if a task could run now: it is not waiting, or its wait is over.
+ */
+static bool Sim_TaskRunnable(SimTask_t* task)
+{
+    if (!task->used) {
+        return false;
+    }
+    if (!task->waiting) {
+        return true;
+    }
+    return sim_cycles >= task->deadline || (task->ready != NULL && task->ready(task->ready_context));
+}
+
+/**
+ * @brief Picks the highest priority runnable task above a priority, round
+ *        robin among equals. The running task is never picked.
+ */
+static SimTask_t* Sim_NextTask(int32_t above_priority)
+{
+    SimTask_t* best = NULL;
+
+    for (uint32_t n = 1; n <= SIM_MAX_THREADS; n++) {
+        SimTask_t* task = &sim_tasks[(sim_last_task + n) % SIM_MAX_THREADS];
+
+        if (task != sim_running_task && (int32_t)task->priority > above_priority &&
+            (best == NULL || task->priority > best->priority) && Sim_TaskRunnable(task)) {
+            best = task;
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Notes when each waiting task became ready, for its latency.
+ */
+static void Sim_WatchTasks(void)
+{
+    for (uint32_t i = 0; i < SIM_MAX_THREADS; i++) {
+        SimTask_t* task = &sim_tasks[i];
+
+        if (task->used && task->waiting && !task->seen_ready && Sim_TaskRunnable(task)) {
+            task->seen_ready = true;
+            task->ready_cycles = (sim_cycles >= task->deadline) ? task->deadline : sim_cycles;
+        }
+    }
+}
+
+/**
+ * @brief Gives the CPU to a task until it waits or is preempted.
+ */
+static void Sim_Resume(SimTask_t* task)
+{
+    if (task->seen_ready && sim_cycles - task->ready_cycles > task->stats.max_latency_cycles) {
+        task->stats.max_latency_cycles = sim_cycles - task->ready_cycles;
+    }
+    task->seen_ready = false;
+    task->waiting = false;
+    task->stats.runs++;
+    sim_last_task = (uint32_t)(task - sim_tasks);
+    sim_running_task = task;
+    swapcontext(&sim_scheduler_context, &task->context);
+    sim_running_task = NULL;
+}
+
+/**
+ * @brief Gives the CPU back to Sim_RunThreads. A task that is not waiting
+ *        was preempted and is ready from now on.
+ */
+static void Sim_Yield(void)
+{
+    SimTask_t* task = sim_running_task;
+
+    if (!task->waiting) {
+        task->seen_ready = true;
+        task->ready_cycles = sim_cycles;
+    }
+    swapcontext(&task->context, &sim_scheduler_context);
+}
+
+/**
+ * @brief Lets a higher priority task that the running task just made ready
+ *        run first, as the kernel would when a flag, semaphore, queue or
+ *        mutex wakes it.
+ */
+static void Sim_Preempt(void)
+{
+    if (sim_running_task != NULL && !Sim_InIsr() && Sim_NextTask(sim_running_task->priority) != NULL) {
+        sim_running_task->waiting = false;
+        Sim_Yield();
+    }
+}
+
+static SimThread_t* Sim_FindThread(osThreadId_t thread, bool create)
+{
+    SimThread_t* free_slot = NULL;
+
+    for (uint32_t i = 0; i < SIM_MAX_THREADS; i++) {
+        if (sim_threads[i].id == thread) {
+            return &sim_threads[i];
+        }
+        if (sim_threads[i].id == NULL && free_slot == NULL) {
+            free_slot = &sim_threads[i];
+        }
+    }
+    if (!create) {
+        return NULL;
+    }
+    if (free_slot == NULL) {
+        Sim_Fatal("too many threads");
+    }
+    free_slot->id = thread;
+    return free_slot;
+}
+
+osThreadId_t osThreadGetId(void)
+{
+    return (sim_running_task != NULL) ? (osThreadId_t)sim_running_task : sim_current_thread;
+}
+
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags)
+{
+    SimThread_t* t;
+
+    if (thread_id == NULL) {
+        return osFlagsErrorResource;
+    }
+    t = Sim_FindThread(thread_id, true);
+    t->flags |= flags;
+    flags = t->flags;
+    Sim_Preempt();
+    return flags;
+}
+
+uint32_t osThreadFlagsClear(uint32_t flags)
+{
+    SimThread_t* t = Sim_FindThread(osThreadGetId(), true);
+    uint32_t old = t->flags;
+
+    t->flags &= ~flags;
+    return old;
+}
+
+static bool Sim_FlagsRaised(void* context)
+{
+    SimFlagsWait_t* wait = context;
+    uint32_t raised = wait->thread->flags & wait->flags;
+
+    return (wait->options & osFlagsWaitAll) ? (raised == wait->flags) : (raised != 0);
+}
+
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout)
+{
+    SimFlagsWait_t wait = { Sim_FindThread(osThreadGetId(), true), flags, options };
+    uint32_t raised;
+
+    if (!Sim_Wait(Sim_FlagsRaised, &wait, timeout, "thread flags wait")) {
+        return (timeout == 0) ? osFlagsErrorResource : osFlagsErrorTimeout;
+    }
+    raised = wait.thread->flags & flags;
+    if ((options & osFlagsNoClear) == 0) {
+        wait.thread->flags &= ~raised;
+    }
+    return raised;
+}
+
+/* --- Semaphores and mutexes --- */
+
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t* attr)
+{
+    (void)attr;
+    for (uint32_t i = 0; i < SIM_MAX_OBJECTS; i++) {
+        if (!sim_semaphores[i].used) {
+            sim_semaphores[i].used = true;
+            sim_semaphores[i].count = initial_count;
+            sim_semaphores[i].max_count = max_count;
+            return &sim_semaphores[i];
+        }
+    }
+    return NULL;
+}
+
+static bool Sim_SemaphoreAvailable(void* context)
+{
+    return ((SimSemaphore_t*)context)->count > 0;
+}
+
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout)
+{
+    SimSemaphore_t* sem = semaphore_id;
+
+    if (sem == NULL) {
+        return osErrorParameter;
+    }
+    if (!Sim_Wait(Sim_SemaphoreAvailable, sem, timeout, "semaphore acquire")) {
+        return (timeout == 0) ? osErrorResource : osErrorTimeout;
+    }
+    sem->count--;
+    return osOK;
+}
+
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id)
+{
+    SimSemaphore_t* sem = semaphore_id;
+
+    if (sem == NULL) {
+        return osErrorParameter;
+    }
+    if (sem->count >= sem->max_count) {
+        return osErrorResource;
+    }
+    sem->count++;
+    Sim_Preempt();
+    return osOK;
+}
+
+osMutexId_t osMutexNew(const osMutexAttr_t* attr)
+{
+    (void)attr;
+    for (uint32_t i = 0; i < SIM_MAX_OBJECTS; i++) {
+        if (!sim_mutexes[i].used) {
+            sim_mutexes[i].used = true;
+            sim_mutexes[i].owner = NULL;
+            return &sim_mutexes[i];
+        }
+    }
+    return NULL;
+}
+
+static bool Sim_MutexFree(void* context)
+{
+    return ((SimMutex_t*)context)->owner == NULL;
+}
+
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout)
+{
+    SimMutex_t* mutex = mutex_id;
+
+    if (mutex == NULL) {
+        return osErrorParameter;
+    }
+    if (mutex->owner == osThreadGetId()) {
+        return osErrorResource;     // Not a recursive mutex
+    }
+    if (!Sim_Wait(Sim_MutexFree, mutex, timeout, "mutex acquire")) {
+        return (timeout == 0) ? osErrorResource : osErrorTimeout;
+    }
+    mutex->owner = osThreadGetId();
+    return osOK;
+}
+
+osStatus_t osMutexRelease(osMutexId_t mutex_id)
+{
+    SimMutex_t* mutex = mutex_id;
+
+    if (mutex == NULL) {
+        return osErrorParameter;
+    }
+    if (mutex->owner != osThreadGetId()) {
+        return osErrorResource;
+    }
+    mutex->owner = NULL;
+    Sim_Preempt();
+    return osOK;
+}
+
+/* --- Message queues --- */
+
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t* attr)
+{
+    (void)attr;
+    for (uint32_t i = 0; i < SIM_MAX_OBJECTS; i++) {
+        if (!sim_queues[i].used) {
+            sim_queues[i].used = true;
+            sim_queues[i].buffer = calloc(msg_count, msg_size);
+            sim_queues[i].msg_count = msg_count;
+            sim_queues[i].msg_size = msg_size;
+            sim_queues[i].head = 0;
+            sim_queues[i].length = 0;
+            return &sim_queues[i];
+        }
+    }
+    return NULL;
+}
+
+static bool Sim_QueueHasRoom(void* context)
+{
+    SimQueue_t* q = context;
+    return q->length < q->msg_count;
+}
+
+static bool Sim_QueueHasMessage(void* context)
+{
+    return ((SimQueue_t*)context)->length > 0;
+}
+
+osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void* msg_ptr, uint8_t msg_prio, uint32_t timeout)
+{
+    SimQueue_t* q = mq_id;
+    uint32_t tail;
+
+    (void)msg_prio;
+    if (q == NULL || msg_ptr == NULL) {
+        return osErrorParameter;
+    }
+    if (!Sim_Wait(Sim_QueueHasRoom, q, timeout, "message queue put")) {
+        return (timeout == 0) ? osErrorResource : osErrorTimeout;
+    }
+    tail = (q->head + q->length) % q->msg_count;
+    memcpy(q->buffer + tail * q->msg_size, msg_ptr, q->msg_size);
+    q->length++;
+    if (q->length > q->max_length) {
+        q->max_length = q->length;
+    }
+    Sim_Preempt();
+    return osOK;
+}
+
+osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void* msg_ptr, uint8_t* msg_prio, uint32_t timeout)
+{
+    SimQueue_t* q = mq_id;
+
+    if (q == NULL || msg_ptr == NULL) {
+        return osErrorParameter;
+    }
+    if (!Sim_Wait(Sim_QueueHasMessage, q, timeout, "message queue get")) {
+        return (timeout == 0) ? osErrorResource : osErrorTimeout;
+    }
+    memcpy(msg_ptr, q->buffer + q->head * q->msg_size, q->msg_size);
+    q->head = (q->head + 1) % q->msg_count;
+    q->length--;
+    if (msg_prio != NULL) {
+        *msg_prio = 0;
+    }
+    return osOK;
+}
+
+uint32_t osMessageQueueGetCount(osMessageQueueId_t mq_id)
+{
+    SimQueue_t* q = mq_id;
+    return (q != NULL) ? q->length : 0;
+}
+
+uint32_t Sim_GetQueueMaxCount(osMessageQueueId_t mq_id)
+{
+    SimQueue_t* q = mq_id;
+    return (q != NULL) ? q->max_length : 0;
+}
+
+/* --- Memory pools --- */
+
+osMemoryPoolId_t osMemoryPoolNew(uint32_t block_count, uint32_t block_size, const osMemoryPoolAttr_t* attr)
+{
+    (void)attr;
+    for (uint32_t i = 0; i < SIM_MAX_OBJECTS; i++) {
+        if (!sim_pools[i].used) {
+            sim_pools[i].used = true;
+            sim_pools[i].blocks = calloc(block_count, block_size);
+            sim_pools[i].allocated = calloc(block_count, sizeof(bool));
+            sim_pools[i].block_count = block_count;
+            sim_pools[i].block_size = block_size;
+            return &sim_pools[i];
+        }
+    }
+    return NULL;
+}
+
+void* osMemoryPoolAlloc(osMemoryPoolId_t mp_id, uint32_t timeout)
+{
+    SimPool_t* pool = mp_id;
+
+    (void)timeout;
+    if (pool == NULL) {
+        return NULL;
+    }
+    for (uint32_t i = 0; i < pool->block_count; i++) {
+        if (!pool->allocated[i]) {
+            pool->allocated[i] = true;
+            return pool->blocks + i * pool->block_size;
+        }
+    }
+    return NULL;
+}
+
+osStatus_t osMemoryPoolFree(osMemoryPoolId_t mp_id, void* block)
+{
+    SimPool_t* pool = mp_id;
+    uint32_t index;
+
+    if (pool == NULL || block == NULL) {
+        return osErrorParameter;
+    }
+    index = (uint32_t)((uint8_t*)block - pool->blocks) / pool->block_size;
+    if (index >= pool->block_count || !pool->allocated[index]) {
+        Sim_Fatal("memory pool: free of a block not allocated");
+    }
+    pool->allocated[index] = false;
+    return osOK;
+}
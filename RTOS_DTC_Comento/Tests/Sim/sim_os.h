@@ -0,0 +1,156 @@
+/*
+ * sim_os.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef TESTS_SIM_SIM_OS_H_
+#define TESTS_SIM_SIM_OS_H_
+
+#include "stm32f4xx_hal.h"
+#include "cmsis_os2.h"
+#include <stdbool.h>
+#include <stdio.h>
+
+/*
+ * Simulated kernel and core for host tests. Everything runs on the one
+ * host thread: time only moves when a model or the code under test waits
+ * (osDelay, a semaphore, queue or flag wait) or clocks bytes over a bus.
+ * While a task waits, device events and ticks go on and may end the wait
+ * early, as an interrupt waking the task would. A wait forever that nothing
+ * ends within SIM_FOREVER_TICKS is reported as a deadlock.
+ *
+ * The CPU runs at SIM_CPU_HZ, the HSI clock of the target, and the kernel
+ * ticks at 1 kHz, so DWT cycle counts come out as they would on the board.
+ *
+ * Tasks created with osThreadNew run under Sim_RunThreads, each on a host
+ * stack of its own. The highest priority task that is ready runs until it
+ * waits; code takes no time except where a model advances it, e.g. a
+ * polled transfer, and a higher priority task that becomes ready in such a
+ * stretch preempts it. Mutexes have owners and block their other takers.
+ */
+
+/* --- Defines --- */
+#define SIM_CPU_HZ          16000000U
+#define SIM_CYCLES_PER_TICK (SIM_CPU_HZ / 1000U)
+#define SIM_FOREVER_TICKS   60000U  // A wait forever still unsatisfied after this is a deadlock
+
+/* --- Checks --- */
+extern int sim_check_failures;
+
+#define SIM_CHECK(cond)                                                         \
+    do {                                                                        \
+        if (!(cond)) {                                                          \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            sim_check_failures++;                                               \
+        }                                                                       \
+    } while (0)
+
+#define SIM_CHECK_EQ(actual, expected)                                          \
+    do {                                                                        \
+        long long a_ = (long long)(actual), e_ = (long long)(expected);        \
+        if (a_ != e_) {                                                         \
+            fprintf(stderr, "%s:%d: check failed: %s == %lld, expected %lld\n", \
+                    __FILE__, __LINE__, #actual, a_, e_);                       \
+            sim_check_failures++;                                               \
+        }                                                                       \
+    } while (0)
+
+/**
+ * @brief Prints the verdict of a test program.
+ * @retval Exit status for main: 0 if every check passed.
+ */
+int Sim_Result(const char* name);
+
+/**
+ * @brief Stops the test with a message; for states the test cannot go on from.
+ */
+void Sim_Fatal(const char* message);
+
+/* --- Time --- */
+/**
+ * @brief Resets time, kernel objects, thread flags and interrupt state.
+ */
+void Sim_Reset(void);
+
+/**
+ * @brief Moves simulated time forward, running the tick hook at every tick.
+ */
+void Sim_AdvanceCycles(uint64_t cycles);
+void Sim_AdvanceUs(uint32_t us);
+
+/**
+ * @brief Simulated time since Sim_Reset.
+ */
+uint64_t Sim_GetCycles(void);
+uint64_t Sim_GetUs(void);
+
+/**
+ * @brief Sets a function called at every kernel tick, like SysTick_Handler.
+ */
+void Sim_SetTickHook(void (*hook)(void));
+
+/**
+ * @brief Adds a model that acts at times of its own, e.g. a bus.
+ * @param next_event Returns the time of the device's next event, in cycles;
+ *        UINT64_MAX if none. Time never moves past it without `run`.
+ * @param run Called once the event time is reached; it may pend interrupts.
+ */
+void Sim_AddDevice(uint64_t (*next_event)(void), void (*run)(void));
+
+/* --- Interrupts --- */
+/**
+ * @brief Sets the handler run when an interrupt is pended.
+ * @note A pended interrupt runs at once when pended from task level, and
+ *       when the running handler returns when pended from an interrupt.
+ */
+void Sim_SetIrqHandler(IRQn_Type irq, void (*handler)(void));
+
+/**
+ * @brief Runs a function as an interrupt handler, for models raising
+ *        peripheral interrupts. Nested calls run at once.
+ */
+void Sim_RunIsr(void (*handler)(void* context), void* context);
+
+/**
+ * @brief True while an interrupt handler runs.
+ */
+bool Sim_InIsr(void);
+
+/* --- Threads --- */
+/**
+ * @brief Sets the thread osThreadGetId returns, i.e. which task is running.
+ */
+void Sim_SetCurrentThread(osThreadId_t thread);
+
+/**
+ * @brief Returns the flags raised on a thread and not yet waited for.
+ */
+uint32_t Sim_GetThreadFlags(osThreadId_t thread);
+
+/**
+ * @brief Scheduling figures of a task created with osThreadNew.
+ */
+typedef struct {
+    uint32_t runs;                  // Times it was given the CPU
+    uint64_t max_latency_cycles;    // Longest it was ready without running
+} Sim_ThreadStats_t;
+
+/**
+ * @brief Runs the tasks created with osThreadNew for the given time, as
+ *        the kernel would. Tasks keep their state between calls.
+ */
+void Sim_RunThreads(uint32_t duration_ms);
+
+/**
+ * @brief Copies the scheduling figures of a task.
+ */
+void Sim_GetThreadStats(osThreadId_t thread, Sim_ThreadStats_t* p_stats);
+
+/* --- Kernel objects --- */
+/**
+ * @brief Most messages a queue has held at once.
+ */
+uint32_t Sim_GetQueueMaxCount(osMessageQueueId_t mq_id);
+
+#endif /* TESTS_SIM_SIM_OS_H_ */
@@ -0,0 +1,60 @@
+/*
+ * uart_model.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#include "uart_model.h"
+#include "sim_os.h"
+#include <string.h>
+
+// --- Private Variables ---
+static char output[UART_MODEL_CAPTURE_SIZE + 1];
+static uint32_t output_length;
+static UART_Model_Stats_t stats;
+
+// --- Public Functions ---
+
+void UART_Model_Reset(void)
+{
+    output[0] = '\0';
+    output_length = 0;
+    memset(&stats, 0, sizeof(stats));
+}
+
+const char* UART_Model_Get_Output(void)
+{
+    return output;
+}
+
+void UART_Model_Get_Stats(UART_Model_Stats_t* p_stats)
+{
+    *p_stats = stats;
+}
+
+// --- HAL ---
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size, uint32_t Timeout)
+{
+    uint64_t cycles;
+
+    (void)Timeout;
+    if (huart == NULL || pData == NULL || Size == 0 || huart->Init.BaudRate == 0) {
+        return HAL_ERROR;
+    }
+    for (uint16_t i = 0; i < Size; i++) {
+        if (output_length < UART_MODEL_CAPTURE_SIZE) {
+            output[output_length++] = (char)pData[i];
+            output[output_length] = '\0';
+        }
+        if (pData[i] == '\n') {
+            stats.lines++;
+        }
+    }
+    cycles = (uint64_t)Size * UART_MODEL_BITS_PER_BYTE * SIM_CPU_HZ / huart->Init.BaudRate;
+    stats.transmits++;
+    stats.bytes += Size;
+    stats.busy_cycles += cycles;
+    Sim_AdvanceCycles(cycles);
+    return HAL_OK;
+}
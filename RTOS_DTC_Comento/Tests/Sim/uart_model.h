@@ -0,0 +1,48 @@
+/*
+ * uart_model.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+#ifndef TESTS_SIM_UART_MODEL_H_
+#define TESTS_SIM_UART_MODEL_H_
+
+#include "stm32f4xx_hal.h"
+
+/*
+ * Model of UART4 behind HAL_UART_Transmit. The HAL polls the data register,
+ * so the call keeps the CPU for the whole frame time, ten bits per byte at
+ * the handle's Init.BaudRate. A higher priority task that becomes ready in
+ * the meantime preempts it, as on the board. The text sent is kept.
+ */
+
+/* --- Defines --- */
+#define UART_MODEL_BITS_PER_BYTE    10U     // Start, 8 data bits, stop
+#define UART_MODEL_CAPTURE_SIZE     4096U
+
+/* --- Types --- */
+typedef struct {
+    uint32_t transmits;         // HAL_UART_Transmit calls
+    uint32_t bytes;
+    uint32_t lines;             // Line feeds sent
+    uint64_t busy_cycles;       // Time spent sending
+} UART_Model_Stats_t;
+
+/* --- Functions --- */
+/**
+ * @brief Clears the captured text and the statistics.
+ */
+void UART_Model_Reset(void);
+
+/**
+ * @brief Returns the text sent since the reset, NUL terminated. Text past
+ *        UART_MODEL_CAPTURE_SIZE is counted but not kept.
+ */
+const char* UART_Model_Get_Output(void);
+
+/**
+ * @brief Copies the statistics.
+ */
+void UART_Model_Get_Stats(UART_Model_Stats_t* p_stats);
+
+#endif /* TESTS_SIM_UART_MODEL_H_ */
@@ -0,0 +1,16 @@
+/*
+ * cmsis_os.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * Host stand-in for the CMSIS-RTOS2 compatibility header.
+ */
+
+#ifndef TESTS_STUBS_CMSIS_OS_H_
+#define TESTS_STUBS_CMSIS_OS_H_
+
+#include "cmsis_os2.h"
+
+#endif /* TESTS_STUBS_CMSIS_OS_H_ */
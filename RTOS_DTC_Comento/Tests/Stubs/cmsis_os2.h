@@ -0,0 +1,90 @@
+/*
+ * cmsis_os2.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * Host stand-in for the CMSIS-RTOS2 API: only what the Core modules use.
+ * Implemented by Tests/Sim/sim_os.c on simulated time.
+ */
+
+#ifndef TESTS_STUBS_CMSIS_OS2_H_
+#define TESTS_STUBS_CMSIS_OS2_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum {
+    osOK = 0,
+    osError = -1,
+    osErrorTimeout = -2,
+    osErrorResource = -3,
+    osErrorParameter = -4,
+    osErrorNoMemory = -5,
+    osErrorISR = -6
+} osStatus_t;
+
+typedef void* osThreadId_t;
+typedef void* osSemaphoreId_t;
+typedef void* osMutexId_t;
+typedef void* osMessageQueueId_t;
+typedef void* osMemoryPoolId_t;
+
+typedef struct {
+    const char* name;
+} osSemaphoreAttr_t, osMutexAttr_t, osMessageQueueAttr_t, osMemoryPoolAttr_t;
+
+typedef enum {
+    osPriorityIdle = 1,
+    osPriorityLow = 8,
+    osPriorityBelowNormal = 16,
+    osPriorityNormal = 24,
+    osPriorityAboveNormal = 32,
+    osPriorityHigh = 40,
+    osPriorityRealtime = 48
+} osPriority_t;
+
+typedef void (*osThreadFunc_t)(void* argument);
+
+typedef struct {
+    const char* name;
+    uint32_t stack_size;
+    osPriority_t priority;
+} osThreadAttr_t;
+
+#define osWaitForever   0xFFFFFFFFU
+#define osFlagsWaitAny  0x00000000U
+#define osFlagsWaitAll  0x00000001U
+#define osFlagsNoClear  0x00000002U
+#define osFlagsError    0x80000000U
+
+uint32_t osKernelGetTickCount(void);
+uint32_t osKernelGetTickFreq(void);
+osStatus_t osDelay(uint32_t ticks);
+
+osThreadId_t osThreadNew(osThreadFunc_t func, void* argument, const osThreadAttr_t* attr);
+osThreadId_t osThreadGetId(void);
+uint32_t osThreadGetStackSpace(osThreadId_t thread_id);
+uint32_t osThreadFlagsSet(osThreadId_t thread_id, uint32_t flags);
+uint32_t osThreadFlagsClear(uint32_t flags);
+uint32_t osThreadFlagsWait(uint32_t flags, uint32_t options, uint32_t timeout);
+
+osSemaphoreId_t osSemaphoreNew(uint32_t max_count, uint32_t initial_count, const osSemaphoreAttr_t* attr);
+osStatus_t osSemaphoreAcquire(osSemaphoreId_t semaphore_id, uint32_t timeout);
+osStatus_t osSemaphoreRelease(osSemaphoreId_t semaphore_id);
+
+osMutexId_t osMutexNew(const osMutexAttr_t* attr);
+osStatus_t osMutexAcquire(osMutexId_t mutex_id, uint32_t timeout);
+osStatus_t osMutexRelease(osMutexId_t mutex_id);
+
+osMessageQueueId_t osMessageQueueNew(uint32_t msg_count, uint32_t msg_size, const osMessageQueueAttr_t* attr);
+osStatus_t osMessageQueuePut(osMessageQueueId_t mq_id, const void* msg_ptr, uint8_t msg_prio, uint32_t timeout);
+osStatus_t osMessageQueueGet(osMessageQueueId_t mq_id, void* msg_ptr, uint8_t* msg_prio, uint32_t timeout);
+uint32_t osMessageQueueGetCount(osMessageQueueId_t mq_id);
+
+osMemoryPoolId_t osMemoryPoolNew(uint32_t block_count, uint32_t block_size, const osMemoryPoolAttr_t* attr);
+void* osMemoryPoolAlloc(osMemoryPoolId_t mp_id, uint32_t timeout);
+osStatus_t osMemoryPoolFree(osMemoryPoolId_t mp_id, void* block);
+
+#endif /* TESTS_STUBS_CMSIS_OS2_H_ */
@@ -0,0 +1,267 @@
+/*
+ * stm32f4xx_hal.h
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * Host stand-in for the STM32F4 HAL: only the types, constants and
+ * functions the Core modules use. Values follow the F4 HAL where the
+ * modules depend on them (CAN register layout, error bits); the functions
+ * are implemented by the models in Tests/Sim.
+ */
+
+#ifndef TESTS_STUBS_STM32F4XX_HAL_H_
+#define TESTS_STUBS_STM32F4XX_HAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define __IO volatile
+#define __weak __attribute__((weak))
+
+typedef enum {
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum { DISABLE = 0U, ENABLE = !DISABLE } FunctionalState;
+typedef enum { RESET = 0U, SET = !RESET } FlagStatus;
+typedef enum { GPIO_PIN_RESET = 0U, GPIO_PIN_SET } GPIO_PinState;
+
+#define HAL_MAX_DELAY 0xFFFFFFFFU
+
+/* --- Core --- */
+typedef enum {
+    CAN1_TX_IRQn = 19,
+    CAN1_RX0_IRQn = 20,
+    CAN1_RX1_IRQn = 21,
+    CAN1_SCE_IRQn = 22
+} IRQn_Type;
+
+typedef struct {
+    __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+    __IO uint32_t CTRL;
+    __IO uint32_t CYCCNT;
+} DWT_Type;
+
+extern DWT_Type* DWT;
+extern CoreDebug_Type* CoreDebug;
+extern uint32_t SystemCoreClock;
+
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL << 0)
+
+uint32_t __get_PRIMASK(void);
+void __set_PRIMASK(uint32_t primask);
+void __disable_irq(void);
+void __enable_irq(void);
+uint32_t __get_IPSR(void);
+
+void HAL_NVIC_SetPendingIRQ(IRQn_Type IRQn);
+uint32_t HAL_GetTick(void);
+void HAL_Delay(uint32_t Delay);
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+
+/* --- GPIO --- */
+typedef struct {
+    uint32_t id;
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef* const GPIOA;
+extern GPIO_TypeDef* const GPIOB;
+extern GPIO_TypeDef* const GPIOC;
+
+#define GPIO_PIN_0  ((uint16_t)0x0001)
+#define GPIO_PIN_4  ((uint16_t)0x0010)
+
+void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
+
+/* --- SPI --- */
+typedef struct {
+    uint32_t id;
+} SPI_TypeDef;
+
+typedef struct {
+    SPI_TypeDef* Instance;
+} SPI_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_SPI_Transmit(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_TransmitReceive(SPI_HandleTypeDef* hspi, uint8_t* pTxData, uint8_t* pRxData,
+                                          uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_SPI_Transmit_DMA(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_SPI_Receive_DMA(SPI_HandleTypeDef* hspi, uint8_t* pData, uint16_t Size);
+void HAL_SPI_TxCpltCallback(SPI_HandleTypeDef* hspi);
+void HAL_SPI_RxCpltCallback(SPI_HandleTypeDef* hspi);
+
+/* --- I2C --- */
+typedef struct {
+    uint32_t id;
+} I2C_TypeDef;
+
+typedef struct {
+    I2C_TypeDef* Instance;
+} I2C_HandleTypeDef;
+
+#define I2C_MEMADD_SIZE_8BIT    0x00000001U
+
+HAL_StatusTypeDef HAL_I2C_Mem_Write_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                        uint16_t MemAddSize, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_DMA(I2C_HandleTypeDef* hi2c, uint16_t DevAddress, uint16_t MemAddress,
+                                       uint16_t MemAddSize, uint8_t* pData, uint16_t Size);
+void HAL_I2C_MemTxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_MemRxCpltCallback(I2C_HandleTypeDef* hi2c);
+void HAL_I2C_ErrorCallback(I2C_HandleTypeDef* hi2c);
+
+/* --- ADC --- */
+typedef struct {
+    uint32_t id;
+} ADC_TypeDef;
+
+typedef struct {
+    ADC_TypeDef* Instance;
+} ADC_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_ADC_Start(ADC_HandleTypeDef* hadc);
+HAL_StatusTypeDef HAL_ADC_PollForConversion(ADC_HandleTypeDef* hadc, uint32_t Timeout);
+uint32_t HAL_ADC_GetValue(ADC_HandleTypeDef* hadc);
+
+/* --- UART --- */
+typedef struct {
+    uint32_t id;
+} USART_TypeDef;
+
+typedef struct {
+    uint32_t BaudRate;
+} UART_InitTypeDef;
+
+typedef struct {
+    USART_TypeDef* Instance;
+    UART_InitTypeDef Init;
+} UART_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size, uint32_t Timeout);
+
+/* --- CAN --- */
+typedef struct {
+    uint32_t id;
+} CAN_TypeDef;
+
+typedef struct {
+    uint32_t Prescaler;
+    uint32_t Mode;
+    uint32_t SyncJumpWidth;
+    uint32_t TimeSeg1;
+    uint32_t TimeSeg2;
+    FunctionalState AutoRetransmission;
+    FunctionalState TransmitFifoPriority;
+} CAN_InitTypeDef;
+
+typedef struct {
+    CAN_TypeDef* Instance;
+    CAN_InitTypeDef Init;
+    __IO uint32_t ErrorCode;
+} CAN_HandleTypeDef;
+
+typedef struct {
+    uint32_t StdId;
+    uint32_t ExtId;
+    uint32_t IDE;
+    uint32_t RTR;
+    uint32_t DLC;
+    FunctionalState TransmitGlobalTime;
+} CAN_TxHeaderTypeDef;
+
+typedef struct {
+    uint32_t StdId;
+    uint32_t ExtId;
+    uint32_t IDE;
+    uint32_t RTR;
+    uint32_t DLC;
+    uint32_t Timestamp;
+    uint32_t FilterMatchIndex;
+} CAN_RxHeaderTypeDef;
+
+typedef struct {
+    uint32_t FilterIdHigh;
+    uint32_t FilterIdLow;
+    uint32_t FilterMaskIdHigh;
+    uint32_t FilterMaskIdLow;
+    uint32_t FilterFIFOAssignment;
+    uint32_t FilterBank;
+    uint32_t FilterMode;
+    uint32_t FilterScale;
+    uint32_t FilterActivation;
+    uint32_t SlaveStartFilterBank;
+} CAN_FilterTypeDef;
+
+#define CAN_BTR_TS1_Pos             16U
+#define CAN_BTR_TS2_Pos             20U
+#define CAN_BS1_1TQ                 0x00000000U
+#define CAN_BS2_1TQ                 0x00000000U
+
+#define CAN_ID_STD                  0x00000000U
+#define CAN_ID_EXT                  0x00000004U
+#define CAN_RTR_DATA                0x00000000U
+#define CAN_RTR_REMOTE              0x00000002U
+#define CAN_RX_FIFO0                0x00000000U
+#define CAN_RX_FIFO1                0x00000001U
+#define CAN_FILTER_FIFO0            0x00000000U
+#define CAN_FILTER_FIFO1            0x00000001U
+#define CAN_FILTERMODE_IDMASK       0x00000000U
+#define CAN_FILTERMODE_IDLIST       0x00000001U
+#define CAN_FILTERSCALE_16BIT       0x00000000U
+#define CAN_FILTERSCALE_32BIT       0x00000001U
+#define CAN_TX_MAILBOX0             0x00000001U
+#define CAN_TX_MAILBOX1             0x00000002U
+#define CAN_TX_MAILBOX2             0x00000004U
+
+#define CAN_IT_TX_MAILBOX_EMPTY     0x00000001U
+#define CAN_IT_RX_FIFO0_MSG_PENDING 0x00000002U
+#define CAN_IT_RX_FIFO0_FULL        0x00000004U
+#define CAN_IT_RX_FIFO0_OVERRUN     0x00000008U
+#define CAN_IT_RX_FIFO1_MSG_PENDING 0x00000010U
+#define CAN_IT_RX_FIFO1_FULL        0x00000020U
+#define CAN_IT_RX_FIFO1_OVERRUN     0x00000040U
+
+#define HAL_CAN_ERROR_NONE          0x00000000U
+#define HAL_CAN_ERROR_RX_FOV0       0x00000200U
+#define HAL_CAN_ERROR_RX_FOV1       0x00000400U
+#define HAL_CAN_ERROR_TX_ALST0      0x00000800U
+#define HAL_CAN_ERROR_TX_TERR0      0x00001000U
+#define HAL_CAN_ERROR_TX_ALST1      0x00002000U
+#define HAL_CAN_ERROR_TX_TERR1      0x00004000U
+#define HAL_CAN_ERROR_TX_ALST2      0x00008000U
+#define HAL_CAN_ERROR_TX_TERR2      0x00010000U
+#define HAL_CAN_ERROR_NOT_STARTED   0x00100000U
+#define HAL_CAN_ERROR_PARAM         0x00200000U
+
+HAL_StatusTypeDef HAL_CAN_ConfigFilter(CAN_HandleTypeDef* hcan, CAN_FilterTypeDef* sFilterConfig);
+HAL_StatusTypeDef HAL_CAN_Start(CAN_HandleTypeDef* hcan);
+HAL_StatusTypeDef HAL_CAN_ActivateNotification(CAN_HandleTypeDef* hcan, uint32_t ActiveITs);
+HAL_StatusTypeDef HAL_CAN_DeactivateNotification(CAN_HandleTypeDef* hcan, uint32_t InactiveITs);
+HAL_StatusTypeDef HAL_CAN_AddTxMessage(CAN_HandleTypeDef* hcan, CAN_TxHeaderTypeDef* pHeader,
+                                       uint8_t aData[], uint32_t* pTxMailbox);
+HAL_StatusTypeDef HAL_CAN_AbortTxRequest(CAN_HandleTypeDef* hcan, uint32_t TxMailboxes);
+uint32_t HAL_CAN_GetTxMailboxesFreeLevel(CAN_HandleTypeDef* hcan);
+HAL_StatusTypeDef HAL_CAN_GetRxMessage(CAN_HandleTypeDef* hcan, uint32_t RxFifo,
+                                       CAN_RxHeaderTypeDef* pHeader, uint8_t aData[]);
+uint32_t HAL_CAN_GetRxFifoFillLevel(CAN_HandleTypeDef* hcan, uint32_t RxFifo);
+uint32_t HAL_CAN_GetError(CAN_HandleTypeDef* hcan);
+HAL_StatusTypeDef HAL_CAN_ResetError(CAN_HandleTypeDef* hcan);
+void HAL_CAN_IRQHandler(CAN_HandleTypeDef* hcan);
+void HAL_CAN_TxMailbox0CompleteCallback(CAN_HandleTypeDef* hcan);
+void HAL_CAN_TxMailbox1CompleteCallback(CAN_HandleTypeDef* hcan);
+void HAL_CAN_TxMailbox2CompleteCallback(CAN_HandleTypeDef* hcan);
+void HAL_CAN_RxFifo0MsgPendingCallback(CAN_HandleTypeDef* hcan);
+void HAL_CAN_RxFifo0FullCallback(CAN_HandleTypeDef* hcan);
+void HAL_CAN_RxFifo1MsgPendingCallback(CAN_HandleTypeDef* hcan);
+void HAL_CAN_RxFifo1FullCallback(CAN_HandleTypeDef* hcan);
+void HAL_CAN_ErrorCallback(CAN_HandleTypeDef* hcan);
+
+#endif /* TESTS_STUBS_STM32F4XX_HAL_H_ */
@@ -0,0 +1,216 @@
+/*
+ * bench_eeprom.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * Access-pattern benchmark of the 25LC256 driver against the device
+ * model: sequential, random and page-straddling reads and writes, plus a
+ * record rewritten through eeprom_cache. Times are simulated, from the SPI
+ * clock and the write cycle time, and taken from the driver statistics as
+ * on the board. Every pattern is read back and checked, and the device
+ * must never see a command during a write cycle or a WRITE without WREN.
+ */
+
+#include "sim_os.h"
+#include "eeprom_model.h"
+#include "eeprom_25lc256.h"
+#include "eeprom_cache.h"
+#include "timebase.h"
+#include <string.h>
+
+/* --- Defines --- */
+#define BENCH_RANDOM_READS      1000
+#define BENCH_RANDOM_WRITES     200
+#define BENCH_SEQ_WRITE_PAGES   64
+#define BENCH_STRADDLE_WRITES   64
+#define BENCH_RECORD_UPDATES    32
+#define BENCH_RECORD_SIZE       76      // One DTC_Export record
+
+/* --- Private Variables --- */
+static SPI_HandleTypeDef bench_hspi = { .Instance = (SPI_TypeDef*)1 };
+static uint8_t bench_expected[EEPROM_TOTAL_SIZE];
+static uint8_t bench_buffer[EEPROM_TOTAL_SIZE];
+static uint32_t bench_seed = 0x2545F491U;
+
+/* --- Private Functions --- */
+
+static uint32_t Bench_Random(void)
+{
+    bench_seed ^= bench_seed << 13;
+    bench_seed ^= bench_seed >> 17;
+    bench_seed ^= bench_seed << 5;
+    return bench_seed;
+}
+
+static void Bench_Fill(uint8_t* p_data, uint16_t size)
+{
+    for (uint16_t i = 0; i < size; i++) {
+        p_data[i] = (uint8_t)Bench_Random();
+    }
+}
+
+static void Bench_Start(void)
+{
+    EEPROM_ResetStats();
+}
+
+/**
+ * @brief Prints one result line from the driver statistics.
+ */
+static void Bench_Report(const char* name)
+{
+    EEPROM_Stats_t s;
+    uint32_t calls;
+    uint32_t bytes;
+    uint64_t cycles;
+    uint64_t us;
+
+    EEPROM_GetStats(&s);
+    calls = s.read_calls + s.write_calls;
+    bytes = s.read_bytes + s.write_bytes;
+    cycles = s.read_cycles + s.write_cycles;
+    us = cycles / (SIM_CPU_HZ / 1000000U);
+    printf("%-26s %6u %7u %6u %9.1f %9.1f %8.1f %8u\n", name, (unsigned)calls, (unsigned)bytes,
+           (unsigned)s.write_pages, us / 1000.0, (us != 0) ? bytes * 1000.0 / us : 0.0,
+           (calls != 0) ? (double)us / calls : 0.0, (unsigned)Timebase_CyclesToUs(s.max_call_cycles));
+}
+
+static void Bench_CheckDevice(void)
+{
+    EEPROM_Model_Stats_t m;
+
+    EEPROM_Model_GetStats(&m);
+    SIM_CHECK_EQ(m.busy_commands, 0);
+    SIM_CHECK_EQ(m.unlatched_writes, 0);
+    SIM_CHECK_EQ(m.page_wraps, 0);
+    SIM_CHECK(memcmp(EEPROM_Model_GetArray(), bench_expected, EEPROM_TOTAL_SIZE) == 0);
+}
+
+/* --- Patterns --- */
+
+static void Bench_SequentialRead(uint16_t chunk)
+{
+    char name[32];
+
+    Bench_Start();
+    for (uint32_t address = 0; address < EEPROM_TOTAL_SIZE; address += chunk) {
+        SIM_CHECK(EEPROM_Read_DMA((uint16_t)address, &bench_buffer[address], chunk) == HAL_OK);
+    }
+    snprintf(name, sizeof(name), "sequential read %u B", chunk);
+    Bench_Report(name);
+    SIM_CHECK(memcmp(bench_buffer, bench_expected, EEPROM_TOTAL_SIZE) == 0);
+}
+
+static void Bench_RandomRead(uint16_t size)
+{
+    char name[32];
+
+    Bench_Start();
+    for (uint32_t i = 0; i < BENCH_RANDOM_READS; i++) {
+        uint16_t address = Bench_Random() % (EEPROM_TOTAL_SIZE - size);
+
+        SIM_CHECK(EEPROM_Read_DMA(address, bench_buffer, size) == HAL_OK);
+        SIM_CHECK(memcmp(bench_buffer, &bench_expected[address], size) == 0);
+    }
+    snprintf(name, sizeof(name), "random read %u B", size);
+    Bench_Report(name);
+}
+
+static void Bench_SequentialWrite(void)
+{
+    EEPROM_Stats_t s;
+
+    Bench_Start();
+    for (uint32_t page = 0; page < BENCH_SEQ_WRITE_PAGES; page++) {
+        uint16_t address = (uint16_t)(page * EEPROM_PAGE_SIZE);
+
+        Bench_Fill(&bench_expected[address], EEPROM_PAGE_SIZE);
+        SIM_CHECK(EEPROM_Write_DMA(address, &bench_expected[address], EEPROM_PAGE_SIZE) == HAL_OK);
+    }
+    Bench_Report("sequential write 64 B");
+    EEPROM_GetStats(&s);
+    SIM_CHECK_EQ(s.write_pages, BENCH_SEQ_WRITE_PAGES);
+}
+
+static void Bench_RandomWrite(uint16_t size)
+{
+    EEPROM_Stats_t s;
+    uint32_t straddles = 0;
+    char name[32];
+
+    Bench_Start();
+    for (uint32_t i = 0; i < BENCH_RANDOM_WRITES; i++) {
+        uint16_t address = Bench_Random() % (EEPROM_TOTAL_SIZE - size);
+
+        if (address / EEPROM_PAGE_SIZE != (address + size - 1) / EEPROM_PAGE_SIZE) {
+            straddles++;
+        }
+        Bench_Fill(&bench_expected[address], size);
+        SIM_CHECK(EEPROM_Write_DMA(address, &bench_expected[address], size) == HAL_OK);
+    }
+    snprintf(name, sizeof(name), "random write %u B", size);
+    Bench_Report(name);
+    EEPROM_GetStats(&s);
+    SIM_CHECK_EQ(s.write_pages, BENCH_RANDOM_WRITES + straddles);
+}
+
+static void Bench_StraddlingWrite(void)
+{
+    EEPROM_Stats_t s;
+
+    Bench_Start();
+    for (uint32_t i = 0; i < BENCH_STRADDLE_WRITES; i++) {
+        uint16_t address = (uint16_t)(8192 + i * EEPROM_PAGE_SIZE + EEPROM_PAGE_SIZE / 2);
+
+        Bench_Fill(&bench_expected[address], EEPROM_PAGE_SIZE);
+        SIM_CHECK(EEPROM_Write_DMA(address, &bench_expected[address], EEPROM_PAGE_SIZE) == HAL_OK);
+    }
+    Bench_Report("page-straddling write 64 B");
+    EEPROM_GetStats(&s);
+    SIM_CHECK_EQ(s.write_pages, 2 * BENCH_STRADDLE_WRITES);
+}
+
+static void Bench_CachedRecord(void)
+{
+    EEPROM_Cache_Stats_t c;
+    const uint16_t address = 16384 + 20;    // Spans two pages
+
+    EEPROM_Cache_Init(&(EEPROM_Cache_Policy_t){ 0, 0 });
+    Bench_Start();
+    for (uint32_t i = 0; i < BENCH_RECORD_UPDATES; i++) {
+        Bench_Fill(&bench_expected[address], 4);   // Only the first bytes change, like a status update
+        SIM_CHECK(EEPROM_Cache_Write(address, &bench_expected[address], BENCH_RECORD_SIZE) == HAL_OK);
+    }
+    SIM_CHECK(EEPROM_Cache_Sync() == HAL_OK);
+    Bench_Report("cached record 76 B x32");
+    EEPROM_Cache_GetStats(&c);
+    SIM_CHECK_EQ(c.page_flushes, 1);    // Only the first page changed
+}
+
+int main(void)
+{
+    Sim_Reset();
+    EEPROM_Model_Reset();
+    EEPROM_Init(&bench_hspi, GPIOC, GPIO_PIN_4);
+
+    // Start from known random contents, loaded behind the driver's back
+    Bench_Fill(bench_expected, EEPROM_TOTAL_SIZE);
+    memcpy(EEPROM_Model_GetArray(), bench_expected, EEPROM_TOTAL_SIZE);
+
+    printf("25LC256 at %u MHz SCK, tWC %u us\n", EEPROM_MODEL_SCK_HZ / 1000000U, EEPROM_MODEL_WRITE_TIME_US);
+    printf("%-26s %6s %7s %6s %9s %9s %8s %8s\n", "pattern", "calls", "bytes", "pages",
+           "time ms", "kB/s", "us/call", "max us");
+    Bench_SequentialRead(64);
+    Bench_SequentialRead(1024);
+    Bench_RandomRead(16);
+    Bench_RandomRead(76);
+    Bench_SequentialWrite();
+    Bench_RandomWrite(16);
+    Bench_StraddlingWrite();
+    Bench_CachedRecord();
+    Bench_CheckDevice();
+
+    return Sim_Result("bench_eeprom");
+}
@@ -0,0 +1,391 @@
+/*
+ * test_app_tasks.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * The firmware tasks of app_tasks.c, as main.c creates them, on the
+ * simulated kernel with every model attached: the PMIC and its ADC, the
+ * EEPROM, the UART and the CAN bus.
+ *
+ * A tester polls ReadDTCInformation at a steady rate, a listener takes the
+ * DTC broadcast and Buck B is under voltage for two seconds. For each rate
+ * the report gives the UDS response time against P2, the deepest CanQueue
+ * and RX pool use, and the longest time each task was ready without
+ * running. The tasks share CommMutexHandle and the CPU as on the board.
+ * CANRxTask must answer within P2 at every rate: it waits on nothing but
+ * CanQueue, and the printout and storage read it triggers run in UARTTask.
+ */
+
+#include "sim_os.h"
+#include "app_tasks.h"
+#include "can_bus.h"
+#include "can_filter_model.h"
+#include "eeprom_model.h"
+#include "isotp_tester.h"
+#include "mp5475gu_model.h"
+#include "uart_model.h"
+#include "can_manager.h"
+#include "dtc_manager.h"
+#include "eeprom_25lc256.h"
+#include "eeprom_cache.h"
+#include "eeprom_log.h"
+#include <string.h>
+
+#define TEST_DURATION_MS        6000
+#define TEST_DRAIN_MS           1000    // Polling stopped, so the last responses get out
+#define TEST_P2_MS              50      // P2server_max of ISO 14229-2
+#define TEST_DTC_PERIOD_MS      1000    // CANTask
+#define TEST_MAX_REQUESTS       1024
+#define TEST_MAX_QUEUE          2       // Frames in CanQueue: a request and the broadcast's flow control
+#define TEST_POWER_DOWN_MS      2550    // Buck B confirmed, mid I2CTask poll delay
+#define TEST_MAX_SAVE_MS        30      // PVD to cache synced; was up to 200 ms behind the I2C poll
+
+/* --- Private Variables --- */
+static SPI_HandleTypeDef hspi1 = { .Instance = (SPI_TypeDef*)1 };
+static I2C_HandleTypeDef hi2c1 = { .Instance = (I2C_TypeDef*)1 };
+static ADC_HandleTypeDef hadc1 = { .Instance = (ADC_TypeDef*)1 };
+static UART_HandleTypeDef huart4 = { .Instance = (USART_TypeDef*)1, .Init = { .BaudRate = 115200 } };
+static CAN_HandleTypeDef hcan1 = {
+    .Instance = (CAN_TypeDef*)1,
+    .Init = {
+        .Prescaler = 16,
+        .TimeSeg1 = CAN_BS1_1TQ,
+        .TimeSeg2 = CAN_BS2_1TQ,
+        .AutoRetransmission = ENABLE,
+        .TransmitFifoPriority = ENABLE,
+    },
+};
+
+// As in main.c
+static const osThreadAttr_t I2CTask_attributes = { .name = "I2CTask", .stack_size = 128 * 4, .priority = osPriorityNormal };
+static const osThreadAttr_t SPITask_attributes = { .name = "SPITask", .stack_size = 128 * 4, .priority = osPriorityNormal };
+static const osThreadAttr_t CANTask_attributes = { .name = "CANTask", .stack_size = 128 * 4, .priority = osPriorityNormal };
+static const osThreadAttr_t UARTTask_attributes = { .name = "UARTTask", .stack_size = 256 * 4, .priority = osPriorityBelowNormal };
+static const osThreadAttr_t CANRxTask_attributes = { .name = "CANRxTask", .stack_size = 256 * 4, .priority = osPriorityAboveNormal };
+// The tester is another ECU: it takes no simulated CPU time
+static const osThreadAttr_t tester_attributes = { .name = "tester", .stack_size = 0, .priority = osPriorityRealtime };
+
+static const MP5475GU_Model_Step_t scenario[] = {
+    { 1000, MP5475GU_UV_BUCK_B },
+    { 3000, 0 },
+};
+
+static App_Tasks_t app_tasks;
+static osMessageQueueId_t can_queue;
+static IsoTp_Tester_t tester;
+static IsoTp_Tester_t listener;
+
+static uint32_t poll_period_ms;
+static bool polling;
+static uint32_t requests_sent;
+static uint64_t request_cycles[TEST_MAX_REQUESTS];
+static uint32_t responses;
+static uint32_t bad_responses;
+static uint32_t busy_responses;
+static uint32_t late_responses;
+static uint64_t response_max_cycles;
+static uint64_t response_sum_cycles;
+
+/**
+ * @brief What one polling rate gave.
+ */
+typedef struct {
+    uint32_t period_ms;
+    uint32_t requests;
+    uint32_t responses;
+    uint32_t late;              // Over P2
+    uint32_t busy;              // NRC 0x21 busyRepeatRequest
+    double avg_ms;
+    double max_ms;
+    uint32_t queue_max;         // Most frames in CanQueue at once
+    uint32_t pool_empty;        // CAN_Manager_Stats_t.rx_pool_empty
+    uint32_t overruns;          // Frames lost in the RX FIFOs
+    uint32_t broadcasts;
+    double task_max_ms[5];      // Ready to running: I2C, SPI, CAN, UART, CAN RX
+} Test_Result_t;
+
+/* --- Hooks --- */
+
+static void Test_CAN1_TX_IRQHandler(void)
+{
+    HAL_CAN_IRQHandler(&hcan1);
+    CAN_Manager_TX_IRQHandler();
+}
+
+static void Test_CAN1_RX_IRQHandler(void)
+{
+    HAL_CAN_IRQHandler(&hcan1);
+}
+
+static void Test_On_Response(const IsoTp_Tester_t* t)
+{
+    // Responses come in request order; a lost request shows as a count
+    // mismatch below
+    if (responses < requests_sent) {
+        uint64_t cycles = t->message_end_cycles - request_cycles[responses];
+
+        response_sum_cycles += cycles;
+        if (cycles > response_max_cycles) {
+            response_max_cycles = cycles;
+        }
+        if (cycles > (uint64_t)TEST_P2_MS * SIM_CYCLES_PER_TICK) {
+            late_responses++;
+        }
+    }
+    if (t->message_length == 3 && t->message[0] == 0x7F && t->message[1] == 0x19 && t->message[2] == 0x21) {
+        busy_responses++;
+    } else if (t->message_length < 3 || t->message[0] != 0x59 || t->message[1] != 0x02) {
+        bad_responses++;
+    }
+    responses++;
+}
+
+/**
+ * @brief The tester: reportDTCByStatusMask every poll_period_ms, without
+ *        waiting for the response.
+ */
+static void Test_Tester_Task(void* argument)
+{
+    static const uint8_t request[] = { 0x19, 0x02, 0xFF };
+
+    (void)argument;
+    for (;;) {
+        if (polling && requests_sent < TEST_MAX_REQUESTS &&
+            IsoTp_Tester_Request(&tester, request, sizeof(request))) {
+            request_cycles[requests_sent++] = Sim_GetCycles();
+        }
+        osDelay(poll_period_ms);
+    }
+}
+
+static void Test_I2C_Task(void* argument)
+{
+    (void)argument;
+    App_I2C_Task();
+}
+
+static void Test_SPI_Task(void* argument)
+{
+    (void)argument;
+    App_SPI_Task();
+}
+
+static void Test_CAN_Task(void* argument)
+{
+    (void)argument;
+    App_CAN_Task();
+}
+
+static void Test_UART_Task(void* argument)
+{
+    (void)argument;
+    App_UART_Task();
+}
+
+static void Test_CAN_Rx_Task(void* argument)
+{
+    (void)argument;
+    App_CAN_Rx_Task();
+}
+
+/* --- Harness --- */
+
+/**
+ * @brief Power-up with a blank EEPROM, as main does it, up to osKernelStart.
+ */
+static void Test_Boot(void)
+{
+    static const IsoTp_Tester_Config_t tester_config = {
+        .request_id = CAN_DIAG_PHYSICAL_RECEIVE_ID,
+        .response_id = CAN_DIAG_TRANSMIT_ID,
+        .flow_control = true,
+        .on_message = Test_On_Response,
+    };
+    static const IsoTp_Tester_Config_t listener_config = {
+        .request_id = CAN_DTC_FLOW_CONTROL_ID,
+        .response_id = CAN_DTC_TRANSMIT_ID,
+        .flow_control = true,
+    };
+
+    Sim_Reset();
+    EEPROM_Model_Reset();
+    MP5475GU_Model_Reset();
+    UART_Model_Reset();
+    CAN_Filter_Model_Reset();
+    CAN_Bus_Reset(CAN_Manager_Get_Bitrate(&hcan1));
+    CAN_Bus_Attach_Controller(&hcan1);
+    IsoTp_Tester_Init(&tester, "tester", &tester_config);
+    IsoTp_Tester_Init(&listener, "listener", &listener_config);
+    Sim_SetIrqHandler(CAN1_TX_IRQn, Test_CAN1_TX_IRQHandler);
+    Sim_SetIrqHandler(CAN1_RX0_IRQn, Test_CAN1_RX_IRQHandler);
+    Sim_SetIrqHandler(CAN1_RX1_IRQn, Test_CAN1_RX_IRQHandler);
+    Sim_SetTickHook(CAN_Manager_Tick);
+
+    requests_sent = 0;
+    responses = 0;
+    bad_responses = 0;
+    busy_responses = 0;
+    late_responses = 0;
+    response_max_cycles = 0;
+    response_sum_cycles = 0;
+    polling = true;
+
+    mp5475gu_init();
+    EEPROM_Init(&hspi1, GPIOC, GPIO_PIN_4);
+    SIM_CHECK(CAN_Manager_Init(&hcan1) == HAL_OK);
+    can_queue = osMessageQueueNew(CAN_RX_POOL_SIZE, sizeof(void*), NULL);
+    SIM_CHECK(CAN_Manager_Start_Rx(can_queue) == HAL_OK);
+
+    app_tasks = (App_Tasks_t){
+        .hcan = &hcan1,
+        .hi2c = &hi2c1,
+        .hadc = &hadc1,
+        .huart = &huart4,
+        .comm_mutex = osMutexNew(NULL),
+        .i2c_task = osThreadNew(Test_I2C_Task, NULL, &I2CTask_attributes),
+        .spi_task = osThreadNew(Test_SPI_Task, NULL, &SPITask_attributes),
+        .can_task = osThreadNew(Test_CAN_Task, NULL, &CANTask_attributes),
+        .uart_task = osThreadNew(Test_UART_Task, NULL, &UARTTask_attributes),
+        .can_rx_task = osThreadNew(Test_CAN_Rx_Task, NULL, &CANRxTask_attributes),
+    };
+    SIM_CHECK(osThreadNew(Test_Tester_Task, NULL, &tester_attributes) != NULL);
+    SIM_CHECK(App_Tasks_Init(&app_tasks) == HAL_OK);
+}
+
+static void Test_Polling(uint32_t period_ms, Test_Result_t* r)
+{
+    osThreadId_t tasks[5];
+    CAN_Manager_Stats_t can;
+    Sim_ThreadStats_t ts;
+
+    poll_period_ms = period_ms;
+    Test_Boot();
+    MP5475GU_Model_Set_Script(scenario, sizeof(scenario) / sizeof(scenario[0]));
+    Sim_RunThreads(TEST_DURATION_MS);
+    polling = false;
+    Sim_RunThreads(TEST_DRAIN_MS);
+
+    CAN_Manager_Get_Stats(&can);
+    memset(r, 0, sizeof(*r));
+    r->period_ms = period_ms;
+    r->requests = requests_sent;
+    r->responses = responses;
+    r->late = late_responses;
+    r->busy = busy_responses;
+    r->avg_ms = responses ? (double)response_sum_cycles / responses / SIM_CYCLES_PER_TICK : 0;
+    r->max_ms = (double)response_max_cycles / SIM_CYCLES_PER_TICK;
+    r->queue_max = Sim_GetQueueMaxCount(can_queue);
+    r->pool_empty = can.rx_pool_empty;
+    r->overruns = can.rx_overruns;
+    r->broadcasts = listener.messages;
+    tasks[0] = app_tasks.i2c_task;
+    tasks[1] = app_tasks.spi_task;
+    tasks[2] = app_tasks.can_task;
+    tasks[3] = app_tasks.uart_task;
+    tasks[4] = app_tasks.can_rx_task;
+    for (int i = 0; i < 5; i++) {
+        Sim_GetThreadStats(tasks[i], &ts);
+        SIM_CHECK(ts.runs > 0);
+        r->task_max_ms[i] = (double)ts.max_latency_cycles / SIM_CYCLES_PER_TICK;
+    }
+
+    // Whatever the load, the firmware did its job: every answer it gave
+    // was right or busyRepeatRequest, Buck B's DTC was confirmed and saved, the broadcast went
+    // out every second and the debug printout ran
+    SIM_CHECK_EQ(bad_responses, 0);
+    SIM_CHECK(responses > 0);
+    SIM_CHECK(DTC_GetStatus(DTC_PMIC_BUCK_B_UNDERVOLTAGE) & 0x08);
+    SIM_CHECK(r->broadcasts >= (TEST_DURATION_MS + TEST_DRAIN_MS) / TEST_DTC_PERIOD_MS - 1);
+    SIM_CHECK(strstr(UART_Model_Get_Output(), "DTC Value: ") != NULL);
+
+    // CANRxTask only waits on CanQueue, so every request is answered within
+    // P2 and the RX pool never runs dry, whatever the other tasks hold
+    SIM_CHECK_EQ(r->responses, r->requests);
+    SIM_CHECK_EQ(r->late, 0);
+    SIM_CHECK_EQ(r->busy, 0);
+    SIM_CHECK(r->queue_max <= TEST_MAX_QUEUE);
+    SIM_CHECK_EQ(r->pool_empty, 0);
+    SIM_CHECK_EQ(r->overruns, 0);
+    SIM_CHECK(r->task_max_ms[4] < 1.0);
+}
+
+static void Test_PVD_Isr(void* context)
+{
+    (void)context;
+    App_Power_Down();
+}
+
+/* --- Tests --- */
+
+static void Test_Load(void)
+{
+    static const uint32_t periods_ms[] = { 200, 100, 50, 20, 10 };
+    Test_Result_t r;
+
+    printf("  poll ms | rsp/req  >P2 busy | avg ms  max ms | queue pool ovr | DTC | ready to run ms I2C   SPI   CAN  UART    RX\n");
+    for (uint32_t i = 0; i < sizeof(periods_ms) / sizeof(periods_ms[0]); i++) {
+        Test_Polling(periods_ms[i], &r);
+        printf("  %7u | %3u/%-3u %4u %4u | %6.1f %7.1f | %5u %4u %3u | %3u | %19.1f %5.1f %5.1f %5.1f %5.1f\n",
+               (unsigned)r.period_ms, (unsigned)r.responses, (unsigned)r.requests, (unsigned)r.late, (unsigned)r.busy,
+               r.avg_ms, r.max_ms, (unsigned)r.queue_max, (unsigned)r.pool_empty, (unsigned)r.overruns,
+               (unsigned)r.broadcasts, r.task_max_ms[0], r.task_max_ms[1], r.task_max_ms[2], r.task_max_ms[3], r.task_max_ms[4]);
+    }
+}
+
+/**
+ * @brief The PVD fires: SPITask ends the cycle, saves it and syncs the
+ *        cache straight away, and the record survives the power cut.
+ */
+static void Test_Power_Down(void)
+{
+    EEPROM_Log_Stats_t log;
+    uint8_t record[DTC_STORAGE_SIZE];
+    uint16_t length = 0;
+    uint32_t appends;
+    uint64_t start;
+    double save_ms;
+
+    poll_period_ms = 100;
+    Test_Boot();
+    MP5475GU_Model_Set_Script(scenario, sizeof(scenario) / sizeof(scenario[0]));
+    Sim_RunThreads(TEST_POWER_DOWN_MS);
+    SIM_CHECK(DTC_GetStatus(DTC_PMIC_BUCK_B_UNDERVOLTAGE) & DTC_STATUS_CONFIRMED);
+
+    EEPROM_Log_GetStats(&log);
+    appends = log.appends;
+    start = Sim_GetCycles();
+    Sim_RunIsr(Test_PVD_Isr, NULL);
+    for (uint32_t ms = 0; ms < 1000; ms++) {
+        EEPROM_Log_GetStats(&log);
+        if (log.appends > appends && EEPROM_Cache_GetDirtyCount() == 0) {
+            break;
+        }
+        Sim_RunThreads(1);
+    }
+    save_ms = (double)(Sim_GetCycles() - start) / SIM_CYCLES_PER_TICK;
+    printf("  power down: saved and synced in %.1f ms\n", save_ms);
+    SIM_CHECK(log.appends > appends);
+    SIM_CHECK_EQ(EEPROM_Cache_GetDirtyCount(), 0);
+    SIM_CHECK(save_ms < TEST_MAX_SAVE_MS);
+
+    // Power cut: the record in the EEPROM holds the ended cycle
+    Sim_Reset();
+    EEPROM_Model_Restart();
+    EEPROM_Init(&hspi1, GPIOC, GPIO_PIN_4);
+    EEPROM_Cache_Init(&(EEPROM_Cache_Policy_t){ DTC_PERSIST_WINDOW_MS, EEPROM_CACHE_MAX_DIRTY });
+    SIM_CHECK(EEPROM_Log_Init() == HAL_OK);
+    SIM_CHECK(EEPROM_Log_ReadLatest(record, sizeof(record), &length) == HAL_OK);
+    DTC_Init(record, length);
+    SIM_CHECK(DTC_GetStatus(DTC_PMIC_BUCK_B_UNDERVOLTAGE) & DTC_STATUS_CONFIRMED);
+    SIM_CHECK(DTC_GetStatus(DTC_PMIC_BUCK_B_UNDERVOLTAGE) & DTC_STATUS_TEST_NOT_COMPLETED_THIS_OP_CYCLE);
+    SIM_CHECK_EQ(DTC_GetStatus(DTC_PMIC_BUCK_B_UNDERVOLTAGE) & DTC_STATUS_TEST_FAILED_THIS_OP_CYCLE, 0);
+}
+
+int main(void)
+{
+    Test_Load();
+    Test_Power_Down();
+    return Sim_Result("test_app_tasks");
+}
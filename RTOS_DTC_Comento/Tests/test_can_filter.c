@@ -0,0 +1,179 @@
+/*
+ * test_can_filter.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * Unit tests of can_filter against the bxCAN filter bank model: every bank
+ * layout accepts its entries and nothing next to them, and the bank count
+ * follows the table as entries come and go.
+ */
+
+#include "sim_os.h"
+#include "can_filter_model.h"
+#include "can_filter.h"
+#include "can_manager.h"
+
+/* --- Private Variables --- */
+static CAN_HandleTypeDef test_hcan;
+
+static bool Test_Accepts(uint32_t id, uint32_t ide)
+{
+    return CAN_Filter_Model_Match(id, ide, NULL);
+}
+
+/* --- Tests --- */
+
+static void Test_Defaults(void)
+{
+    CAN_Filter_Model_Reset();
+    SIM_CHECK(CAN_Filter_Init(&test_hcan) == HAL_OK);
+    SIM_CHECK(CAN_Filter_GetBanksUsed() > 0);
+    SIM_CHECK_EQ(CAN_Filter_Model_GetActiveBanks(), CAN_Filter_GetBanksUsed());
+
+    SIM_CHECK(Test_Accepts(CAN_DIAG_RECEIVE_ID, CAN_ID_EXT));
+    SIM_CHECK(!Test_Accepts(CAN_DIAG_RECEIVE_ID + 1, CAN_ID_EXT));
+    SIM_CHECK(!Test_Accepts(CAN_DIAG_RECEIVE_ID & 0x7FFU, CAN_ID_STD));
+    SIM_CHECK(Test_Accepts(CAN_OBD_FUNCTIONAL_RECEIVE_ID, CAN_ID_STD));
+    SIM_CHECK(Test_Accepts(CAN_OBD_PHYSICAL_RECEIVE_ID, CAN_ID_STD));
+
+    // Physical requests only when they are addressed to us
+    SIM_CHECK(Test_Accepts(CAN_DIAG_PHYSICAL_RECEIVE_ID, CAN_ID_EXT));
+    SIM_CHECK(!Test_Accepts(0x18DA10F1, CAN_ID_EXT));
+    SIM_CHECK(!Test_Accepts(0x7E1, CAN_ID_STD));
+
+    // Nothing this ECU does not handle
+    SIM_CHECK(!Test_Accepts(0x18FECA21, CAN_ID_EXT));           // J1939 DM1
+    SIM_CHECK(!Test_Accepts(0x18EAFF21, CAN_ID_EXT));           // J1939 global request
+    SIM_CHECK(Test_Accepts(CAN_DTC_FLOW_CONTROL_ID, CAN_ID_EXT));
+    SIM_CHECK(!Test_Accepts(CAN_DTC_TRANSMIT_ID, CAN_ID_EXT));   // Our own broadcast
+    SIM_CHECK(!Test_Accepts(CAN_DIAG_TRANSMIT_ID, CAN_ID_EXT));  // Our own responses
+    SIM_CHECK(!Test_Accepts(0x123, CAN_ID_STD));
+}
+
+static void Test_Layouts(void)
+{
+    static const CAN_Filter_Entry_t entries[] = {
+        { 0x100, CAN_FILTER_STD_EXACT, CAN_ID_STD },
+        { 0x101, CAN_FILTER_STD_EXACT, CAN_ID_STD },
+        { 0x102, CAN_FILTER_STD_EXACT, CAN_ID_STD },
+        { 0x103, CAN_FILTER_STD_EXACT, CAN_ID_STD },
+        { 0x7FF, CAN_FILTER_STD_EXACT, CAN_ID_STD },     // Fifth: a second list bank
+        { 0x200, 0x7F0, CAN_ID_STD },                    // 0x200-0x20F
+        { 0x340, 0x7FC, CAN_ID_STD },                    // 0x340-0x343
+        { 0x500, 0x7FF & ~0x100U, CAN_ID_STD },          // 0x500 and 0x400
+        { 0x1ABCDEF0, CAN_FILTER_EXT_EXACT, CAN_ID_EXT },
+        { 0x00000001, CAN_FILTER_EXT_EXACT, CAN_ID_EXT },
+        { 0x1FFFFFFF, CAN_FILTER_EXT_EXACT, CAN_ID_EXT },
+        { 0x0CF00400, 0x03FFFF00, CAN_ID_EXT },          // PGN 0xF004 from any source
+    };
+    uint32_t fifo_count[2] = { 0, 0 };
+    uint32_t fifo;
+
+    CAN_Filter_Model_Reset();
+    SIM_CHECK(CAN_Filter_Init(&test_hcan) == HAL_OK);
+    for (uint32_t i = 0; i < sizeof(entries) / sizeof(entries[0]); i++) {
+        SIM_CHECK(CAN_Filter_Add(&entries[i]) == HAL_OK);
+        SIM_CHECK(CAN_Filter_Add(&entries[i]) == HAL_OK);   // Not added twice
+    }
+    SIM_CHECK(CAN_Filter_Apply() == HAL_OK);
+    SIM_CHECK_EQ(CAN_Filter_Model_GetActiveBanks(), CAN_Filter_GetBanksUsed());
+
+    // Exact 11-bit IDs, with the unused slots of the second bank
+    for (uint32_t id = 0x100; id <= 0x103; id++) {
+        SIM_CHECK(Test_Accepts(id, CAN_ID_STD));
+    }
+    SIM_CHECK(Test_Accepts(0x7FF, CAN_ID_STD));
+    SIM_CHECK(!Test_Accepts(0x104, CAN_ID_STD));
+    SIM_CHECK(!Test_Accepts(0x7FE, CAN_ID_STD));
+    SIM_CHECK(!Test_Accepts(0x000, CAN_ID_STD));
+
+    // Masked 11-bit IDs
+    for (uint32_t id = 0x200; id <= 0x20F; id++) {
+        SIM_CHECK(Test_Accepts(id, CAN_ID_STD));
+    }
+    SIM_CHECK(!Test_Accepts(0x210, CAN_ID_STD));
+    SIM_CHECK(!Test_Accepts(0x1FF, CAN_ID_STD));
+    SIM_CHECK(Test_Accepts(0x343, CAN_ID_STD));
+    SIM_CHECK(!Test_Accepts(0x344, CAN_ID_STD));
+    SIM_CHECK(Test_Accepts(0x400, CAN_ID_STD));
+    SIM_CHECK(Test_Accepts(0x500, CAN_ID_STD));
+    SIM_CHECK(!Test_Accepts(0x501, CAN_ID_STD));
+
+    // 29-bit IDs, exact and masked
+    SIM_CHECK(Test_Accepts(0x1ABCDEF0, CAN_ID_EXT));
+    SIM_CHECK(!Test_Accepts(0x1ABCDEF1, CAN_ID_EXT));
+    SIM_CHECK(!Test_Accepts(0x0ABCDEF0, CAN_ID_EXT));
+    SIM_CHECK(Test_Accepts(0x00000001, CAN_ID_EXT));
+    SIM_CHECK(Test_Accepts(0x1FFFFFFF, CAN_ID_EXT));
+    SIM_CHECK(Test_Accepts(0x0CF00400, CAN_ID_EXT));
+    SIM_CHECK(Test_Accepts(0x18F004F9, CAN_ID_EXT));
+    SIM_CHECK(!Test_Accepts(0x18F005F9, CAN_ID_EXT));
+
+    // The IDE bit takes part: an 11-bit ID never matches a 29-bit entry
+    SIM_CHECK(!Test_Accepts(0x001, CAN_ID_STD));
+    SIM_CHECK(!Test_Accepts(0x100, CAN_ID_EXT));
+    SIM_CHECK(!Test_Accepts(0x100U << 18, CAN_ID_EXT));
+    SIM_CHECK(!Test_Accepts(0x200U << 18, CAN_ID_EXT));     // In a masked 11-bit bank
+
+    // Both FIFOs take a share
+    for (uint32_t i = 0; i < sizeof(entries) / sizeof(entries[0]); i++) {
+        if (CAN_Filter_Model_Match(entries[i].id, entries[i].ide, &fifo)) {
+            fifo_count[fifo]++;
+        }
+    }
+    SIM_CHECK(fifo_count[0] > 0 && fifo_count[1] > 0);
+}
+
+static void Test_AddRemove(void)
+{
+    CAN_Filter_Entry_t entry = { 0x321, CAN_FILTER_STD_EXACT, CAN_ID_STD };
+    uint8_t banks;
+    uint32_t calls;
+
+    CAN_Filter_Model_Reset();
+    SIM_CHECK(CAN_Filter_Init(&test_hcan) == HAL_OK);
+    banks = CAN_Filter_GetBanksUsed();
+
+    SIM_CHECK(CAN_Filter_Add(&entry) == HAL_OK);
+    SIM_CHECK(!Test_Accepts(0x321, CAN_ID_STD));    // Not before Apply
+    SIM_CHECK(CAN_Filter_Apply() == HAL_OK);
+    SIM_CHECK(Test_Accepts(0x321, CAN_ID_STD));
+
+    // Removed entries stop matching and their banks are switched off
+    SIM_CHECK(CAN_Filter_Remove(0x321, CAN_ID_STD) == HAL_OK);
+    SIM_CHECK(CAN_Filter_Remove(0x321, CAN_ID_STD) == HAL_ERROR);
+    SIM_CHECK(CAN_Filter_Remove(0x321, CAN_ID_EXT) == HAL_ERROR);
+    SIM_CHECK(CAN_Filter_Apply() == HAL_OK);
+    SIM_CHECK(!Test_Accepts(0x321, CAN_ID_STD));
+    SIM_CHECK_EQ(CAN_Filter_GetBanksUsed(), banks);
+    SIM_CHECK_EQ(CAN_Filter_Model_GetActiveBanks(), banks);
+
+    // More masked 29-bit entries than banks: the hardware is left alone
+    for (uint32_t i = 0; i < CAN_FILTER_BANK_COUNT; i++) {
+        entry = (CAN_Filter_Entry_t){ 0x10000000U + (i << 8), 0x1FFFFF00U, CAN_ID_EXT };
+        SIM_CHECK(CAN_Filter_Add(&entry) == HAL_OK);
+    }
+    calls = CAN_Filter_Model_GetConfigCalls();
+    SIM_CHECK(CAN_Filter_Apply() == HAL_ERROR);
+    SIM_CHECK_EQ(CAN_Filter_Model_GetConfigCalls(), calls);
+    SIM_CHECK_EQ(CAN_Filter_GetBanksUsed(), banks);
+    SIM_CHECK(!Test_Accepts(0x10000000U, CAN_ID_EXT));
+
+    // The table holds CAN_FILTER_MAX_ENTRIES entries
+    for (uint32_t i = 0; i < CAN_FILTER_MAX_ENTRIES; i++) {
+        entry = (CAN_Filter_Entry_t){ 0x600 + i, CAN_FILTER_STD_EXACT, CAN_ID_STD };
+        (void)CAN_Filter_Add(&entry);
+    }
+    entry = (CAN_Filter_Entry_t){ 0x6FF, CAN_FILTER_STD_EXACT, CAN_ID_STD };
+    SIM_CHECK(CAN_Filter_Add(&entry) == HAL_ERROR);
+}
+
+int main(void)
+{
+    Test_Defaults();
+    Test_Layouts();
+    Test_AddRemove();
+    return Sim_Result("test_can_filter");
+}
@@ -0,0 +1,389 @@
+/*
+ * test_can_isotp.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * ISO-TP segmentation in can_manager on an otherwise idle virtual CAN bus.
+ *
+ * A listener takes the DTC broadcast and a tester sends diagnostic requests,
+ * each on its own link. The tests cover flow control with BS and STmin,
+ * WAIT and OVERFLOW, the N_Bs timeout, a first frame that finds the
+ * transmit queue full, a diagnostic response overtaking a broadcast that
+ * waits for flow control, a segmented request, and a request that arrives
+ * while the previous response is still pending, and the 11-bit and
+ * physical request IDs with the NRCs a functional request does not get.
+ */
+
+#include "sim_os.h"
+#include "can_bus.h"
+#include "can_filter_model.h"
+#include "isotp_tester.h"
+#include "can_manager.h"
+#include "dtc_manager.h"
+#include "uds_server.h"
+#include <string.h>
+
+#define TEST_P2_MS              50
+#define TEST_PAYLOAD_SIZE       40      // First frame and five consecutive frames
+
+/* --- Private Variables --- */
+// As MX_CAN1_Init configures it
+static CAN_HandleTypeDef hcan1 = {
+    .Instance = (CAN_TypeDef*)1,
+    .Init = {
+        .Prescaler = 16,
+        .TimeSeg1 = CAN_BS1_1TQ,
+        .TimeSeg2 = CAN_BS2_1TQ,
+        .AutoRetransmission = ENABLE,
+        .TransmitFifoPriority = ENABLE,
+    },
+};
+
+static IsoTp_Tester_t tester;
+static IsoTp_Tester_t listener;
+static int flow_node;               // Sends hand-made flow control for the broadcast
+static uint8_t payload[TEST_PAYLOAD_SIZE];
+
+// Consecutive frames of the broadcast as they ended on the bus
+static uint64_t cf_end_cycles[16];
+static uint32_t cf_count;
+
+/* --- Interrupts, as in stm32f4xx_it.c --- */
+
+static void Test_CAN1_TX_IRQHandler(void)
+{
+    HAL_CAN_IRQHandler(&hcan1);
+    CAN_Manager_TX_IRQHandler();
+}
+
+static void Test_CAN1_RX_IRQHandler(void)
+{
+    HAL_CAN_IRQHandler(&hcan1);
+}
+
+/* --- Bus observers --- */
+
+static void Test_Watch(void* context, const CAN_Bus_Frame_t* frame, uint64_t end_cycles)
+{
+    (void)context;
+    if (frame->ide == CAN_ID_EXT && frame->id == CAN_DTC_TRANSMIT_ID &&
+        (frame->data[0] & 0xF0) == 0x20 && cf_count < 16) {
+        cf_end_cycles[cf_count++] = end_cycles;
+    }
+}
+
+/* --- Harness --- */
+
+static void Test_Boot(uint8_t block_size, uint8_t st_min, bool flow_control)
+{
+    IsoTp_Tester_Config_t tester_config = {
+        .request_id = CAN_DIAG_RECEIVE_ID,
+        .response_id = CAN_DIAG_TRANSMIT_ID,
+        .flow_control = true,
+    };
+    IsoTp_Tester_Config_t listener_config = {
+        .request_id = CAN_DTC_FLOW_CONTROL_ID,
+        .response_id = CAN_DTC_TRANSMIT_ID,
+        .block_size = block_size,
+        .st_min = st_min,
+        .flow_control = flow_control,
+    };
+
+    Sim_Reset();
+    CAN_Filter_Model_Reset();
+    hcan1.ErrorCode = HAL_CAN_ERROR_NONE;
+    CAN_Bus_Reset(CAN_Manager_Get_Bitrate(&hcan1));
+    CAN_Bus_Attach_Controller(&hcan1);
+    IsoTp_Tester_Init(&tester, "tester", &tester_config);
+    IsoTp_Tester_Init(&listener, "listener", &listener_config);
+    flow_node = CAN_Bus_Add_Node("flow", Test_Watch, NULL);
+    cf_count = 0;
+
+    Sim_SetIrqHandler(CAN1_TX_IRQn, Test_CAN1_TX_IRQHandler);
+    Sim_SetIrqHandler(CAN1_RX0_IRQn, Test_CAN1_RX_IRQHandler);
+    Sim_SetIrqHandler(CAN1_RX1_IRQn, Test_CAN1_RX_IRQHandler);
+    Sim_SetTickHook(CAN_Manager_Tick);
+
+    DTC_Init(NULL, 0);
+    SIM_CHECK(CAN_Manager_Init(&hcan1) == HAL_OK);
+    SIM_CHECK(CAN_Manager_Start_Rx(osMessageQueueNew(CAN_RX_POOL_SIZE, sizeof(void*), NULL)) == HAL_OK);
+
+    for (uint32_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 13 + 1);
+    }
+}
+
+/**
+ * @brief Runs the consumer task for the given time.
+ */
+static void Test_Run(uint32_t ms)
+{
+    uint32_t start = HAL_GetTick();
+
+    while (HAL_GetTick() - start < ms) {
+        CAN_Manager_Process_Rx(1);
+    }
+}
+
+static void Test_Send_Flow_Control(uint8_t flow_status)
+{
+    CAN_Bus_Frame_t frame = { CAN_DTC_FLOW_CONTROL_ID, CAN_ID_EXT, 8, { 0x30 | flow_status, 0, 0 } };
+
+    CAN_Bus_Send(flow_node, &frame);
+}
+
+static bool Test_Broadcast_Received(void)
+{
+    return listener.messages == 1 && listener.message_length == sizeof(payload) &&
+           memcmp(listener.message, payload, sizeof(payload)) == 0;
+}
+
+/* --- Tests --- */
+
+/**
+ * @brief Blocks of two, 5 ms apart: a flow control per block and the gap between frames.
+ */
+static void Test_Block_Size_And_St_Min(void)
+{
+    CAN_Manager_Stats_t s;
+
+    Test_Boot(2, 5, true);
+    SIM_CHECK(CAN_Manager_Transmit_DTC(&hcan1, payload, sizeof(payload)) == HAL_OK);
+    Test_Run(100);
+
+    SIM_CHECK(Test_Broadcast_Received());
+    SIM_CHECK_EQ(listener.sequence_errors, 0);
+    SIM_CHECK_EQ(cf_count, (sizeof(payload) - 6 + 6) / 7);
+    for (uint32_t i = 1; i < cf_count; i++) {
+        SIM_CHECK(cf_end_cycles[i] - cf_end_cycles[i - 1] >= 5ULL * SIM_CYCLES_PER_TICK);
+    }
+    CAN_Manager_Get_Stats(&s);
+    SIM_CHECK_EQ(s.tx_errors, 0);
+
+    // The slot is free again for the next broadcast
+    SIM_CHECK(CAN_Manager_Transmit_DTC(&hcan1, payload, sizeof(payload)) == HAL_OK);
+}
+
+/**
+ * @brief WAIT restarts N_Bs; OVERFLOW aborts and frees the slot.
+ */
+static void Test_Wait_And_Overflow(void)
+{
+    CAN_Manager_Stats_t s;
+
+    Test_Boot(0, 0, false);
+    SIM_CHECK(CAN_Manager_Transmit_DTC(&hcan1, payload, sizeof(payload)) == HAL_OK);
+    Test_Run(CAN_ISOTP_TIMEOUT_MS - 200);
+    Test_Send_Flow_Control(0x01);
+    Test_Run(CAN_ISOTP_TIMEOUT_MS - 200);
+    Test_Send_Flow_Control(0x00);
+    Test_Run(50);
+    SIM_CHECK(Test_Broadcast_Received());
+    CAN_Manager_Get_Stats(&s);
+    SIM_CHECK_EQ(s.tx_errors, 0);
+
+    SIM_CHECK(CAN_Manager_Transmit_DTC(&hcan1, payload, sizeof(payload)) == HAL_OK);
+    Test_Run(10);
+    SIM_CHECK(CAN_Manager_Transmit_DTC(&hcan1, payload, sizeof(payload)) == HAL_BUSY);
+    Test_Send_Flow_Control(0x02);
+    Test_Run(10);
+    CAN_Manager_Get_Stats(&s);
+    SIM_CHECK_EQ(s.tx_errors, 1);
+    SIM_CHECK_EQ(cf_count, (sizeof(payload) - 6 + 6) / 7);
+    SIM_CHECK(CAN_Manager_Transmit_DTC(&hcan1, payload, sizeof(payload)) == HAL_OK);
+}
+
+/**
+ * @brief No flow control at all: N_Bs ends the broadcast, while diagnostic
+ *        responses keep meeting P2 on their own link.
+ */
+static void Test_Response_Overtakes_Broadcast(void)
+{
+    static const uint8_t request[] = { UDS_SID_READ_DTC_INFORMATION, UDS_RDTCI_REPORT_SUPPORTED_DTC };
+    CAN_Manager_Stats_t s;
+    uint64_t sent;
+
+    Test_Boot(0, 0, false);
+    SIM_CHECK(CAN_Manager_Transmit_DTC(&hcan1, payload, sizeof(payload)) == HAL_OK);
+    Test_Run(10);
+
+    for (uint32_t i = 0; i < 5; i++) {
+        SIM_CHECK(IsoTp_Tester_Request(&tester, request, sizeof(request)));
+        sent = Sim_GetCycles();
+        Test_Run(100);
+        SIM_CHECK_EQ(tester.messages, i + 1);
+        SIM_CHECK(tester.message_end_cycles - sent < (uint64_t)TEST_P2_MS * SIM_CYCLES_PER_TICK);
+        SIM_CHECK_EQ(tester.message[0], UDS_SID_READ_DTC_INFORMATION + UDS_POSITIVE_RESPONSE_OFFSET);
+    }
+    SIM_CHECK_EQ(tester.sequence_errors, 0);
+
+    Test_Run(CAN_ISOTP_TIMEOUT_MS);
+    CAN_Manager_Get_Stats(&s);
+    SIM_CHECK_EQ(s.tx_errors, 1);
+    SIM_CHECK_EQ(listener.messages, 0);
+    SIM_CHECK(CAN_Manager_Transmit_DTC(&hcan1, payload, sizeof(payload)) == HAL_OK);
+}
+
+/**
+ * @brief A broadcast whose first frame finds the queue full stays ready
+ *        and goes out once there is room.
+ */
+static void Test_Queue_Full_At_Start(void)
+{
+    static const uint8_t data[8] = { 0 };
+    CAN_Manager_Stats_t s;
+    uint32_t queued = 0;
+
+    Test_Boot(0, 0, true);
+    while (CAN_Manager_Transmit_Frame(0x7FF, CAN_ID_STD, data, 8, CAN_TX_PRIORITY_NORMAL) == HAL_OK) {
+        queued++;
+    }
+    SIM_CHECK(queued >= CAN_TX_QUEUE_SIZE);
+    SIM_CHECK(CAN_Manager_Transmit_DTC(&hcan1, payload, sizeof(payload)) == HAL_OK);
+    CAN_Manager_Get_Stats(&s);
+    SIM_CHECK(s.tx_queue_full >= 2);
+
+    Test_Run(100);
+    SIM_CHECK(Test_Broadcast_Received());
+    CAN_Manager_Get_Stats(&s);
+    SIM_CHECK_EQ(s.tx_errors, 0);
+    SIM_CHECK_EQ(s.tx_frames, queued + 1 + (sizeof(payload) - 6 + 6) / 7);
+}
+
+/**
+ * @brief A segmented request is granted with flow control on the response ID
+ *        and answered.
+ */
+static void Test_Segmented_Request(void)
+{
+    uint8_t request[12] = { UDS_SID_READ_DTC_INFORMATION, UDS_RDTCI_REPORT_SUPPORTED_DTC };
+
+    Test_Boot(0, 0, true);
+    SIM_CHECK(IsoTp_Tester_Request(&tester, request, sizeof(request)));
+    Test_Run(50);
+
+    SIM_CHECK_EQ(tester.flow_controls, 1);
+    SIM_CHECK_EQ(tester.messages, 1);
+    SIM_CHECK_EQ(tester.message_length, 3);
+    SIM_CHECK_EQ(tester.message[0], UDS_SID_NEGATIVE_RESPONSE);
+    SIM_CHECK_EQ(tester.message[2], UDS_NRC_INCORRECT_LENGTH);
+    SIM_CHECK_EQ(listener.messages, 0);
+}
+
+/**
+ * @brief A request that arrives while the previous response is still
+ *        waiting for flow control is answered with busyRepeatRequest.
+ */
+static void Test_Busy_Repeat_Request(void)
+{
+    static const uint8_t request[] = { UDS_SID_READ_DTC_INFORMATION, UDS_RDTCI_REPORT_SUPPORTED_DTC };
+
+    Test_Boot(0, 0, true);
+    tester.config.flow_control = false;
+    SIM_CHECK(IsoTp_Tester_Request(&tester, request, sizeof(request)));
+    Test_Run(10);
+    SIM_CHECK_EQ(tester.messages, 0);
+    SIM_CHECK(tester.rx_active);
+
+    SIM_CHECK(IsoTp_Tester_Request(&tester, request, sizeof(request)));
+    Test_Run(10);
+    SIM_CHECK_EQ(tester.messages, 1);
+    SIM_CHECK_EQ(tester.message_length, 3);
+    SIM_CHECK_EQ(tester.message[0], UDS_SID_NEGATIVE_RESPONSE);
+    SIM_CHECK_EQ(tester.message[1], UDS_SID_READ_DTC_INFORMATION);
+    SIM_CHECK_EQ(tester.message[2], UDS_NRC_BUSY_REPEAT_REQUEST);
+
+    // Once N_Bs has ended the first response the request is served again
+    Test_Run(CAN_ISOTP_TIMEOUT_MS);
+    tester.config.flow_control = true;
+    SIM_CHECK(IsoTp_Tester_Request(&tester, request, sizeof(request)));
+    Test_Run(50);
+    SIM_CHECK_EQ(tester.messages, 2);
+    SIM_CHECK_EQ(tester.message[0], UDS_SID_READ_DTC_INFORMATION + UDS_POSITIVE_RESPONSE_OFFSET);
+}
+
+/**
+ * @brief Requests on the 11-bit and the physical 29-bit IDs are answered on
+ *        the link they came in on; physical requests to another ECU are not.
+ */
+static void Test_Addressing(void)
+{
+    static const uint8_t request[] = { UDS_SID_READ_DTC_INFORMATION, UDS_RDTCI_REPORT_SUPPORTED_DTC };
+    static const uint8_t unsupported[] = { 0x22, 0xF1, 0x90 };
+    static const IsoTp_Tester_Config_t obd_config = {
+        .request_id = CAN_OBD_PHYSICAL_RECEIVE_ID,
+        .response_id = CAN_OBD_TRANSMIT_ID,
+        .standard_ids = true,
+        .flow_control = true,
+    };
+    static const IsoTp_Tester_Config_t obd_functional_config = {
+        .request_id = CAN_OBD_FUNCTIONAL_RECEIVE_ID,
+        .response_id = CAN_OBD_TRANSMIT_ID,
+        .standard_ids = true,
+        .flow_control = false,  // obd answers for both, a second flow control would collide
+    };
+    static const IsoTp_Tester_Config_t physical_config = {
+        .request_id = CAN_DIAG_PHYSICAL_RECEIVE_ID,
+        .response_id = CAN_DIAG_TRANSMIT_ID,
+        .flow_control = true,
+    };
+    static const IsoTp_Tester_Config_t other_ecu_config = {
+        .request_id = 0x18DA10F1,
+        .response_id = 0x18DAF110,
+        .flow_control = true,
+    };
+    IsoTp_Tester_t* testers[4];
+    IsoTp_Tester_t obd;
+    IsoTp_Tester_t obd_functional;
+    IsoTp_Tester_t physical;
+    IsoTp_Tester_t other_ecu;
+
+    Test_Boot(0, 0, true);
+    IsoTp_Tester_Init(&obd, "obd", &obd_config);
+    IsoTp_Tester_Init(&obd_functional, "obd functional", &obd_functional_config);
+    IsoTp_Tester_Init(&physical, "physical", &physical_config);
+    IsoTp_Tester_Init(&other_ecu, "other ecu", &other_ecu_config);
+    testers[0] = &obd;
+    testers[1] = &obd_functional;
+    testers[2] = &physical;
+    testers[3] = &other_ecu;
+
+    // One at a time: the 11-bit testers share the response ID
+    for (uint32_t i = 0; i < 4; i++) {
+        SIM_CHECK(IsoTp_Tester_Request(testers[i], request, sizeof(request)));
+        Test_Run(50);
+    }
+    SIM_CHECK_EQ(obd.messages, 2);
+    SIM_CHECK_EQ(obd_functional.messages, 2);
+    SIM_CHECK_EQ(obd.message[0], UDS_SID_READ_DTC_INFORMATION + UDS_POSITIVE_RESPONSE_OFFSET);
+    SIM_CHECK_EQ(obd.message_length, 3 + 4 * DTC_CODE_COUNT);
+    SIM_CHECK_EQ(physical.messages, 1);
+    SIM_CHECK_EQ(physical.message_length, 3 + 4 * DTC_CODE_COUNT);
+    SIM_CHECK_EQ(other_ecu.messages, 0);
+    SIM_CHECK_EQ(tester.messages, 1);  // Also listens on CAN_DIAG_TRANSMIT_ID
+    SIM_CHECK_EQ(obd.sequence_errors + obd_functional.sequence_errors + physical.sequence_errors, 0);
+
+    // An unsupported service is rejected on a physical request only
+    SIM_CHECK(IsoTp_Tester_Request(&obd_functional, unsupported, sizeof(unsupported)));
+    Test_Run(50);
+    SIM_CHECK_EQ(obd_functional.messages, 2);
+    SIM_CHECK(IsoTp_Tester_Request(&physical, unsupported, sizeof(unsupported)));
+    Test_Run(50);
+    SIM_CHECK_EQ(physical.messages, 2);
+    SIM_CHECK_EQ(physical.message_length, 3);
+    SIM_CHECK_EQ(physical.message[2], UDS_NRC_SERVICE_NOT_SUPPORTED);
+}
+
+int main(void)
+{
+    Test_Block_Size_And_St_Min();
+    Test_Wait_And_Overflow();
+    Test_Response_Overtakes_Broadcast();
+    Test_Queue_Full_At_Start();
+    Test_Segmented_Request();
+    Test_Busy_Repeat_Request();
+    Test_Addressing();
+    return Sim_Result("test_can_isotp");
+}
@@ -0,0 +1,343 @@
+/*
+ * test_can_load.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * Multi-node load test of can_manager on the virtual CAN bus.
+ *
+ * The ECU runs can_manager, can_filter and the UDS server behind the
+ * simulated bxCAN with the bit timing and interrupt wiring of the firmware.
+ * A tester asks for the supported DTCs every 100 ms and a second node takes
+ * the 1 s DTC broadcast on its own ISO-TP link, while two other ECUs load
+ * the bus with periodic frames: one with 11-bit IDs that win arbitration
+ * against ours, one with priority 7 J1939 DM1 frames that lose against ours
+ * and that the filter banks keep out of the receive path. Each load level
+ * prints the response latency, what arrived intact, and the loss counters
+ * of both sides, and checks that the CAN Manager's statistics agree with
+ * what the bus saw and that the ECU's messages get through the load.
+ */
+
+#include "sim_os.h"
+#include "can_bus.h"
+#include "can_filter_model.h"
+#include "isotp_tester.h"
+#include "can_manager.h"
+#include "dtc_manager.h"
+#include "uds_server.h"
+#include <string.h>
+
+#define TEST_DURATION_MS        10000
+#define TEST_REQUEST_PERIOD_MS  100
+#define TEST_DTC_PERIOD_MS      1000    // StartCANTask
+#define TEST_CONSUMER_WORK_US   4000    // UARTTask printing one line after a command
+#define TEST_P2_MS              50
+#define TEST_BACKGROUND_IDS     4       // Periodic frames per background node
+#define TEST_MIN_DELIVERY_PCT   95      // UDS responses that must arrive at any load
+
+/* --- Private Variables --- */
+// As MX_CAN1_Init configures it
+static CAN_HandleTypeDef hcan1 = {
+    .Instance = (CAN_TypeDef*)1,
+    .Init = {
+        .Prescaler = 16,
+        .TimeSeg1 = CAN_BS1_1TQ,
+        .TimeSeg2 = CAN_BS2_1TQ,
+        .AutoRetransmission = ENABLE,
+        .TransmitFifoPriority = ENABLE,
+    },
+};
+
+static IsoTp_Tester_t tester;
+static IsoTp_Tester_t listener;     // Receives the DTC broadcast
+static int ecu_node;
+static uint8_t dtc_payload[DTC_STORAGE_SIZE];
+
+// Per load level
+static uint32_t requests_sent;
+static uint64_t request_sent_cycles;
+static uint32_t responses;
+static uint32_t responses_late;
+static uint64_t response_latency_max;
+static uint64_t response_latency_sum;
+static uint32_t dtc_queued;
+static uint32_t dtc_received;
+static uint32_t messages_damaged;
+
+/* --- Interrupts, as in stm32f4xx_it.c --- */
+
+static void Test_CAN1_TX_IRQHandler(void)
+{
+    HAL_CAN_IRQHandler(&hcan1);
+    CAN_Manager_TX_IRQHandler();
+}
+
+static void Test_CAN1_RX_IRQHandler(void)
+{
+    HAL_CAN_IRQHandler(&hcan1);
+}
+
+/* --- Tester --- */
+
+static void Test_On_Response(const IsoTp_Tester_t* t)
+{
+    if (t->message_length >= 2 && t->message[0] == UDS_SID_READ_DTC_INFORMATION + UDS_POSITIVE_RESPONSE_OFFSET &&
+        t->message[1] == UDS_RDTCI_REPORT_SUPPORTED_DTC) {
+        uint64_t latency = t->message_end_cycles - request_sent_cycles;
+
+        if (t->message_length != 3 + 4 * DTC_CODE_COUNT) {
+            messages_damaged++;
+            return;
+        }
+        responses++;
+        response_latency_sum += latency;
+        if (latency > response_latency_max) {
+            response_latency_max = latency;
+        }
+        if (latency > (uint64_t)TEST_P2_MS * SIM_CYCLES_PER_TICK) {
+            responses_late++;
+        }
+    } else {
+        messages_damaged++;
+    }
+}
+
+static void Test_On_Broadcast(const IsoTp_Tester_t* t)
+{
+    if (t->message_length == sizeof(dtc_payload) && memcmp(t->message, dtc_payload, sizeof(dtc_payload)) == 0) {
+        dtc_received++;
+    } else {
+        messages_damaged++;
+    }
+}
+
+/* --- Harness --- */
+
+static void Test_Boot(void)
+{
+    static const IsoTp_Tester_Config_t tester_config = {
+        .request_id = CAN_DIAG_RECEIVE_ID,
+        .response_id = CAN_DIAG_TRANSMIT_ID,
+        .block_size = 0,
+        .st_min = 0,
+        .flow_control = true,
+        .on_message = Test_On_Response,
+    };
+    static const IsoTp_Tester_Config_t listener_config = {
+        .request_id = CAN_DTC_FLOW_CONTROL_ID,
+        .response_id = CAN_DTC_TRANSMIT_ID,
+        .block_size = 0,
+        .st_min = 0,
+        .flow_control = true,
+        .on_message = Test_On_Broadcast,
+    };
+    osMessageQueueId_t rx_queue;
+
+    Sim_Reset();
+    CAN_Filter_Model_Reset();
+    hcan1.ErrorCode = HAL_CAN_ERROR_NONE;
+    CAN_Bus_Reset(CAN_Manager_Get_Bitrate(&hcan1));
+    ecu_node = CAN_Bus_Attach_Controller(&hcan1);
+    IsoTp_Tester_Init(&tester, "tester", &tester_config);
+    IsoTp_Tester_Init(&listener, "listener", &listener_config);
+
+    Sim_SetIrqHandler(CAN1_TX_IRQn, Test_CAN1_TX_IRQHandler);
+    Sim_SetIrqHandler(CAN1_RX0_IRQn, Test_CAN1_RX_IRQHandler);
+    Sim_SetIrqHandler(CAN1_RX1_IRQn, Test_CAN1_RX_IRQHandler);
+    Sim_SetTickHook(CAN_Manager_Tick);
+
+    DTC_Init(NULL, 0);
+    SIM_CHECK(CAN_Manager_Init(&hcan1) == HAL_OK);
+    rx_queue = osMessageQueueNew(CAN_RX_POOL_SIZE, sizeof(void*), NULL);
+    SIM_CHECK(CAN_Manager_Start_Rx(rx_queue) == HAL_OK);
+
+    for (uint32_t i = 0; i < sizeof(dtc_payload); i++) {
+        dtc_payload[i] = (uint8_t)(i * 7 + 3);
+    }
+}
+
+/**
+ * @brief Adds a node sending TEST_BACKGROUND_IDS frames, together taking
+ *        the given share of the bus.
+ */
+static void Test_Add_Background(const char* name, uint32_t first_id, uint32_t ide, uint32_t per_mille)
+{
+    int node = CAN_Bus_Add_Node(name, NULL, NULL);
+    CAN_Bus_Frame_t frame = { 0, ide, 8, { 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88 } };
+
+    for (uint32_t i = 0; i < TEST_BACKGROUND_IDS; i++) {
+        uint64_t frame_us;
+        uint32_t period_us;
+
+        frame.id = first_id + i;
+        frame_us = CAN_Bus_Bits_To_Cycles(CAN_Bus_Frame_Bits(&frame)) / (SIM_CPU_HZ / 1000000U);
+        period_us = (uint32_t)(frame_us * TEST_BACKGROUND_IDS * 1000U / per_mille);
+        CAN_Bus_Add_Periodic(node, &frame, 1 + i * period_us / TEST_BACKGROUND_IDS, period_us);
+    }
+}
+
+/**
+ * @brief Runs UARTTask and StartCANTask on the one simulated thread: the
+ *        consumer waits for frames until the next broadcast or request is due.
+ */
+static void Test_Run(uint32_t duration_ms)
+{
+    static const uint8_t request[] = { UDS_SID_READ_DTC_INFORMATION, UDS_RDTCI_REPORT_SUPPORTED_DTC };
+    uint32_t start = HAL_GetTick();
+    uint32_t next_dtc = start;
+    uint32_t next_request = start + TEST_REQUEST_PERIOD_MS / 2;
+    uint32_t now;
+
+    while ((now = HAL_GetTick()) - start < duration_ms) {
+        if ((int32_t)(now - next_dtc) >= 0) {
+            if (CAN_Manager_Transmit_DTC(&hcan1, dtc_payload, sizeof(dtc_payload)) == HAL_OK) {
+                dtc_queued++;
+            }
+            next_dtc += TEST_DTC_PERIOD_MS;
+        }
+        if ((int32_t)(now - next_request) >= 0) {
+            SIM_CHECK(IsoTp_Tester_Request(&tester, request, sizeof(request)));
+            request_sent_cycles = Sim_GetCycles();
+            requests_sent++;
+            next_request += TEST_REQUEST_PERIOD_MS;
+        }
+
+        uint32_t next = ((int32_t)(next_dtc - next_request) < 0) ? next_dtc : next_request;
+        if (CAN_Manager_Process_Rx(next - now) != CMD_NONE) {
+            Sim_AdvanceUs(TEST_CONSUMER_WORK_US);
+        }
+    }
+}
+
+/**
+ * @brief Lets the bus and the receive path run dry.
+ */
+static void Test_Drain(void)
+{
+    CAN_Bus_Stop_Periodic();
+    for (uint32_t ms = 0; ms < 2 * CAN_ISOTP_TIMEOUT_MS && !CAN_Bus_Is_Idle(); ms++) {
+        CAN_Manager_Process_Rx(1);
+    }
+    SIM_CHECK(CAN_Bus_Is_Idle());
+
+    // Frames left in the pool, then those the pool had no room for
+    for (uint32_t i = 0; i < 2 * (CAN_RX_POOL_SIZE + 2 * CAN_BUS_FIFO_DEPTH); i++) {
+        CAN_Manager_Process_Rx(0);
+    }
+}
+
+/* --- Tests --- */
+
+static void Test_Load(uint32_t load_percent)
+{
+    CAN_Bus_Stats_t bus;
+    CAN_Bus_Node_Stats_t ecu;
+    CAN_Bus_Node_Stats_t tool;
+    CAN_Manager_Stats_t s;
+
+    Test_Boot();
+    if (load_percent != 0) {
+        Test_Add_Background("body", 0x100, CAN_ID_STD, load_percent * 5);
+        Test_Add_Background("gateway", 0x1CFECA21, CAN_ID_EXT, load_percent * 5);
+    }
+    requests_sent = 0;
+    responses = 0;
+    responses_late = 0;
+    response_latency_max = 0;
+    response_latency_sum = 0;
+    dtc_queued = 0;
+    dtc_received = 0;
+    messages_damaged = 0;
+
+    Test_Run(TEST_DURATION_MS);
+    CAN_Bus_Get_Stats(&bus);
+    Test_Drain();
+
+    CAN_Bus_Get_Node_Stats(ecu_node, &ecu);
+    CAN_Bus_Get_Node_Stats(tester.node, &tool);
+    CAN_Manager_Get_Stats(&s);
+
+    printf("  %3u%% | %5.1f%% | %3u/%3u %3u | %6.2f %6.2f | %2u/%2u | %4u %4u %4u | %4u %4u %4u | %6.2f\n",
+           (unsigned)load_percent,
+           100.0 * (double)bus.busy_cycles / (double)bus.elapsed_cycles,
+           (unsigned)responses, (unsigned)requests_sent, (unsigned)responses_late,
+           responses ? (double)response_latency_sum / responses / SIM_CYCLES_PER_TICK : 0.0,
+           (double)response_latency_max / SIM_CYCLES_PER_TICK,
+           (unsigned)dtc_received, (unsigned)dtc_queued,
+           (unsigned)ecu.lost_arbitration, (unsigned)s.tx_errors,
+           (unsigned)(tester.sequence_errors + listener.sequence_errors),
+           (unsigned)ecu.rx_overruns, (unsigned)s.rx_overruns, (unsigned)s.rx_pool_empty,
+           (double)ecu.max_wait_cycles / SIM_CYCLES_PER_TICK);
+
+    // The CAN Manager accounts exactly what the bus carried
+    SIM_CHECK_EQ(s.tx_frames, ecu.tx_frames);
+    SIM_CHECK_EQ(s.tx_bits, ecu.tx_bits);
+    // Lost arbitration is retried by the mailbox, never reported as an error
+    SIM_CHECK_EQ(s.tx_errors, 0);
+    SIM_CHECK_EQ(s.rx_frames + ecu.rx_overruns, ecu.rx_accepted);
+    SIM_CHECK((s.rx_overruns != 0) == (ecu.rx_overruns != 0));
+    SIM_CHECK(s.rx_overruns <= ecu.rx_overruns);
+    SIM_CHECK_EQ(messages_damaged, 0);
+
+    // Competing traffic may delay the ECU but not lose its messages
+    SIM_CHECK(responses * 100U >= requests_sent * TEST_MIN_DELIVERY_PCT);
+    SIM_CHECK_EQ(dtc_received, TEST_DURATION_MS / TEST_DTC_PERIOD_MS);
+
+    // Without competing traffic nothing may be lost or late
+    if (load_percent == 0) {
+        SIM_CHECK_EQ(responses, requests_sent);
+        SIM_CHECK_EQ(responses_late, 0);
+        SIM_CHECK_EQ(ecu.lost_arbitration, 0);
+        SIM_CHECK_EQ(tool.lost_arbitration, 0);
+    } else {
+        double busy = (double)bus.busy_cycles / (double)bus.elapsed_cycles;
+        SIM_CHECK(busy * 100.0 >= load_percent - 2);
+    }
+}
+
+/**
+ * @brief The virtual bus itself: frame length and arbitration order.
+ */
+static void Test_Bus(void)
+{
+    // All dominant: 34 bits up to the CRC, a stuff bit after every fifth
+    CAN_Bus_Frame_t zero = { 0x000, CAN_ID_STD, 0, { 0 } };
+    CAN_Bus_Frame_t frame = { 0x123, CAN_ID_STD, 1, { 0x00 } };
+    CAN_Bus_Node_Stats_t a;
+    CAN_Bus_Node_Stats_t b;
+    int node_a;
+    int node_b;
+
+    Sim_Reset();
+    CAN_Bus_Reset(500000);
+    SIM_CHECK_EQ(CAN_Bus_Frame_Bits(&zero), 34 + 6 + CAN_BUS_TRAILER_BITS + CAN_BUS_IFS_BITS);
+
+    // Two nodes ready at once: the 11-bit frame wins over the 29-bit one with the same base
+    node_a = CAN_Bus_Add_Node("a", NULL, NULL);
+    node_b = CAN_Bus_Add_Node("b", NULL, NULL);
+    CAN_Bus_Frame_t ext = { 0x123U << 18, CAN_ID_EXT, 0, { 0 } };
+    CAN_Bus_Send(node_b, &ext);
+    CAN_Bus_Send(node_a, &frame);
+    Sim_AdvanceUs(1000);
+    CAN_Bus_Get_Node_Stats(node_a, &a);
+    CAN_Bus_Get_Node_Stats(node_b, &b);
+    SIM_CHECK_EQ(a.tx_frames, 1);
+    SIM_CHECK_EQ(b.tx_frames, 1);
+    SIM_CHECK_EQ(a.lost_arbitration, 0);
+    SIM_CHECK_EQ(b.lost_arbitration, 1);
+    SIM_CHECK(b.max_wait_cycles > a.max_wait_cycles);
+    SIM_CHECK(CAN_Bus_Is_Idle());
+}
+
+int main(void)
+{
+    Test_Bus();
+
+    printf("  load | bus    | UDS ok/req >P2 | avg ms max ms | DTC   | ALST txer seqe | ovr  FOV  pool | ECU wait ms\n");
+    Test_Load(0);
+    Test_Load(60);
+    Test_Load(75);
+    Test_Load(90);
+    return Sim_Result("test_can_load");
+}
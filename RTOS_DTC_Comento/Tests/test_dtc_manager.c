@@ -0,0 +1,382 @@
+/*
+ * test_dtc_manager.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * Unit tests of dtc_manager: status bits, the bit-sliced index behind the
+ * counts and iterators, debouncing, aging and healing, extended data,
+ * snapshots and the export/import round trip.
+ */
+
+#include "sim_os.h"
+#include "dtc_manager.h"
+#include <string.h>
+
+#define STATUS_INITIAL  (DTC_STATUS_TEST_NOT_COMPLETED_SINCE_CLEAR | DTC_STATUS_TEST_NOT_COMPLETED_THIS_OP_CYCLE)
+#define STATUS_FAILED   0xAF    // testFailed, thisCycle, pending, confirmed, sinceClear, warning; not completed this cycle
+
+/* --- Private Variables --- */
+static uint32_t test_time;
+static uint32_t test_changes;
+
+static uint32_t Test_Time(void)
+{
+    return test_time;
+}
+
+static void Test_Changed(void)
+{
+    test_changes++;
+}
+
+/* --- Tests --- */
+
+static void Test_SetAndClear(void)
+{
+    DTC_Init(NULL, 0);
+    SIM_CHECK_EQ(DTC_GetStatus(DTC_PMIC_BUCK_A_UNDERVOLTAGE), STATUS_INITIAL);
+    SIM_CHECK_EQ(DTC_GetActiveCount(), 0);
+
+    DTC_Set(DTC_PMIC_BUCK_B_UNDERVOLTAGE);
+    SIM_CHECK_EQ(DTC_GetStatus(DTC_PMIC_BUCK_B_UNDERVOLTAGE), STATUS_FAILED);
+    SIM_CHECK(DTC_IsSet(DTC_PMIC_BUCK_B_UNDERVOLTAGE));
+    SIM_CHECK(!DTC_IsSet(DTC_PMIC_BUCK_A_UNDERVOLTAGE));
+    SIM_CHECK_EQ(DTC_GetActiveCount(), 1);
+
+    // Clearing only drops testFailed; the history bits stay
+    DTC_Clear(DTC_PMIC_BUCK_B_UNDERVOLTAGE);
+    SIM_CHECK_EQ(DTC_GetStatus(DTC_PMIC_BUCK_B_UNDERVOLTAGE), STATUS_FAILED & ~DTC_STATUS_TEST_FAILED);
+    SIM_CHECK_EQ(DTC_GetActiveCount(), 0);
+
+    DTC_ClearAll();
+    SIM_CHECK_EQ(DTC_GetStatus(DTC_PMIC_BUCK_B_UNDERVOLTAGE), STATUS_INITIAL);
+
+    // Invalid codes are ignored
+    DTC_Set(DTC_CODE_COUNT);
+    SIM_CHECK_EQ(DTC_GetStatus(DTC_CODE_COUNT), 0);
+    SIM_CHECK_EQ(DTC_GetActiveCount(), 0);
+}
+
+static void Test_CountsAndIterators(void)
+{
+    DTC_Iterator_t it;
+    DTC_Code_t code;
+    uint32_t seen = 0;
+
+    DTC_Init(NULL, 0);
+    DTC_Set(DTC_PMIC_BUCK_A_UNDERVOLTAGE);
+    DTC_Set(DTC_PMIC_BUCK_D_UNDERVOLTAGE);
+    DTC_Set(DTC_PMIC_BUCK_C_UNDERVOLTAGE);
+    DTC_Clear(DTC_PMIC_BUCK_C_UNDERVOLTAGE);
+
+    SIM_CHECK_EQ(DTC_GetActiveCount(), 2);
+    SIM_CHECK_EQ(DTC_CountByStatusMask(DTC_STATUS_TEST_FAILED), 2);
+    SIM_CHECK_EQ(DTC_CountByStatusMask(DTC_STATUS_CONFIRMED), 3);
+    SIM_CHECK_EQ(DTC_CountByStatusMask(DTC_STATUS_TEST_FAILED | DTC_STATUS_TEST_NOT_COMPLETED_SINCE_CLEAR), 3);
+    SIM_CHECK_EQ(DTC_CountByStatusMask(0xFF), DTC_CODE_COUNT);
+    SIM_CHECK_EQ(DTC_CountByStatusMask(0), 0);
+
+    // Ascending order, only matching DTCs
+    DTC_Iterator_Init(&it);
+    while (DTC_Iterator_Next(&it, &code)) {
+        seen = (seen << 4) | (code + 1);
+    }
+    SIM_CHECK_EQ(seen, ((DTC_PMIC_BUCK_A_UNDERVOLTAGE + 1) << 4) | (DTC_PMIC_BUCK_D_UNDERVOLTAGE + 1));
+
+    seen = 0;
+    DTC_Iterator_InitByStatusMask(&it, DTC_STATUS_TEST_FAILED_SINCE_CLEAR);
+    while (DTC_Iterator_Next(&it, &code)) {
+        seen++;
+    }
+    SIM_CHECK_EQ(seen, 3);
+}
+
+static void Test_Lookup(void)
+{
+    DTC_Code_t code;
+    const DTC_Definition_t* def = DTC_GetDefinition(DTC_PMIC_BUCK_C_UNDERVOLTAGE);
+
+    SIM_CHECK_EQ(DTC_GetNumber(DTC_PMIC_BUCK_B_UNDERVOLTAGE), 0x500216);
+    SIM_CHECK(DTC_FindByNumber(0x500416, &code) && code == DTC_PMIC_BUCK_D_UNDERVOLTAGE);
+    SIM_CHECK(!DTC_FindByNumber(0x500516, &code));
+    SIM_CHECK(def != NULL && def->debounce.algorithm == DTC_DEBOUNCE_TIME);
+    SIM_CHECK(DTC_GetDefinition(DTC_CODE_COUNT) == NULL);
+}
+
+static void Test_CounterDebounce(void)
+{
+    uint32_t t = 0;
+
+    DTC_Init(NULL, 0);
+
+    // A toggling signal restarts the count every sample and never qualifies
+    for (int i = 0; i < 10; i++) {
+        DTC_ReportEvent(DTC_PMIC_BUCK_A_UNDERVOLTAGE, (i & 1) ? DTC_EVENT_PREPASSED : DTC_EVENT_PREFAILED,
+                        t += 100, NULL);
+    }
+    SIM_CHECK_EQ(DTC_GetStatus(DTC_PMIC_BUCK_A_UNDERVOLTAGE), STATUS_INITIAL);
+
+    // 3 prefailed reports to fail, 5 prepassed to pass
+    for (int i = 0; i < 2; i++) {
+        DTC_ReportEvent(DTC_PMIC_BUCK_A_UNDERVOLTAGE, DTC_EVENT_PREFAILED, t += 100, NULL);
+    }
+    SIM_CHECK(!DTC_IsSet(DTC_PMIC_BUCK_A_UNDERVOLTAGE));
+    DTC_ReportEvent(DTC_PMIC_BUCK_A_UNDERVOLTAGE, DTC_EVENT_PREFAILED, t += 100, NULL);
+    SIM_CHECK(DTC_IsSet(DTC_PMIC_BUCK_A_UNDERVOLTAGE));
+
+    for (int i = 0; i < 4; i++) {
+        DTC_ReportEvent(DTC_PMIC_BUCK_A_UNDERVOLTAGE, DTC_EVENT_PREPASSED, t += 100, NULL);
+    }
+    SIM_CHECK(DTC_IsSet(DTC_PMIC_BUCK_A_UNDERVOLTAGE));
+    DTC_ReportEvent(DTC_PMIC_BUCK_A_UNDERVOLTAGE, DTC_EVENT_PREPASSED, t += 100, NULL);
+    SIM_CHECK(!DTC_IsSet(DTC_PMIC_BUCK_A_UNDERVOLTAGE));
+}
+
+static void Test_TimeDebounce(void)
+{
+    uint32_t t = 1000;
+
+    DTC_Init(NULL, 0);
+
+    // 300 ms of prefailed to fail
+    for (int i = 0; i < 3; i++, t += 100) {
+        DTC_ReportEvent(DTC_PMIC_BUCK_C_UNDERVOLTAGE, DTC_EVENT_PREFAILED, t, NULL);
+        SIM_CHECK(!DTC_IsSet(DTC_PMIC_BUCK_C_UNDERVOLTAGE));
+    }
+    DTC_ReportEvent(DTC_PMIC_BUCK_C_UNDERVOLTAGE, DTC_EVENT_PREFAILED, t, NULL);
+    SIM_CHECK(DTC_IsSet(DTC_PMIC_BUCK_C_UNDERVOLTAGE));
+
+    // A qualified result bypasses the debounce
+    DTC_ReportEvent(DTC_PMIC_BUCK_C_UNDERVOLTAGE, DTC_EVENT_PASSED, t, NULL);
+    SIM_CHECK(!DTC_IsSet(DTC_PMIC_BUCK_C_UNDERVOLTAGE));
+    DTC_ReportEvent(DTC_PMIC_BUCK_D_UNDERVOLTAGE, DTC_EVENT_FAILED, t, NULL);
+    SIM_CHECK(DTC_IsSet(DTC_PMIC_BUCK_D_UNDERVOLTAGE));
+}
+
+static void Test_AgingAndHealing(void)
+{
+    uint8_t status;
+
+    DTC_Init(NULL, 0);
+    DTC_StartOperationCycle();
+    DTC_ReportEvent(DTC_PMIC_BUCK_A_UNDERVOLTAGE, DTC_EVENT_FAILED, 0, NULL);
+    DTC_ReportEvent(DTC_PMIC_BUCK_B_UNDERVOLTAGE, DTC_EVENT_PASSED, 0, NULL);
+    SIM_CHECK_EQ(DTC_GetStatus(DTC_PMIC_BUCK_B_UNDERVOLTAGE), 0x00);
+    DTC_EndOperationCycle();
+    DTC_StartOperationCycle();
+    SIM_CHECK_EQ(DTC_GetStatus(DTC_PMIC_BUCK_A_UNDERVOLTAGE), 0xED);
+    SIM_CHECK_EQ(DTC_GetStatus(DTC_PMIC_BUCK_B_UNDERVOLTAGE), DTC_STATUS_TEST_NOT_COMPLETED_THIS_OP_CYCLE);
+
+    // Fault-free cycles: pending goes first, warning after the healing
+    // cycles, confirmed after the aging cycles
+    for (int cycle = 1; cycle <= DTC_AGING_CYCLES + 1; cycle++) {
+        DTC_ReportEvent(DTC_PMIC_BUCK_A_UNDERVOLTAGE, DTC_EVENT_PASSED, 0, NULL);
+        SIM_CHECK(DTC_EndOperationCycle() == (cycle <= DTC_AGING_CYCLES));
+        DTC_StartOperationCycle();
+        status = DTC_GetStatus(DTC_PMIC_BUCK_A_UNDERVOLTAGE);
+        SIM_CHECK((status & DTC_STATUS_PENDING) == 0);
+        SIM_CHECK(((status & DTC_STATUS_WARNING_INDICATOR) != 0) == (cycle < DTC_HEALING_CYCLES));
+        SIM_CHECK(((status & DTC_STATUS_CONFIRMED) != 0) == (cycle < DTC_AGING_CYCLES));
+    }
+    SIM_CHECK_EQ(DTC_GetStatus(DTC_PMIC_BUCK_A_UNDERVOLTAGE), 0x60);
+
+    // A cycle without a completed test changes nothing
+    SIM_CHECK(!DTC_EndOperationCycle());
+}
+
+static void Test_ExtData(void)
+{
+    DTC_ExtData_t e;
+
+    DTC_Init(NULL, 0);
+    test_time = 1000;
+    DTC_RegisterTimeSource(Test_Time);
+    DTC_StartOperationCycle();
+
+    // Intermittent: every 0 -> 1 edge is an occurrence
+    for (int i = 0; i < 3; i++) {
+        test_time += 10;
+        DTC_ReportEvent(DTC_PMIC_BUCK_A_UNDERVOLTAGE, DTC_EVENT_FAILED, 0, NULL);
+        DTC_ReportEvent(DTC_PMIC_BUCK_A_UNDERVOLTAGE, DTC_EVENT_FAILED, 0, NULL);
+        DTC_ReportEvent(DTC_PMIC_BUCK_A_UNDERVOLTAGE, DTC_EVENT_PASSED, 0, NULL);
+    }
+    SIM_CHECK(DTC_GetExtData(DTC_PMIC_BUCK_A_UNDERVOLTAGE, &e));
+    SIM_CHECK_EQ(e.occurrence_counter, 3);
+    SIM_CHECK_EQ(e.first_failure_time, 1010);
+    SIM_CHECK_EQ(e.last_failure_time, 1030);
+
+    // Hard: one occurrence, one pending cycle per operation cycle
+    for (int cycle = 0; cycle < 3; cycle++) {
+        test_time += 100;
+        DTC_ReportEvent(DTC_PMIC_BUCK_B_UNDERVOLTAGE, DTC_EVENT_FAILED, 0, NULL);
+        DTC_EndOperationCycle();
+        DTC_StartOperationCycle();
+    }
+    SIM_CHECK(DTC_GetExtData(DTC_PMIC_BUCK_B_UNDERVOLTAGE, &e));
+    SIM_CHECK_EQ(e.occurrence_counter, 1);
+    SIM_CHECK_EQ(e.pending_counter, 3);
+
+    DTC_ClearAll();
+    SIM_CHECK(DTC_GetExtData(DTC_PMIC_BUCK_A_UNDERVOLTAGE, &e));
+    SIM_CHECK_EQ(e.occurrence_counter, 0);
+    SIM_CHECK(!DTC_GetExtData(DTC_CODE_COUNT, &e));
+    DTC_RegisterTimeSource(NULL);
+}
+
+static void Test_Snapshots(void)
+{
+    DTC_Snapshot_t s = { { 1200, 1000, 1800, 3300 }, 0x7AB, 0x04, 1234 };
+    DTC_Snapshot_t out;
+
+    DTC_Init(NULL, 0);
+    SIM_CHECK(!DTC_GetSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, DTC_SNAPSHOT_RECORD_FIRST, &out));
+
+    DTC_SetWithSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, &s);
+    s.timestamp_ms = 5000;
+    DTC_SetWithSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, &s);     // Still failed: not a new occurrence
+    SIM_CHECK(DTC_GetSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, DTC_SNAPSHOT_RECORD_LATEST, &out));
+    SIM_CHECK_EQ(out.timestamp_ms, 1234);
+
+    DTC_Clear(DTC_PMIC_BUCK_B_UNDERVOLTAGE);
+    s.timestamp_ms = 9000;
+    DTC_SetWithSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, &s);
+    SIM_CHECK(DTC_GetSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, DTC_SNAPSHOT_RECORD_FIRST, &out));
+    SIM_CHECK_EQ(out.timestamp_ms, 1234);
+    SIM_CHECK_EQ(out.rail_setpoint_mv[3], 3300);
+    SIM_CHECK(DTC_GetSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, DTC_SNAPSHOT_RECORD_LATEST, &out));
+    SIM_CHECK_EQ(out.timestamp_ms, 9000);
+    SIM_CHECK(!DTC_GetSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, 0x03, &out));
+
+    // Other DTCs overwrite the latest record in the ring, never the first one
+    for (uint32_t i = 0; i < DTC_SNAPSHOT_RING_SIZE; i++) {
+        DTC_SetWithSnapshot(DTC_PMIC_BUCK_A_UNDERVOLTAGE, &s);
+        DTC_Clear(DTC_PMIC_BUCK_A_UNDERVOLTAGE);
+    }
+    SIM_CHECK(!DTC_GetSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, DTC_SNAPSHOT_RECORD_LATEST, &out));
+    SIM_CHECK(DTC_GetSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, DTC_SNAPSHOT_RECORD_FIRST, &out));
+    SIM_CHECK_EQ(out.timestamp_ms, 1234);
+
+    DTC_ClearAll();
+    SIM_CHECK(!DTC_GetSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, DTC_SNAPSHOT_RECORD_LATEST, &out));
+    SIM_CHECK(!DTC_GetSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, DTC_SNAPSHOT_RECORD_FIRST, &out));
+
+    // The pool pins the first records of the first DTCs to fail; past it a
+    // first record lives in the ring and goes when the ring wraps
+    for (uint32_t code = 0; code < DTC_CODE_COUNT; code++) {
+        s.timestamp_ms = 100 + code;
+        DTC_SetWithSnapshot((DTC_Code_t)code, &s);
+    }
+    for (uint32_t code = 0; code < DTC_CODE_COUNT; code++) {
+        SIM_CHECK(DTC_GetSnapshot((DTC_Code_t)code, DTC_SNAPSHOT_RECORD_FIRST, &out));
+        SIM_CHECK_EQ(out.timestamp_ms, 100 + code);
+    }
+    s.timestamp_ms = 200;
+    for (uint32_t i = 0; i < DTC_SNAPSHOT_RING_SIZE; i++) {
+        DTC_Clear(DTC_PMIC_BUCK_D_UNDERVOLTAGE);
+        DTC_SetWithSnapshot(DTC_PMIC_BUCK_D_UNDERVOLTAGE, &s);
+    }
+    for (uint32_t code = 0; code < DTC_CODE_COUNT - 1; code++) {
+        SIM_CHECK_EQ(DTC_GetSnapshot((DTC_Code_t)code, DTC_SNAPSHOT_RECORD_FIRST, &out),
+                     code < DTC_SNAPSHOT_FIRST_POOL_SIZE);
+    }
+
+    // A clear frees the pool for the next DTCs to fail
+    DTC_ClearAll();
+    s.timestamp_ms = 300;
+    DTC_SetWithSnapshot(DTC_PMIC_BUCK_D_UNDERVOLTAGE, &s);
+    s.timestamp_ms = 301;
+    for (uint32_t i = 0; i < DTC_SNAPSHOT_RING_SIZE; i++) {
+        DTC_Clear(DTC_PMIC_BUCK_A_UNDERVOLTAGE);
+        DTC_SetWithSnapshot(DTC_PMIC_BUCK_A_UNDERVOLTAGE, &s);
+    }
+    SIM_CHECK(DTC_GetSnapshot(DTC_PMIC_BUCK_D_UNDERVOLTAGE, DTC_SNAPSHOT_RECORD_FIRST, &out));
+    SIM_CHECK_EQ(out.timestamp_ms, 300);
+    DTC_ClearAll();
+}
+
+static void Test_ExportImport(void)
+{
+    uint8_t saved[DTC_STORAGE_SIZE];
+    uint8_t again[DTC_STORAGE_SIZE];
+    uint8_t status[DTC_CODE_COUNT];
+    DTC_Snapshot_t s = { { 0 }, 0, 0x02, 1000 };
+    DTC_Snapshot_t out;
+    DTC_ExtData_t e;
+
+    DTC_Init(NULL, 0);
+    test_time = 1000;
+    DTC_RegisterTimeSource(Test_Time);
+    DTC_StartOperationCycle();
+    DTC_ReportEvent(DTC_PMIC_BUCK_A_UNDERVOLTAGE, DTC_EVENT_FAILED, 0, NULL);
+    DTC_ReportEvent(DTC_PMIC_BUCK_C_UNDERVOLTAGE, DTC_EVENT_PASSED, 0, NULL);
+    DTC_EndOperationCycle();
+    DTC_StartOperationCycle();
+    DTC_ReportEvent(DTC_PMIC_BUCK_D_UNDERVOLTAGE, DTC_EVENT_FAILED, 0, NULL);
+    for (uint32_t i = 0; i < DTC_CODE_COUNT; i++) {
+        status[i] = DTC_GetStatus((DTC_Code_t)i);
+    }
+
+    SIM_CHECK_EQ(DTC_Export(saved, sizeof(saved) - 1), 0);
+    SIM_CHECK_EQ(DTC_Export(saved, sizeof(saved)), DTC_STORAGE_SIZE);
+
+    // Restored through DTC_Init, as at boot. Snapshots are not saved, so
+    // one taken before the reset is gone.
+    DTC_SetWithSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, &s);
+    DTC_Init(saved, sizeof(saved));
+    SIM_CHECK(!DTC_GetSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, DTC_SNAPSHOT_RECORD_FIRST, &out));
+    for (uint32_t i = 0; i < DTC_CODE_COUNT; i++) {
+        SIM_CHECK_EQ(DTC_GetStatus((DTC_Code_t)i), status[i]);
+    }
+    SIM_CHECK_EQ(DTC_GetActiveCount(), 2);
+    SIM_CHECK_EQ(DTC_CountByStatusMask(DTC_STATUS_CONFIRMED), 2);
+    SIM_CHECK(DTC_GetExtData(DTC_PMIC_BUCK_A_UNDERVOLTAGE, &e));
+    SIM_CHECK_EQ(e.occurrence_counter, 1);
+    SIM_CHECK_EQ(e.first_failure_time, 1000);
+    SIM_CHECK_EQ(DTC_Export(again, sizeof(again)), DTC_STORAGE_SIZE);
+    SIM_CHECK(memcmp(saved, again, sizeof(saved)) == 0);
+
+    // Too short to be a saved state: start cleared
+    DTC_Init(saved, DTC_STORAGE_SIZE - 1);
+    SIM_CHECK_EQ(DTC_GetStatus(DTC_PMIC_BUCK_A_UNDERVOLTAGE), STATUS_INITIAL);
+    DTC_RegisterTimeSource(NULL);
+}
+
+static void Test_ChangeCallback(void)
+{
+    DTC_Init(NULL, 0);
+    DTC_RegisterChangeCallback(Test_Changed);
+    test_changes = 0;
+    DTC_Set(DTC_PMIC_BUCK_A_UNDERVOLTAGE);
+    SIM_CHECK(test_changes > 0);
+
+    // Setting a DTC that is already set saves nothing new
+    test_changes = 0;
+    DTC_Set(DTC_PMIC_BUCK_A_UNDERVOLTAGE);
+    SIM_CHECK_EQ(test_changes, 0);
+
+    // Nor does clearing it twice: the second clear finds only history bits
+    DTC_Clear(DTC_PMIC_BUCK_A_UNDERVOLTAGE);
+    SIM_CHECK(test_changes > 0);
+    test_changes = 0;
+    DTC_Clear(DTC_PMIC_BUCK_A_UNDERVOLTAGE);
+    SIM_CHECK_EQ(test_changes, 0);
+    DTC_RegisterChangeCallback(NULL);
+}
+
+int main(void)
+{
+    Sim_Reset();
+    Test_SetAndClear();
+    Test_CountsAndIterators();
+    Test_Lookup();
+    Test_CounterDebounce();
+    Test_TimeDebounce();
+    Test_AgingAndHealing();
+    Test_ExtData();
+    Test_Snapshots();
+    Test_ExportImport();
+    Test_ChangeCallback();
+    return Sim_Result("test_dtc_manager");
+}
@@ -0,0 +1,215 @@
+/*
+ * test_eeprom_cache.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * Unit tests of eeprom_cache on the 25LC256 model: merging, the write-back
+ * policies, skipped unchanged bytes and eviction.
+ */
+
+#include "sim_os.h"
+#include "eeprom_model.h"
+#include "eeprom_cache.h"
+#include <string.h>
+
+#define TEST_RECORD_SIZE    76      // Spans two pages from address 0
+
+/* --- Private Variables --- */
+static SPI_HandleTypeDef test_hspi = { .Instance = (SPI_TypeDef*)1 };
+
+static void Test_Boot(uint32_t max_age_ms, uint8_t max_dirty_pages)
+{
+    Sim_Reset();
+    EEPROM_Model_Reset();
+    EEPROM_Init(&test_hspi, GPIOC, GPIO_PIN_4);
+    EEPROM_Cache_Init(&(EEPROM_Cache_Policy_t){ max_age_ms, max_dirty_pages });
+}
+
+static uint32_t Test_PageWrites(void)
+{
+    EEPROM_Model_Stats_t m;
+
+    EEPROM_Model_GetStats(&m);
+    return m.page_writes;
+}
+
+/* --- Tests --- */
+
+static void Test_MergeAndAge(void)
+{
+    uint8_t record[TEST_RECORD_SIZE];
+    uint8_t readback[TEST_RECORD_SIZE];
+    EEPROM_Cache_Stats_t s;
+
+    Test_Boot(500, 0);
+    memset(record, 0x50, sizeof(record));
+    for (int i = 0; i < 10; i++) {
+        record[i] = (uint8_t)i;
+        SIM_CHECK(EEPROM_Cache_Write(0, record, sizeof(record)) == HAL_OK);
+        osDelay(10);
+    }
+    SIM_CHECK_EQ(EEPROM_Cache_GetDirtyCount(), 2);
+    SIM_CHECK_EQ(Test_PageWrites(), 0);
+
+    // Reads see the data not written back yet
+    SIM_CHECK(EEPROM_Cache_Read(0, readback, sizeof(readback)) == HAL_OK);
+    SIM_CHECK(memcmp(readback, record, sizeof(record)) == 0);
+    SIM_CHECK_EQ(EEPROM_Model_GetArray()[9], 0xFF);
+
+    // Too young: stays in RAM
+    SIM_CHECK(EEPROM_Cache_Poll() == HAL_OK);
+    SIM_CHECK_EQ(Test_PageWrites(), 0);
+
+    // Ten updates cost one write per page, and each poll writes one
+    osDelay(500);
+    SIM_CHECK(EEPROM_Cache_IsDue());
+    SIM_CHECK(EEPROM_Cache_Poll() == HAL_OK);
+    SIM_CHECK_EQ(Test_PageWrites(), 1);
+    SIM_CHECK(EEPROM_Cache_Poll() == HAL_OK);
+    SIM_CHECK_EQ(Test_PageWrites(), 2);
+    SIM_CHECK(!EEPROM_Cache_IsDue());
+    SIM_CHECK(memcmp(EEPROM_Model_GetArray(), record, sizeof(record)) == 0);
+    SIM_CHECK_EQ(EEPROM_Cache_GetDirtyCount(), 0);
+
+    // Rewriting the same data dirties nothing
+    SIM_CHECK(EEPROM_Cache_Write(0, record, sizeof(record)) == HAL_OK);
+    SIM_CHECK_EQ(EEPROM_Cache_GetDirtyCount(), 0);
+
+    EEPROM_Cache_GetStats(&s);
+    SIM_CHECK_EQ(s.page_flushes, 2);
+    SIM_CHECK(s.write_merges >= 9);
+    SIM_CHECK(s.write_skips >= 2);
+}
+
+static void Test_DirtyCountPolicy(void)
+{
+    Test_Boot(0, 4);
+    for (uint16_t page = 0; page < 3; page++) {
+        uint8_t value = (uint8_t)(page + 1);
+        SIM_CHECK(EEPROM_Cache_Write(1024 + page * EEPROM_PAGE_SIZE, &value, 1) == HAL_OK);
+    }
+    SIM_CHECK_EQ(Test_PageWrites(), 0);
+    SIM_CHECK(EEPROM_Cache_Poll() == HAL_OK);
+    SIM_CHECK_EQ(Test_PageWrites(), 0);
+
+    SIM_CHECK(!EEPROM_Cache_IsDue());
+
+    // The fourth dirty page makes all of them due, without a write yet;
+    // the polls then write them back one at a time
+    uint8_t value = 4;
+    SIM_CHECK(EEPROM_Cache_Write(1024 + 3 * EEPROM_PAGE_SIZE, &value, 1) == HAL_OK);
+    SIM_CHECK_EQ(Test_PageWrites(), 0);
+    for (uint32_t writes = 1; writes <= 4; writes++) {
+        SIM_CHECK(EEPROM_Cache_IsDue());
+        SIM_CHECK(EEPROM_Cache_Poll() == HAL_OK);
+        SIM_CHECK_EQ(Test_PageWrites(), writes);
+    }
+    SIM_CHECK(!EEPROM_Cache_IsDue());
+    SIM_CHECK_EQ(EEPROM_Cache_GetDirtyCount(), 0);
+    for (uint16_t page = 0; page < 4; page++) {
+        SIM_CHECK_EQ(EEPROM_Model_GetArray()[1024 + page * EEPROM_PAGE_SIZE], page + 1);
+    }
+}
+
+static void Test_Drain(void)
+{
+    uint8_t value = 1;
+    uint32_t polls = 0;
+
+    Test_Boot(0, 0);
+    for (uint16_t page = 0; page < 3; page++) {
+        SIM_CHECK(EEPROM_Cache_Write(2048 + page * EEPROM_PAGE_SIZE, &value, 1) == HAL_OK);
+    }
+    SIM_CHECK(!EEPROM_Cache_IsDue());
+
+    // A page dirtied while draining is written back too
+    EEPROM_Cache_Drain();
+    SIM_CHECK(EEPROM_Cache_Poll() == HAL_OK);
+    SIM_CHECK(EEPROM_Cache_Write(2048 + 3 * EEPROM_PAGE_SIZE, &value, 1) == HAL_OK);
+    while (EEPROM_Cache_IsDue() && polls++ < 10) {
+        SIM_CHECK(EEPROM_Cache_Poll() == HAL_OK);
+    }
+    SIM_CHECK_EQ(Test_PageWrites(), 4);
+    SIM_CHECK_EQ(EEPROM_Cache_GetDirtyCount(), 0);
+
+    // Over once the cache is clean
+    value = 2;
+    SIM_CHECK(EEPROM_Cache_Write(2048, &value, 1) == HAL_OK);
+    SIM_CHECK(!EEPROM_Cache_IsDue());
+}
+
+static void Test_Eviction(void)
+{
+    const uint16_t pages = 3 * EEPROM_CACHE_LINES;
+
+    Test_Boot(0, 0);
+    for (uint16_t page = 0; page < pages; page++) {
+        uint8_t value = (uint8_t)(page + 7);
+        SIM_CHECK(EEPROM_Cache_Write(4096 + page * EEPROM_PAGE_SIZE, &value, 1) == HAL_OK);
+    }
+    SIM_CHECK(EEPROM_Cache_GetDirtyCount() <= EEPROM_CACHE_LINES);
+    SIM_CHECK(EEPROM_Cache_Sync() == HAL_OK);
+    SIM_CHECK_EQ(EEPROM_Cache_GetDirtyCount(), 0);
+    for (uint16_t page = 0; page < pages; page++) {
+        SIM_CHECK_EQ(EEPROM_Model_GetArray()[4096 + page * EEPROM_PAGE_SIZE], page + 7);
+    }
+}
+
+static void Test_WholePageMiss(void)
+{
+    uint8_t page_data[EEPROM_PAGE_SIZE];
+    const uint16_t pages = 2 * EEPROM_CACHE_LINES + 1;
+
+    // A whole-page write is not read in first, so it must not be compared
+    // with what a reused line held before: every line here held the same
+    // bytes the next page is written with
+    Test_Boot(0, 0);
+    memset(page_data, 0x55, sizeof(page_data));
+    for (uint16_t page = 0; page < pages; page++) {
+        SIM_CHECK(EEPROM_Cache_Write(page * EEPROM_PAGE_SIZE, page_data, sizeof(page_data)) == HAL_OK);
+    }
+    SIM_CHECK(EEPROM_Cache_Sync() == HAL_OK);
+    for (uint32_t i = 0; i < pages * EEPROM_PAGE_SIZE; i++) {
+        if (EEPROM_Model_GetArray()[i] != 0x55) {
+            SIM_CHECK_EQ(i, -1);
+            break;
+        }
+    }
+}
+
+static void Test_PageBoundaries(void)
+{
+    uint8_t data[200];
+    uint8_t readback[200];
+    EEPROM_Model_Stats_t m;
+
+    Test_Boot(0, 0);
+    for (uint32_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 3);
+    }
+    SIM_CHECK(EEPROM_Cache_Write(8000, data, sizeof(data)) == HAL_OK);
+    SIM_CHECK(EEPROM_Cache_Sync() == HAL_OK);
+    SIM_CHECK(memcmp(&EEPROM_Model_GetArray()[8000], data, sizeof(data)) == 0);
+
+    // Read back past the cache
+    EEPROM_Cache_Init(&(EEPROM_Cache_Policy_t){ 0, 0 });
+    SIM_CHECK(EEPROM_Cache_Read(8000, readback, sizeof(readback)) == HAL_OK);
+    SIM_CHECK(memcmp(readback, data, sizeof(data)) == 0);
+
+    EEPROM_Model_GetStats(&m);
+    SIM_CHECK_EQ(m.page_wraps, 0);
+    SIM_CHECK_EQ(m.busy_commands, 0);
+}
+
+int main(void)
+{
+    Test_MergeAndAge();
+    Test_DirtyCountPolicy();
+    Test_Drain();
+    Test_Eviction();
+    Test_WholePageMiss();
+    Test_PageBoundaries();
+    return Sim_Result("test_eeprom_cache");
+}
@@ -0,0 +1,182 @@
+/*
+ * test_eeprom_log.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * Unit tests of eeprom_log on the 25LC256 model: the boot scan, wear
+ * levelling over the whole device, records torn by a reset and records
+ * damaged after they were written.
+ */
+
+#include "sim_os.h"
+#include "eeprom_model.h"
+#include "eeprom_cache.h"
+#include "eeprom_log.h"
+#include <string.h>
+
+#define TEST_RECORD_SIZE    76      // One DTC_Export record, two pages with the header
+
+/* --- Private Variables --- */
+static SPI_HandleTypeDef test_hspi = { .Instance = (SPI_TypeDef*)1 };
+
+/**
+ * @brief Power cycle: the EEPROM keeps its contents.
+ */
+static void Test_Boot(void)
+{
+    Sim_Reset();
+    EEPROM_Model_Restart();
+    EEPROM_Init(&test_hspi, GPIOC, GPIO_PIN_4);
+    EEPROM_Cache_Init(&(EEPROM_Cache_Policy_t){ 500, 4 });
+    SIM_CHECK(EEPROM_Log_Init() == HAL_OK);
+}
+
+static void Test_Record(uint8_t* p_data, uint16_t length, uint32_t n)
+{
+    for (uint16_t i = 0; i < length; i++) {
+        p_data[i] = (uint8_t)(n + i);
+    }
+}
+
+static bool Test_IsRecord(const uint8_t* p_data, uint16_t length, uint32_t n)
+{
+    for (uint16_t i = 0; i < length; i++) {
+        if (p_data[i] != (uint8_t)(n + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* --- Tests --- */
+
+static void Test_Empty(void)
+{
+    uint8_t record[TEST_RECORD_SIZE];
+    uint16_t length;
+    EEPROM_Log_Stats_t s;
+
+    EEPROM_Model_Reset();
+    Test_Boot();
+    EEPROM_Log_GetStats(&s);
+    SIM_CHECK_EQ(s.sequence, 0);
+    SIM_CHECK_EQ(s.head_page, 0);
+    SIM_CHECK(EEPROM_Log_ReadLatest(record, sizeof(record), &length) == HAL_ERROR);
+    SIM_CHECK(EEPROM_Log_Append(record, EEPROM_LOG_MAX_LENGTH + 1) == HAL_ERROR);
+}
+
+static void Test_WearLevelling(void)
+{
+    uint8_t record[TEST_RECORD_SIZE];
+    uint16_t length;
+    EEPROM_Log_Stats_t s;
+    uint32_t min = UINT32_MAX;
+    uint32_t max = 0;
+    const uint32_t appends = 1000;
+
+    EEPROM_Model_Reset();
+    Test_Boot();
+    for (uint32_t n = 1; n <= appends; n++) {
+        Test_Record(record, sizeof(record), n);
+        SIM_CHECK(EEPROM_Log_Append(record, sizeof(record)) == HAL_OK);
+    }
+    SIM_CHECK(EEPROM_Cache_Sync() == HAL_OK);
+    EEPROM_Log_GetStats(&s);
+    SIM_CHECK_EQ(s.sequence, appends);
+    SIM_CHECK_EQ(s.wraps, appends * 2 / EEPROM_LOG_PAGE_COUNT);
+
+    // Every page takes its share of the writes
+    for (uint16_t page = 0; page < EEPROM_LOG_PAGE_COUNT; page++) {
+        uint32_t writes = EEPROM_Model_GetPageWrites(page);
+        min = (writes < min) ? writes : min;
+        max = (writes > max) ? writes : max;
+    }
+    SIM_CHECK(max - min <= 1);
+
+    // The newest record is found again after a reset
+    Test_Boot();
+    EEPROM_Log_GetStats(&s);
+    SIM_CHECK_EQ(s.sequence, appends);
+    SIM_CHECK(EEPROM_Log_ReadLatest(record, sizeof(record), &length) == HAL_OK);
+    SIM_CHECK_EQ(length, sizeof(record));
+    SIM_CHECK(Test_IsRecord(record, length, appends));
+    SIM_CHECK(EEPROM_Log_ReadLatest(record, sizeof(record) - 1, &length) == HAL_ERROR);
+
+    // Appends go on after it
+    Test_Record(record, sizeof(record), appends + 1);
+    SIM_CHECK(EEPROM_Log_Append(record, sizeof(record)) == HAL_OK);
+    SIM_CHECK(EEPROM_Cache_Sync() == HAL_OK);
+    Test_Boot();
+    EEPROM_Log_GetStats(&s);
+    SIM_CHECK_EQ(s.sequence, appends + 1);
+}
+
+static void Test_TornAppend(void)
+{
+    uint8_t record[TEST_RECORD_SIZE];
+    uint16_t length;
+    EEPROM_Log_Stats_t s;
+
+    EEPROM_Model_Reset();
+    Test_Boot();
+    for (uint32_t n = 1; n <= 5; n++) {
+        Test_Record(record, sizeof(record), n);
+        SIM_CHECK(EEPROM_Log_Append(record, sizeof(record)) == HAL_OK);
+        SIM_CHECK(EEPROM_Cache_Sync() == HAL_OK);
+    }
+
+    // The supply fails while the first page of the sixth record is written
+    Test_Record(record, sizeof(record), 6);
+    EEPROM_Model_TearNextWrite(20);
+    SIM_CHECK(EEPROM_Log_Append(record, sizeof(record)) == HAL_OK);
+    SIM_CHECK(EEPROM_Cache_Sync() == HAL_OK);
+
+    Test_Boot();
+    EEPROM_Log_GetStats(&s);
+    SIM_CHECK_EQ(s.sequence, 5);
+    SIM_CHECK(EEPROM_Log_ReadLatest(record, sizeof(record), &length) == HAL_OK);
+    SIM_CHECK(Test_IsRecord(record, length, 5));
+
+    // A bit flipped in the newest payload later on: its CRC fails too
+    EEPROM_Model_GetArray()[s.latest_page * EEPROM_PAGE_SIZE + EEPROM_PAGE_SIZE + 3] ^= 0x01;
+    Test_Boot();
+    EEPROM_Log_GetStats(&s);
+    SIM_CHECK_EQ(s.sequence, 4);
+    SIM_CHECK(EEPROM_Log_ReadLatest(record, sizeof(record), &length) == HAL_OK);
+    SIM_CHECK(Test_IsRecord(record, length, 4));
+}
+
+static void Test_VariableLengths(void)
+{
+    static uint8_t record[EEPROM_LOG_MAX_LENGTH];
+    uint16_t length;
+    uint16_t last_length = 0;
+    EEPROM_Log_Stats_t s;
+
+    EEPROM_Model_Reset();
+    Test_Boot();
+    for (uint32_t n = 1; n <= 300; n++) {
+        last_length = (uint16_t)((n * 37) % EEPROM_LOG_MAX_LENGTH + 1);
+        Test_Record(record, last_length, n);
+        SIM_CHECK(EEPROM_Log_Append(record, last_length) == HAL_OK);
+    }
+    SIM_CHECK(EEPROM_Cache_Sync() == HAL_OK);
+
+    Test_Boot();
+    EEPROM_Log_GetStats(&s);
+    SIM_CHECK_EQ(s.sequence, 300);
+    SIM_CHECK(EEPROM_Log_ReadLatest(record, sizeof(record), &length) == HAL_OK);
+    SIM_CHECK_EQ(length, last_length);
+    SIM_CHECK(Test_IsRecord(record, length, 300));
+}
+
+int main(void)
+{
+    Test_Empty();
+    Test_WearLevelling();
+    Test_TornAppend();
+    Test_VariableLengths();
+    return Sim_Result("test_eeprom_log");
+}
@@ -0,0 +1,274 @@
+/*
+ * test_fault_latency.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * Fault-to-DTC and fault-to-CAN latency, end to end on the host models.
+ *
+ * The MP5475GU model drops Buck B at 2 s and Buck D at 5 s, both recover at
+ * 8 s. The real driver, uv_monitor and dtc_manager run the I2CTask cycle
+ * (set VOUT, start the ADC, 100 ms, poll, 100 ms), CANTask queues the DTC
+ * broadcast every second, and a tester on the virtual CAN bus receives it.
+ * Each fault is timed from the scripted rail drop to the DTC being set and
+ * to the end of the first broadcast that carries it, and checked against
+ * what the poll period and the debounce settings allow. The monitor's own
+ * figures, which start at the poll that saw the fault, must agree.
+ */
+
+#include "sim_os.h"
+#include "mp5475gu_model.h"
+#include "can_bus.h"
+#include "can_filter_model.h"
+#include "isotp_tester.h"
+#include "uv_monitor.h"
+#include "dtc_manager.h"
+#include "can_manager.h"
+#include <string.h>
+
+#define TEST_POLL_DELAY_MS      100     // Each of the two osDelay calls in StartI2CTask
+#define TEST_POLL_PERIOD_MS     (2 * TEST_POLL_DELAY_MS)
+#define TEST_DTC_PERIOD_MS      1000    // StartCANTask
+#define TEST_DURATION_MS        10000
+#define TEST_ADC_RAW            0x5A5
+#define TEST_FAULTS             2
+
+/* --- Private Variables --- */
+static I2C_HandleTypeDef hi2c1 = { .Instance = (I2C_TypeDef*)1 };
+static ADC_HandleTypeDef hadc1 = { .Instance = (ADC_TypeDef*)1 };
+static CAN_HandleTypeDef hcan1 = {
+    .Instance = (CAN_TypeDef*)1,
+    .Init = {
+        .Prescaler = 16,
+        .TimeSeg1 = CAN_BS1_1TQ,
+        .TimeSeg2 = CAN_BS2_1TQ,
+        .AutoRetransmission = ENABLE,
+        .TransmitFifoPriority = ENABLE,
+    },
+};
+
+static const MP5475GU_Model_Step_t scenario[] = {
+    { 2000, MP5475GU_UV_BUCK_B },
+    { 5000, MP5475GU_UV_BUCK_B | MP5475GU_UV_BUCK_D },
+    { 8000, 0 },
+};
+
+// One row per fault
+static const DTC_Code_t fault_code[TEST_FAULTS] = {
+    DTC_PMIC_BUCK_B_UNDERVOLTAGE,
+    DTC_PMIC_BUCK_D_UNDERVOLTAGE,
+};
+static const uint32_t fault_edge_ms[TEST_FAULTS] = { 2000, 5000 };
+static uint64_t fault_set_cycles[TEST_FAULTS];
+static uint64_t fault_queued_cycles[TEST_FAULTS];
+static uint64_t fault_bus_cycles[TEST_FAULTS];
+static uint32_t fault_monitor_ms[TEST_FAULTS];
+
+static IsoTp_Tester_t tester;
+static uint64_t broadcast_queued_cycles;
+
+/* --- Hooks --- */
+
+static void Test_CAN1_TX_IRQHandler(void)
+{
+    HAL_CAN_IRQHandler(&hcan1);
+    CAN_Manager_TX_IRQHandler();
+}
+
+static void Test_CAN1_RX_IRQHandler(void)
+{
+    HAL_CAN_IRQHandler(&hcan1);
+}
+
+static void Test_DTC_Changed(void)
+{
+    for (int i = 0; i < TEST_FAULTS; i++) {
+        if (fault_set_cycles[i] == 0 && DTC_IsSet(fault_code[i])) {
+            fault_set_cycles[i] = Sim_GetCycles();
+        }
+    }
+}
+
+static void Test_On_Message(const IsoTp_Tester_t* t)
+{
+    // The first broadcast queued after a DTC was set carries it
+    for (int i = 0; i < TEST_FAULTS; i++) {
+        if (fault_bus_cycles[i] == 0 && fault_queued_cycles[i] != 0 &&
+            broadcast_queued_cycles >= fault_queued_cycles[i]) {
+            fault_bus_cycles[i] = t->message_end_cycles;
+        }
+    }
+}
+
+/* --- Harness --- */
+
+static void Test_Boot(void)
+{
+    static const IsoTp_Tester_Config_t tester_config = {
+        .request_id = CAN_DTC_FLOW_CONTROL_ID,
+        .response_id = CAN_DTC_TRANSMIT_ID,
+        .flow_control = true,
+        .on_message = Test_On_Message,
+    };
+
+    Sim_Reset();
+    MP5475GU_Model_Reset();
+    MP5475GU_Model_Set_Adc(TEST_ADC_RAW);
+    CAN_Filter_Model_Reset();
+    CAN_Bus_Reset(CAN_Manager_Get_Bitrate(&hcan1));
+    CAN_Bus_Attach_Controller(&hcan1);
+    IsoTp_Tester_Init(&tester, "tester", &tester_config);
+    Sim_SetIrqHandler(CAN1_TX_IRQn, Test_CAN1_TX_IRQHandler);
+    Sim_SetIrqHandler(CAN1_RX0_IRQn, Test_CAN1_RX_IRQHandler);
+    Sim_SetIrqHandler(CAN1_RX1_IRQn, Test_CAN1_RX_IRQHandler);
+    Sim_SetTickHook(CAN_Manager_Tick);
+
+    mp5475gu_init();
+    DTC_Init(NULL, 0);
+    DTC_RegisterChangeCallback(Test_DTC_Changed);
+    SIM_CHECK(CAN_Manager_Init(&hcan1) == HAL_OK);
+    SIM_CHECK(CAN_Manager_Start_Rx(osMessageQueueNew(CAN_RX_POOL_SIZE, sizeof(void*), NULL)) == HAL_OK);
+}
+
+/**
+ * @brief Runs I2CTask and CANTask on the one simulated thread, each at the
+ *        point its delays would wake it.
+ */
+static void Test_Run(uint32_t duration_ms)
+{
+    static uint8_t dtc_data[DTC_STORAGE_SIZE];
+    uint32_t start = HAL_GetTick();
+    uint32_t next_i2c = start;
+    uint32_t next_can = start;
+    bool poll_next = false;
+
+    while (HAL_GetTick() - start < duration_ms) {
+        if ((int32_t)(HAL_GetTick() - next_i2c) >= 0) {
+            if (poll_next) {
+                SIM_CHECK(UV_Monitor_Poll(&hi2c1, &hadc1) == HAL_OK);
+                for (int i = 0; i < TEST_FAULTS; i++) {
+                    UV_Monitor_Latency_t latency;
+                    UV_Monitor_Get_Latency(&latency);
+                    if (fault_monitor_ms[i] == 0 && latency.faults == (uint32_t)i + 1) {
+                        fault_monitor_ms[i] = latency.uv_to_dtc_set_ms;
+                    }
+                }
+            } else {
+                SIM_CHECK(mp5475gu_set_vout(&hi2c1, BUCK_A, 1.2f) == HAL_OK);
+                HAL_ADC_Start(&hadc1);
+            }
+            poll_next = !poll_next;
+            next_i2c = HAL_GetTick() + TEST_POLL_DELAY_MS;
+        }
+        if ((int32_t)(HAL_GetTick() - next_can) >= 0) {
+            DTC_Export(dtc_data, sizeof(dtc_data));
+            if (CAN_Manager_Transmit_DTC(&hcan1, dtc_data, sizeof(dtc_data)) == HAL_OK) {
+                broadcast_queued_cycles = Sim_GetCycles();
+                UV_Monitor_DTC_Sent();
+                for (int i = 0; i < TEST_FAULTS; i++) {
+                    if (fault_set_cycles[i] != 0 && fault_queued_cycles[i] == 0) {
+                        fault_queued_cycles[i] = broadcast_queued_cycles;
+                    }
+                }
+            }
+            next_can += TEST_DTC_PERIOD_MS;
+        }
+
+        uint32_t next = ((int32_t)(next_i2c - next_can) < 0) ? next_i2c : next_can;
+        uint64_t target = (uint64_t)next * SIM_CYCLES_PER_TICK;
+        if (target > Sim_GetCycles()) {
+            Sim_AdvanceCycles(target - Sim_GetCycles());
+        }
+    }
+}
+
+/* --- Tests --- */
+
+static void Test_Latency(void)
+{
+    UV_Monitor_Latency_t latency;
+    DTC_Snapshot_t snapshot;
+    uint64_t script_start;
+
+    Test_Boot();
+    script_start = Sim_GetCycles();
+    MP5475GU_Model_Set_Script(scenario, sizeof(scenario) / sizeof(scenario[0]));
+    Test_Run(TEST_DURATION_MS);
+
+    printf("  rail | UV to DTC ms | monitor ms | UV to CAN queued ms | UV to CAN received ms\n");
+    for (int i = 0; i < TEST_FAULTS; i++) {
+        uint64_t edge = script_start + (uint64_t)fault_edge_ms[i] * SIM_CYCLES_PER_TICK;
+        double to_set = (double)(fault_set_cycles[i] - edge) / SIM_CYCLES_PER_TICK;
+        double to_queue = (double)(fault_queued_cycles[i] - edge) / SIM_CYCLES_PER_TICK;
+        double to_bus = (double)(fault_bus_cycles[i] - edge) / SIM_CYCLES_PER_TICK;
+
+        printf("  %s    | %12.1f | %10u | %19.1f | %21.1f\n", (i == 0) ? "B" : "D",
+               to_set, (unsigned)fault_monitor_ms[i], to_queue, to_bus);
+
+        SIM_CHECK(fault_set_cycles[i] > edge);
+        SIM_CHECK(fault_queued_cycles[i] >= fault_set_cycles[i]);
+        SIM_CHECK(fault_bus_cycles[i] > fault_queued_cycles[i]);
+
+        // Three bad samples (B) or 300 ms of them (D): the third poll after
+        // the one that first saw the drop, which came within one period
+        SIM_CHECK(to_set > 2 * TEST_POLL_PERIOD_MS);
+        SIM_CHECK(to_set <= 3 * TEST_POLL_PERIOD_MS + 5);
+        SIM_CHECK(fault_monitor_ms[i] >= 2 * TEST_POLL_PERIOD_MS);
+        SIM_CHECK(fault_monitor_ms[i] <= 2 * TEST_POLL_PERIOD_MS + 5);
+        SIM_CHECK(fault_monitor_ms[i] <= to_set);
+
+        // Then the next broadcast, which is on the idle bus within a few ms
+        SIM_CHECK(to_queue <= to_set + TEST_DTC_PERIOD_MS);
+        SIM_CHECK(to_bus <= to_queue + 10);
+    }
+
+    UV_Monitor_Get_Latency(&latency);
+    SIM_CHECK_EQ(latency.faults, TEST_FAULTS);
+    SIM_CHECK_EQ(latency.uv_to_dtc_set_ms, fault_monitor_ms[TEST_FAULTS - 1]);
+    SIM_CHECK(latency.uv_to_can_tx_ms >= latency.uv_to_dtc_set_ms);
+    SIM_CHECK(latency.uv_to_can_tx_ms <= latency.uv_to_dtc_set_ms + TEST_DTC_PERIOD_MS);
+
+    // The freeze frame holds what the PMIC and the ADC reported
+    SIM_CHECK(DTC_GetSnapshot(DTC_PMIC_BUCK_D_UNDERVOLTAGE, DTC_SNAPSHOT_RECORD_FIRST, &snapshot));
+    SIM_CHECK_EQ(snapshot.status_uv, MP5475GU_UV_BUCK_B | MP5475GU_UV_BUCK_D);
+    SIM_CHECK_EQ(snapshot.adc_raw, TEST_ADC_RAW);
+    SIM_CHECK_EQ(snapshot.rail_setpoint_mv[BUCK_A], 1200);
+
+    // Both rails recovered at 8 s and passed their debounce
+    SIM_CHECK(!(DTC_GetStatus(DTC_PMIC_BUCK_B_UNDERVOLTAGE) & 0x01));
+    SIM_CHECK(!(DTC_GetStatus(DTC_PMIC_BUCK_D_UNDERVOLTAGE) & 0x01));
+}
+
+/**
+ * @brief The driver against the register file: VOUT encoding and a missing device.
+ */
+static void Test_Driver(void)
+{
+    MP5475GU_StatusUV_t status;
+    uint16_t vref;
+
+    Sim_Reset();
+    MP5475GU_Model_Reset();
+    mp5475gu_init();
+
+    // VREF = (V - 0.3 V) / 2 mV over two registers, the high one first
+    SIM_CHECK(mp5475gu_set_vout(&hi2c1, BUCK_C, 1.2f) == HAL_OK);
+    vref = (uint16_t)(MP5475GU_Model_Get_Register(MP5475GU_REG_VOUT_C_HIGH) << 8) |
+           MP5475GU_Model_Get_Register(MP5475GU_REG_VOUT_C_LOW);
+    SIM_CHECK_EQ(vref, 450);
+    SIM_CHECK_EQ(mp5475gu_get_vout_mv(BUCK_C), 1200);
+    SIM_CHECK_EQ(mp5475gu_get_vout_mv(BUCK_B), 0);
+    SIM_CHECK(mp5475gu_set_vout(&hi2c1, BUCK_C, 2.5f) == HAL_ERROR);
+
+    SIM_CHECK(mp5475gu_read_uv_status(&hi2c1, &status) == HAL_OK);
+    SIM_CHECK_EQ(status.data, 0);
+    SIM_CHECK_EQ(MP5475GU_Model_Get_Transfers(), 2);
+}
+
+int main(void)
+{
+    Test_Driver();
+    Test_Latency();
+    return Sim_Result("test_fault_latency");
+}
@@ -0,0 +1,219 @@
+/*
+ * test_storage_manager.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * Unit tests of storage_manager on the 25LC256 model: reads merged within
+ * a run, requests served in the order they were queued, so a read sees the
+ * appends queued before it, and a full queue refused.
+ */
+
+#include "sim_os.h"
+#include "eeprom_model.h"
+#include "eeprom_25lc256.h"
+#include "eeprom_cache.h"
+#include "eeprom_log.h"
+#include "storage_manager.h"
+#include <string.h>
+
+#define TEST_RECORD_SIZE    76      // One DTC_Export record
+
+/* --- Private Variables --- */
+static SPI_HandleTypeDef test_hspi = { .Instance = (SPI_TypeDef*)1 };
+static const osThreadAttr_t test_storage_attributes = { .name = "storage", .stack_size = 0, .priority = osPriorityNormal };
+
+static osThreadId_t storage_thread;
+static Storage_Request_t* completed[STORAGE_QUEUE_DEPTH + 1];
+static uint32_t completed_count;
+
+/**
+ * @brief Never runs: the tests call Storage_Process themselves.
+ */
+static void Test_Storage_Task(void* argument)
+{
+    (void)argument;
+}
+
+static void Test_Done(Storage_Request_t* request)
+{
+    if (completed_count < sizeof(completed) / sizeof(completed[0])) {
+        completed[completed_count] = request;
+    }
+    completed_count++;
+}
+
+/**
+ * @brief Blank EEPROM, an empty log and an empty queue.
+ */
+static void Test_Boot(void)
+{
+    Sim_Reset();
+    EEPROM_Model_Reset();
+    EEPROM_Init(&test_hspi, GPIOC, GPIO_PIN_4);
+    EEPROM_Cache_Init(&(EEPROM_Cache_Policy_t){ 500, 4 });
+    SIM_CHECK(EEPROM_Log_Init() == HAL_OK);
+    storage_thread = osThreadNew(Test_Storage_Task, NULL, &test_storage_attributes);
+    SIM_CHECK(Storage_Init(storage_thread) == HAL_OK);
+    completed_count = 0;
+}
+
+static void Test_Record(uint8_t* p_data, uint32_t n)
+{
+    for (uint16_t i = 0; i < TEST_RECORD_SIZE; i++) {
+        p_data[i] = (uint8_t)(n + i);
+    }
+}
+
+static void Test_Request(Storage_Request_t* request, Storage_RequestType_t type, uint8_t* p_data, uint16_t size)
+{
+    *request = (Storage_Request_t){
+        .type = type,
+        .p_data = p_data,
+        .size = size,
+        .status = HAL_TIMEOUT,
+        .callback = Test_Done,
+    };
+    SIM_CHECK(Storage_Submit(request) == HAL_OK);
+}
+
+/* --- Tests --- */
+
+/**
+ * @brief A run of reads costs one EEPROM read; a buffer too small for the
+ *        record reads on its own and fails.
+ */
+static void Test_ReadMerging(void)
+{
+    static uint8_t record[TEST_RECORD_SIZE];
+    static uint8_t data[4][TEST_RECORD_SIZE];
+    Storage_Request_t append;
+    Storage_Request_t reads[4];
+    Storage_Stats_t stats;
+
+    Test_Boot();
+    Test_Record(record, 1);
+    Test_Request(&append, STORAGE_REQUEST_APPEND_RECORD, record, sizeof(record));
+    Storage_Process();
+    SIM_CHECK_EQ(append.status, HAL_OK);
+
+    Test_Request(&reads[0], STORAGE_REQUEST_READ_RECORD, data[0], sizeof(data[0]));
+    Test_Request(&reads[1], STORAGE_REQUEST_READ_RECORD, data[1], sizeof(data[1]));
+    Test_Request(&reads[2], STORAGE_REQUEST_READ_RECORD, data[2], sizeof(data[2]) - 1);
+    Test_Request(&reads[3], STORAGE_REQUEST_READ_RECORD, data[3], sizeof(data[3]));
+    Storage_Process();
+
+    Storage_GetStats(&stats);
+    SIM_CHECK_EQ(stats.reads, 4);
+    SIM_CHECK_EQ(stats.read_merges, 2);
+    SIM_CHECK_EQ(reads[2].status, HAL_ERROR);
+    for (uint32_t i = 0; i < 4; i++) {
+        if (i == 2) {
+            continue;
+        }
+        SIM_CHECK_EQ(reads[i].status, HAL_OK);
+        SIM_CHECK_EQ(reads[i].length, sizeof(record));
+        SIM_CHECK(memcmp(data[i], record, sizeof(record)) == 0);
+    }
+}
+
+/**
+ * @brief Requests complete in the order queued: each read returns the
+ *        newest append queued before it, not one queued after it, and
+ *        only the last append of a run is written.
+ */
+static void Test_Ordering(void)
+{
+    static uint8_t records[3][TEST_RECORD_SIZE];
+    static uint8_t data[3][TEST_RECORD_SIZE];
+    static uint8_t expected[TEST_RECORD_SIZE];
+    Storage_Request_t requests[6];
+    Storage_Stats_t stats;
+    EEPROM_Log_Stats_t log;
+    uint16_t length = 0;
+
+    Test_Boot();
+    for (uint32_t i = 0; i < 3; i++) {
+        Test_Record(records[i], 10 * (i + 1));
+    }
+
+    // Read on an empty log, append 1, read, append 2 and 3, read
+    Test_Request(&requests[0], STORAGE_REQUEST_READ_RECORD, data[0], sizeof(data[0]));
+    Test_Request(&requests[1], STORAGE_REQUEST_APPEND_RECORD, records[0], sizeof(records[0]));
+    Test_Request(&requests[2], STORAGE_REQUEST_READ_RECORD, data[1], sizeof(data[1]));
+    Test_Request(&requests[3], STORAGE_REQUEST_APPEND_RECORD, records[1], sizeof(records[1]));
+    Test_Request(&requests[4], STORAGE_REQUEST_APPEND_RECORD, records[2], sizeof(records[2]));
+    Test_Request(&requests[5], STORAGE_REQUEST_READ_RECORD, data[2], sizeof(data[2]));
+    Storage_Process();
+
+    SIM_CHECK_EQ(completed_count, 6);
+    for (uint32_t i = 0; i < 6; i++) {
+        SIM_CHECK(completed[i] == &requests[i]);
+    }
+    SIM_CHECK_EQ(requests[0].status, HAL_ERROR);
+    SIM_CHECK_EQ(requests[2].status, HAL_OK);
+    SIM_CHECK(memcmp(data[1], records[0], sizeof(records[0])) == 0);
+    SIM_CHECK_EQ(requests[3].status, HAL_OK);
+    SIM_CHECK_EQ(requests[4].status, HAL_OK);
+    SIM_CHECK_EQ(requests[5].status, HAL_OK);
+    SIM_CHECK(memcmp(data[2], records[2], sizeof(records[2])) == 0);
+
+    Storage_GetStats(&stats);
+    SIM_CHECK_EQ(stats.reads, 3);
+    SIM_CHECK_EQ(stats.read_merges, 0);
+    SIM_CHECK_EQ(stats.appends, 3);
+    SIM_CHECK_EQ(stats.append_merges, 1);
+    EEPROM_Log_GetStats(&log);
+    SIM_CHECK_EQ(log.appends, 2);
+
+    // What was written survives a power cycle, with the cache synced
+    SIM_CHECK(EEPROM_Cache_Sync() == HAL_OK);
+    Sim_Reset();
+    EEPROM_Model_Restart();
+    EEPROM_Init(&test_hspi, GPIOC, GPIO_PIN_4);
+    EEPROM_Cache_Init(&(EEPROM_Cache_Policy_t){ 500, 4 });
+    SIM_CHECK(EEPROM_Log_Init() == HAL_OK);
+    SIM_CHECK(EEPROM_Log_ReadLatest(expected, sizeof(expected), &length) == HAL_OK);
+    SIM_CHECK(memcmp(expected, records[2], sizeof(records[2])) == 0);
+}
+
+/**
+ * @brief A request beyond STORAGE_QUEUE_DEPTH is refused and counted; the
+ *        queue takes requests again once served.
+ */
+static void Test_QueueFull(void)
+{
+    static uint8_t data[STORAGE_QUEUE_DEPTH + 1][TEST_RECORD_SIZE];
+    Storage_Request_t requests[STORAGE_QUEUE_DEPTH + 1];
+    Storage_Stats_t stats;
+
+    Test_Boot();
+    for (uint32_t i = 0; i < STORAGE_QUEUE_DEPTH; i++) {
+        Test_Request(&requests[i], STORAGE_REQUEST_READ_RECORD, data[i], sizeof(data[i]));
+    }
+    requests[STORAGE_QUEUE_DEPTH] = requests[0];
+    requests[STORAGE_QUEUE_DEPTH].p_data = data[STORAGE_QUEUE_DEPTH];
+    SIM_CHECK(Storage_Submit(&requests[STORAGE_QUEUE_DEPTH]) == HAL_BUSY);
+    SIM_CHECK(Sim_GetThreadFlags(storage_thread) & STORAGE_REQUEST_FLAG);
+
+    Storage_GetStats(&stats);
+    SIM_CHECK_EQ(stats.queue_full, 1);
+    Storage_Process();
+    SIM_CHECK_EQ(completed_count, STORAGE_QUEUE_DEPTH);
+
+    SIM_CHECK(Storage_Submit(&requests[STORAGE_QUEUE_DEPTH]) == HAL_OK);
+    Storage_Process();
+    SIM_CHECK_EQ(completed_count, STORAGE_QUEUE_DEPTH + 1);
+    Storage_GetStats(&stats);
+    SIM_CHECK_EQ(stats.queue_full, 1);
+    SIM_CHECK_EQ(stats.reads, STORAGE_QUEUE_DEPTH + 1);
+}
+
+int main(void)
+{
+    Test_ReadMerging();
+    Test_Ordering();
+    Test_QueueFull();
+    return Sim_Result("test_storage_manager");
+}
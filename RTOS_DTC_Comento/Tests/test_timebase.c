@@ -0,0 +1,77 @@
+/*
+ * test_timebase.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * Unit tests of timebase: the 64-bit extension of the DWT cycle counter
+ * across wraps, read with and without a tick in between, and the
+ * conversions done with 32-bit divisions.
+ */
+
+#include "sim_os.h"
+#include "timebase.h"
+
+/* --- Tests --- */
+
+static void Test_Extension(void)
+{
+    Sim_Reset();
+    Timebase_Init();
+    Timebase_Tick();
+    SIM_CHECK_EQ(Timebase_GetCycles64(), DWT->CYCCNT);
+
+    // Into the upper half, then across the wrap before the next tick
+    DWT->CYCCNT = 0x7FFFFFF0U;
+    Timebase_Tick();
+    DWT->CYCCNT = 0x80000010U;
+    SIM_CHECK_EQ(Timebase_GetCycles64(), 0x80000010ULL);
+    Timebase_Tick();
+    DWT->CYCCNT = 0x00000010U;
+    SIM_CHECK_EQ(Timebase_GetCycles64(), 0x100000010ULL);
+    Timebase_Tick();
+    SIM_CHECK_EQ(Timebase_GetCycles64(), 0x100000010ULL);
+
+    // Ticks of the simulated kernel keep it going
+    Sim_SetTickHook(Timebase_Tick);
+    Sim_AdvanceCycles(3ULL << 32);
+    SIM_CHECK_EQ(Timebase_GetCycles64(), 0x100000010ULL + (3ULL << 32));
+}
+
+static void Test_Conversions(void)
+{
+    static const uint32_t clocks[] = { 16000000U, 100000000U };
+    uint64_t cycles;
+
+    for (uint32_t c = 0; c < sizeof(clocks) / sizeof(clocks[0]); c++) {
+        uint32_t cycles_per_us = clocks[c] / 1000000U;
+
+        SystemCoreClock = clocks[c];
+        Sim_Reset();
+        Timebase_Init();
+        DWT->CYCCNT = 0;
+        Timebase_Tick();
+        cycles = 0;
+
+        // Steps below half a period, so each tick sees every half
+        for (uint32_t i = 0; i < 200; i++) {
+            cycles += 0x7654321UL * (i % 17 + 1);
+            DWT->CYCCNT = (uint32_t)cycles;
+            Timebase_Tick();
+
+            SIM_CHECK_EQ(Timebase_GetCycles64(), cycles);
+            SIM_CHECK_EQ(Timebase_GetUs(), cycles / cycles_per_us);
+            SIM_CHECK_EQ(Timebase_GetTime(100), (uint32_t)(cycles / (cycles_per_us * 100U)));
+            SIM_CHECK_EQ(Timebase_GetTime(655), (uint32_t)(cycles / (cycles_per_us * 655U)));
+        }
+    }
+    SystemCoreClock = SIM_CPU_HZ;
+}
+
+int main(void)
+{
+    Test_Extension();
+    Test_Conversions();
+    return Sim_Result("test_timebase");
+}
@@ -0,0 +1,174 @@
+/*
+ * test_uds_server.c
+ *
+ *  Created on: 2026. 10. 16.
+ */
+
+/*
+ * Request to response byte checks of uds_server against a known DTC state.
+ *
+ * Buck B has failed with a snapshot and Buck D without one; A and C have
+ * not run yet. Each table entry is one request, physical or functional,
+ * with the exact response it must get: the ReadDTCInformation
+ * sub-functions, record number filtering, the negative responses, the
+ * suppressPosRspMsgIndicationBit and the NRCs a functional request is not
+ * answered with.
+ */
+
+#include "sim_os.h"
+#include "dtc_manager.h"
+#include "uds_server.h"
+#include <string.h>
+
+#define TEST_RESPONSE_SIZE      128
+#define TEST_FAILURE_TIME       0x01020304
+
+// DTCAndStatusRecords of the table, in the state Test_Setup leaves
+#define DTC_A   0x50, 0x01, 0x16, 0x50
+#define DTC_B   0x50, 0x02, 0x16, 0xAF
+#define DTC_C   0x50, 0x03, 0x16, 0x50
+#define DTC_D   0x50, 0x04, 0x16, 0xAF
+
+// Buck B's snapshot as a DTCSnapshotRecord without its record number
+#define SNAPSHOT_B  0x07, \
+                    0xD1, 0x00, 0x04, 0xB0, 0xD1, 0x01, 0x03, 0xE8, 0xD1, 0x02, 0x07, 0x08, \
+                    0xD1, 0x03, 0x0C, 0xE4, 0xD1, 0x04, 0x04, 0xD1, 0x05, 0x07, 0xAB, \
+                    0xD1, 0x06, 0x00, 0x00, 0x04, 0xD2
+
+typedef struct {
+    const char* name;
+    uint8_t request[8];
+    uint8_t request_length;
+    bool functional;
+    uint16_t response_size;         // 0 for TEST_RESPONSE_SIZE
+    uint8_t response[80];
+    uint16_t response_length;       // 0 if no response may be sent
+} Test_Case_t;
+
+#define REQ(...)    { __VA_ARGS__ }, sizeof((uint8_t[]){ __VA_ARGS__ })
+#define RSP(...)    { __VA_ARGS__ }, sizeof((uint8_t[]){ __VA_ARGS__ })
+#define NO_RSP      { 0 }, 0
+
+static const Test_Case_t test_cases[] = {
+    // reportNumberOfDTCByStatusMask
+    { "01 confirmed", REQ(0x19, 0x01, 0x08), false, 0, RSP(0x59, 0x01, 0xFF, 0x01, 0x00, 0x02) },
+    { "01 none", REQ(0x19, 0x01, 0x00), false, 0, RSP(0x59, 0x01, 0xFF, 0x01, 0x00, 0x00) },
+    { "01 short", REQ(0x19, 0x01), false, 0, RSP(0x7F, 0x19, 0x13) },
+    { "01 long", REQ(0x19, 0x01, 0x08, 0x00), false, 0, RSP(0x7F, 0x19, 0x13) },
+    { "01 no room", REQ(0x19, 0x01, 0x08), false, 5, RSP(0x7F, 0x19, 0x14) },
+
+    // reportDTCByStatusMask
+    { "02 testFailed", REQ(0x19, 0x02, 0x01), false, 0, RSP(0x59, 0x02, 0xFF, DTC_B, DTC_D) },
+    { "02 not completed", REQ(0x19, 0x02, 0x40), false, 0, RSP(0x59, 0x02, 0xFF, DTC_A, DTC_C) },
+    { "02 none", REQ(0x19, 0x02, 0x00), false, 0, RSP(0x59, 0x02, 0xFF) },
+    { "02 short", REQ(0x19, 0x02), false, 0, RSP(0x7F, 0x19, 0x13) },
+    { "02 no room", REQ(0x19, 0x02, 0x01), false, 10, RSP(0x7F, 0x19, 0x14) },
+
+    // reportDTCSnapshotRecordByDTCNumber
+    { "04 first", REQ(0x19, 0x04, 0x50, 0x02, 0x16, 0x01), false, 0,
+      RSP(0x59, 0x04, DTC_B, 0x01, SNAPSHOT_B) },
+    { "04 latest", REQ(0x19, 0x04, 0x50, 0x02, 0x16, 0x02), false, 0,
+      RSP(0x59, 0x04, DTC_B, 0x02, SNAPSHOT_B) },
+    { "04 all", REQ(0x19, 0x04, 0x50, 0x02, 0x16, 0xFF), false, 0,
+      RSP(0x59, 0x04, DTC_B, 0x01, SNAPSHOT_B, 0x02, SNAPSHOT_B) },
+    { "04 never captured", REQ(0x19, 0x04, 0x50, 0x04, 0x16, 0xFF), false, 0, RSP(0x59, 0x04, DTC_D) },
+    { "04 record 3", REQ(0x19, 0x04, 0x50, 0x02, 0x16, 0x03), false, 0, RSP(0x7F, 0x19, 0x31) },
+    { "04 unknown DTC", REQ(0x19, 0x04, 0x50, 0x05, 0x16, 0x01), false, 0, RSP(0x7F, 0x19, 0x31) },
+    { "04 short", REQ(0x19, 0x04, 0x50, 0x02, 0x16), false, 0, RSP(0x7F, 0x19, 0x13) },
+    { "04 no room", REQ(0x19, 0x04, 0x50, 0x02, 0x16, 0xFF), false, 40, RSP(0x7F, 0x19, 0x14) },
+
+    // reportDTCExtDataRecordByDTCNumber
+    { "06 occurrences", REQ(0x19, 0x06, 0x50, 0x02, 0x16, 0x01), false, 0,
+      RSP(0x59, 0x06, DTC_B, 0x01, 0x01) },
+    { "06 first failure", REQ(0x19, 0x06, 0x50, 0x02, 0x16, 0x03), false, 0,
+      RSP(0x59, 0x06, DTC_B, 0x03, 0x01, 0x02, 0x03, 0x04) },
+    { "06 all", REQ(0x19, 0x06, 0x50, 0x02, 0x16, 0xFF), false, 0,
+      RSP(0x59, 0x06, DTC_B, 0x01, 0x01, 0x02, 0x01, 0x03, 0x01, 0x02, 0x03, 0x04, 0x04, 0x01, 0x02, 0x03, 0x04) },
+    { "06 not failed", REQ(0x19, 0x06, 0x50, 0x01, 0x16, 0xFF), false, 0,
+      RSP(0x59, 0x06, DTC_A, 0x01, 0x00, 0x02, 0x00, 0x03, 0x00, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x00) },
+    { "06 record 5", REQ(0x19, 0x06, 0x50, 0x02, 0x16, 0x05), false, 0, RSP(0x7F, 0x19, 0x31) },
+    { "06 unknown DTC", REQ(0x19, 0x06, 0x00, 0x00, 0x00, 0x01), false, 0, RSP(0x7F, 0x19, 0x31) },
+    { "06 no room", REQ(0x19, 0x06, 0x50, 0x02, 0x16, 0xFF), false, 12, RSP(0x7F, 0x19, 0x14) },
+
+    // reportSupportedDTC
+    { "0A", REQ(0x19, 0x0A), false, 0, RSP(0x59, 0x0A, 0xFF, DTC_A, DTC_B, DTC_C, DTC_D) },
+    { "0A long", REQ(0x19, 0x0A, 0x00), false, 0, RSP(0x7F, 0x19, 0x13) },
+    { "0A no room", REQ(0x19, 0x0A), false, 10, RSP(0x7F, 0x19, 0x14) },
+
+    // Other services and sub-functions
+    { "no sub-function", REQ(0x19), false, 0, RSP(0x7F, 0x19, 0x13) },
+    { "sub-function 03", REQ(0x19, 0x03), false, 0, RSP(0x7F, 0x19, 0x12) },
+    { "service 22", REQ(0x22, 0xF1, 0x90), false, 0, RSP(0x7F, 0x22, 0x11) },
+
+    // suppressPosRspMsgIndicationBit: negative responses are still sent
+    { "SPRMIB 01", REQ(0x19, 0x81, 0x08), false, 0, NO_RSP },
+    { "SPRMIB 0A", REQ(0x19, 0x8A), false, 0, NO_RSP },
+    { "SPRMIB short", REQ(0x19, 0x81), false, 0, RSP(0x7F, 0x19, 0x13) },
+    { "SPRMIB 03", REQ(0x19, 0x83), false, 0, RSP(0x7F, 0x19, 0x12) },
+    { "SPRMIB functional", REQ(0x19, 0x8A), true, 0, NO_RSP },
+
+    // Functional requests: only the ECUs that support them answer
+    { "functional 01", REQ(0x19, 0x01, 0x08), true, 0, RSP(0x59, 0x01, 0xFF, 0x01, 0x00, 0x02) },
+    { "functional service 22", REQ(0x22, 0xF1, 0x90), true, 0, NO_RSP },
+    { "functional 03", REQ(0x19, 0x03), true, 0, NO_RSP },
+    { "functional unknown DTC", REQ(0x19, 0x04, 0x50, 0x05, 0x16, 0x01), true, 0, NO_RSP },
+    { "functional short", REQ(0x19, 0x01), true, 0, RSP(0x7F, 0x19, 0x13) },
+    { "functional no room", REQ(0x19, 0x0A), true, 10, RSP(0x7F, 0x19, 0x14) },
+};
+
+#define TEST_CASE_COUNT  (sizeof(test_cases) / sizeof(test_cases[0]))
+
+/* --- Harness --- */
+
+static uint32_t Test_Time(void)
+{
+    return TEST_FAILURE_TIME;
+}
+
+/**
+ * @brief Leaves Buck B failed with a snapshot and Buck D failed without one.
+ */
+static void Test_Setup(void)
+{
+    static const DTC_Snapshot_t snapshot = { { 1200, 1000, 1800, 3300 }, 0x7AB, 0x04, 1234 };
+
+    DTC_Init(NULL, 0);
+    DTC_RegisterTimeSource(Test_Time);
+    DTC_StartOperationCycle();
+    DTC_SetWithSnapshot(DTC_PMIC_BUCK_B_UNDERVOLTAGE, &snapshot);
+    DTC_Set(DTC_PMIC_BUCK_D_UNDERVOLTAGE);
+}
+
+/* --- Tests --- */
+
+static void Test_Table(void)
+{
+    uint8_t response[TEST_RESPONSE_SIZE];
+
+    Test_Setup();
+    for (uint32_t i = 0; i < TEST_CASE_COUNT; i++) {
+        const Test_Case_t* t = &test_cases[i];
+        uint16_t size = t->response_size ? t->response_size : sizeof(response);
+        uint16_t length;
+
+        memset(response, 0xEE, sizeof(response));
+        length = UDS_Server_Process(t->request, t->request_length, t->functional, response, size);
+        if (length != t->response_length || memcmp(response, t->response, length) != 0) {
+            fprintf(stderr, "case \"%s\": got %u bytes:", t->name, (unsigned)length);
+            for (uint16_t b = 0; b < length; b++) {
+                fprintf(stderr, " %02X", response[b]);
+            }
+            fprintf(stderr, "\n");
+        }
+        SIM_CHECK_EQ(length, t->response_length);
+        SIM_CHECK(memcmp(response, t->response, length) == 0);
+        SIM_CHECK(length <= size);
+    }
+    DTC_RegisterTimeSource(NULL);
+}
+
+int main(void)
+{
+    Test_Table();
+    return Sim_Result("test_uds_server");
+}